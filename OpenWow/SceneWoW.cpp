@@ -6,6 +6,16 @@
 // Additional
 #include "Client/Client.h"
 
+namespace
+{
+	// Archive with textures in game data folder (see 'WoW_DataPath')
+#if WOW_CLIENT_VERSION == WOW_CLASSIC_1_12_1
+	const std::string cTexturesArchiveName = "texture.MPQ";
+#else
+	const std::string cTexturesArchiveName = "common.MPQ";
+#endif
+}
+
 CSceneWoW::CSceneWoW(IBaseManager& BaseManager)
 	: SceneBase(BaseManager)
 {}
@@ -58,11 +68,12 @@ void CSceneWoW::Initialize()
 
 	//m_Technique3D.AddPass(std::make_shared<CRenderPass_WMO2>(GetRenderDevice(), wmoListPass, shared_from_this())->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
 	
-	m_Technique3D.AddPass(std::make_shared<CRenderPass_M2>(GetRenderDevice(), sceneListPass, true)->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
-	m_Technique3D.AddPass(std::make_shared<CRenderPass_M2>(GetRenderDevice(), sceneListPass, false)->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
+	//m_Technique3D.AddPass(std::make_shared<CRenderPass_M2>(GetRenderDevice(), sceneListPass, true)->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
+	//m_Technique3D.AddPass(std::make_shared<CRenderPass_M2>(GetRenderDevice(), sceneListPass, false)->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
 	
-	//m_Technique3D.AddPass(std::make_shared<CRenderPass_M2_Instanced>(GetRenderDevice(), sceneListPass, true)->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
-	//m_Technique3D.AddPass(std::make_shared<CRenderPass_M2_Instanced>(GetRenderDevice(), sceneListPass, false)->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
+	m_Technique3D.AddPass(std::make_shared<CRenderPass_M2_Instanced>(GetRenderDevice(), sceneListPass, true)->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
+	m_Technique3D.AddPass(std::make_shared<CRenderPass_M2_Instanced>(GetRenderDevice(), sceneListPass, false)->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
+	m_Technique3D.AddPass(std::make_shared<CRenderPass_M2_Particles>(GetRenderDevice(), sceneListPass)->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
 	
 	//m_Technique3D.AddPass(std::make_shared<CDrawBoundingBoxPass>(GetRenderDevice(), shared_from_this())->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
 	//m_Technique3D.AddPass(std::make_shared<CMaterialParticlePass>(GetRenderDevice(), shared_from_this())->CreatePipeline(GetRenderWindow()->GetRenderTarget(), &GetRenderWindow()->GetViewport()));
@@ -93,6 +104,9 @@ void CSceneWoW::OnPreRender(RenderEventArgs& e)
 	CMapM2Instance::reset();
 #endif
 
+	GetBaseManager().GetManager<IWoWObjectsCreator>()->UpdateCreatures();
+	GetBaseManager().GetManager<IWoWObjectsCreator>()->UpdateTextures(e.TotalTime);
+
 	//m2Instance->SetRotation(glm::vec3(m2Instance->GetRotation().x, m2Instance->GetRotation().y + 0.05f * e.DeltaTime / 60.0f, 0.0f));
 
 	SceneBase::OnPreRender(e);
@@ -116,6 +130,10 @@ bool CSceneWoW::OnWindowKeyPressed(KeyEventArgs & e)
 		return true;
 	}
 
+	if (GetBaseManager().GetManager<ISettings>()->GetGroup("WoWSettings")->GetSettingT<bool>("Debug_TestHotkeys")->Get())
+		if (OnDebugKeyPressed(e))
+			return true;
+
 	return SceneBase::OnWindowKeyPressed(e);
 }
 
@@ -124,6 +142,37 @@ void CSceneWoW::OnWindowKeyReleased(KeyEventArgs & e)
 	SceneBase::OnWindowKeyReleased(e);
 }
 
+bool CSceneWoW::OnDebugKeyPressed(KeyEventArgs & e)
+{
+	if (e.Key == KeyCode::B)
+	{
+		TestM2CollisionBenchmark();
+		return true;
+	}
+	else if (e.Key == KeyCode::P)
+	{
+		TestM2ParticlesBenchmark();
+		return true;
+	}
+	else if (e.Key == KeyCode::N)
+	{
+		TestBLPDecodeBenchmark();
+		return true;
+	}
+	else if (e.Key == KeyCode::M)
+	{
+		TestBLPDecodersValidation();
+		return true;
+	}
+	else if (e.Key == KeyCode::K)
+	{
+		TestTexturesCacheReport();
+		return true;
+	}
+
+	return false;
+}
+
 
 
 //
@@ -174,7 +223,8 @@ void CSceneWoW::Load3D_M2s()
 {
 	Random r(time(0));
 
-	CWorldObjectCreator creator(GetBaseManager());
+	std::vector<uint32> displayInfos;
+	std::vector<std::shared_ptr<ISceneNode3D>> parents;
 
 	const auto& records = GetBaseManager().GetManager<CDBCStorage>()->DBC_CreatureDisplayInfo().Records();
 	for (size_t i = 0; i < 25; i++)
@@ -194,7 +244,17 @@ void CSceneWoW::Load3D_M2s()
 				id = r.NextUInt() % records.size();
 			}
 
-			auto creature = creator.BuildCreatureFromDisplayInfo(GetRenderDevice(), this, id, GetRootNode3D());
+			displayInfos.push_back(static_cast<uint32>(id));
+			parents.push_back(GetRootNode3D());
+		}
+	}
+
+	auto creatures = GetBaseManager().GetManager<IWoWObjectsCreator>()->BuildCreaturesFromDisplayInfos(GetRenderDevice(), this, displayInfos, parents);
+	for (size_t i = 0; i < 25; i++)
+	{
+		for (size_t j = 0; j < 25; j++)
+		{
+			const auto& creature = creatures[i * 25 + j];
 			if (creature != nullptr)
 			{
 				creature->SetTranslate(glm::vec3(i * 17.5f, 0.0f, j * 17.5f));
@@ -296,3 +356,67 @@ void CSceneWoW::TestDeleteMap()
 	map->Unload();
 }
 
+void CSceneWoW::TestM2CollisionBenchmark()
+{
+	const uint32 cRaysCount = 100000;
+
+	std::shared_ptr<CMapTile> tile = (map != nullptr) ? map->getCurrentTile() : nullptr;
+	if (tile == nullptr)
+	{
+		Log::Warn("M2 collision benchmark: map tile isn't loaded.");
+		return;
+	}
+
+	std::vector<const CM2_Base_Instance*> instances;
+	for (const auto& it : tile->m_MDXsInstances)
+		instances.push_back(it);
+
+	SM2_CollisionBenchmarkResult result = M2CollisionBenchmark(instances, cRaysCount);
+	Log::Info("M2 collision benchmark: tile [%d, %d], instances '%d' (with collision '%d'), rays '%d', hits '%d', BVH queries '%d'. Total '%0.3f' ms, '%0.3f' us per ray.",
+		tile->getIndexX(), tile->getIndexZ(), result.Instances, result.InstancesWithCollision, result.Rays, result.Hits, result.BVHQueries,
+		result.TotalTime, (result.Rays > 0) ? (result.TotalTime * 1000.0 / result.Rays) : 0.0);
+}
+
+void CSceneWoW::TestM2ParticlesBenchmark()
+{
+	const size_t cEmittersCount = 1000;
+	const size_t cFramesCount = 300;
+
+	CM2_ParticlesPool::Benchmark(cEmittersCount, cFramesCount);
+}
+
+std::string CSceneWoW::GetTexturesArchiveFileName()
+{
+	return GetBaseManager().GetManager<ISettings>()->GetGroup("WoWSettings")->GetSettingT<std::string>("WoW_DataPath")->Get() + cTexturesArchiveName;
+}
+
+void CSceneWoW::TestBLPDecodeBenchmark()
+{
+	SBLP_DecodeBenchmarkResult result = CImageBLP::Benchmark(GetBaseManager(), GetTexturesArchiveFileName());
+	Log::Info("BLP decode benchmark: files '%d', decoded '%d', mismatches '%d'. Reference '%0.3f' ms, SSE2 '%0.3f' ms.",
+		result.Files, result.Decoded, result.Mismatches, result.ReferenceTime, result.Time);
+}
+
+void CSceneWoW::TestBLPDecodersValidation()
+{
+	SBLP_DecodersValidationResult result = CImageBLP::ValidateDecoders(GetBaseManager(), GetTexturesArchiveFileName());
+	Log::Info("BLP decoders validation: files '%d', mips '%d', invalid mip chains '%d', mismatches '%d'.",
+		result.Files, result.Mips, result.InvalidMipChains, result.Mismatches);
+}
+
+void CSceneWoW::TestTexturesCacheReport()
+{
+	const size_t cReportCount = 20;
+
+	const CTexturesCache* texturesCache = GetBaseManager().GetManager<IWoWObjectsCreator>()->GetTexturesCache();
+	if (texturesCache == nullptr)
+		return;
+
+	STexturesCacheStatistics statistics = texturesCache->GetStatistics();
+	Log::Info("Textures cache: textures '%d', hits '%llu', misses '%llu', evictions '%llu'. Resident '%llu' KB (retained '%llu' KB), budget '%llu' KB.",
+		statistics.Textures, statistics.Hits, statistics.Misses, statistics.Evictions, statistics.ResidentBytes / 1024ull, statistics.RetainedBytes / 1024ull, statistics.BudgetBytes / 1024ull);
+
+	for (const auto& consumer : texturesCache->GetTopConsumers(cReportCount))
+		Log::Info("    '%s' [%dx%d]%s: '%llu' KB, users '%d', hits '%llu'.",
+			consumer.FileName.c_str(), consumer.Width, consumer.Height, consumer.IsStreamed ? " (streamed)" : "", consumer.Bytes / 1024ull, consumer.Users, consumer.Hits);
+}
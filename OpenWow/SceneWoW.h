@@ -20,6 +20,8 @@ public:
 	virtual void OnWindowKeyReleased(KeyEventArgs& e) override;
 
 private:
+	bool OnDebugKeyPressed(KeyEventArgs& e); // Benchmarks and validations, enabled by 'Debug_TestHotkeys'
+
 	void Load3D();
 	void Load3D_M2s();
 	void LoadUI();
@@ -27,6 +29,12 @@ private:
 	void TestCreateMap(uint32 mapID);
 	void GoToCoord(const ISceneNodeUI* Node, const glm::vec2& Point);
 	void TestDeleteMap();
+	void TestM2CollisionBenchmark();
+	void TestM2ParticlesBenchmark();
+	std::string GetTexturesArchiveFileName();
+	void TestBLPDecodeBenchmark();
+	void TestBLPDecodersValidation();
+	void TestTexturesCacheReport();
 
 private:
 	std::shared_ptr<CWMO_Base_Instance> wmoInstance;
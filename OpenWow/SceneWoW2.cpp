@@ -75,6 +75,9 @@ void CSceneWoW2::OnPreRender(RenderEventArgs& e)
 	CMapM2Instance::reset();
 #endif
 
+	GetBaseManager().GetManager<IWoWObjectsCreator>()->UpdateCreatures();
+	GetBaseManager().GetManager<IWoWObjectsCreator>()->UpdateTextures(e.TotalTime);
+
 	SceneBase::OnPreRender(e);
 }
 
@@ -6,14 +6,30 @@ struct M2PerObject
 	float4   Color;
 };
 
+struct M2PerInstance
+{
+	float4x4 Model;
+	float4   Color;
+	uint     BonesOffset; // Instance bones palette (whole skin bones lookup) in 'InstancesBones'
+	uint3    __padding;
+};
+
+// Packed vertex (32 bytes, see SM2_Vertex_znEngine). Packed elements are fetched as raw 32-bit values.
 struct VertexShaderInput
 {
-	float3 position  : POSITION;
-	float4 boneWeight: BLENDWEIGHT0;
-	uint4  boneIndex : BLENDINDICES0;
-	float3 normal    : NORMAL0;
-	float2 texCoord0 : TEXCOORD0;
-	float2 texCoord1 : TEXCOORD1;
+	float3 position              : POSITION;
+	uint2  packedBones           : BLENDWEIGHT0; // 4 x unorm8 weights, 4 x uint8 indexes
+	uint3  packedNormalTexCoords : NORMAL0;      // octahedron snorm16 x 2, half2, half2
+};
+
+struct M2Vertex
+{
+	float3 position;
+	float4 boneWeight;
+	uint4  boneIndex;
+	float3 normal;
+	float2 texCoord0;
+	float2 texCoord1;
 };
 
 struct VertexShaderOutput
@@ -57,6 +73,12 @@ cbuffer M2Geometry : register(b7)
 	float __padding1;
 };
 
+cbuffer M2InstancesRange : register(b8)
+{
+	uint  gInstancesOffset;
+	uint3 __padding2;
+};
+
 // Textures and samples
 Texture2D DiffuseTexture0        : register(t0);
 Texture2D DiffuseTexture1        : register(t1);
@@ -64,42 +86,63 @@ Texture2D DiffuseTexture1        : register(t1);
 sampler   DiffuseTexture0Sampler : register(s0);
 sampler   DiffuseTexture1Sampler : register(s1);
 
-StructuredBuffer<M2PerObject> Instances  : register(t3);
+StructuredBuffer<M2PerInstance> Instances  : register(t3);
 StructuredBuffer<float4x4> Bones  : register(t4);
+StructuredBuffer<float4x4> InstancesBones  : register(t5);
 
 float4 MixColorAndTexture(uint BlendMode, float4 _in, float4 tex0);
 
-VertexShaderOutput DoPSRender(VertexShaderInput IN, M2PerObject M2PerObject)
+uint4 UnpackUint8x4(uint Packed)
+{
+	return uint4(Packed & 0xFFu, (Packed >> 8) & 0xFFu, (Packed >> 16) & 0xFFu, Packed >> 24);
+}
+
+float3 UnpackOctahedronNormal(uint Packed)
 {
+	float2 e = max(float2(int2(Packed << 16, Packed) >> 16) / 32767.0f, -1.0f);
+	float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	float t = saturate(-n.z);
+	n.xy += (n.xy >= 0.0f) ? -t : t;
+	return normalize(n);
+}
+
+M2Vertex UnpackVertex(VertexShaderInput IN)
+{
+	M2Vertex vertex;
+	vertex.position = IN.position;
+	vertex.boneWeight = float4(UnpackUint8x4(IN.packedBones.x)) / 255.0f;
+	vertex.boneIndex = UnpackUint8x4(IN.packedBones.y);
+	vertex.normal = UnpackOctahedronNormal(IN.packedNormalTexCoords.x);
+	vertex.texCoord0 = f16tof32(uint2(IN.packedNormalTexCoords.y, IN.packedNormalTexCoords.y >> 16));
+	vertex.texCoord1 = f16tof32(uint2(IN.packedNormalTexCoords.z, IN.packedNormalTexCoords.z >> 16));
+	return vertex;
+}
+
+float4 SkinVertex(M2Vertex IN, bool IsInstanced, uint BonesOffset)
+{
+	if (gIsAnimated == 0u || gBonesMaxInfluences == 0u)
+		return float4(IN.position, 1.0f);
+
 	float4 newVertex = float4(0.0f, 0.0f, 0.0f, 0.0f);
-	
-	if (gIsAnimated && gBonesMaxInfluences > 0u)
-	{	
-		for (uint i = 0; i < gBonesMaxInfluences; i++)
+	for (uint i = 0; i < gBonesMaxInfluences; i++)
+	{
+		if (IN.boneWeight[i] > 0.0f)
 		{
-			if (IN.boneWeight[i] > 0.0f)
-			{
-				//uint boneIndexes[4];
-				//boneIndexes[0] = (IN.boneIndex & 0xFF000000u >> 24) & 0x000000FFu;
-				//boneIndexes[1] = (IN.boneIndex & 0x00FF0000u >> 16) & 0x000000FFu;
-				//boneIndexes[2] = (IN.boneIndex & 0x0000FF00u >>  8) & 0x000000FFu;
-				//boneIndexes[3] = (IN.boneIndex & 0x000000FFu      ) & 0x000000FFu;
-			
-				newVertex += mul(Bones[(IN.boneIndex[i])], float4(IN.position, 1.0f) * IN.boneWeight[i]);
-			}
+			float4x4 bone = IsInstanced ? InstancesBones[BonesOffset + gStartBoneIndex + IN.boneIndex[i]] : Bones[IN.boneIndex[i]];
+			newVertex += mul(bone, float4(IN.position, 1.0f) * IN.boneWeight[i]);
 		}
 	}
-	else
-	{
-		newVertex = float4(IN.position, 1.0f);
-	}
+	return newVertex;
+}
 
-	const float4x4 mvp = mul(PF.Projection, mul(PF.View, M2PerObject.Model));
+VertexShaderOutput DoPSRender(M2Vertex IN, float4x4 Model, float4 Color, float4 newVertex)
+{
+	const float4x4 mvp = mul(PF.Projection, mul(PF.View, Model));
 
 	VertexShaderOutput OUT;
 	OUT.positionVS = mul(mvp, newVertex);
 	OUT.positionWS = newVertex;
-	OUT.color = M2PerObject.Color;
+	OUT.color = Color;
 	OUT.normal = mul(mvp, IN.normal);
 	if (gTextureAnimEnable)
 	{
@@ -116,12 +159,15 @@ VertexShaderOutput DoPSRender(VertexShaderInput IN, M2PerObject M2PerObject)
 
 VertexShaderOutput VS_main(VertexShaderInput IN)
 {
-	return DoPSRender(IN, M2PO);
+	M2Vertex vertex = UnpackVertex(IN);
+	return DoPSRender(vertex, M2PO.Model, M2PO.Color, SkinVertex(vertex, false, 0u));
 }
 
 VertexShaderOutput VS_main_Inst(VertexShaderInput IN, uint InstanceID : SV_InstanceID)
 {
-	return DoPSRender(IN, Instances[InstanceID]);
+	M2PerInstance instance = Instances[gInstancesOffset + InstanceID];
+	M2Vertex vertex = UnpackVertex(IN);
+	return DoPSRender(vertex, instance.Model, instance.Color, SkinVertex(vertex, true, instance.BonesOffset));
 }
 
 
@@ -0,0 +1,49 @@
+#include "IDB_SHADER_COMMON_INCLUDE"
+
+struct ParticleVertex
+{
+	float3 Position;
+	float4 Color;
+	float2 TexCoord;
+};
+
+struct VertexShaderOutput
+{
+	float4 positionVS : SV_POSITION;
+	float4 positionWS : POSITION;
+	float4 color      : COLOR0;
+	float2 texCoord   : TEXCOORD0;
+};
+
+// Textures and samples
+Texture2D DiffuseTexture        : register(t0);
+sampler   DiffuseTextureSampler : register(s0);
+
+// Vertices of all particles of the frame (already in world space)
+StructuredBuffer<ParticleVertex> Vertices : register(t3);
+
+VertexShaderOutput VS_main(uint VertexID : SV_VertexID)
+{
+	const ParticleVertex vertex = Vertices[VertexID];
+	const float4x4 vp = mul(PF.Projection, PF.View);
+
+	VertexShaderOutput OUT;
+	OUT.positionVS = mul(vp, float4(vertex.Position, 1.0f));
+	OUT.positionWS = float4(vertex.Position, 1.0f);
+	OUT.color = vertex.Color;
+	OUT.texCoord = vertex.TexCoord;
+	return OUT;
+}
+
+DefferedRenderPSOut PS_main(VertexShaderOutput IN) : SV_TARGET
+{
+	float4 resultColor = DiffuseTexture.Sample(DiffuseTextureSampler, IN.texCoord) * IN.color;
+	if (resultColor.a < (1.0f / 255.0f))
+		discard;
+
+	DefferedRenderPSOut OUT;
+	OUT.Diffuse = resultColor;
+	OUT.Specular = float4(0.0f, 0.0f, 0.0f, 1.0f);
+	OUT.NormalWS = float4(0.0f, 0.0f, 0.0f, 0.0f);
+	return OUT;
+}
@@ -100,14 +100,37 @@ std::shared_ptr<WoWUnit> WoWUnit::Create(IBaseManager& BaseManager, IRenderDevic
 
 void WoWUnit::AfterCreate(IBaseManager& BaseManager, IRenderDevice& RenderDevice, IScene * Scene)
 {
-	uint32 displayInfo = GetUInt32Value(UNIT_FIELD_DISPLAYID);
-	if (displayInfo != 0)
-	{
-		CWorldObjectCreator creator(BaseManager);
-		m_HiddenNode = creator.BuildCreatureFromDisplayInfo(RenderDevice, Scene, displayInfo, shared_from_this());
-	}
-	else
+	AfterCreateUnits(BaseManager, RenderDevice, Scene, { std::dynamic_pointer_cast<WoWUnit>(shared_from_this()) });
+}
+
+void WoWUnit::AfterCreateUnits(IBaseManager& BaseManager, IRenderDevice& RenderDevice, IScene * Scene, const std::vector<std::shared_ptr<WoWUnit>>& Units)
+{
+	std::vector<std::shared_ptr<WoWUnit>> units;
+	std::vector<uint32> displayInfos;
+	std::vector<std::shared_ptr<ISceneNode3D>> parents;
+
+	for (const auto& unit : Units)
 	{
-		_ASSERT(false);
+		uint32 displayInfo = unit->GetUInt32Value(UNIT_FIELD_DISPLAYID);
+		if (displayInfo == 0)
+		{
+			_ASSERT(false);
+			continue;
+		}
+
+		units.push_back(unit);
+		displayInfos.push_back(displayInfo);
+		parents.push_back(unit);
 	}
+
+	if (units.empty())
+		return;
+
+	std::vector<std::weak_ptr<WoWUnit>> unitsWPtrs(units.begin(), units.end());
+
+	// Registered creator shares models and textures caches. Packet thread doesn't wait, nodes are attached on update thread.
+	BaseManager.GetManager<IWoWObjectsCreator>()->AddCreaturesToLoadQueue(RenderDevice, Scene, displayInfos, parents, [unitsWPtrs](size_t Index, const std::shared_ptr<Creature>& NewCreature) {
+		if (auto unit = unitsWPtrs[Index].lock())
+			unit->m_HiddenNode = NewCreature;
+	});
 }
@@ -201,6 +201,7 @@ public:
 public:
 	static std::shared_ptr<WoWUnit> Create(IBaseManager& BaseManager, IRenderDevice& RenderDevice, IScene * Scene, ObjectGuid Guid);
 	virtual void AfterCreate(IBaseManager& BaseManager, IRenderDevice& RenderDevice, IScene * Scene) override;
+	static void AfterCreateUnits(IBaseManager& BaseManager, IRenderDevice& RenderDevice, IScene * Scene, const std::vector<std::shared_ptr<WoWUnit>>& Units); // Units from one update packet
 
 protected:
 	uint32 m_MovementFlags;
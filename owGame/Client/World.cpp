@@ -258,6 +258,9 @@ void WoWWorld::ProcessUpdatePacket(CByteBuffer& Bytes)
 	uint32 BlocksCount;
 	Bytes >> BlocksCount;
 
+	// Units are created after all blocks, display infos are resolved once per packet
+	std::vector<std::shared_ptr<WoWUnit>> createdUnits;
+
 	for (uint32 i = 0u; i < BlocksCount; i++)
 	{
 		OBJECT_UPDATE_TYPE updateType;
@@ -302,7 +305,11 @@ void WoWWorld::ProcessUpdatePacket(CByteBuffer& Bytes)
 				std::shared_ptr<WoWObject> object = GetWoWObject(guid);
 				object->ProcessMovementUpdate(Bytes);
 				object->UpdateValues(Bytes);
-				object->AfterCreate(m_BaseManager, m_RenderDevice, m_Scene);
+
+				if (std::shared_ptr<WoWUnit> unit = std::dynamic_pointer_cast<WoWUnit>(object))
+					createdUnits.push_back(unit);
+				else
+					object->AfterCreate(m_BaseManager, m_RenderDevice, m_Scene);
 
 				Log::Warn("UPDATETYPE_CREATE_OBJECT");
 			}
@@ -319,6 +326,8 @@ void WoWWorld::ProcessUpdatePacket(CByteBuffer& Bytes)
 				_ASSERT_EXPR(false, "Unknown update type");
 		}
 	}
+
+	WoWUnit::AfterCreateUnits(m_BaseManager, m_RenderDevice, m_Scene, createdUnits);
 }
 
 std::shared_ptr<WoWObject> WoWWorld::CreateObjectByType(ObjectGuid guid, ObjectTypeID ObjectTypeID)
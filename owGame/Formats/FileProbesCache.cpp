@@ -0,0 +1,129 @@
+#include "stdafx.h"
+
+// General
+#include "FileProbesCache.h"
+
+namespace
+{
+	const size_t cMaxProbesCount = 64 * 1024;
+}
+
+CFileProbesCache::CFileProbesCache(IBaseManager& BaseManager)
+	: m_MissingCount(0)
+	, m_Hits(0)
+	, m_BaseManager(BaseManager)
+{
+}
+
+CFileProbesCache::~CFileProbesCache()
+{
+}
+
+bool CFileProbesCache::IsFileExists(const std::string& FileName)
+{
+	std::string normalizedFileName = NormalizeFileName(FileName);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		const auto& probeIt = m_Probes.find(normalizedFileName);
+		if (probeIt != m_Probes.end())
+		{
+			m_Hits++;
+			return probeIt->second;
+		}
+	}
+
+	bool isExists = m_BaseManager.GetManager<IFilesManager>()->IsFileExists(FileName);
+	SetExists(normalizedFileName, isExists);
+	return isExists;
+}
+
+std::shared_ptr<IFile> CFileProbesCache::TryOpen(const std::string& FileName)
+{
+	if (false == IsFileExists(FileName))
+		return nullptr;
+
+	std::shared_ptr<IFile> file = m_BaseManager.GetManager<IFilesManager>()->Open(FileName);
+	if (file == nullptr)
+		SetExists(NormalizeFileName(FileName), false);
+
+	return file;
+}
+
+void CFileProbesCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	m_Probes.clear();
+	m_MissingCount = 0;
+}
+
+size_t CFileProbesCache::GetMissingCount() const
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_MissingCount;
+}
+
+size_t CFileProbesCache::GetExistingCount() const
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_Probes.size() - m_MissingCount;
+}
+
+uint64 CFileProbesCache::GetHits() const
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_Hits;
+}
+
+std::string CFileProbesCache::NormalizeFileName(const std::string& FileName)
+{
+	std::string normalized;
+	normalized.reserve(FileName.size());
+
+	for (char c : FileName)
+	{
+		if (c == '/')
+			c = '\\';
+
+		// Doubled separators
+		if (c == '\\' && false == normalized.empty() && normalized.back() == '\\')
+			continue;
+
+		normalized.push_back(static_cast<char>(::tolower(static_cast<unsigned char>(c))));
+	}
+
+	return normalized;
+}
+
+
+
+//
+// Private
+//
+void CFileProbesCache::SetExists(const std::string& NormalizedFileName, bool IsExists)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	if (m_Probes.size() >= cMaxProbesCount && m_Probes.find(NormalizedFileName) == m_Probes.end())
+	{
+		m_Probes.clear();
+		m_MissingCount = 0;
+	}
+
+	const auto& insertResult = m_Probes.insert(std::make_pair(NormalizedFileName, IsExists));
+	bool& isExists = insertResult.first->second;
+	if (insertResult.second)
+	{
+		if (false == IsExists)
+			m_MissingCount++;
+		return;
+	}
+
+	// Probed by other thread, or file isn't opened after positive probe
+	if (isExists && false == IsExists)
+		m_MissingCount++;
+	else if (false == isExists && IsExists)
+		m_MissingCount--;
+	isExists = IsExists;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+/**
+  * Remembers results of files storages probes (found and not found files) by normalized name (lower case, backslashes).
+  * Optional assets (specular textures, '.anim' files, gender variants of textures) are probed once,
+  * next probes are hash lookups without storages queries and exceptions. Archives don't change at runtime.
+  * Probes count is limited, all probes are dropped when limit is reached.
+*/
+class ZN_API CFileProbesCache
+{
+public:
+	CFileProbesCache(IBaseManager& BaseManager);
+	virtual ~CFileProbesCache();
+
+	bool IsFileExists(const std::string& FileName);
+	std::shared_ptr<IFile> TryOpen(const std::string& FileName); // nullptr if file is missing
+
+	void Clear();
+	size_t GetMissingCount() const;
+	size_t GetExistingCount() const;
+	uint64 GetHits() const;
+
+	static std::string NormalizeFileName(const std::string& FileName);
+
+private:
+	void SetExists(const std::string& NormalizedFileName, bool IsExists);
+
+private:
+	mutable std::mutex                    m_Lock;
+	std::unordered_map<std::string, bool> m_Probes; // Is file exists
+	size_t                                m_MissingCount;
+	uint64                                m_Hits;
+
+private:
+	IBaseManager& m_BaseManager;
+};
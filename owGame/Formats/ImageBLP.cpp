@@ -1,9 +1,80 @@
 #include "stdafx.h"
 
+// General
 #include "ImageBLP.h"
 
+// Additional
+#include "ImageBLP_Decoders.h"
+#include "MPQFilesStorage.h"
+#include "WowParallel.h"
+
+#include <chrono>
+
+namespace
+{
+	const uint32 cMinPaletteRowsPerTask = 64;
+	const uint32 cMinDXTBlocksRowsPerTask = 16;
+
+	// Mip data, that is shorter than decoder expects, is padded with zeros
+	std::vector<uint8> ReadMip(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f, uint32 Mip, uint32 Size)
+	{
+		std::vector<uint8> data(Size, 0x00);
+		f->seek(header.mipOffsets[Mip]);
+		f->readBytes(data.data(), glm::min(Size, header.mipSizes[Mip]));
+		return data;
+	}
+
+	uint32 GetMipsCount(const BLPFormat::BLPHeader& header)
+	{
+		uint32 count = 0;
+		for (; count < (header.has_mips ? LIBBLP_MIPMAP_COUNT : 1); count++)
+		{
+			if ((header.mipOffsets[count] == 0) || (header.mipSizes[count] == 0))
+				break;
+
+			// Last level is 1x1
+			if ((header.width >> count) <= 1 && (header.height >> count) <= 1)
+				return count + 1;
+		}
+
+		return count;
+	}
+
+	// Full chain (down to 1x1 if file has mips), sizes aren't less than blocks data, data is in file
+	bool IsMipChainValid(const BLPFormat::BLPHeader& header, size_t FileSize)
+	{
+		const uint32 bytesPerBlock = BLPFormat::GetDXTBytesPerBlock(header.pixelFormat);
+		if (bytesPerBlock == 0)
+			return false;
+
+		uint32 expectedCount = 1;
+		if (header.has_mips)
+			while ((header.width >> (expectedCount - 1)) > 1 || (header.height >> (expectedCount - 1)) > 1)
+				expectedCount++;
+
+		const uint32 mipsCount = GetMipsCount(header);
+		if (mipsCount != expectedCount)
+			return false;
+
+		for (uint32 mip = 0; mip < mipsCount; mip++)
+		{
+			uint32 blocksInRow = (std::max(header.width >> mip, 1u) + 3) / 4;
+			uint32 blocksRows = (std::max(header.height >> mip, 1u) + 3) / 4;
+			if (header.mipSizes[mip] < blocksInRow * blocksRows * bytesPerBlock)
+				return false;
+
+			if (static_cast<size_t>(header.mipOffsets[mip]) + header.mipSizes[mip] > FileSize)
+				return false;
+		}
+
+		return true;
+	}
+}
+
 
 CImageBLP::CImageBLP()
+	: m_MipsCount(0)
+	, m_Mip(0)
 {
 }
 
@@ -11,15 +82,29 @@ CImageBLP::~CImageBLP()
 {
 }
 
-bool CImageBLP::LoadImageData(std::shared_ptr<IFile> File)
+bool CImageBLP::LoadImageData(std::shared_ptr<IFile> File, bool UseReferenceDecoders, uint32 Mip)
 {
 	BLPFormat::BLPHeader header = { 0 };
 	File->seek(0);
 	File->read(&header);
-	return LoadBPL(header, File);
+	return LoadBPL(header, File, UseReferenceDecoders, Mip);
+}
+
+bool CImageBLP::GetMipsInfo(const BLPFormat::BLPHeader& Header, uint32* Width, uint32* Height, uint32* MipsCount)
+{
+	*Width = Header.width;
+	*Height = Header.height;
+	*MipsCount = GetMipsCount(Header);
+	return *MipsCount > 0;
 }
 
 bool CImageBLP::IsFileSupported(std::shared_ptr<IFile> File)
+{
+	BLPFormat::BLPHeader header = { 0 };
+	return ReadHeader(File, &header);
+}
+
+bool CImageBLP::ReadHeader(std::shared_ptr<IFile> File, BLPFormat::BLPHeader* Header)
 {
 	_ASSERT(File != nullptr);
 
@@ -30,19 +115,28 @@ bool CImageBLP::IsFileSupported(std::shared_ptr<IFile> File)
 	if (File->getSize() == 0)
 		return false;
 
-	BLPFormat::BLPHeader header = { 0 };
 	File->seek(0);
-	File->read(&header);
+	File->read(Header);
 
-	return (header.magic[0] == 'B' && header.magic[1] == 'L' && header.magic[2] == 'P' && header.magic[3] == '2' && header.type == 1);
+	return (Header->magic[0] == 'B' && Header->magic[1] == 'L' && Header->magic[2] == 'P' && Header->magic[3] == '2' && Header->type == 1);
 }
 
-std::shared_ptr<CImageBLP> CImageBLP::CreateImage(std::shared_ptr<IFile> File)
+std::shared_ptr<CImageBLP> CImageBLP::CreateImage(std::shared_ptr<IFile> File, uint32 Mip)
 {
-	_ASSERT(IsFileSupported(File));
+	BLPFormat::BLPHeader header = { 0 };
+	if (false == ReadHeader(File, &header))
+	{
+		_ASSERT(false);
+		return nullptr;
+	}
 
+	return CreateImage(File, header, Mip);
+}
+
+std::shared_ptr<CImageBLP> CImageBLP::CreateImage(std::shared_ptr<IFile> File, const BLPFormat::BLPHeader& Header, uint32 Mip)
+{
 	std::shared_ptr<CImageBLP> imageBLP = std::make_shared<CImageBLP>();
-	if (!imageBLP->LoadImageData(File))
+	if (!imageBLP->LoadBPL(Header, File, false, Mip))
 	{
 		Log::Error("CImageBLP: Unable to load PLP file '%s'.", File->Name().c_str());
 		return nullptr;
@@ -51,7 +145,7 @@ std::shared_ptr<CImageBLP> CImageBLP::CreateImage(std::shared_ptr<IFile> File)
 	return imageBLP;
 }
 
-bool CImageBLP::LoadBPL(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f)
+bool CImageBLP::LoadBPL(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f, bool UseReferenceDecoders, uint32 Mip)
 {
 	if (header.width & (header.width - 1))
 	{
@@ -64,121 +158,188 @@ bool CImageBLP::LoadBPL(const BLPFormat::BLPHeader& header, std::shared_ptr<IFil
 		return false;
 	}
 
-	m_Width = header.width;
-	m_Height = header.height;
+	m_MipsCount = GetMipsCount(header);
+	if (m_MipsCount == 0)
+	{
+		_ASSERT(false); //LIBBLP_ERROR_FORMAT
+		return false;
+	}
+
+	// Reference palette decoder knows only level 0
+	_ASSERT(false == UseReferenceDecoders || Mip == 0 || header.colorEncoding == BLPFormat::BLPColorEncoding::COLOR_DXT);
+	m_Mip = std::min(Mip, m_MipsCount - 1);
+
+	m_Width = std::max(header.width >> m_Mip, 1u);
+	m_Height = std::max(header.height >> m_Mip, 1u);
 	m_BitsPerPixel = 32;
 	m_Stride = m_Width * (m_BitsPerPixel / 8);
 	m_IsTransperent = (header.alphaChannelBitDepth != 0);
 	m_Data = new uint8[m_Height * m_Stride];
 
+	switch (header.colorEncoding)
+	{
+	case BLPFormat::BLPColorEncoding::COLOR_PALETTE:
+	{
+		if (UseReferenceDecoders)
+			return LoadPalette_Reference(header, f, m_Width, m_Height);
 
-	bool    hasAlpha = (header.alphaChannelBitDepth != 0);
-	uint8_t mipmax = 1; //(header.has_mips ? LIBBLP_MIPMAP_COUNT : 1);
+		return LoadPalette(header, f, m_Width, m_Height);
+	}
 
-	for (uint8_t currentMip = 0; currentMip < mipmax; currentMip++)
+	case BLPFormat::BLPColorEncoding::COLOR_DXT:
 	{
-		if ((header.mipOffsets[currentMip] == 0) || (header.mipSizes[currentMip] == 0))
-			break;
+		if (false == UseReferenceDecoders)
+			return LoadDXT(header, f);
 
-		uint16_t mipWidth = std::max(header.width >> currentMip, 1u);
-		uint16_t mipHeight = std::max(header.height >> currentMip, 1u);
+		f->seek(header.mipOffsets[m_Mip]);
 
-		switch (header.colorEncoding)
+		switch (header.pixelFormat)
 		{
-		case BLPFormat::BLPColorEncoding::COLOR_PALETTE:
-		{
-			// Data in mipmaps in indices info pallete
-			uint8_t* indexInPalleteBuffer = new uint8_t[header.mipSizes[currentMip]];
-			f->seek(header.mipOffsets[currentMip]);
-			f->readBytes(indexInPalleteBuffer, header.mipSizes[currentMip]);
+		case BLPFormat::BLPPixelFormat::PIXEL_DXT1:
+			LoadDXT_Helper <DDSFormat::DXT_BLOCKDECODER_1>(f);
+			break;
+		case BLPFormat::BLPPixelFormat::PIXEL_DXT3:
+			LoadDXT_Helper <DDSFormat::DXT_BLOCKDECODER_3>(f);
+			break;
+		case BLPFormat::BLPPixelFormat::PIXEL_DXT5:
+			LoadDXT_Helper <DDSFormat::DXT_BLOCKDECODER_5>(f);
+			break;
+		default:
+			_ASSERT(false); //LIBBLP_ERROR_FORMAT
+			return false;
+		}
+	}
+	break;
 
-			//view->MipData[currentMip] = new uint8_t[header.width * header.height * 4];
-			uint32_t resultBufferCntr = 0;
+	case BLPFormat::BLPColorEncoding::COLOR_ARGB8888:
+	{
+		f->seek(header.mipOffsets[m_Mip]);
+		f->readBytes(m_Data, std::min(header.mipSizes[m_Mip], m_Height * m_Stride));
+	}
+	break;
 
-			uint8_t* indexInPalleteColor = indexInPalleteBuffer;
-			int alphaBitCntr = 0;
-			uint8_t* indexInPalleteAlpha = &indexInPalleteBuffer[0] + mipWidth * mipHeight;
+	default:
+		_ASSERT(false); //LIBBLP_ERROR_FORMAT
+		return false;
+	}
 
-			for (uint32_t y = 0; y < mipWidth; y++)
-			{
-				for (uint32_t x = 0; x < mipHeight; x++)
-				{
-					// Read color
-					uint32_t color = header.pallete[*indexInPalleteColor++];
-					//color = ((color & 0x00FF0000) >> 16) | ((color & 0x0000FF00)) | ((color & 0x000000FF) << 16);
-
-					// Read alpha
-					uint8_t alpha;
-					switch (header.alphaChannelBitDepth)
-					{
-					case 0:
-						alpha = 0xff;
-						break;
-					case 1:
-						alpha = (*indexInPalleteAlpha & (1 << alphaBitCntr++)) ? 0xff : 0x00;
-						if (alphaBitCntr == 8)
-						{
-							alphaBitCntr = 0;
-							indexInPalleteAlpha++;
-						}
-						break;
-					case 4:
-						alpha = 0xFF;
-						break;
-					case 8:
-						alpha = (*indexInPalleteAlpha++);
-						break;
-					default:
-						_ASSERT(false); //LIBBLP_ERROR_FORMAT
-						return NULL;
-					}
-
-					m_Data[resultBufferCntr++] = ((color & 0x00FF0000) >> 16);
-					m_Data[resultBufferCntr++] = ((color & 0x0000FF00) >> 8);
-					m_Data[resultBufferCntr++] = ((color & 0x000000FF));
-					m_Data[resultBufferCntr++] = ((alpha & 0x000000FF));
-				}
-			}
+	return true;
+}
 
-			delete[] indexInPalleteBuffer;
-		}
+bool CImageBLP::LoadPalette(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f, uint32 MipWidth, uint32 MipHeight)
+{
+	uint32 alphaSize = 0;
+	switch (header.alphaChannelBitDepth)
+	{
+	case 0:
+	case 4:
+		break;
+	case 1:
+		alphaSize = (MipWidth * MipHeight + 7) / 8;
+		break;
+	case 8:
+		alphaSize = MipWidth * MipHeight;
 		break;
+	default:
+		_ASSERT(false); //LIBBLP_ERROR_FORMAT
+		return false;
+	}
+
+	std::vector<uint8> data = ReadMip(header, f, m_Mip, MipWidth * MipHeight + alphaSize);
+	const uint8* indexes = data.data();
+	const uint8* alphas = data.data() + MipWidth * MipHeight;
+
+	// Transparency is defined by header here
+	ParallelFor(MipHeight, cMinPaletteRowsPerTask, [&](size_t Begin, size_t End, size_t TaskIndex) {
+		BLPFormat::DecodePaletteRows(header, indexes, alphas, MipWidth, static_cast<uint32>(Begin), static_cast<uint32>(End - Begin), m_Data);
+	});
+
+	return true;
+}
 
-		case BLPFormat::BLPColorEncoding::COLOR_DXT:
+bool CImageBLP::LoadDXT(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f)
+{
+	const BLPFormat::BLPPixelFormat pixelFormat = header.pixelFormat;
+	const uint32 bytesPerBlock = BLPFormat::GetDXTBytesPerBlock(pixelFormat);
+	if (bytesPerBlock == 0)
+	{
+		_ASSERT(false); //LIBBLP_ERROR_FORMAT
+		return false;
+	}
+
+	// Texture objects of render device have no block compressed formats, so DXT is decoded on CPU. Only requested level is read.
+	const uint32 blocksRows = (m_Height + 3) / 4;
+	std::vector<uint8> blocks = ReadMip(header, f, m_Mip, ((m_Width + 3) / 4) * blocksRows * bytesPerBlock);
+
+	std::vector<uint8> tasksAlpha(glm::max<size_t>(std::thread::hardware_concurrency(), 1), 0xFF);
+	ParallelFor(blocksRows, cMinDXTBlocksRowsPerTask, [&](size_t Begin, size_t End, size_t TaskIndex) {
+		tasksAlpha[TaskIndex] = BLPFormat::DecodeDXTBlocksRows(pixelFormat, blocks.data(), m_Width, m_Height, static_cast<uint32>(Begin), static_cast<uint32>(End - Begin), m_Data, m_Stride);
+	});
+
+	for (const auto& alpha : tasksAlpha)
+		if (alpha < 0xFF)
+			m_IsTransperent = true;
+
+	return true;
+}
+
+bool CImageBLP::LoadPalette_Reference(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f, uint32 MipWidth, uint32 MipHeight)
+{
+	// Data in mipmaps in indices info pallete
+	uint8_t* indexInPalleteBuffer = new uint8_t[header.mipSizes[0]];
+	f->seek(header.mipOffsets[0]);
+	f->readBytes(indexInPalleteBuffer, header.mipSizes[0]);
+
+	//view->MipData[0] = new uint8_t[header.width * header.height * 4];
+	uint32_t resultBufferCntr = 0;
+
+	uint8_t* indexInPalleteColor = indexInPalleteBuffer;
+	int alphaBitCntr = 0;
+	uint8_t* indexInPalleteAlpha = &indexInPalleteBuffer[0] + MipWidth * MipHeight;
+
+	for (uint32_t y = 0; y < MipWidth; y++)
+	{
+		for (uint32_t x = 0; x < MipHeight; x++)
 		{
-			f->seek(header.mipOffsets[currentMip]);
+			// Read color
+			uint32_t color = header.pallete[*indexInPalleteColor++];
+			//color = ((color & 0x00FF0000) >> 16) | ((color & 0x0000FF00)) | ((color & 0x000000FF) << 16);
 
-			switch (header.pixelFormat)
+			// Read alpha
+			uint8_t alpha;
+			switch (header.alphaChannelBitDepth)
 			{
-			case BLPFormat::BLPPixelFormat::PIXEL_DXT1:
-				LoadDXT_Helper <DDSFormat::DXT_BLOCKDECODER_1>(f);
+			case 0:
+				alpha = 0xff;
+				break;
+			case 1:
+				alpha = (*indexInPalleteAlpha & (1 << alphaBitCntr++)) ? 0xff : 0x00;
+				if (alphaBitCntr == 8)
+				{
+					alphaBitCntr = 0;
+					indexInPalleteAlpha++;
+				}
 				break;
-			case BLPFormat::BLPPixelFormat::PIXEL_DXT3:
-				LoadDXT_Helper <DDSFormat::DXT_BLOCKDECODER_3>(f);
+			case 4:
+				alpha = 0xFF;
 				break;
-			case BLPFormat::BLPPixelFormat::PIXEL_DXT5:
-				LoadDXT_Helper <DDSFormat::DXT_BLOCKDECODER_5>(f);
+			case 8:
+				alpha = (*indexInPalleteAlpha++);
 				break;
 			default:
 				_ASSERT(false); //LIBBLP_ERROR_FORMAT
 				return false;
 			}
-		}
-		break;
 
-		case BLPFormat::BLPColorEncoding::COLOR_ARGB8888:
-		{
-			f->seek(header.mipOffsets[currentMip]);
-			f->readBytes(m_Data, header.mipSizes[currentMip]);
-		}
-		break;
-
-		default:
-			_ASSERT(false); //LIBBLP_ERROR_FORMAT
-			return false;
+			m_Data[resultBufferCntr++] = ((color & 0x00FF0000) >> 16);
+			m_Data[resultBufferCntr++] = ((color & 0x0000FF00) >> 8);
+			m_Data[resultBufferCntr++] = ((color & 0x000000FF));
+			m_Data[resultBufferCntr++] = ((alpha & 0x000000FF));
 		}
 	}
 
+	delete[] indexInPalleteBuffer;
+
 	return true;
 }
 
@@ -261,4 +422,92 @@ bool CImageBLP::LoadDXT_Helper(std::shared_ptr<IFile> io)
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+
+
+//
+// Benchmark
+//
+SBLP_DecodeBenchmarkResult CImageBLP::Benchmark(IBaseManager& BaseManager, const std::string& ArchiveFileName)
+{
+	SBLP_DecodeBenchmarkResult result;
+
+	for (const auto& fileName : CMPQFilesStorage::GetArchiveFileNames(ArchiveFileName))
+	{
+		std::shared_ptr<IFile> file = BaseManager.GetManager<IFilesManager>()->Open(fileName);
+		if (file == nullptr || false == IsFileSupported(file))
+			continue;
+
+		result.Files++;
+
+		CImageBLP referenceImage;
+		const auto referenceStartTime = std::chrono::high_resolution_clock::now();
+		bool isReferenceLoaded = referenceImage.LoadImageData(file, true);
+		result.ReferenceTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - referenceStartTime).count();
+
+		CImageBLP image;
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		bool isLoaded = image.LoadImageData(file, false);
+		result.Time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		if (false == isReferenceLoaded || false == isLoaded)
+			continue;
+
+		result.Decoded++;
+
+		if (referenceImage.m_Width != image.m_Width || referenceImage.m_Height != image.m_Height || referenceImage.m_IsTransperent != image.m_IsTransperent ||
+			std::memcmp(referenceImage.m_Data, image.m_Data, image.m_Height * image.m_Stride) != 0)
+		{
+			Log::Warn("CImageBLP: Benchmark: '%s' isn't bit-exact with reference decoder.", fileName.c_str());
+			result.Mismatches++;
+		}
+	}
+
+	return result;
+}
+
+SBLP_DecodersValidationResult CImageBLP::ValidateDecoders(IBaseManager& BaseManager, const std::string& ArchiveFileName)
+{
+	SBLP_DecodersValidationResult result;
+
+	for (const auto& fileName : CMPQFilesStorage::GetArchiveFileNames(ArchiveFileName))
+	{
+		std::shared_ptr<IFile> file = BaseManager.GetManager<IFilesManager>()->Open(fileName);
+		if (file == nullptr || false == IsFileSupported(file))
+			continue;
+
+		BLPFormat::BLPHeader header = { 0 };
+		file->seek(0);
+		file->read(&header);
+		if (header.colorEncoding != BLPFormat::BLPColorEncoding::COLOR_DXT)
+			continue;
+
+		result.Files++;
+
+		if (false == IsMipChainValid(header, file->getSize()))
+		{
+			Log::Warn("CImageBLP: ValidateDecoders: '%s' has invalid mip chain.", fileName.c_str());
+			result.InvalidMipChains++;
+		}
+
+		for (uint32 mip = 0; mip < GetMipsCount(header); mip++)
+		{
+			CImageBLP referenceImage;
+			CImageBLP image;
+			if (false == referenceImage.LoadImageData(file, true, mip) || false == image.LoadImageData(file, false, mip))
+				continue;
+
+			result.Mips++;
+
+			if (referenceImage.m_Width != image.m_Width || referenceImage.m_Height != image.m_Height || referenceImage.m_IsTransperent != image.m_IsTransperent ||
+				std::memcmp(referenceImage.m_Data, image.m_Data, image.m_Height * image.m_Stride) != 0)
+			{
+				Log::Warn("CImageBLP: ValidateDecoders: '%s' level '%d' isn't bit-exact with reference decoder.", fileName.c_str(), mip);
+				result.Mismatches++;
+			}
+		}
+	}
+
+	return result;
+}
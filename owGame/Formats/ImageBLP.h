@@ -54,22 +54,76 @@ namespace BLPFormat
 
 }
 
-class CImageBLP
+struct ZN_API SBLP_DecodeBenchmarkResult
+{
+	SBLP_DecodeBenchmarkResult()
+		: Files(0)
+		, Decoded(0)
+		, Mismatches(0)
+		, ReferenceTime(0.0)
+		, Time(0.0)
+	{}
+
+	uint32 Files;
+	uint32 Decoded;       // Supported and decoded by both decoders
+	uint32 Mismatches;    // Not bit-exact with reference decoder
+	double ReferenceTime; // ms
+	double Time;          // ms
+};
+
+struct ZN_API SBLP_DecodersValidationResult
+{
+	SBLP_DecodersValidationResult()
+		: Files(0)
+		, Mips(0)
+		, InvalidMipChains(0)
+		, Mismatches(0)
+	{}
+
+	uint32 Files;            // DXT encoded files
+	uint32 Mips;             // Decoded by both decoders
+	uint32 InvalidMipChains; // Absent levels, wrong sizes or data out of file
+	uint32 Mismatches;       // Levels, that aren't bit-exact with reference decoder
+};
+
+class ZN_API CImageBLP
 	: public CImageBase
 {
 public:
 	CImageBLP();
 	virtual ~CImageBLP();
 
+	// Image is one level of stored mip chain
+	uint32 GetMipsCount() const { return m_MipsCount; }
+	uint32 GetMip() const { return m_Mip; }
+
 protected:
-	bool LoadImageData(std::shared_ptr<IFile> File);
-	bool LoadBPL(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f);
+	bool LoadImageData(std::shared_ptr<IFile> File, bool UseReferenceDecoders = false, uint32 Mip = 0);
+	bool LoadBPL(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f, bool UseReferenceDecoders, uint32 Mip);
+
+	// SSE2 decoders, large images are split by rows (blocks rows) between threads
+	bool LoadPalette(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f, uint32 MipWidth, uint32 MipHeight);
+	bool LoadDXT(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f);
 
+	// Reference (scalar) decoders. Palette decoder knows only level 0.
+	bool LoadPalette_Reference(const BLPFormat::BLPHeader& header, std::shared_ptr<IFile> f, uint32 MipWidth, uint32 MipHeight);
 	template <class DECODER>
 	bool LoadDXT_Helper(std::shared_ptr<IFile> io);
 
 public: // Static
 	static bool IsFileSupported(std::shared_ptr<IFile> File);
-	static std::shared_ptr<CImageBLP> CreateImage(std::shared_ptr<IFile> File);
+	static bool ReadHeader(std::shared_ptr<IFile> File, BLPFormat::BLPHeader* Header); // False if file isn't supported
+	static std::shared_ptr<CImageBLP> CreateImage(std::shared_ptr<IFile> File, uint32 Mip = 0); // Mip is clamped to stored levels
+	static std::shared_ptr<CImageBLP> CreateImage(std::shared_ptr<IFile> File, const BLPFormat::BLPHeader& Header, uint32 Mip); // Header of this file, that is already read
+	static bool GetMipsInfo(const BLPFormat::BLPHeader& Header, uint32* Width, uint32* Height, uint32* MipsCount); // Level 0 size
+
+	// Decodes every BLP from archive '(listfile)' with reference and SSE2 decoders and compares results. Nothing is uploaded to GPU.
+	static SBLP_DecodeBenchmarkResult Benchmark(IBaseManager& BaseManager, const std::string& ArchiveFileName);
+
+	// Checks mip chain of every DXT BLP from archive '(listfile)' and compares each level, decoded by SSE2 decoder, with reference decoder.
+	static SBLP_DecodersValidationResult ValidateDecoders(IBaseManager& BaseManager, const std::string& ArchiveFileName);
 
+private:
+	uint32                          m_MipsCount;
+	uint32                          m_Mip;
 };
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "stdafx.h"
+
+// General
+#include "ImageBLP_Decoders.h"
+
+#include <emmintrin.h>
+
+namespace
+{
+	//
+	// Common
+	//
+	inline __m128i MergeAlpha(__m128i Colors, __m128i Alphas)
+	{
+		return _mm_or_si128(_mm_and_si128(Colors, _mm_set1_epi32(0x00FFFFFF)), _mm_slli_epi32(Alphas, 24));
+	}
+
+	inline uint8 GetAlpha(__m128i AlphaAnd)
+	{
+		alignas(16) uint32 lanes[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes), AlphaAnd);
+		return static_cast<uint8>((lanes[0] & lanes[1] & lanes[2] & lanes[3]) >> 24);
+	}
+
+
+	//
+	// Palette
+	//
+	inline uint32 GetPaletteAlpha(uint8 AlphaDepth, const uint8* Alphas, uint32 Pixel)
+	{
+		switch (AlphaDepth)
+		{
+		case 1:
+			return (Alphas[Pixel / 8] & (1 << (Pixel % 8))) ? 0xFF : 0x00;
+		case 8:
+			return Alphas[Pixel];
+		}
+		return 0xFF;
+	}
+
+
+	//
+	// DXT
+	//
+
+	// 565 to 888 with integer division (not bits replication), like reference decoder
+	inline void Expand565(uint16 Color, uint32 Channels[3])
+	{
+		Channels[0] = ((Color >> 11) & 0x1F) * 0xFF / 0x1F;
+		Channels[1] = ((Color >> 5) & 0x3F) * 0xFF / 0x3F;
+		Channels[2] = (Color & 0x1F) * 0xFF / 0x1F;
+	}
+
+	inline uint32 MakeRGBA(uint32 R, uint32 G, uint32 B, uint32 A)
+	{
+		return R | (G << 8) | (B << 16) | (A << 24);
+	}
+
+	inline void GetBlockColors(const uint8* ColorBlock, bool IsDXT1, __m128i Colors[4])
+	{
+		uint16 color0 = ColorBlock[0] | (ColorBlock[1] << 8);
+		uint16 color1 = ColorBlock[2] | (ColorBlock[3] << 8);
+
+		uint32 c0[3], c1[3];
+		Expand565(color0, c0);
+		Expand565(color1, c1);
+
+		Colors[0] = _mm_set1_epi32(MakeRGBA(c0[0], c0[1], c0[2], 0xFF));
+		Colors[1] = _mm_set1_epi32(MakeRGBA(c1[0], c1[1], c1[2], 0xFF));
+
+		if (color0 > color1 || false == IsDXT1)
+		{
+			Colors[2] = _mm_set1_epi32(MakeRGBA((c0[0] * 2 + c1[0]) / 3, (c0[1] * 2 + c1[1]) / 3, (c0[2] * 2 + c1[2]) / 3, 0xFF));
+			Colors[3] = _mm_set1_epi32(MakeRGBA((c0[0] + c1[0] * 2) / 3, (c0[1] + c1[1] * 2) / 3, (c0[2] + c1[2] * 2) / 3, 0xFF));
+		}
+		else
+		{
+			// 3 colors block, 4th is transparent black
+			Colors[2] = _mm_set1_epi32(MakeRGBA((c0[0] + c1[0]) / 2, (c0[1] + c1[1]) / 2, (c0[2] + c1[2]) / 2, 0xFF));
+			Colors[3] = _mm_setzero_si128();
+		}
+	}
+
+	// Four pixels of block row. 2 bits indexes are compared with masks, SSE2 hasn't per lane shifts.
+	inline __m128i SelectColors(uint8 Row, const __m128i Colors[4])
+	{
+		const __m128i mask = _mm_set_epi32(0xC0, 0x30, 0x0C, 0x03);
+		const __m128i index1 = _mm_set_epi32(0x40, 0x10, 0x04, 0x01);
+		const __m128i index2 = _mm_set_epi32(0x80, 0x20, 0x08, 0x02);
+
+		__m128i bits = _mm_and_si128(_mm_set1_epi32(Row), mask);
+
+		__m128i result = _mm_and_si128(_mm_cmpeq_epi32(bits, _mm_setzero_si128()), Colors[0]);
+		result = _mm_or_si128(result, _mm_and_si128(_mm_cmpeq_epi32(bits, index1), Colors[1]));
+		result = _mm_or_si128(result, _mm_and_si128(_mm_cmpeq_epi32(bits, index2), Colors[2]));
+		result = _mm_or_si128(result, _mm_and_si128(_mm_cmpeq_epi32(bits, mask), Colors[3]));
+		return result;
+	}
+
+	template <BLPFormat::BLPPixelFormat PixelFormat>
+	inline void DecodeBlock(const uint8* Block, __m128i Rows[4])
+	{
+		const bool isDXT1 = (PixelFormat == BLPFormat::BLPPixelFormat::PIXEL_DXT1);
+		const uint8* colorBlock = isDXT1 ? Block : Block + 8;
+
+		__m128i colors[4];
+		GetBlockColors(colorBlock, isDXT1, colors);
+		for (uint32 y = 0; y < 4; y++)
+			Rows[y] = SelectColors(colorBlock[4 + y], colors);
+
+		if (PixelFormat == BLPFormat::BLPPixelFormat::PIXEL_DXT3)
+		{
+			// Explicit 4 bits alpha
+			for (uint32 y = 0; y < 4; y++)
+			{
+				uint32 row = Block[y * 2] | (Block[y * 2 + 1] << 8);
+				__m128i alphas = _mm_set_epi32((row >> 12) & 0xF, (row >> 8) & 0xF, (row >> 4) & 0xF, row & 0xF);
+				Rows[y] = MergeAlpha(Rows[y], _mm_mullo_epi16(alphas, _mm_set1_epi32(0xFF / 0xF)));
+			}
+		}
+		else if (PixelFormat == BLPFormat::BLPPixelFormat::PIXEL_DXT5)
+		{
+			// Interpolated alpha, 3 bits indexes
+			uint32 alphas[8];
+			alphas[0] = Block[0];
+			alphas[1] = Block[1];
+			if (alphas[0] > alphas[1])
+			{
+				for (uint32 i = 0; i < 6; i++)
+					alphas[i + 2] = ((6 - i) * alphas[0] + (1 + i) * alphas[1] + 3) / 7;
+			}
+			else
+			{
+				for (uint32 i = 0; i < 4; i++)
+					alphas[i + 2] = ((4 - i) * alphas[0] + (1 + i) * alphas[1] + 2) / 5;
+				alphas[6] = 0x00;
+				alphas[7] = 0xFF;
+			}
+
+			uint64 bits = 0;
+			for (uint32 i = 0; i < 6; i++)
+				bits |= static_cast<uint64>(Block[2 + i]) << (i * 8);
+
+			for (uint32 y = 0; y < 4; y++)
+			{
+				uint32 row = static_cast<uint32>(bits >> (y * 12)) & 0xFFF;
+				Rows[y] = MergeAlpha(Rows[y], _mm_set_epi32(alphas[(row >> 9) & 7], alphas[(row >> 6) & 7], alphas[(row >> 3) & 7], alphas[row & 7]));
+			}
+		}
+	}
+
+	template <BLPFormat::BLPPixelFormat PixelFormat>
+	uint8 DecodeBlocksRows(const uint8* Blocks, uint32 Width, uint32 Height, uint32 FirstBlocksRow, uint32 BlocksRowsCount, uint8* Dst, uint32 Stride)
+	{
+		const uint32 bytesPerBlock = BLPFormat::GetDXTBytesPerBlock(PixelFormat);
+		const uint32 blocksInRow = (Width + 3) / 4;
+
+		__m128i alphaAnd = _mm_set1_epi32(-1);
+		uint32 alphaAndPartial = UINT32_MAX;
+
+		for (uint32 by = FirstBlocksRow; by < FirstBlocksRow + BlocksRowsCount; by++)
+		{
+			const uint32 rows = glm::min(4u, Height - by * 4);
+			const uint8* block = Blocks + by * blocksInRow * bytesPerBlock;
+
+			for (uint32 bx = 0; bx < blocksInRow; bx++, block += bytesPerBlock)
+			{
+				const uint32 cols = glm::min(4u, Width - bx * 4);
+
+				__m128i pixels[4];
+				DecodeBlock<PixelFormat>(block, pixels);
+
+				for (uint32 y = 0; y < rows; y++)
+				{
+					uint8* dst = Dst + (by * 4 + y) * Stride + bx * 4 * 4;
+					if (cols == 4)
+					{
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), pixels[y]);
+						alphaAnd = _mm_and_si128(alphaAnd, pixels[y]);
+					}
+					else
+					{
+						alignas(16) uint32 partial[4];
+						_mm_store_si128(reinterpret_cast<__m128i*>(partial), pixels[y]);
+						std::memcpy(dst, partial, cols * 4);
+						for (uint32 x = 0; x < cols; x++)
+							alphaAndPartial &= partial[x];
+					}
+				}
+			}
+		}
+
+		return GetAlpha(alphaAnd) & static_cast<uint8>(alphaAndPartial >> 24);
+	}
+}
+
+namespace BLPFormat
+{
+	uint8 DecodePaletteRows(const BLPHeader& Header, const uint8* Indexes, const uint8* Alphas, uint32 Width, uint32 FirstRow, uint32 RowsCount, uint8* Dst)
+	{
+		// BGRA to RGBA, alpha is merged later
+		uint32 palette[LIBBLP_PALETTE_SIZE];
+		for (uint32 i = 0; i < LIBBLP_PALETTE_SIZE; i++)
+		{
+			uint32 color = Header.pallete[i];
+			palette[i] = MakeRGBA((color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, 0xFF);
+		}
+
+		const uint8 alphaDepth = Header.alphaChannelBitDepth;
+		const uint32 firstPixel = FirstRow * Width;
+		const uint32 pixelsCount = RowsCount * Width;
+
+		uint32* dst = reinterpret_cast<uint32*>(Dst) + firstPixel;
+		const uint8* indexes = Indexes + firstPixel;
+
+		__m128i alphaAnd = _mm_set1_epi32(-1);
+		uint32 alphaAndScalar = 0xFF;
+
+		uint32 p = 0;
+
+		// 1 bit alpha: vector part starts from alpha byte
+		if (alphaDepth == 1)
+			for (; p < pixelsCount && ((firstPixel + p) & 7) != 0; p++)
+			{
+				uint32 alpha = GetPaletteAlpha(alphaDepth, Alphas, firstPixel + p);
+				dst[p] = (palette[indexes[p]] & 0x00FFFFFF) | (alpha << 24);
+				alphaAndScalar &= alpha;
+			}
+
+		if (alphaDepth == 1)
+		{
+			const __m128i bitsLow = _mm_set_epi32(0x08, 0x04, 0x02, 0x01);
+			const __m128i bitsHigh = _mm_set_epi32(0x80, 0x40, 0x20, 0x10);
+
+			for (; p + 8 <= pixelsCount; p += 8)
+			{
+				__m128i alphaByte = _mm_set1_epi32(Alphas[(firstPixel + p) / 8]);
+				__m128i alphaLow = _mm_srli_epi32(_mm_cmpeq_epi32(_mm_and_si128(alphaByte, bitsLow), bitsLow), 24);
+				__m128i alphaHigh = _mm_srli_epi32(_mm_cmpeq_epi32(_mm_and_si128(alphaByte, bitsHigh), bitsHigh), 24);
+
+				__m128i colorsLow = MergeAlpha(_mm_set_epi32(palette[indexes[p + 3]], palette[indexes[p + 2]], palette[indexes[p + 1]], palette[indexes[p + 0]]), alphaLow);
+				__m128i colorsHigh = MergeAlpha(_mm_set_epi32(palette[indexes[p + 7]], palette[indexes[p + 6]], palette[indexes[p + 5]], palette[indexes[p + 4]]), alphaHigh);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p), colorsLow);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p + 4), colorsHigh);
+				alphaAnd = _mm_and_si128(alphaAnd, _mm_and_si128(colorsLow, colorsHigh));
+			}
+		}
+		else if (alphaDepth == 8)
+		{
+			for (; p + 4 <= pixelsCount; p += 4)
+			{
+				int32 alphaBytes;
+				std::memcpy(&alphaBytes, Alphas + firstPixel + p, sizeof(int32));
+				__m128i alphas = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(alphaBytes), _mm_setzero_si128()), _mm_setzero_si128());
+
+				__m128i colors = MergeAlpha(_mm_set_epi32(palette[indexes[p + 3]], palette[indexes[p + 2]], palette[indexes[p + 1]], palette[indexes[p + 0]]), alphas);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p), colors);
+				alphaAnd = _mm_and_si128(alphaAnd, colors);
+			}
+		}
+		else
+		{
+			// 0 and 4 bits alpha are opaque
+			for (; p + 4 <= pixelsCount; p += 4)
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p), _mm_set_epi32(palette[indexes[p + 3]], palette[indexes[p + 2]], palette[indexes[p + 1]], palette[indexes[p + 0]]));
+		}
+
+		// Tail
+		for (; p < pixelsCount; p++)
+		{
+			uint32 alpha = GetPaletteAlpha(alphaDepth, Alphas, firstPixel + p);
+			dst[p] = (palette[indexes[p]] & 0x00FFFFFF) | (alpha << 24);
+			alphaAndScalar &= alpha;
+		}
+
+		return GetAlpha(alphaAnd) & static_cast<uint8>(alphaAndScalar);
+	}
+
+	uint8 DecodeDXTBlocksRows(BLPPixelFormat PixelFormat, const uint8* Blocks, uint32 Width, uint32 Height, uint32 FirstBlocksRow, uint32 BlocksRowsCount, uint8* Dst, uint32 Stride)
+	{
+		switch (PixelFormat)
+		{
+		case BLPPixelFormat::PIXEL_DXT1:
+			return DecodeBlocksRows<BLPPixelFormat::PIXEL_DXT1>(Blocks, Width, Height, FirstBlocksRow, BlocksRowsCount, Dst, Stride);
+		case BLPPixelFormat::PIXEL_DXT3:
+			return DecodeBlocksRows<BLPPixelFormat::PIXEL_DXT3>(Blocks, Width, Height, FirstBlocksRow, BlocksRowsCount, Dst, Stride);
+		case BLPPixelFormat::PIXEL_DXT5:
+			return DecodeBlocksRows<BLPPixelFormat::PIXEL_DXT5>(Blocks, Width, Height, FirstBlocksRow, BlocksRowsCount, Dst, Stride);
+		}
+
+		_ASSERT(false);
+		return 0xFF;
+	}
+
+	uint32 GetDXTBytesPerBlock(BLPPixelFormat PixelFormat)
+	{
+		switch (PixelFormat)
+		{
+		case BLPPixelFormat::PIXEL_DXT1:
+			return 8;
+		case BLPPixelFormat::PIXEL_DXT3:
+		case BLPPixelFormat::PIXEL_DXT5:
+			return 16;
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ImageBLP.h"
+
+namespace BLPFormat
+{
+	//
+	// SSE2 decoders. Output is RGBA8, same as reference decoders of CImageBLP.
+	// Functions decode part of image (rows or blocks rows), so image can be split between threads.
+	// Result is AND of all decoded alpha values (0xFF if image is opaque).
+	//
+
+	// 'Indexes' - one byte per pixel. 'Alphas' - packed by 'alphaChannelBitDepth' (1 or 8 bits per pixel), ignored for 0 and 4.
+	uint8 DecodePaletteRows(const BLPHeader& Header, const uint8* Indexes, const uint8* Alphas, uint32 Width, uint32 FirstRow, uint32 RowsCount, uint8* Dst);
+
+	// 'Blocks' - whole mip, blocks rows are '(Width + 3) / 4' blocks. 'Dst' - whole image with 'Stride'.
+	uint8 DecodeDXTBlocksRows(BLPPixelFormat PixelFormat, const uint8* Blocks, uint32 Width, uint32 Height, uint32 FirstBlocksRow, uint32 BlocksRowsCount, uint8* Dst, uint32 Stride);
+
+	uint32 GetDXTBytesPerBlock(BLPPixelFormat PixelFormat);
+}
@@ -202,3 +202,44 @@ SMPQFileLocation CMPQFilesStorage::GetFileLocation(const std::string& filename)
 
 	return SMPQFileLocation();
 }
+
+std::vector<std::string> CMPQFilesStorage::GetArchiveFileNames(const std::string& ArchiveFileName)
+{
+	std::vector<std::string> fileNames;
+
+	mpq_archive_s* mpq_a;
+	if (libmpq__archive_open(&mpq_a, ArchiveFileName.c_str(), -1))
+	{
+		Log::Error("Error opening archive [%s].", ArchiveFileName.c_str());
+		return fileNames;
+	}
+
+	uint32 filenum;
+	if (libmpq__file_number(mpq_a, "(listfile)", &filenum) != LIBMPQ_ERROR_EXIST)
+	{
+		libmpq__off_t size;
+		libmpq__file_size_unpacked(mpq_a, filenum, &size);
+
+		std::string listFile;
+		listFile.resize(size);
+		libmpq__file_read(mpq_a, filenum, reinterpret_cast<uint8*>(&listFile[0]), size, &size);
+
+		// Names are separated by new lines or ';'
+		size_t begin = 0;
+		while (begin < listFile.size())
+		{
+			size_t end = listFile.find_first_of("\r\n;", begin);
+			if (end == std::string::npos)
+				end = listFile.size();
+
+			if (end > begin)
+				fileNames.push_back(listFile.substr(begin, end - begin));
+
+			begin = end + 1;
+		}
+	}
+
+	libmpq__archive_close(mpq_a);
+
+	return fileNames;
+}
@@ -42,6 +42,9 @@ public:
 	void AddArchive(std::string _filename);
 	SMPQFileLocation GetFileLocation(const std::string& _filename);
 
+	// Names from '(listfile)' of archive. Archive is opened separately from storage.
+	static std::vector<std::string> GetArchiveFileNames(const std::string& ArchiveFileName);
+
 private:
 	const std::string           m_Path;
 	const Priority              m_Priority;
@@ -3,6 +3,9 @@
 // FORWARD BEGIN
 class CWMO;
 class CM2;
+class CLiquidTextures;
+class CTexturesCache;
+class Creature;
 // FORWARD END
 
 ZN_INTERFACE ZN_API __declspec(uuid("42D47100-B825-47F1-BE2F-6F7C78443884")) IWoWObjectsCreator
@@ -14,7 +17,33 @@ ZN_INTERFACE ZN_API __declspec(uuid("42D47100-B825-47F1-BE2F-6F7C78443884")) IWo
 
 	virtual std::shared_ptr<CM2>  LoadM2(IRenderDevice& RenderDevice, const std::string& Filename, bool ImmediateLoad = false) = 0;
 	virtual std::shared_ptr<CWMO> LoadWMO(IRenderDevice& RenderDevice, const std::string& Filename, bool ImmediateLoad = false) = 0;
+	virtual std::shared_ptr<CLiquidTextures> LoadLiquidTextures(IRenderDevice& RenderDevice, const std::string& BaseName) = 0;
+
+	// Creatures and characters for 'CreatureDisplayInfo' IDs (nullptr for invalid). Equal IDs resolve DBC records, model and
+	// textures once, different IDs are resolved on several threads. Scene nodes are created on calling thread.
+	virtual std::vector<std::shared_ptr<Creature>> BuildCreaturesFromDisplayInfos(IRenderDevice& RenderDevice, IScene* Scene, const std::vector<uint32>& DisplayInfos, const std::vector<std::shared_ptr<ISceneNode3D>>& Parents) = 0;
+	// Same with appearances resolved on loader threads, calling thread doesn't wait. Scene nodes are created by 'UpdateCreatures'
+	// on its thread, 'OnCreated' gets index in 'DisplayInfos' of each created creature there.
+	virtual void AddCreaturesToLoadQueue(IRenderDevice& RenderDevice, IScene* Scene, const std::vector<uint32>& DisplayInfos, const std::vector<std::shared_ptr<ISceneNode3D>>& Parents, std::function<void(size_t, const std::shared_ptr<Creature>&)> OnCreated) = 0;
+	virtual void UpdateCreatures() = 0; // Once per frame on update thread
+
+	// Textures are shared by normalized file name. Full resolution textures are required by CPU users (skins baking).
+	virtual std::shared_ptr<ITexture> LoadTexture2D(IRenderDevice& RenderDevice, const std::string& Filename) = 0;
+	virtual const CTexturesCache*     GetTexturesCache() const = 0; // nullptr before first texture
+
+	// Optional assets. Missing files are remembered, so next probes don't query files storages and don't throw.
+	virtual std::shared_ptr<IFile>    TryOpen(const std::string& Filename) = 0;
+	virtual std::shared_ptr<ITexture> TryLoadTexture2D(IRenderDevice& RenderDevice, const std::string& Filename) = 0;
+
+	// BLP textures are loaded with small mip and streamed by requested on-screen size (part of screen height)
+	virtual std::shared_ptr<ITexture> LoadStreamedTexture2D(IRenderDevice& RenderDevice, const std::string& Filename) = 0;
+	virtual void                      RequestTextureSize(const ITexture* Texture, float ScreenSize, double Time) = 0;
+	virtual void                      UpdateTextures(double Time) = 0; // Once per frame, streamed levels are recalculated and evicted
 
 	virtual void                         InitEGxBlend(IRenderDevice& RenderDevice) = 0;
 	virtual std::shared_ptr<IBlendState> GetEGxBlend(uint32 Index) const = 0;
+
+	// Materials with equal flags share states objects, so passes can skip redundant binds
+	virtual std::shared_ptr<IDepthStencilState> GetMaterialDepthStencilState(bool DepthTest, bool DepthWrite) const = 0;
+	virtual std::shared_ptr<IRasterizerState>    GetMaterialRasterizerState(bool TwoSided) const = 0;
 };
@@ -100,8 +100,14 @@ void CLiquid::createLayers(const DBC_LiquidTypeRecord* _type, const std::shared_
 		}
 	}*/
 
-	auto geometry = layer->CreateGeometry(ydir);
-	layer->AddConnection(layer->GetMaterial(), geometry);
-
 	m_WaterLayers.push_back(layer);
 }
+
+void CLiquid::createGeometry()
+{
+	for (const auto& layer : m_WaterLayers)
+	{
+		auto geometry = layer->CreateGeometry(ydir);
+		layer->AddConnection(layer->GetMaterial(), geometry);
+	}
+}
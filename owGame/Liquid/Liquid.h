@@ -57,6 +57,7 @@ public:
 
 protected:
 	void createLayers(const DBC_LiquidTypeRecord* _type, const std::shared_ptr<IByteBuffer>& Bytes);
+	void createGeometry(); // Own geometry for each layer. Map chunks layers are merged by tile instead (see CMapTile::AddChunkLiquid)
 	
 public:
 	uint32                                                              m_TilesX, m_TilesY;
@@ -16,64 +16,56 @@ CLiquidLayer::~CLiquidLayer()
 {
 }
 
-std::shared_ptr<IGeometry> CLiquidLayer::CreateGeometry(float YDir)
+std::shared_ptr<IGeometry> CLiquidLayer::CreateGeometry(float YDir) const
 {
-	std::vector<glm::vec3> mh2oVerticesPos;
-	std::vector<glm::vec3> mh2oVerticesTex;
-	std::vector<uint16> m_Indices;
-	uint32 cntr = 0;
+	std::vector<glm::vec3> verticesPos;
+	std::vector<glm::vec3> verticesTex;
+	std::vector<uint16> indices;
+	AppendGeometry(YDir, glm::vec3(0.0f), verticesPos, verticesTex, indices);
 
-	for (uint8 y0 = y; y0 < Height + y; y0++)
-	{
-		for (uint8 x0 = x; x0 < Width + x; x0++)
-		{
-			unsigned tx = x0 - x;
-			unsigned ty = y0 - y;
+	std::shared_ptr<IGeometry> geometry = m_RenderDevice.GetObjectsFactory().CreateGeometry();
+	geometry->AddVertexBuffer(BufferBinding("POSITION", 0), m_RenderDevice.GetObjectsFactory().CreateVertexBuffer(verticesPos));
+	geometry->AddVertexBuffer(BufferBinding("TEXCOORD", 0), m_RenderDevice.GetObjectsFactory().CreateVertexBuffer(verticesTex));
+	geometry->SetIndexBuffer(m_RenderDevice.GetObjectsFactory().CreateIndexBuffer(indices));
 
-			// p1--p4
-			// |    |
-			// p2--p3
-			unsigned p1 = tx + ty * (Width + 1);
-			unsigned p2 = tx + (ty + 1)     * (Width + 1);
-			unsigned p3 = tx + 1 + (ty + 1) * (Width + 1);
-			unsigned p4 = tx + 1 + ty * (Width + 1);
-
-			// heights
-			float h1, h2, h3, h4;
-			h1 = h2 = h3 = h4 = 0.0f;
-			if (heights.size() > 0)
-			{
-				h1 = heights[p1];
-				h2 = heights[p2];
-				h3 = heights[p3];
-				h4 = heights[p4];
-			}
+	return geometry;
+}
 
-			// R_Texture coords
-			std::pair<float, float> t1, t2, t3, t4;
-			t1 = std::make_pair(0.0f, 0.0f);
-			t2 = std::make_pair(0.0f, 1.0f);
-			t3 = std::make_pair(1.0f, 1.0f);
-			t4 = std::make_pair(1.0f, 0.0f);
-			if (textureCoords.size() > 0)
-			{
-				t1 = textureCoords[p1];
-				t2 = textureCoords[p2];
-				t3 = textureCoords[p3];
-				t4 = textureCoords[p4];
-			}
+void CLiquidLayer::AppendGeometry(float YDir, const glm::vec3& Offset, std::vector<glm::vec3>& VerticesPos, std::vector<glm::vec3>& VerticesTex, std::vector<uint16>& Indices) const
+{
+	// Grid points are shared by neighbour cells, only points of visible cells are added
+	std::vector<uint16> gridToVertex((Width + 1) * (Height + 1), UINT16_MAX);
 
-			// alpha
-			float a1, a2, a3, a4;
-			a1 = a2 = a3 = a4 = 1.0f;
-			if (depths.size() > 0)
-			{
-				a1 = minf(static_cast<float>(depths[p1]) / 127.0f, 1.0f); // whats the magic formular here ???
-				a2 = minf(static_cast<float>(depths[p2]) / 127.0f, 1.0f);
-				a3 = minf(static_cast<float>(depths[p3]) / 127.0f, 1.0f);
-				a4 = minf(static_cast<float>(depths[p4]) / 127.0f, 1.0f);
-			}
+	auto getVertex = [&](unsigned gx, unsigned gy) -> uint16 {
+		unsigned p = gx + gy * (Width + 1);
+		if (gridToVertex[p] != UINT16_MAX)
+			return gridToVertex[p];
+
+		_ASSERT(VerticesPos.size() < UINT16_MAX);
+
+		float h = (heights.size() > 0) ? heights[p] : 0.0f;
+
+		// R_Texture coords (cell is 0..1, sampler wraps)
+		std::pair<float, float> t = std::make_pair(static_cast<float>(gx), static_cast<float>(gy));
+		if (textureCoords.size() > 0)
+			t = textureCoords[p];
+
+		// alpha
+		float a = 1.0f;
+		if (depths.size() > 0)
+			a = minf(static_cast<float>(depths[p]) / 127.0f, 1.0f); // whats the magic formular here ???
 
+		VerticesPos.push_back(Offset + glm::vec3(C_UnitSize * static_cast<float>(x + gx), h, YDir * (C_UnitSize * static_cast<float>(y + gy))));
+		VerticesTex.push_back(glm::vec3(t.first, t.second, a));
+
+		gridToVertex[p] = static_cast<uint16>(VerticesPos.size() - 1);
+		return gridToVertex[p];
+	};
+
+	for (unsigned ty = 0; ty < Height; ty++)
+	{
+		for (unsigned tx = 0; tx < Width; tx++)
+		{
 			// Skip hidden water tile
 			if (renderTiles.size() != 0)
 			{
@@ -83,36 +75,22 @@ std::shared_ptr<IGeometry> CLiquidLayer::CreateGeometry(float YDir)
 				}
 			}
 
-			// Insert vertex
-
-			mh2oVerticesPos.push_back(glm::vec3(C_UnitSize * static_cast<float>(x0), h1, YDir * (C_UnitSize * static_cast<float>(y0))));
-			mh2oVerticesTex.push_back(glm::vec3(t1.first, t1.second, a1));
-
-			mh2oVerticesPos.push_back(glm::vec3(C_UnitSize * static_cast<float>(x0), h2, YDir * (C_UnitSize + C_UnitSize * static_cast<float>(y0))));
-			mh2oVerticesTex.push_back(glm::vec3(t2.first, t2.second, a2));
-
-			mh2oVerticesPos.push_back(glm::vec3(C_UnitSize + C_UnitSize * static_cast<float>(x0), h4, YDir * (C_UnitSize * static_cast<float>(y0))));
-			mh2oVerticesTex.push_back(glm::vec3(t4.first, t4.second, a4));
-
-			mh2oVerticesPos.push_back(glm::vec3(C_UnitSize + C_UnitSize * static_cast<float>(x0), h3, YDir * (C_UnitSize + C_UnitSize * static_cast<float>(y0))));
-			mh2oVerticesTex.push_back(glm::vec3(t3.first, t3.second, a3));
-
-			m_Indices.push_back(cntr + 2);
-			m_Indices.push_back(cntr + 1);
-			m_Indices.push_back(cntr + 0);
-			m_Indices.push_back(cntr + 3);
-			m_Indices.push_back(cntr + 1);
-			m_Indices.push_back(cntr + 2);
-			cntr += 4;
+			// p1--p4
+			// |    |
+			// p2--p3
+			uint16 p1 = getVertex(tx, ty);
+			uint16 p2 = getVertex(tx, ty + 1);
+			uint16 p3 = getVertex(tx + 1, ty + 1);
+			uint16 p4 = getVertex(tx + 1, ty);
+
+			Indices.push_back(p4);
+			Indices.push_back(p2);
+			Indices.push_back(p1);
+			Indices.push_back(p3);
+			Indices.push_back(p2);
+			Indices.push_back(p4);
 		}
 	}
-
-	std::shared_ptr<IGeometry> geometry = m_RenderDevice.GetObjectsFactory().CreateGeometry();
-	geometry->AddVertexBuffer(BufferBinding("POSITION", 0), m_RenderDevice.GetObjectsFactory().CreateVertexBuffer(mh2oVerticesPos));
-	geometry->AddVertexBuffer(BufferBinding("TEXCOORD", 0), m_RenderDevice.GetObjectsFactory().CreateVertexBuffer(mh2oVerticesTex));
-	geometry->SetIndexBuffer(m_RenderDevice.GetObjectsFactory().CreateIndexBuffer(m_Indices));
-
-	return geometry;
 }
 
 std::shared_ptr<IMaterial> CLiquidLayer::GetMaterial() const
@@ -127,8 +105,7 @@ std::shared_ptr<IMaterial> CLiquidLayer::GetMaterial() const
 //
 bool CLiquidLayer::Render(const RenderEventArgs& renderEventArgs) const
 {
-	uint32_t texidx = (uint32_t)(renderEventArgs.TotalTime / 60.0f) % m_Textures.size();
-	m_Material->SetTexture(0, m_Textures[texidx]);
+	m_Material->SetTexture(0, m_LiquidTextures->GetFrame(renderEventArgs.TotalTime));
 
 	if (m_SkyManager != nullptr)
 	{
@@ -178,12 +155,5 @@ void CLiquidLayer::InitTextures(DBC_LIQUIDTYPE_Type::List _liquidType)
 		_ASSERT(false);
 	}
 
-	char buf[MAX_PATH];
-	for (int i = 1; i <= 30; i++)
-	{
-		sprintf(buf, "%s.%d.blp", baseName.c_str(), i);
-		std::shared_ptr<ITexture> texture = m_RenderDevice.GetObjectsFactory().LoadTexture2D(buf);
-		m_Textures.push_back(texture);
-	}
+	m_LiquidTextures = m_RenderDevice.GetBaseManager().GetManager<IWoWObjectsCreator>()->LoadLiquidTextures(m_RenderDevice, baseName);
 }
-
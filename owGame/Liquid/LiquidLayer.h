@@ -1,6 +1,7 @@
 #pragma once
 
 #include "LiquidMaterial.h"
+#include "LiquidTextures.h"
 
 #include "DBC/DBC__Storage.h"
 
@@ -11,7 +12,9 @@ public:
 	CLiquidLayer(IRenderDevice& RenderDevice);
 	virtual ~CLiquidLayer();
 
-	std::shared_ptr<IGeometry> CreateGeometry(float YDir);
+	std::shared_ptr<IGeometry> CreateGeometry(float YDir) const;
+	// Indexed grid with shared vertices. Used to merge several layers into one geometry.
+	void AppendGeometry(float YDir, const glm::vec3& Offset, std::vector<glm::vec3>& VerticesPos, std::vector<glm::vec3>& VerticesTex, std::vector<uint16>& Indices) const;
 	std::shared_ptr<IMaterial> GetMaterial() const;
 
 	// IModel
@@ -45,7 +48,7 @@ public:
 
 private:
 	ISkyManager* m_SkyManager;
-	std::vector<std::shared_ptr<ITexture>>    m_Textures;
+	std::shared_ptr<CLiquidTextures> m_LiquidTextures;
 	std::shared_ptr<LiquidMaterial> m_Material;
 
 private:
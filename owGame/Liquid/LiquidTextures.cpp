@@ -0,0 +1,30 @@
+#include "stdafx.h"
+
+// General
+#include "LiquidTextures.h"
+
+namespace
+{
+	const uint32 cLiquidFramesCount = 30;
+}
+
+CLiquidTextures::CLiquidTextures(IRenderDevice& RenderDevice, const std::string& BaseName)
+{
+	m_Frames.reserve(cLiquidFramesCount);
+
+	char buf[MAX_PATH];
+	for (uint32 i = 1; i <= cLiquidFramesCount; i++)
+	{
+		sprintf(buf, "%s.%d.blp", BaseName.c_str(), i);
+		m_Frames.push_back(RenderDevice.GetBaseManager().GetManager<IWoWObjectsCreator>()->LoadTexture2D(RenderDevice, buf));
+	}
+}
+
+CLiquidTextures::~CLiquidTextures()
+{}
+
+const std::shared_ptr<ITexture>& CLiquidTextures::GetFrame(double TotalTime) const
+{
+	uint32 frameIndex = static_cast<uint32>(TotalTime / 60.0) % m_Frames.size();
+	return m_Frames[frameIndex];
+}
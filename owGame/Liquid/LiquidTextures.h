@@ -0,0 +1,18 @@
+#pragma once
+
+/**
+  * Animated frames of one liquid type ('BaseName.1.blp' ... 'BaseName.30.blp').
+  * Loaded once per type by IWoWObjectsCreator::LoadLiquidTextures and shared by all liquid layers.
+*/
+class ZN_API CLiquidTextures
+{
+public:
+	CLiquidTextures(IRenderDevice& RenderDevice, const std::string& BaseName);
+	virtual ~CLiquidTextures();
+
+	const std::shared_ptr<ITexture>& GetFrame(double TotalTime) const;
+	size_t GetFramesCount() const { return m_Frames.size(); }
+
+private:
+	std::vector<std::shared_ptr<ITexture>> m_Frames;
+};
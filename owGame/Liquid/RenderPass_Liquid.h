@@ -1,7 +1,9 @@
 #pragma once
 
+#include "WowRecordedListPass.h"
+
 class ZN_API CRenderPass_Liquid
-	: public CBaseList3DPass
+	: public CRecordedList3DPass
 {
 public:
 	CRenderPass_Liquid(IRenderDevice& RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneNodeListPass);
@@ -3,6 +3,32 @@
 // General
 #include "M2.h"
 
+//
+// CM2::CSkinLoader
+//
+class CM2::CSkinLoader
+	: public CLoadableObject
+{
+public:
+	CSkinLoader(const std::shared_ptr<const CM2>& M2Model, uint32 LODIndex)
+		: m_M2Model(M2Model)
+		, m_LODIndex(LODIndex)
+	{}
+
+	// CLoadableObject
+	bool Load() override
+	{
+		m_M2Model->OnSkinLoaded(m_LODIndex, m_M2Model->LoadSkin(m_LODIndex));
+		return true;
+	}
+
+private:
+	const std::shared_ptr<const CM2> m_M2Model; // Model is alive while skin is in load queue
+	const uint32 m_LODIndex;
+};
+
+
+
 CM2::CM2(IBaseManager& BaseManager, IRenderDevice& RenderDevice, const std::string& FileName)
 	: m_FileName(FileName)
 	, m_UniqueName("")
@@ -10,6 +36,8 @@ CM2::CM2(IBaseManager& BaseManager, IRenderDevice& RenderDevice, const std::stri
 	// Loops and sequences
 	, m_IsAnimated(false)
 
+	, m_SkinsLastEvictTime(0.0)
+
 	// Vertices
 	, m_BaseManager(BaseManager)
 	, m_RenderDevice(RenderDevice)
@@ -41,6 +69,11 @@ CM2::CM2(IBaseManager& BaseManager, IRenderDevice& RenderDevice, const std::stri
 		m_UniqueName = std::string((const char*)(m_F->getData() + m_Header.name.offset));
 
 	m_Bounds = m_Header.bounding_box.Convert();
+
+	std::shared_ptr<ISettingGroup> wowSettings = BaseManager.GetManager<ISettings>()->GetGroup("WoWSettings");
+	m_SkinLODEnabled = wowSettings->GetSettingT<bool>("M2_SkinLOD_Enabled");
+	m_SkinLODDistance = wowSettings->GetSettingT<float>("M2_SkinLOD_Distance");
+	m_SkinLODEvictTime = wowSettings->GetSettingT<float>("M2_SkinLOD_EvictTime");
 }
 
 CM2::~CM2()
@@ -49,11 +82,73 @@ CM2::~CM2()
 
 void CM2::CreateInsances(const std::shared_ptr<ISceneNode3D>& Parent) const
 {
-	for (auto& it : m_Skins)
+	// Skin 0 is registered as instance model, render passes replace it with instance's LOD skin
+	if (false == m_Skins.empty() && m_Skins[0] != nullptr)
+		Parent->GetComponent<IModelsComponent3D>()->AddModel(m_Skins[0]);
+}
+
+uint32 CM2::GetSkinsCount() const
+{
+#if WOW_CLIENT_VERSION <= WOW_BC_2_4_3
+	return m_Header.skin_profiles.size;
+#else
+	return m_Header.num_skin_profiles;
+#endif
+}
+
+uint32 CM2::GetSkinLODIndex(float Distance) const
+{
+	if (m_Skins.size() <= 1 || !m_SkinLODEnabled->Get())
+		return 0;
+
+	float lodDistance = m_SkinLODDistance->Get();
+	if (lodDistance <= 0.0f)
+		return 0;
+
+	return glm::min(static_cast<uint32>(Distance / lodDistance), static_cast<uint32>(m_Skins.size() - 1));
+}
+
+std::shared_ptr<CM2_Skin> CM2::RequestSkin(const std::shared_ptr<const CM2>& M2Model, uint32 LODIndex, double Time)
+{
+	if (M2Model->m_Skins.empty())
+		return nullptr;
+
+	std::shared_ptr<CSkinLoader> skinLoader = nullptr;
+
 	{
-		Parent->GetComponent<IModelsComponent3D>()->AddModel(it);
-		break;
+		std::lock_guard<std::mutex> lock(M2Model->m_SkinsLock);
+
+		// Eviction once per frame (first request with new time)
+		if (Time != M2Model->m_SkinsLastEvictTime)
+		{
+			M2Model->EvictUnusedSkins(Time);
+			M2Model->m_SkinsLastEvictTime = Time;
+		}
+
+		if (LODIndex >= M2Model->m_Skins.size() || M2Model->m_Vertexes.empty() || M2Model->m_SkinsStates[LODIndex] == ESkinState::Failed)
+			LODIndex = 0;
+
+		M2Model->m_SkinsLastUsedTime[LODIndex] = Time;
+
+		switch (M2Model->m_SkinsStates[LODIndex])
+		{
+			case ESkinState::Loaded:
+				return M2Model->m_Skins[LODIndex];
+
+			case ESkinState::NotLoaded:
+				M2Model->m_SkinsStates[LODIndex] = ESkinState::Loading;
+				skinLoader = std::make_shared<CSkinLoader>(M2Model, LODIndex);
+				break;
+
+			default:
+				break;
+		}
 	}
+
+	if (skinLoader != nullptr)
+		M2Model->GetBaseManager().GetManager<ILoader>()->AddToLoadQueue(skinLoader);
+
+	return nullptr;
 }
 
 bool CM2::Load()
@@ -74,45 +169,29 @@ bool CM2::Load()
 	if (m_Header.vertices.size > 0)
 	{
 		// Vertices
-		std::vector<SM2_Vertex>	m2Vertexes;
 		const SM2_Vertex* Vertexes = (const SM2_Vertex*)(m_F->getData() + m_Header.vertices.offset);
-		for (uint32 i = 0; i < m_Header.vertices.size; i++)
-			m2Vertexes.push_back(Vertexes[i]);
+		m_Vertexes.assign(Vertexes, Vertexes + m_Header.vertices.size);
 
 		for (uint32 i = 0; i < m_Header.vertices.size; i++)
 		{
-			m2Vertexes[i].pos = Fix_XZmY(m2Vertexes[i].pos);
-			m2Vertexes[i].normal = Fix_XZmY(m2Vertexes[i].normal);
-		}
-
-#if WOW_CLIENT_VERSION <= WOW_BC_2_4_3
-		_ASSERT(m_Header.skin_profiles.size > 0);
-		const SM2_SkinProfile* m2Skins = (const SM2_SkinProfile*)(m_F->getData() + m_Header.skin_profiles.offset);
-		for (uint32 i = 0; i < m_Header.skin_profiles.size; i++)
-		{
-			std::shared_ptr<CM2_Skin> skin = std::make_shared<CM2_Skin>(m_BaseManager, m_RenderDevice, *this, m2Skins[i]);
-			skin->Load(m_Header, m_F, m2Vertexes);
-			m_Skins.push_back(skin);
-			break;
+			m_Vertexes[i].pos = Fix_XZmY(m_Vertexes[i].pos);
+			m_Vertexes[i].normal = Fix_XZmY(m_Vertexes[i].normal);
 		}
-#else
-		_ASSERT(m_Header.num_skin_profiles > 0);
-		for (uint32 i = 0; i < m_Header.num_skin_profiles; i++)
-		{
-			char buf[256];
-			sprintf_s(buf, "%s%02d.skin", m_FileNameWithoutExt.c_str(), i);
 
-			std::shared_ptr<IFile> skinFile = GetBaseManager().GetManager<IFilesManager>()->Open(buf);
+		// Only the most detailed skin is loaded here, other skins are loaded by 'RequestSkin'
+		_ASSERT(GetSkinsCount() > 0);
+		m_Skins.resize(GetSkinsCount());
+		m_SkinsStates.resize(GetSkinsCount(), ESkinState::NotLoaded);
+		m_SkinsLastUsedTime.resize(GetSkinsCount(), 0.0);
+		m_Skins[0] = LoadSkin(0);
+		m_SkinsStates[0] = (m_Skins[0] != nullptr) ? ESkinState::Loaded : ESkinState::Failed;
 
-
-			const SM2_SkinProfile* m2Skin = (const SM2_SkinProfile*)skinFile->getData();
-
-			std::shared_ptr<CM2_Skin> skin = std::make_shared<CM2_Skin>(m_BaseManager, m_RenderDevice, *this, *m2Skin);
-			skin->Load(m_Header, skinFile, m2Vertexes);
-			m_Skins.push_back(skin);
-			break;
+		// Vertices are not needed anymore if LOD skins can't be requested
+		if (GetSkinsCount() == 1 || !m_SkinLODEnabled->Get())
+		{
+			m_Vertexes.clear();
+			m_Vertexes.shrink_to_fit();
 		}
-#endif
 	}
 	else
 	{
@@ -123,6 +202,27 @@ bool CM2::Load()
 #endif
 	}
 
+	// Collision
+	if (m_Header.collisionVertices.size > 0 && m_Header.collisionTriangles.size >= 3)
+	{
+		const glm::vec3* collisionVertexes = (const glm::vec3*)(m_F->getData() + m_Header.collisionVertices.offset);
+		std::vector<glm::vec3> vertexes(m_Header.collisionVertices.size);
+		for (uint32 i = 0; i < m_Header.collisionVertices.size; i++)
+			vertexes[i] = Fix_XZmY(collisionVertexes[i]);
+
+		const uint16* collisionTriangles = (const uint16*)(m_F->getData() + m_Header.collisionTriangles.offset);
+		std::vector<uint16> indexes(collisionTriangles, collisionTriangles + (m_Header.collisionTriangles.size / 3) * 3);
+
+		bool isIndexesValid = std::all_of(indexes.begin(), indexes.end(), [&vertexes](uint16 Index) {
+			return Index < vertexes.size();
+		});
+
+		if (isIndexesValid)
+			m_Collision = std::make_unique<CM2_CollisionBVH>(vertexes, indexes);
+		else
+			Log::Warn("M2[%s] contains invalid collision triangles.", getFilename().c_str());
+	}
+
 #if 0
 	// Collisions
 	std::shared_ptr<IBuffer> collisonVB = nullptr;
@@ -178,3 +278,64 @@ bool CM2::Load()
 
 	return true;
 }
+
+
+
+//
+// Private
+//
+std::shared_ptr<CM2_Skin> CM2::LoadSkin(uint32 LODIndex) const
+{
+	_ASSERT(LODIndex < GetSkinsCount());
+
+#if WOW_CLIENT_VERSION <= WOW_BC_2_4_3
+	// Skin profiles are stored in model file
+	std::shared_ptr<IFile> skinFile = (m_F != nullptr) ? m_F : GetBaseManager().GetManager<IFilesManager>()->Open(m_FileName);
+	if (skinFile == nullptr)
+	{
+		Log::Error("M2[%s]: Unable to reopen file for skin [%d].", getFilename().c_str(), LODIndex);
+		return nullptr;
+	}
+
+	const SM2_SkinProfile* m2Skin = (const SM2_SkinProfile*)(skinFile->getData() + m_Header.skin_profiles.offset) + LODIndex;
+#else
+	char buf[256];
+	sprintf_s(buf, "%s%02d.skin", m_FileNameWithoutExt.c_str(), LODIndex);
+
+	std::shared_ptr<IFile> skinFile = GetBaseManager().GetManager<IFilesManager>()->Open(buf);
+	if (skinFile == nullptr)
+	{
+		Log::Error("M2[%s]: Skin file '%s' not found.", getFilename().c_str(), buf);
+		return nullptr;
+	}
+
+	const SM2_SkinProfile* m2Skin = (const SM2_SkinProfile*)skinFile->getData();
+#endif
+
+	std::shared_ptr<CM2_Skin> skin = std::make_shared<CM2_Skin>(m_BaseManager, m_RenderDevice, *this, *m2Skin);
+	skin->Load(m_Header, skinFile, m_Vertexes);
+	return skin;
+}
+
+void CM2::OnSkinLoaded(uint32 LODIndex, const std::shared_ptr<CM2_Skin>& Skin) const
+{
+	std::lock_guard<std::mutex> lock(m_SkinsLock);
+
+	m_Skins[LODIndex] = Skin;
+	m_SkinsStates[LODIndex] = (Skin != nullptr) ? ESkinState::Loaded : ESkinState::Failed;
+}
+
+void CM2::EvictUnusedSkins(double Time) const
+{
+	double evictTime = m_SkinLODEvictTime->Get();
+
+	// Skin 0 is used by instances models components and never evicted. Skins that are still drawn by instances are kept.
+	for (size_t i = 1; i < m_Skins.size(); i++)
+	{
+		if (m_SkinsStates[i] != ESkinState::Loaded || (Time - m_SkinsLastUsedTime[i]) <= evictTime || m_Skins[i].use_count() > 1)
+			continue;
+
+		m_Skins[i].reset();
+		m_SkinsStates[i] = ESkinState::NotLoaded;
+	}
+}
@@ -10,6 +10,9 @@
 // Skins
 #include "M2_Skin.h"
 
+// Collision
+#include "M2_CollisionBVH.h"
+
 class ZN_API CM2 
 	: public ISceneNodeProvider
 	, public CLoadableObject
@@ -33,6 +36,16 @@ public:
 	std::string getFilePath() const { return m_FilePath; }
 	std::string getUniqueName() const { return m_UniqueName; }
 	cbbox       GetBounds() const { return m_Bounds; }
+	const std::vector<std::shared_ptr<CM2_Skin>>& GetSkins() const { return m_Skins; }
+
+	// Skin LOD (skin 0 is loaded with model, lower-detail skins are queued to loader on first request and evicted when unused).
+	// Returns nullptr while requested skin is loading, caller continues to draw current skin.
+	uint32                              GetSkinsCount() const;
+	uint32                              GetSkinLODIndex(float Distance) const;
+	static std::shared_ptr<CM2_Skin>    RequestSkin(const std::shared_ptr<const CM2>& M2Model, uint32 LODIndex, double Time);
+
+	// Collision mesh queries structure (shared by all instances), nullptr if model don't have collision
+	const CM2_CollisionBVH*             GetCollision() const { return m_Collision.get(); }
 	
 public:
 	const bool isAnimated() const { return m_IsAnimated; }
@@ -62,9 +75,34 @@ private:
 	BoundingBox							m_Bounds;
 
 	// Skins
-	std::vector<std::shared_ptr<CM2_Skin>> m_Skins;
+	class CSkinLoader;
+
+	std::shared_ptr<CM2_Skin>           LoadSkin(uint32 LODIndex) const;
+	void                                OnSkinLoaded(uint32 LODIndex, const std::shared_ptr<CM2_Skin>& Skin) const;
+	void                                EvictUnusedSkins(double Time) const;
+
+	enum class ESkinState : uint8
+	{
+		NotLoaded = 0,
+		Loading,
+		Loaded,
+		Failed
+	};
+
+	mutable std::vector<std::shared_ptr<CM2_Skin>> m_Skins;
+	mutable std::vector<ESkinState>     m_SkinsStates;
+	mutable std::vector<double>         m_SkinsLastUsedTime;
+	mutable double                      m_SkinsLastEvictTime;
+	mutable std::mutex                  m_SkinsLock;
+	std::vector<SM2_Vertex>             m_Vertexes; // Kept for lazy skins loading
+	std::shared_ptr<ISettingT<bool>>    m_SkinLODEnabled;
+	std::shared_ptr<ISettingT<float>>   m_SkinLODDistance;
+	std::shared_ptr<ISettingT<float>>   m_SkinLODEvictTime;
 
 private:
+	// Collision
+	std::unique_ptr<CM2_CollisionBVH>   m_Collision;
+
 	// Buffers and geom
 	std::shared_ptr<IModel>				m_CollisionGeom;
 	uint32								m_CollisionIndCnt;
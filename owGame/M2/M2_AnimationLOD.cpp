@@ -0,0 +1,51 @@
+#include "stdafx.h"
+
+// Include
+#include "M2_Base_Instance.h"
+
+// General
+#include "M2_AnimationLOD.h"
+
+CM2_AnimationLOD::CM2_AnimationLOD(IBaseManager& BaseManager)
+{
+	std::shared_ptr<ISettingGroup> wowSettings = BaseManager.GetManager<ISettings>()->GetGroup("WoWSettings");
+	m_Enabled = wowSettings->GetSettingT<bool>("M2_AnimLOD_Enabled");
+	m_BonesCulling = wowSettings->GetSettingT<bool>("M2_AnimLOD_BonesCulling");
+	m_HalfRateSize = wowSettings->GetSettingT<float>("M2_AnimLOD_HalfRate_Size");
+	m_QuarterRateSize = wowSettings->GetSettingT<float>("M2_AnimLOD_QuarterRate_Size");
+	m_EighthRateSize = wowSettings->GetSettingT<float>("M2_AnimLOD_EighthRate_Size");
+}
+
+CM2_AnimationLOD::~CM2_AnimationLOD()
+{
+}
+
+uint32 CM2_AnimationLOD::GetUpdateInterval(const CM2_Base_Instance& M2Instance, const ICameraComponent3D* Camera) const
+{
+	if (Camera == nullptr || !m_Enabled->Get())
+		return 1;
+
+	const BoundingBox& bounds = M2Instance.getM2().GetBounds();
+	glm::vec3 worldScale = extractScale(M2Instance.GetWorldTransfom());
+	float radius = glm::length(bounds.getMax() - bounds.getMin()) * 0.5f * glm::max(worldScale.x, glm::max(worldScale.y, worldScale.z));
+
+	glm::vec3 instancePosition = glm::vec3(M2Instance.GetWorldTransfom()[3]);
+	float distance = glm::distance(instancePosition, Camera->GetTranslation());
+	if (distance <= radius)
+		return 1;
+
+	float projectedSize = radius / distance;
+	if (projectedSize < m_EighthRateSize->Get())
+		return 8;
+	else if (projectedSize < m_QuarterRateSize->Get())
+		return 4;
+	else if (projectedSize < m_HalfRateSize->Get())
+		return 2;
+
+	return 1;
+}
+
+bool CM2_AnimationLOD::IsBonesCullingEnabled() const
+{
+	return m_BonesCulling->Get();
+}
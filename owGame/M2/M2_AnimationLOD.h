@@ -0,0 +1,27 @@
+#pragma once
+
+// FORWARD BEGIN
+class CM2_Base_Instance;
+// FORWARD END
+
+/**
+  * Animation LOD policy for M2 instances.
+  * Distant (small on screen) instances evaluate their skeleton at 1/2, 1/4 or 1/8 of the frame rate,
+  * the bone palette is interpolated between two evaluated poses on skipped frames.
+*/
+class CM2_AnimationLOD
+{
+public:
+	CM2_AnimationLOD(IBaseManager& BaseManager);
+	virtual ~CM2_AnimationLOD();
+
+	uint32 GetUpdateInterval(const CM2_Base_Instance& M2Instance, const ICameraComponent3D* Camera) const;
+	bool   IsBonesCullingEnabled() const;
+
+private:
+	std::shared_ptr<ISettingT<bool>>  m_Enabled;
+	std::shared_ptr<ISettingT<bool>>  m_BonesCulling;
+	std::shared_ptr<ISettingT<float>> m_HalfRateSize;
+	std::shared_ptr<ISettingT<float>> m_QuarterRateSize;
+	std::shared_ptr<ISettingT<float>> m_EighthRateSize;
+};
@@ -6,12 +6,19 @@
 // General
 #include "M2_Animator.h"
 
+CM2_Animator::SBlendLayer::SBlendLayer(const CM2_Animation* Animation, bool IsLoop, float Weight)
+	: Animation(Animation)
+	, IsLoop(IsLoop)
+	, IsStopped(false)
+	, AnimTime(0.0)
+	, CurrentTime(Animation->getStart())
+	, Weight(Weight)
+	, TargetWeight(Weight)
+	, WeightSpeed(0.0f)
+{}
+
 CM2_Animator::CM2_Animator(const IBaseManager& BaseManager, const CM2& M2Model) 
 	: m_M2Model(M2Model)
-	, m_IsLoop(false)
-	, m_IsStopped(false)
-	, animtime(0.0)
-	, m_CurrentTime(0)
 {
 	const auto& sequences = m_M2Model.getSkeleton().GetSequences();
 	for (uint16 j = 0; j < sequences.size(); j++)
@@ -35,24 +42,38 @@ CM2_Animator::~CM2_Animator()
 	//ERASE_MAP(m_Animations);
 }
 
-void CM2_Animator::PlayAnimation(uint16 AnimationId, bool Loop)
+void CM2_Animator::PlayAnimation(uint16 AnimationId, bool Loop, double BlendTime)
 {
-	m_IsLoop = Loop;
+	const CM2_Animation* animation = FindAnimation(AnimationId);
 
-	const auto& animIt = m_Animations.find(AnimationId);
-	if (animIt != m_Animations.end())
+	if (BlendTime <= 0.0 || m_BaseLayers.empty())
 	{
-		m_CurrentAnimation = animIt->second.get();
+		m_BaseLayers.clear();
+		m_BaseLayers.push_back(SBlendLayer(animation, Loop, 1.0f));
+		return;
 	}
-	else
+
+	// Animation is already playing, don't blend it into itself. Ended animation is restarted.
+	SBlendLayer& currentLayer = m_BaseLayers.back();
+	if (currentLayer.Animation == animation)
 	{
-		m_CurrentAnimation = m_Animations.begin()->second.get();
-		//Log::Error("CM2_Animator: Animation '%d' not found. Playing first animation '%s' ('%d').", AnimationId, m_CurrentAnimation->getAnimationName().c_str(), m_CurrentAnimation->getAnimID());
+		currentLayer.IsLoop = Loop;
+		if (currentLayer.IsStopped)
+		{
+			currentLayer.IsStopped = false;
+			currentLayer.AnimTime = 0.0;
+			currentLayer.CurrentTime = animation->getStart();
+		}
+		return;
 	}
 
-	m_CurrentTime = m_CurrentAnimation->getStart();
-	m_IsStopped = false;
-	animtime = 0.0;
+	// Fade out all current animations
+	for (auto& layer : m_BaseLayers)
+		SetLayerTargetWeight(layer, 0.0f, BlendTime);
+
+	SBlendLayer newLayer(animation, Loop, 0.0f);
+	SetLayerTargetWeight(newLayer, 1.0f, BlendTime);
+	m_BaseLayers.push_back(newLayer);
 }
 
 void CM2_Animator::PrintList()
@@ -65,14 +86,51 @@ void CM2_Animator::PrintList()
 
 void CM2_Animator::Update(double _time, double _dTime)
 {
-	if (m_IsStopped)
+	for (auto& layer : m_BaseLayers)
+		UpdateLayer(layer, _dTime);
+
+	// Remove faded out layers. Last started base animation always stays
+	m_BaseLayers.erase(std::remove_if(m_BaseLayers.begin(), m_BaseLayers.end() - 1, [](const SBlendLayer& Layer) {
+		return Layer.TargetWeight <= 0.0f && Layer.Weight <= 0.0f;
+	}), m_BaseLayers.end() - 1);
+}
+
+
+
+//
+// Private
+//
+const CM2_Animation* CM2_Animator::FindAnimation(uint16 AnimationId) const
+{
+	const auto& animIt = m_Animations.find(AnimationId);
+	if (animIt != m_Animations.end())
+		return animIt->second.get();
+
+	//Log::Error("CM2_Animator: Animation '%d' not found. Playing first animation '%s' ('%d').", AnimationId, m_CurrentAnimation->getAnimationName().c_str(), m_CurrentAnimation->getAnimID());
+	return m_Animations.begin()->second.get();
+}
+
+void CM2_Animator::UpdateLayer(SBlendLayer& Layer, double _dTime) const
+{
+	// Weight
+	if (Layer.Weight != Layer.TargetWeight)
+	{
+		float delta = Layer.WeightSpeed * static_cast<float>(_dTime);
+		if (glm::abs(Layer.TargetWeight - Layer.Weight) <= delta)
+			Layer.Weight = Layer.TargetWeight;
+		else
+			Layer.Weight += (Layer.TargetWeight > Layer.Weight) ? delta : -delta;
+	}
+
+	// Time
+	if (Layer.IsStopped)
 		return;
 
-	animtime += _dTime / 10.0f;
-	m_CurrentTime = static_cast<uint32>(m_CurrentAnimation->getStart() + animtime);
+	Layer.AnimTime += _dTime / 10.0f;
+	Layer.CurrentTime = static_cast<uint32>(Layer.Animation->getStart() + Layer.AnimTime);
 
 	// Animation don't ended
-	if (m_CurrentTime < m_CurrentAnimation->getEnd())
+	if (Layer.CurrentTime < Layer.Animation->getEnd())
 		return;
 
 	// Ended!
@@ -85,11 +143,26 @@ void CM2_Animator::Update(double _time, double _dTime)
 		return;
 	}*/
 
-	m_CurrentTime = m_CurrentAnimation->getEnd() - 1;
-	m_IsStopped = true;
+	if (Layer.IsLoop)
+	{
+		Layer.CurrentTime = Layer.Animation->getStart();
+		Layer.AnimTime = 0.0;
+		return;
+	}
+
+	Layer.CurrentTime = Layer.Animation->getEnd() - 1;
+	Layer.IsStopped = true;
+}
 
-	if (m_IsLoop)
+void CM2_Animator::SetLayerTargetWeight(SBlendLayer& Layer, float TargetWeight, double BlendTime)
+{
+	Layer.TargetWeight = TargetWeight;
+	if (BlendTime <= 0.0)
 	{
-		PlayAnimation(m_CurrentAnimation->getAnimID(), true);
+		Layer.Weight = TargetWeight;
+		Layer.WeightSpeed = 0.0f;
+		return;
 	}
+
+	Layer.WeightSpeed = glm::abs(TargetWeight - Layer.Weight) / static_cast<float>(BlendTime);
 }
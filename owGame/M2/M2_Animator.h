@@ -5,32 +5,54 @@
 
 class ZN_API CM2_Animator
 {
+public:
+	struct SBlendLayer
+	{
+		SBlendLayer(const CM2_Animation* Animation, bool IsLoop, float Weight);
+
+		const CM2_Animation*        Animation;
+		bool                        IsLoop;
+		bool                        IsStopped;
+		double                      AnimTime;
+		uint32                      CurrentTime;
+
+		float                       Weight;
+		float                       TargetWeight;
+		float                       WeightSpeed;  // Weight change per millisecond
+	};
+
 public:
 	CM2_Animator(const IBaseManager& BaseManager, const CM2& M2Model);
 	virtual ~CM2_Animator();
 
-	void PlayAnimation(uint16 AnimationId, bool Loop);
+	// Crossfade from the current animation to new one during 'BlendTime' milliseconds. Zero time - switch immediately
+	void PlayAnimation(uint16 AnimationId, bool Loop, double BlendTime = 0.0);
+
 	void PrintList();
 	void Update(double _time, double _dTime);
 
-	uint16 getSequenceIndex() const { return m_CurrentAnimation->getSequenceIndex(); }
-	uint32 getCurrentTime() { return m_CurrentTime; }
+	// Dominant (last started) animation, used by non skeletal tracks
+	uint16 getSequenceIndex() const { return m_BaseLayers.back().Animation->getSequenceIndex(); }
+	uint32 getCurrentTime() { return m_BaseLayers.back().CurrentTime; }
 	//uint32 getStart() const { return m_CurrentAnimation->getStart(); }
 	//uint32 getEnd() const { return m_CurrentAnimation->getEnd(); }
 
+	// Layers are blended by weight
+	const std::vector<SBlendLayer>& GetBaseLayers() const { return m_BaseLayers; }
+
 	//void setOnEndFunction(Function* _onEnd);
 
+private:
+	const CM2_Animation* FindAnimation(uint16 AnimationId) const;
+	void UpdateLayer(SBlendLayer& Layer, double _dTime) const;
+	static void SetLayerTargetWeight(SBlendLayer& Layer, float TargetWeight, double BlendTime);
+
 private:
 	std::unordered_map<uint16, std::shared_ptr<CM2_Animation>>	m_Animations;
-	const CM2_Animation*		m_CurrentAnimation;
-	bool						m_IsLoop;
-	bool						m_IsStopped;
+	std::vector<SBlendLayer>    m_BaseLayers;
 
 	//Function*					m_OnAnimationEnded;
 
-	double						animtime;
-	uint32						m_CurrentTime;
-
 private:
 	const CM2& m_M2Model;
-};
\ No newline at end of file
+};
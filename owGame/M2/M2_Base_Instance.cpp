@@ -5,11 +5,13 @@
 
 // Additional
 #include "M2_ColliderComponent.h"
+#include "WowHash.h"
 
 CM2_Base_Instance::CM2_Base_Instance(const std::shared_ptr<CM2>& M2Object) 
 	: CLoadableObject(M2Object)
 	, m_M2(M2Object)
 	, m_AttachmentType(M2_AttachmentType::NotAttached)
+	, m_PinnedBoneIndex(-1)
 	, m_Color(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f))
 	, m_Alpha(1.0f)
 	, m_Animator(nullptr)
@@ -19,6 +21,8 @@ CM2_Base_Instance::CM2_Base_Instance(const std::shared_ptr<CM2>& M2Object)
 
 CM2_Base_Instance::~CM2_Base_Instance()
 {
+	SetPinnedBone(nullptr, -1);
+
 	if (getM2().isAnimated())
 	{
 		//_Bindings->UnregisterUpdatableObject(this);
@@ -63,6 +67,7 @@ void CM2_Base_Instance::Attach(M2_AttachmentType AttachmentType)
 void CM2_Base_Instance::Detach()
 {
 	m_AttachmentType = M2_AttachmentType::NotAttached;
+	SetPinnedBone(nullptr, -1);
 }
 
 void CM2_Base_Instance::UpdateAttachPositionAfterSkeletonUpdate()
@@ -88,6 +93,21 @@ const std::shared_ptr<ITexture>& CM2_Base_Instance::getSpecialTexture(SM2_Textur
 	_ASSERT(_type < SM2_Texture::Type::COUNT);
 	return m_SpecialTextures[_type];
 }
+uint64 CM2_Base_Instance::getSpecialTexturesSignature() const
+{
+	uint64 signature = cHashFNV1aOffset;
+	for (uint32 i = 0; i < SM2_Texture::Type::COUNT; i++)
+		signature = HashFNV1a(signature, static_cast<uint64>(reinterpret_cast<uintptr_t>(m_SpecialTextures[i].get())));
+	return signature;
+}
+
+// Skin LOD
+const CM2_Skin* CM2_Base_Instance::getActiveSkin(const CM2_Skin* RegisteredSkin) const
+{
+	if (m_ActiveSkin == nullptr)
+		return RegisteredSkin;
+	return m_ActiveSkin.get();
+}
 
 
 //
@@ -116,7 +136,22 @@ void CM2_Base_Instance::Update(const UpdateEventArgs & e)
 	if (m_ParticleComponent)
 		m_ParticleComponent->Update(e);
 
+	if (e.Camera != nullptr && getM2().GetSkinsCount() > 1)
+	{
+		float distance = glm::distance(glm::vec3(GetWorldTransfom()[3]), e.Camera->GetTranslation());
+		if (std::shared_ptr<CM2_Skin> skin = CM2::RequestSkin(m_M2, getM2().GetSkinLODIndex(distance), e.TotalTime))
+			m_ActiveSkin = skin;
+	}
 
+	// Textures level by on-screen size (part of screen height)
+	if (e.Camera != nullptr)
+	{
+		const BoundingBox& bounds = getM2().GetBounds();
+		glm::vec3 worldScale = extractScale(GetWorldTransfom());
+		float radius = glm::length(bounds.getMax() - bounds.getMin()) * 0.5f * glm::max(worldScale.x, glm::max(worldScale.y, worldScale.z));
+		float distance = glm::max(glm::distance(glm::vec3(GetWorldTransfom()[3]), e.Camera->GetTranslation()), radius);
+		getM2().getMaterials().RequestTexturesSize(this, radius / distance * e.Camera->GetProjectionMatrix()[1][1], e.TotalTime);
+	}
 }
 
 void CM2_Base_Instance::Accept(IVisitor* visitor)
@@ -140,20 +175,47 @@ glm::mat4 CM2_Base_Instance::CalculateLocalTransform() const
 
 			uint16 boneIndex = parentM2Instance->getM2().getMiscellaneous().getAttachment(m_AttachmentType).GetBoneIndex();
 
+			// Attachment bone must be calculated even if parent culls bones of hidden geosets
+			SetPinnedBone(parentM2Instance->getSkeletonComponent(), boneIndex);
+
 			const auto& bone = parentM2Instance->getSkeletonComponent()->GetBone(boneIndex);
 			glm::mat4 relMatrix = glm::translate(bone->GetPivotPoint());
 
 			return bone->GetMatrix() * relMatrix;
 		}
 
+		SetPinnedBone(nullptr, -1);
 		return __super::CalculateLocalTransform();
 	}
 	else
 	{
+		SetPinnedBone(nullptr, -1);
 		return __super::CalculateLocalTransform();
 	}
 }
 
+
+
+//
+// Private
+//
+void CM2_Base_Instance::SetPinnedBone(const std::shared_ptr<CM2SkeletonComponent3D>& Skeleton, int32 BoneIndex) const
+{
+	std::shared_ptr<CM2SkeletonComponent3D> pinnedSkeleton = m_PinnedSkeleton.lock();
+	if (pinnedSkeleton == Skeleton && m_PinnedBoneIndex == BoneIndex)
+		return;
+
+	// Attachment or parent was changed, release previous bone
+	if (pinnedSkeleton != nullptr && m_PinnedBoneIndex != -1)
+		pinnedSkeleton->UnpinBone(m_PinnedBoneIndex);
+
+	m_PinnedSkeleton = Skeleton;
+	m_PinnedBoneIndex = BoneIndex;
+
+	if (Skeleton != nullptr && BoneIndex != -1)
+		Skeleton->PinBone(BoneIndex);
+}
+
 void CM2_Base_Instance::RegisterComponents()
 {
 	m_Components_Models = AddComponent(std::make_shared<CModelsComponent3D>(*this));
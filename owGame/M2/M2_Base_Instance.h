@@ -35,14 +35,19 @@ public:
 
 	// Mesh & textures provider
 	virtual bool                        isMeshEnabled(uint32 _index) const;
+	virtual uint64                      getMeshesSignature() const { return 0; } // Instances with equal signatures have equal 'isMeshEnabled' results
 	void                                setSpecialTexture(SM2_Texture::Type _type, const std::shared_ptr<ITexture>& _texture);
 	const std::shared_ptr<ITexture>&    getSpecialTexture(SM2_Texture::Type _type) const;
+	uint64                              getSpecialTexturesSignature() const; // Instances with equal signatures have equal special textures
 
 	// Animations
 	const std::shared_ptr<CM2_Animator>&           getAnimator() const { return m_Animator; }
 	const std::shared_ptr<CM2SkeletonComponent3D>  getSkeletonComponent() const { return m_SkeletonComponent; }
 	const std::shared_ptr<CM2ParticlesComponent3D>   getParticleComponent() const { return m_ParticleComponent; }
 
+	// Skin LOD (render passes draw this skin instead of registered skin 0)
+	const CM2_Skin*                     getActiveSkin(const CM2_Skin* RegisteredSkin) const;
+
     // Components
     virtual void                        RegisterComponents() override;
 
@@ -54,9 +59,14 @@ public:
 protected:
 	virtual glm::mat4                   CalculateLocalTransform() const override;
 
+private:
+	void                                SetPinnedBone(const std::shared_ptr<CM2SkeletonComponent3D>& Skeleton, int32 BoneIndex) const;
+
 private:
 	// This M2Instance attached to parent
 	M2_AttachmentType                   m_AttachmentType;
+	mutable std::weak_ptr<CM2SkeletonComponent3D> m_PinnedSkeleton; // Parent skeleton, that calculates attachment bone for this instance
+	mutable int32                       m_PinnedBoneIndex;
 
 	// Color & Alpha
 	glm::vec4                           m_Color;
@@ -70,6 +80,9 @@ private:
 	std::shared_ptr<CM2SkeletonComponent3D> m_SkeletonComponent;
 	std::shared_ptr<CM2ParticlesComponent3D>m_ParticleComponent;
 
+	// Skin LOD
+	std::shared_ptr<CM2_Skin>               m_ActiveSkin;
+
 private:
 	std::shared_ptr<const CM2>           m_M2;
 };
\ No newline at end of file
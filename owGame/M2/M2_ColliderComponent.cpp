@@ -15,7 +15,34 @@ CM2_ColliderComponent::~CM2_ColliderComponent()
 {
 }
 
-const CM2_Base_Instance& CM2_ColliderComponent::GetOwnerNode()
+bool CM2_ColliderComponent::RayCast(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SM2_CollisionHit* Hit) const
+{
+    const CM2_CollisionBVH* collision = GetOwnerNode().getM2().GetCollision();
+    if (collision == nullptr)
+        return false;
+
+    return collision->RayCast(GetOwnerNode().GetWorldTransfom(), Origin, Direction, MaxDistance, Hit);
+}
+
+bool CM2_ColliderComponent::SphereSweep(const glm::vec3& Origin, const glm::vec3& Direction, float Radius, float MaxDistance, SM2_CollisionHit* Hit) const
+{
+    const CM2_CollisionBVH* collision = GetOwnerNode().getM2().GetCollision();
+    if (collision == nullptr)
+        return false;
+
+    return collision->SphereSweep(GetOwnerNode().GetWorldTransfom(), Origin, Direction, Radius, MaxDistance, Hit);
+}
+
+bool CM2_ColliderComponent::IsPointInside(const glm::vec3& Point) const
+{
+    const CM2_CollisionBVH* collision = GetOwnerNode().getM2().GetCollision();
+    if (collision == nullptr)
+        return false;
+
+    return collision->IsPointInside(GetOwnerNode().GetWorldTransfom(), Point);
+}
+
+const CM2_Base_Instance& CM2_ColliderComponent::GetOwnerNode() const
 {
     return reinterpret_cast<const CM2_Base_Instance&>(__super::GetOwnerNode());
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "M2_CollisionBVH.h"
+
 // FORWARD BEGIN
 class CM2_Base_Instance;
 // FORWARD END
@@ -12,8 +14,13 @@ public:
     CM2_ColliderComponent(const ISceneNode3D& OwnerNode);
     virtual ~CM2_ColliderComponent();
 
+    // World space queries against model collision mesh. Direction must be normalized.
+    bool RayCast(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SM2_CollisionHit* Hit = nullptr) const;
+    bool SphereSweep(const glm::vec3& Origin, const glm::vec3& Direction, float Radius, float MaxDistance, SM2_CollisionHit* Hit = nullptr) const;
+    bool IsPointInside(const glm::vec3& Point) const;
+
 protected:
-    const CM2_Base_Instance& GetOwnerNode();
+    const CM2_Base_Instance& GetOwnerNode() const;
 
     // CColliderComponent
     virtual void UpdateBounds() override;
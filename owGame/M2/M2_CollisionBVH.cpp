@@ -0,0 +1,436 @@
+#include "stdafx.h"
+
+// General
+#include "M2_CollisionBVH.h"
+
+// Additional
+#include "WowCollisionMath.h"
+
+namespace
+{
+	const uint32 cMaxTrianglesInLeaf = 4;
+	const uint32 cMaxTraverseDepth = 64;
+	const float  cEpsilon = 1e-8f;
+
+	inline bool IsPointInTriangle(const glm::vec3& Point, const glm::vec3& V0, const glm::vec3& V1, const glm::vec3& V2, const glm::vec3& Normal)
+	{
+		float c0 = glm::dot(glm::cross(V1 - V0, Point - V0), Normal);
+		float c1 = glm::dot(glm::cross(V2 - V1, Point - V1), Normal);
+		float c2 = glm::dot(glm::cross(V0 - V2, Point - V2), Normal);
+		return (c0 >= 0.0f && c1 >= 0.0f && c2 >= 0.0f) || (c0 <= 0.0f && c1 <= 0.0f && c2 <= 0.0f);
+	}
+
+	inline glm::vec3 ClosestPointOnSegment(const glm::vec3& Point, const glm::vec3& A, const glm::vec3& B)
+	{
+		glm::vec3 ab = B - A;
+		float abab = glm::dot(ab, ab);
+		if (abab < cEpsilon)
+			return A;
+		return A + ab * glm::clamp(glm::dot(Point - A, ab) / abab, 0.0f, 1.0f);
+	}
+
+	// Returns entry distance or negative value if capsule is missed
+	float IntersectCapsule(const glm::vec3& Origin, const glm::vec3& Direction, const glm::vec3& A, const glm::vec3& B, float Radius)
+	{
+		glm::vec3 ba = B - A;
+		glm::vec3 oa = Origin - A;
+		float baba = glm::dot(ba, ba);
+		float bard = glm::dot(ba, Direction);
+		float baoa = glm::dot(ba, oa);
+		float rdoa = glm::dot(Direction, oa);
+		float oaoa = glm::dot(oa, oa);
+
+		// Cylinder
+		float a = baba - bard * bard;
+		if (a > cEpsilon)
+		{
+			float b = baba * rdoa - baoa * bard;
+			float c = baba * oaoa - baoa * baoa - Radius * Radius * baba;
+			float h = b * b - a * c;
+			if (h < 0.0f)
+				return -1.0f;
+
+			float t = (-b - glm::sqrt(h)) / a;
+			float y = baoa + t * bard;
+			if (y > 0.0f && y < baba)
+				return t;
+		}
+
+		// Caps (vertexes spheres)
+		float nearest = -1.0f;
+		for (const glm::vec3* center : { &A, &B })
+		{
+			glm::vec3 oc = Origin - *center;
+			float b = glm::dot(Direction, oc);
+			float c = glm::dot(oc, oc) - Radius * Radius;
+			float h = b * b - c;
+			if (h < 0.0f)
+				continue;
+
+			float t = -b - glm::sqrt(h);
+			if (t >= 0.0f && (nearest < 0.0f || t < nearest))
+				nearest = t;
+		}
+		return nearest;
+	}
+
+	bool SweepSphereTriangle(const glm::vec3& Origin, const glm::vec3& Direction, float Radius, const glm::vec3& V0, const glm::vec3& V1, const glm::vec3& V2, float& Distance, glm::vec3& Point, glm::vec3& Normal)
+	{
+		glm::vec3 normal = glm::cross(V1 - V0, V2 - V0);
+		float length = glm::length(normal);
+		if (length < cEpsilon)
+			return false;
+		normal /= length;
+
+		float planeDistance = glm::dot(Origin - V0, normal);
+		if (planeDistance < 0.0f)
+		{
+			normal = -normal;
+			planeDistance = -planeDistance;
+		}
+
+		// Face. Contact inside triangle is the first contact with whole triangle.
+		if (planeDistance <= Radius)
+		{
+			glm::vec3 projection = Origin - normal * planeDistance;
+			if (IsPointInTriangle(projection, V0, V1, V2, normal))
+			{
+				Distance = 0.0f;
+				Point = projection;
+				Normal = normal;
+				return true;
+			}
+		}
+		else
+		{
+			float denom = glm::dot(Direction, normal);
+			if (denom < 0.0f)
+			{
+				float t = (planeDistance - Radius) / -denom;
+				glm::vec3 contact = Origin + Direction * t - normal * Radius;
+				if (IsPointInTriangle(contact, V0, V1, V2, normal))
+				{
+					Distance = t;
+					Point = contact;
+					Normal = normal;
+					return true;
+				}
+			}
+		}
+
+		// Edges and vertexes
+		float bestDistance = FLT_MAX;
+		const glm::vec3* edges[3][2] = { { &V0, &V1 }, { &V1, &V2 }, { &V2, &V0 } };
+		for (const auto& edge : edges)
+		{
+			float t = 0.0f;
+			glm::vec3 closest = ClosestPointOnSegment(Origin, *edge[0], *edge[1]);
+			if (glm::distance(closest, Origin) > Radius)
+			{
+				t = IntersectCapsule(Origin, Direction, *edge[0], *edge[1], Radius);
+				if (t < 0.0f)
+					continue;
+			}
+
+			if (t < bestDistance)
+			{
+				glm::vec3 center = Origin + Direction * t;
+				bestDistance = t;
+				Point = ClosestPointOnSegment(center, *edge[0], *edge[1]);
+				Normal = (glm::distance(center, Point) > cEpsilon) ? glm::normalize(center - Point) : normal;
+			}
+		}
+
+		if (bestDistance == FLT_MAX)
+			return false;
+
+		Distance = bestDistance;
+		return true;
+	}
+
+	// Query in model space of instance
+	struct SLocalQuery
+	{
+		SLocalQuery(const glm::mat4& Transform, const glm::vec3& WorldOrigin, const glm::vec3& WorldDirection)
+		{
+			glm::mat4 inverseTransform = glm::inverse(Transform);
+			Origin = glm::vec3(inverseTransform * glm::vec4(WorldOrigin, 1.0f));
+
+			glm::vec3 direction = glm::mat3(inverseTransform) * WorldDirection;
+			Scale = glm::length(direction);
+			Direction = direction / Scale;
+			NormalMatrix = glm::transpose(glm::mat3(inverseTransform));
+		}
+
+		void ToWorld(const glm::mat4& Transform, SM2_CollisionHit* Hit) const
+		{
+			Hit->Distance /= Scale;
+			Hit->Point = glm::vec3(Transform * glm::vec4(Hit->Point, 1.0f));
+			Hit->Normal = glm::normalize(NormalMatrix * Hit->Normal);
+		}
+
+		glm::vec3 Origin;
+		glm::vec3 Direction;
+		float     Scale; // Model units in one world unit
+		glm::mat3 NormalMatrix;
+	};
+}
+
+CM2_CollisionBVH::CM2_CollisionBVH(const std::vector<glm::vec3>& Vertices, const std::vector<uint16>& Indexes)
+	: m_Vertices(Vertices)
+	, m_Indexes(Indexes)
+{
+	uint32 trianglesCount = static_cast<uint32>(m_Indexes.size() / 3);
+	if (trianglesCount == 0)
+		return;
+
+	std::vector<glm::vec3> centroids(trianglesCount);
+	m_Triangles.resize(trianglesCount);
+	for (uint32 i = 0; i < trianglesCount; i++)
+	{
+		glm::vec3 v0, v1, v2;
+		GetTriangle(i, v0, v1, v2);
+
+		m_Triangles[i] = i;
+		centroids[i] = (v0 + v1 + v2) / 3.0f;
+	}
+
+	m_Nodes.reserve(trianglesCount * 2);
+	Build(0, trianglesCount, centroids);
+	m_Nodes.shrink_to_fit();
+}
+
+CM2_CollisionBVH::~CM2_CollisionBVH()
+{
+}
+
+bool CM2_CollisionBVH::RayCast(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SM2_CollisionHit* Hit) const
+{
+	float bestDistance = MaxDistance;
+	uint32 bestTriangle = UINT32_MAX;
+
+	Traverse(Origin, Direction, 0.0f, bestDistance, [&](uint32 Triangle) {
+		glm::vec3 v0, v1, v2;
+		GetTriangle(Triangle, v0, v1, v2);
+
+		float distance;
+		if (IntersectRayTriangle(Origin, Direction, v0, v1, v2, distance) && distance < bestDistance)
+		{
+			bestDistance = distance;
+			bestTriangle = Triangle;
+		}
+	});
+
+	if (bestTriangle == UINT32_MAX)
+		return false;
+
+	if (Hit != nullptr)
+	{
+		glm::vec3 v0, v1, v2;
+		GetTriangle(bestTriangle, v0, v1, v2);
+
+		glm::vec3 normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
+		Hit->Distance = bestDistance;
+		Hit->Point = Origin + Direction * bestDistance;
+		Hit->Normal = (glm::dot(normal, Direction) > 0.0f) ? -normal : normal;
+		Hit->TriangleIndex = bestTriangle;
+	}
+
+	return true;
+}
+
+bool CM2_CollisionBVH::SphereSweep(const glm::vec3& Origin, const glm::vec3& Direction, float Radius, float MaxDistance, SM2_CollisionHit* Hit) const
+{
+	SM2_CollisionHit bestHit;
+	bestHit.Distance = MaxDistance;
+
+	Traverse(Origin, Direction, Radius, bestHit.Distance, [&](uint32 Triangle) {
+		glm::vec3 v0, v1, v2;
+		GetTriangle(Triangle, v0, v1, v2);
+
+		float distance;
+		glm::vec3 point, normal;
+		if (SweepSphereTriangle(Origin, Direction, Radius, v0, v1, v2, distance, point, normal) && distance < bestHit.Distance)
+		{
+			bestHit.Distance = distance;
+			bestHit.Point = point;
+			bestHit.Normal = normal;
+			bestHit.TriangleIndex = Triangle;
+		}
+	});
+
+	if (bestHit.TriangleIndex == UINT32_MAX)
+		return false;
+
+	if (Hit != nullptr)
+		*Hit = bestHit;
+
+	return true;
+}
+
+bool CM2_CollisionBVH::IsPointInside(const glm::vec3& Point) const
+{
+	if (IsEmpty())
+		return false;
+
+	const SNode& root = m_Nodes.front();
+	if (glm::any(glm::lessThan(Point, root.Min)) || glm::any(glm::greaterThan(Point, root.Max)))
+		return false;
+
+	// Parity of crossings of vertical ray
+	const glm::vec3 direction(0.0f, 1.0f, 0.0f);
+	const float maxDistance = FLT_MAX;
+
+	uint32 crossings = 0;
+	Traverse(Point, direction, 0.0f, maxDistance, [&](uint32 Triangle) {
+		glm::vec3 v0, v1, v2;
+		GetTriangle(Triangle, v0, v1, v2);
+
+		float distance;
+		if (IntersectRayTriangle(Point, direction, v0, v1, v2, distance))
+			crossings++;
+	});
+
+	return (crossings & 1u) != 0;
+}
+
+bool CM2_CollisionBVH::RayCast(const glm::mat4& Transform, const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SM2_CollisionHit* Hit) const
+{
+	SLocalQuery query(Transform, Origin, Direction);
+	if (false == RayCast(query.Origin, query.Direction, MaxDistance * query.Scale, Hit))
+		return false;
+
+	if (Hit != nullptr)
+		query.ToWorld(Transform, Hit);
+
+	return true;
+}
+
+bool CM2_CollisionBVH::SphereSweep(const glm::mat4& Transform, const glm::vec3& Origin, const glm::vec3& Direction, float Radius, float MaxDistance, SM2_CollisionHit* Hit) const
+{
+	SLocalQuery query(Transform, Origin, Direction);
+	if (false == SphereSweep(query.Origin, query.Direction, Radius * query.Scale, MaxDistance * query.Scale, Hit))
+		return false;
+
+	if (Hit != nullptr)
+		query.ToWorld(Transform, Hit);
+
+	return true;
+}
+
+bool CM2_CollisionBVH::IsPointInside(const glm::mat4& Transform, const glm::vec3& Point) const
+{
+	return IsPointInside(glm::vec3(glm::inverse(Transform) * glm::vec4(Point, 1.0f)));
+}
+
+
+
+//
+// Private
+//
+uint32 CM2_CollisionBVH::Build(uint32 First, uint32 Count, std::vector<glm::vec3>& Centroids)
+{
+	uint32 nodeIndex = static_cast<uint32>(m_Nodes.size());
+	m_Nodes.push_back(SNode());
+
+	glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+	glm::vec3 centroidsMin(FLT_MAX), centroidsMax(-FLT_MAX);
+	for (uint32 i = First; i < First + Count; i++)
+	{
+		glm::vec3 v0, v1, v2;
+		GetTriangle(m_Triangles[i], v0, v1, v2);
+
+		min = glm::min(min, glm::min(v0, glm::min(v1, v2)));
+		max = glm::max(max, glm::max(v0, glm::max(v1, v2)));
+		centroidsMin = glm::min(centroidsMin, Centroids[m_Triangles[i]]);
+		centroidsMax = glm::max(centroidsMax, Centroids[m_Triangles[i]]);
+	}
+
+	m_Nodes[nodeIndex].Min = min;
+	m_Nodes[nodeIndex].Max = max;
+
+	// Split by median of centroids on longest axis
+	glm::vec3 extent = centroidsMax - centroidsMin;
+	int axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) : ((extent.y > extent.z) ? 1 : 2);
+	if (Count <= cMaxTrianglesInLeaf || extent[axis] <= 0.0f)
+	{
+		m_Nodes[nodeIndex].Index = First;
+		m_Nodes[nodeIndex].Count = Count;
+		return nodeIndex;
+	}
+
+	uint32 middle = First + Count / 2;
+	std::nth_element(m_Triangles.begin() + First, m_Triangles.begin() + middle, m_Triangles.begin() + First + Count, [&Centroids, axis](uint32 Left, uint32 Right) {
+		return Centroids[Left][axis] < Centroids[Right][axis];
+	});
+
+	Build(First, middle - First, Centroids);
+	uint32 rightIndex = Build(middle, First + Count - middle, Centroids);
+
+	m_Nodes[nodeIndex].Index = rightIndex;
+	m_Nodes[nodeIndex].Count = 0;
+	return nodeIndex;
+}
+
+template <typename TriangleTest>
+void CM2_CollisionBVH::Traverse(const glm::vec3& Origin, const glm::vec3& Direction, float Expand, const float& MaxDistance, TriangleTest Test) const
+{
+	if (IsEmpty())
+		return;
+
+	const glm::vec3 invDirection = 1.0f / Direction;
+	const glm::vec3 expand(Expand);
+
+	struct SStackItem
+	{
+		uint32 Node;
+		float  Distance;
+	} stack[cMaxTraverseDepth];
+	uint32 stackSize = 0;
+
+	float rootDistance = IntersectRayBox(m_Nodes[0].Min - expand, m_Nodes[0].Max + expand, Origin, invDirection, MaxDistance);
+	if (rootDistance == FLT_MAX)
+		return;
+	stack[stackSize++] = { 0, rootDistance };
+
+	while (stackSize > 0)
+	{
+		SStackItem item = stack[--stackSize];
+		if (item.Distance > MaxDistance) // Closer hit was found
+			continue;
+
+		const SNode& node = m_Nodes[item.Node];
+		if (node.Count > 0)
+		{
+			for (uint32 i = node.Index; i < node.Index + node.Count; i++)
+				Test(m_Triangles[i]);
+			continue;
+		}
+
+		uint32 left = item.Node + 1;
+		uint32 right = node.Index;
+		float leftDistance = IntersectRayBox(m_Nodes[left].Min - expand, m_Nodes[left].Max + expand, Origin, invDirection, MaxDistance);
+		float rightDistance = IntersectRayBox(m_Nodes[right].Min - expand, m_Nodes[right].Max + expand, Origin, invDirection, MaxDistance);
+
+		// Nearer child is visited first
+		if (leftDistance > rightDistance)
+		{
+			std::swap(left, right);
+			std::swap(leftDistance, rightDistance);
+		}
+
+		_ASSERT(stackSize + 2 <= cMaxTraverseDepth);
+		if (rightDistance != FLT_MAX)
+			stack[stackSize++] = { right, rightDistance };
+		if (leftDistance != FLT_MAX)
+			stack[stackSize++] = { left, leftDistance };
+	}
+}
+
+void CM2_CollisionBVH::GetTriangle(uint32 Triangle, glm::vec3& V0, glm::vec3& V1, glm::vec3& V2) const
+{
+	_ASSERT(Triangle * 3 + 2 < m_Indexes.size());
+	V0 = m_Vertices[m_Indexes[Triangle * 3 + 0]];
+	V1 = m_Vertices[m_Indexes[Triangle * 3 + 1]];
+	V2 = m_Vertices[m_Indexes[Triangle * 3 + 2]];
+}
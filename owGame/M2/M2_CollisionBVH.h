@@ -0,0 +1,68 @@
+#pragma once
+
+//
+// Result of collision query
+//
+struct ZN_API SM2_CollisionHit
+{
+	SM2_CollisionHit()
+		: Distance(FLT_MAX)
+		, Point(0.0f)
+		, Normal(0.0f)
+		, TriangleIndex(UINT32_MAX)
+	{}
+
+	float     Distance;      // Along query direction, in query space units
+	glm::vec3 Point;         // Contact point
+	glm::vec3 Normal;        // Surface normal in contact point, faces query origin
+	uint32    TriangleIndex; // Index of triangle in model collision triangles
+};
+
+/**
+  * Bounding volume hierarchy over M2 collision mesh ('collisionVertices' and 'collisionTriangles').
+  * Built once per model and shared by all instances. Model-space queries work directly with tree,
+  * instance queries transform ray to model space with instance world transform (uniform scale is expected for sphere sweep).
+*/
+class ZN_API CM2_CollisionBVH
+{
+public:
+	CM2_CollisionBVH(const std::vector<glm::vec3>& Vertices, const std::vector<uint16>& Indexes);
+	virtual ~CM2_CollisionBVH();
+
+	bool IsEmpty() const { return m_Nodes.empty(); }
+	uint32 GetTrianglesCount() const { return static_cast<uint32>(m_Triangles.size()); }
+	uint32 GetNodesCount() const { return static_cast<uint32>(m_Nodes.size()); }
+
+	// Model space. Direction must be normalized.
+	bool RayCast(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SM2_CollisionHit* Hit) const;
+	bool SphereSweep(const glm::vec3& Origin, const glm::vec3& Direction, float Radius, float MaxDistance, SM2_CollisionHit* Hit) const;
+	bool IsPointInside(const glm::vec3& Point) const;
+
+	// World space (instance transform)
+	bool RayCast(const glm::mat4& Transform, const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SM2_CollisionHit* Hit) const;
+	bool SphereSweep(const glm::mat4& Transform, const glm::vec3& Origin, const glm::vec3& Direction, float Radius, float MaxDistance, SM2_CollisionHit* Hit) const;
+	bool IsPointInside(const glm::mat4& Transform, const glm::vec3& Point) const;
+
+private:
+	// 32 bytes. Inner node: 'Count' is zero, left child is next node, 'Index' is right child. Leaf: 'Index' is first triangle.
+	struct SNode
+	{
+		glm::vec3 Min;
+		uint32    Index;
+		glm::vec3 Max;
+		uint32    Count;
+	};
+
+	uint32 Build(uint32 First, uint32 Count, std::vector<glm::vec3>& Centroids);
+
+	template <typename TriangleTest>
+	void Traverse(const glm::vec3& Origin, const glm::vec3& Direction, float Expand, const float& MaxDistance, TriangleTest Test) const;
+
+	void GetTriangle(uint32 Triangle, glm::vec3& V0, glm::vec3& V1, glm::vec3& V2) const;
+
+private:
+	std::vector<SNode>     m_Nodes;
+	std::vector<uint32>    m_Triangles; // Model triangles indexes in leafs order
+	std::vector<glm::vec3> m_Vertices;
+	std::vector<uint16>    m_Indexes;
+};
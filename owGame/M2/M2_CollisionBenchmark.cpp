@@ -0,0 +1,117 @@
+#include "stdafx.h"
+
+// Include
+#include "M2_Base_Instance.h"
+
+// General
+#include "M2_CollisionBenchmark.h"
+
+// Additional
+#include "WowCollisionMath.h"
+#include <chrono>
+#include <random>
+
+namespace
+{
+	struct SInstanceBounds
+	{
+		const CM2_Base_Instance* Instance;
+		const CM2_CollisionBVH*  Collision;
+		glm::vec3                Min;
+		glm::vec3                Max;
+	};
+
+}
+
+SM2_CollisionBenchmarkResult M2CollisionBenchmark(const std::vector<const CM2_Base_Instance*>& Instances, uint32 RaysCount, uint32 Seed)
+{
+	SM2_CollisionBenchmarkResult result;
+	result.Instances = static_cast<uint32>(Instances.size());
+
+	// Area of all instances
+	std::vector<SInstanceBounds> instancesBounds;
+	glm::vec3 areaMin(FLT_MAX), areaMax(-FLT_MAX);
+	for (const auto& instance : Instances)
+	{
+		if (instance == nullptr || instance->getM2().GetCollision() == nullptr)
+			continue;
+
+		BoundingBox bounds = instance->GetColliderComponent()->GetWorldBounds();
+
+		SInstanceBounds instanceBounds;
+		instanceBounds.Instance = instance;
+		instanceBounds.Collision = instance->getM2().GetCollision();
+		instanceBounds.Min = glm::min(bounds.getMin(), bounds.getMax());
+		instanceBounds.Max = glm::max(bounds.getMin(), bounds.getMax());
+		instancesBounds.push_back(instanceBounds);
+
+		areaMin = glm::min(areaMin, instanceBounds.Min);
+		areaMax = glm::max(areaMax, instanceBounds.Max);
+	}
+
+	result.InstancesWithCollision = static_cast<uint32>(instancesBounds.size());
+	if (instancesBounds.empty())
+		return result;
+
+	std::mt19937 random(Seed);
+	std::uniform_real_distribution<float> random01(0.0f, 1.0f);
+	auto randomInArea = [&]() -> glm::vec3 {
+		return areaMin + (areaMax - areaMin) * glm::vec3(random01(random), random01(random), random01(random));
+	};
+
+	// Rays are generated before timing
+	std::vector<std::pair<glm::vec3, glm::vec3>> rays(RaysCount);
+	for (uint32 i = 0; i < RaysCount; i++)
+	{
+		glm::vec3 origin = randomInArea();
+		glm::vec3 target = randomInArea();
+		if (i % 2 == 0) // Ground snapping
+		{
+			origin.y = areaMax.y;
+			target = glm::vec3(origin.x, areaMin.y, origin.z);
+		}
+		else // Camera and picking
+		{
+			target.y = origin.y;
+		}
+
+		glm::vec3 direction = target - origin;
+		if (glm::length(direction) < 0.001f)
+			direction = glm::vec3(0.0f, -1.0f, 0.0f);
+		rays[i] = std::make_pair(origin, glm::normalize(direction));
+	}
+
+	float maxDistance = glm::distance(areaMin, areaMax);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (const auto& ray : rays)
+	{
+		glm::vec3 invDirection = 1.0f / ray.second;
+
+		bool isHit = false;
+		SM2_CollisionHit nearestHit;
+		nearestHit.Distance = maxDistance;
+		for (const auto& instanceBounds : instancesBounds)
+		{
+			if (IntersectRayBox(instanceBounds.Min, instanceBounds.Max, ray.first, invDirection, nearestHit.Distance) == FLT_MAX)
+				continue;
+
+			result.BVHQueries++;
+
+			SM2_CollisionHit hit;
+			if (instanceBounds.Collision->RayCast(instanceBounds.Instance->GetWorldTransfom(), ray.first, ray.second, nearestHit.Distance, &hit))
+			{
+				nearestHit = hit;
+				isHit = true;
+			}
+		}
+
+		if (isHit)
+			result.Hits++;
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	result.Rays = RaysCount;
+	result.TotalTime = std::chrono::duration<double, std::milli>(end - start).count();
+	return result;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// FORWARD BEGIN
+class CM2_Base_Instance;
+// FORWARD END
+
+struct ZN_API SM2_CollisionBenchmarkResult
+{
+	SM2_CollisionBenchmarkResult()
+		: Instances(0)
+		, InstancesWithCollision(0)
+		, Rays(0)
+		, Hits(0)
+		, BVHQueries(0)
+		, TotalTime(0.0)
+	{}
+
+	uint32 Instances;
+	uint32 InstancesWithCollision;
+	uint32 Rays;
+	uint32 Hits;
+	uint32 BVHQueries; // Instances, that passed world bounds test
+	double TotalTime;  // ms
+};
+
+//
+// Headless benchmark: casts random rays (vertical and horizontal) through area of instances.
+// Broad phase is instance world bounds, narrow phase is model collision BVH. Nothing is rendered.
+//
+ZN_API SM2_CollisionBenchmarkResult M2CollisionBenchmark(const std::vector<const CM2_Base_Instance*>& Instances, uint32 RaysCount, uint32 Seed = 0);
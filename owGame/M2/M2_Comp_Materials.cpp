@@ -14,6 +14,12 @@ CM2_Comp_Materials::CM2_Comp_Materials(const CM2& M2Object)
 CM2_Comp_Materials::~CM2_Comp_Materials()
 {}
 
+void CM2_Comp_Materials::RequestTexturesSize(const CM2_Base_Instance* M2Instance, float ScreenSize, double Time) const
+{
+	for (const auto& texture : m_Textures)
+		texture->RequestSize(M2Instance, ScreenSize, Time);
+}
+
 
 void CM2_Comp_Materials::Load(const SM2_Header& M2Header, const std::shared_ptr<IFile>& File)
 {
@@ -13,6 +13,7 @@
 // FORWARD BEGIN
 class CM2;
 class CM2_Skin_Batch;
+class CM2_Base_Instance;
 // FORWARD END
 
 class CM2_Comp_Materials
@@ -25,6 +26,7 @@ public:
 	void Load(const SM2_Header& M2Header, const std::shared_ptr<IFile>& File);
 
 	bool IsAnimTextures() const { return m_IsAnimTextures; }
+	void RequestTexturesSize(const CM2_Base_Instance* M2Instance, float ScreenSize, double Time) const;
 
 public:
 	std::shared_ptr<const CM2_Part_Color> GetColorDirect(uint32 _index) const
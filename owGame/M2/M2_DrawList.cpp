@@ -0,0 +1,152 @@
+#include "stdafx.h"
+
+// General
+#include "M2_DrawList.h"
+
+// Additional
+#include "M2_Skin_Batch.h"
+
+CM2_DrawList::CM2_DrawList()
+{
+}
+
+CM2_DrawList::~CM2_DrawList()
+{
+}
+
+void CM2_DrawList::Clear()
+{
+	m_Items.clear();
+}
+
+void CM2_DrawList::Add(uint64 Key, uint32 SkinDrawIndex, CM2_SkinSection* Section, CM2_Skin_Batch* Batch)
+{
+	SItem item;
+	item.Key = Key;
+	item.SkinDrawIndex = SkinDrawIndex;
+	item.Section = Section;
+	item.Batch = Batch;
+	m_Items.push_back(item);
+}
+
+void CM2_DrawList::Add(const std::vector<SItem>& Items)
+{
+	m_Items.insert(m_Items.end(), Items.begin(), Items.end());
+}
+
+void CM2_DrawList::Sort()
+{
+	if (m_Items.size() < 2)
+		return;
+
+	m_SortBuffer.resize(m_Items.size());
+
+	// LSD radix sort by bytes of key. Bytes, that are equal for all items, are skipped.
+	for (uint32 shift = 0; shift < 64; shift += 8)
+	{
+		size_t counts[256] = { 0 };
+		for (const auto& item : m_Items)
+			counts[(item.Key >> shift) & 0xFF]++;
+
+		if (counts[(m_Items.front().Key >> shift) & 0xFF] == m_Items.size())
+			continue;
+
+		size_t offsets[256];
+		size_t offset = 0;
+		for (size_t i = 0; i < 256; i++)
+		{
+			offsets[i] = offset;
+			offset += counts[i];
+		}
+
+		for (const auto& item : m_Items)
+			m_SortBuffer[offsets[(item.Key >> shift) & 0xFF]++] = item;
+
+		m_Items.swap(m_SortBuffer);
+	}
+}
+
+void CM2_DrawList::Record(std::vector<SM2_DrawCommand>& Commands, SM2_DrawStatistics& Statistics) const
+{
+	Commands.clear();
+	Statistics = SM2_DrawStatistics();
+
+	uint32 boundSkinDrawIndex = UINT32_MAX;
+	const CM2_SkinSection* boundSection = nullptr;
+	const CM2_Skin_Batch* boundBatch = nullptr;
+	uint32 boundBatchSkinDrawIndex = UINT32_MAX; // Material props are taken from first instance of skin draw
+	const IBlendState* boundBlendState = nullptr;
+	const IDepthStencilState* boundDepthStencilState = nullptr;
+	const IRasterizerState* boundRasterizerState = nullptr;
+
+	auto addCommand = [&Commands](EM2_DrawCommandType Type, const SItem& Item) {
+		SM2_DrawCommand command;
+		command.Type = Type;
+		command.SkinDrawIndex = Item.SkinDrawIndex;
+		command.Section = Item.Section;
+		command.Batch = Item.Batch;
+		Commands.push_back(command);
+	};
+
+	for (const auto& item : m_Items)
+	{
+		if (item.SkinDrawIndex != boundSkinDrawIndex)
+		{
+			addCommand(EM2_DrawCommandType::InstancesRange, item);
+			boundSkinDrawIndex = item.SkinDrawIndex;
+			Statistics.InstancesRangeBinds++;
+		}
+		else
+			Statistics.SkippedBinds++;
+
+		if (item.Section != boundSection)
+		{
+			addCommand(EM2_DrawCommandType::Section, item);
+			boundSection = item.Section;
+			Statistics.SectionBinds++;
+		}
+		else
+			Statistics.SkippedBinds++;
+
+		const auto& m2Material = item.Batch->GetM2Material();
+		if (m2Material->GetBlendState().get() != boundBlendState)
+		{
+			addCommand(EM2_DrawCommandType::BlendState, item);
+			boundBlendState = m2Material->GetBlendState().get();
+			Statistics.StateBinds++;
+		}
+		else
+			Statistics.SkippedBinds++;
+
+		if (m2Material->GetDepthStencilState().get() != boundDepthStencilState)
+		{
+			addCommand(EM2_DrawCommandType::DepthStencilState, item);
+			boundDepthStencilState = m2Material->GetDepthStencilState().get();
+			Statistics.StateBinds++;
+		}
+		else
+			Statistics.SkippedBinds++;
+
+		if (m2Material->GetRasterizerState().get() != boundRasterizerState)
+		{
+			addCommand(EM2_DrawCommandType::RasterizerState, item);
+			boundRasterizerState = m2Material->GetRasterizerState().get();
+			Statistics.StateBinds++;
+		}
+		else
+			Statistics.SkippedBinds++;
+
+		if (item.Batch != boundBatch || item.SkinDrawIndex != boundBatchSkinDrawIndex)
+		{
+			addCommand(EM2_DrawCommandType::Material, item);
+			boundBatch = item.Batch;
+			boundBatchSkinDrawIndex = item.SkinDrawIndex;
+			Statistics.MaterialBinds++;
+		}
+		else
+			Statistics.SkippedBinds++;
+
+		addCommand(EM2_DrawCommandType::Draw, item);
+		Statistics.Draws++;
+	}
+}
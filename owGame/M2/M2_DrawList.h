@@ -0,0 +1,84 @@
+#pragma once
+
+// FORWARD BEGIN
+class CM2_SkinSection;
+class CM2_Skin_Batch;
+// FORWARD END
+
+//
+// Compact command of recorded M2 pass. Commands reference objects, that live at least until the end of the frame.
+//
+enum class EM2_DrawCommandType : uint8
+{
+	InstancesRange = 0,
+	Section,
+	BlendState,
+	DepthStencilState,
+	RasterizerState,
+	Material,
+	Draw
+};
+
+struct SM2_DrawCommand
+{
+	EM2_DrawCommandType Type;
+	uint32              SkinDrawIndex;
+	CM2_SkinSection*    Section;
+	CM2_Skin_Batch*     Batch;
+};
+
+//
+// State changes of one M2 pass frame
+//
+struct ZN_API SM2_DrawStatistics
+{
+	SM2_DrawStatistics()
+		: Draws(0)
+		, InstancesRangeBinds(0)
+		, SectionBinds(0)
+		, StateBinds(0)
+		, MaterialBinds(0)
+		, SkippedBinds(0)
+	{}
+
+	uint32 Draws;
+	uint32 InstancesRangeBinds;
+	uint32 SectionBinds;
+	uint32 StateBinds;
+	uint32 MaterialBinds;
+	uint32 SkippedBinds;
+};
+
+//
+// Visible M2 batches of one pass. Items are ordered by 64-bit render state keys with stable radix sort,
+// so items with equal keys keep order of adding (batches layers of one skin).
+//
+class ZN_API CM2_DrawList
+{
+public:
+	struct SItem
+	{
+		uint64           Key;
+		uint32           SkinDrawIndex;
+		CM2_SkinSection* Section;
+		CM2_Skin_Batch*  Batch;
+	};
+
+public:
+	CM2_DrawList();
+	virtual ~CM2_DrawList();
+
+	void Clear();
+	void Add(uint64 Key, uint32 SkinDrawIndex, CM2_SkinSection* Section, CM2_Skin_Batch* Batch);
+	void Add(const std::vector<SItem>& Items);
+	void Sort();
+
+	// Sorted items to commands. Binds of objects, that are already bound by previous command, are not recorded.
+	void Record(std::vector<SM2_DrawCommand>& Commands, SM2_DrawStatistics& Statistics) const;
+
+	const std::vector<SItem>& GetItems() const { return m_Items; }
+
+private:
+	std::vector<SItem> m_Items;
+	std::vector<SItem> m_SortBuffer;
+};
@@ -21,48 +21,57 @@ SM2_Part_Bone_Wrapper::~SM2_Part_Bone_Wrapper()
 {
 }
 
-glm::mat4 SM2_Part_Bone_Wrapper::calcMatrix(const CM2_Base_Instance* M2Instance, uint32 globalTime) const
+void SM2_Part_Bone_Wrapper::calcMatrices(const CM2_Base_Instance* M2Instance, uint32 globalTime, glm::mat4& Matrix, glm::mat4& RotateMatrix) const
 {
-	glm::mat4 m(1.0f);
-	if (const auto& animator = M2Instance->getAnimator())
-	{
-		if (IsInterpolated(animator->getSequenceIndex()))
-		{
-			m = glm::translate(m, getPivot());
+	Matrix = glm::mat4(1.0f);
+	RotateMatrix = glm::mat4(1.0f);
 
-			if (m_TranslateAnimated.IsUsesBySequence(animator->getSequenceIndex()))
-			{
-				m = glm::translate(m, m_TranslateAnimated.GetValue(animator->getSequenceIndex(), animator->getCurrentTime(), m_M2Object.getSkeleton().getGlobalLoops(), globalTime));
-			}
+	const auto& animator = M2Instance->getAnimator();
+	if (animator == nullptr)
+		return;
 
-			if (m_RotateAnimated.IsUsesBySequence(animator->getSequenceIndex()))
-			{
-				m *= glm::toMat4(m_RotateAnimated.GetValue(animator->getSequenceIndex(), animator->getCurrentTime(), m_M2Object.getSkeleton().getGlobalLoops(), globalTime));
-			}
+	glm::vec3 translate(0.0f);
+	glm::quat rotate(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3 scale(1.0f);
+	bool isAnimated = false;
 
-			if (m_ScaleAnimated.IsUsesBySequence(animator->getSequenceIndex()))
-			{
-				m = glm::scale(m, m_ScaleAnimated.GetValue(animator->getSequenceIndex(), animator->getCurrentTime(), m_M2Object.getSkeleton().getGlobalLoops(), globalTime));
-			}
-
-			m = glm::translate(m, getPivot() * -1.0f);
-		}
-	}
+	// Base layers: normalized weighted average. Sequence that don't animate this bone gives bind pose.
+	float accumulatedWeight = 0.0f;
+	for (const auto& layer : animator->GetBaseLayers())
+	{
+		if (layer.Weight <= 0.0f)
+			continue;
 
-	return m;
-}
+		glm::vec3 layerTranslate(0.0f);
+		glm::quat layerRotate(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::vec3 layerScale(1.0f);
+		isAnimated |= sampleSequence(layer.Animation->getSequenceIndex(), layer.CurrentTime, globalTime, layerTranslate, layerRotate, layerScale);
 
-glm::mat4 SM2_Part_Bone_Wrapper::calcRotationMatrix(const CM2_Base_Instance * M2Instance, uint32 globalTime) const
-{
-	if (const auto& animator = M2Instance->getAnimator())
-	{
-		if (m_RotateAnimated.IsUsesBySequence(animator->getSequenceIndex()))
+		accumulatedWeight += layer.Weight;
+		if (accumulatedWeight == layer.Weight)
 		{
-			return glm::toMat4(m_RotateAnimated.GetValue(animator->getSequenceIndex(), animator->getCurrentTime(), m_M2Object.getSkeleton().getGlobalLoops(), globalTime));
+			translate = layerTranslate;
+			rotate = layerRotate;
+			scale = layerScale;
+			continue;
 		}
+
+		float factor = layer.Weight / accumulatedWeight;
+		translate = glm::mix(translate, layerTranslate, factor);
+		rotate = glm::slerp(rotate, layerRotate, factor);
+		scale = glm::mix(scale, layerScale, factor);
 	}
 
-	return glm::mat4(1.0f);
+	if (false == isAnimated)
+		return;
+
+	RotateMatrix = glm::toMat4(rotate);
+
+	Matrix = glm::translate(Matrix, getPivot());
+	Matrix = glm::translate(Matrix, translate);
+	Matrix *= RotateMatrix;
+	Matrix = glm::scale(Matrix, scale);
+	Matrix = glm::translate(Matrix, getPivot() * -1.0f);
 }
 
 glm::mat4 SM2_Part_Bone_Wrapper::calcBillboardMatrix(const glm::mat4& CalculatedMatrix, const CM2_Base_Instance* M2Instance, const ICameraComponent3D* Camera) const
@@ -114,3 +123,27 @@ glm::mat4 SM2_Part_Bone_Wrapper::calcBillboardMatrix(const glm::mat4& Calculated
 
 	return m;
 }
+
+
+
+//
+// Private
+//
+bool SM2_Part_Bone_Wrapper::sampleSequence(uint16 Sequence, uint32 Time, uint32 globalTime, glm::vec3& Translate, glm::quat& Rotate, glm::vec3& Scale) const
+{
+	if (false == IsInterpolated(Sequence))
+		return false;
+
+	const auto& globalLoops = m_M2Object.getSkeleton().getGlobalLoops();
+
+	if (m_TranslateAnimated.IsUsesBySequence(Sequence))
+		Translate = m_TranslateAnimated.GetValue(Sequence, Time, globalLoops, globalTime);
+
+	if (m_RotateAnimated.IsUsesBySequence(Sequence))
+		Rotate = m_RotateAnimated.GetValue(Sequence, Time, globalLoops, globalTime);
+
+	if (m_ScaleAnimated.IsUsesBySequence(Sequence))
+		Scale = m_ScaleAnimated.GetValue(Sequence, Time, globalLoops, globalTime);
+
+	return true;
+}
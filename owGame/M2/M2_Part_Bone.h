@@ -87,8 +87,8 @@ public:
 	SM2_Part_Bone_Wrapper(const CM2& M2Object, const std::shared_ptr<IFile>& File, const SM2_Bone& M2Bone);
 	virtual ~SM2_Part_Bone_Wrapper();
 
-	glm::mat4 calcMatrix(const CM2_Base_Instance* M2Instance, uint32 globalTime) const;
-	glm::mat4 calcRotationMatrix(const CM2_Base_Instance* M2Instance, uint32 globalTime) const;
+	// Sample all animator layers once and build bone and rotation matrices in the single pass
+	void calcMatrices(const CM2_Base_Instance* M2Instance, uint32 globalTime, glm::mat4& Matrix, glm::mat4& RotateMatrix) const;
 	glm::mat4 calcBillboardMatrix(const glm::mat4& CalculatedMatrix, const CM2_Base_Instance* M2Instance, const ICameraComponent3D* Camera) const;
 
 	bool IsInterpolated(uint16 anim) const
@@ -112,6 +112,9 @@ public:
 	uint16                              getSubmeshID() const { return m_M2Bone.submesh_id; }
 	glm::vec3                           getPivot() const { return Fix_XZmY(m_M2Bone.pivot); }
 
+private:
+	bool sampleSequence(uint16 Sequence, uint32 Time, uint32 globalTime, glm::vec3& Translate, glm::quat& Rotate, glm::vec3& Scale) const;
+
 private:
 	M2_Animated<glm::vec3>              m_TranslateAnimated;
 #if WOW_CLIENT_VERSION == WOW_CLASSIC_1_12_1
@@ -30,11 +30,10 @@ CM2_Part_Material::CM2_Part_Material(IBaseManager& BaseManager, IRenderDevice& R
 
 	m_BlendState = BaseManager.GetManager<IWoWObjectsCreator>()->GetEGxBlend(M2Blend_To_EGxBlend[M2Material.BlendMode].EGxBLend);
 
-	m_DepthStencilState = RenderDevice.GetObjectsFactory().CreateDepthStencilState();
-	m_DepthStencilState->SetDepthMode(IDepthStencilState::DepthMode(M2Material.flags.DEPTHTEST == 0, (M2Material.flags.DEPTHWRITE == 0) ? IDepthStencilState::DepthWrite::Enable : IDepthStencilState::DepthWrite::Disable));
+	m_StatesID = ((M2Material.flags.DEPTHTEST == 0) ? 0x01 : 0x00) | ((M2Material.flags.DEPTHWRITE == 0) ? 0x02 : 0x00) | ((M2Material.flags.TWOSIDED != 0) ? 0x04 : 0x00);
 
-	m_RasterizerState = RenderDevice.GetObjectsFactory().CreateRasterizerState();
-	m_RasterizerState->SetCullMode((M2Material.flags.TWOSIDED != 0) ? IRasterizerState::CullMode::None : IRasterizerState::CullMode::Back);
+	m_DepthStencilState = BaseManager.GetManager<IWoWObjectsCreator>()->GetMaterialDepthStencilState(M2Material.flags.DEPTHTEST == 0, M2Material.flags.DEPTHWRITE == 0);
+	m_RasterizerState = BaseManager.GetManager<IWoWObjectsCreator>()->GetMaterialRasterizerState(M2Material.flags.TWOSIDED != 0);
 }
 
 CM2_Part_Material::~CM2_Part_Material()
@@ -9,6 +9,7 @@ public:
 	virtual ~CM2_Part_Material();
 
 	uint32 getBlendMode() const { return m_M2BlendMode; }
+	uint32 getStatesID() const { return m_StatesID; } // Depth test, depth write and two sided flags
 
 	const std::shared_ptr<IDepthStencilState>& GetDepthStencilState() const { return m_DepthStencilState; }
 	const std::shared_ptr<IBlendState>& GetBlendState() const { return m_BlendState; };
@@ -16,6 +17,7 @@ public:
 
 private:
 	uint32 m_M2BlendMode;
+	uint32 m_StatesID;
 
 	std::shared_ptr<IDepthStencilState> m_DepthStencilState;
 	std::shared_ptr<IBlendState> m_BlendState;
@@ -7,7 +7,8 @@
 #include "M2_Part_Texture.h"
 
 CM2_Part_Texture::CM2_Part_Texture(IBaseManager& BaseManager, IRenderDevice& RenderDevice, const CM2& M2Object, const std::shared_ptr<IFile>& File, const SM2_Texture& M2Texture)
-	: m_M2Object(M2Object)
+	: m_WoWObjectsCreator(BaseManager.GetManager<IWoWObjectsCreator>())
+	, m_M2Object(M2Object)
 {
 	m_WrapX = M2Texture.flags.WRAPX == 0;
 	m_WrapY = M2Texture.flags.WRAPY == 0;
@@ -18,7 +19,7 @@ CM2_Part_Texture::CM2_Part_Texture(IBaseManager& BaseManager, IRenderDevice& Ren
 	if (m_SpecialType == SM2_Texture::Type::NONE)
 	{
 		std::string textureFileName = (const char*)(File->getData() + M2Texture.filename.offset);
-		m_Texture = RenderDevice.GetObjectsFactory().LoadTexture2D(textureFileName);
+		m_Texture = m_WoWObjectsCreator->LoadStreamedTexture2D(RenderDevice, textureFileName);
 	}
 }
 
@@ -38,3 +39,10 @@ const std::shared_ptr<ITexture>& CM2_Part_Texture::GetTexture(const CM2_Base_Ins
 		return M2Instance->getSpecialTexture(m_SpecialType);
 	return m_Texture;
 }
+
+void CM2_Part_Texture::RequestSize(const CM2_Base_Instance* M2Instance, float ScreenSize, double Time) const
+{
+	const std::shared_ptr<ITexture>& texture = GetTexture(M2Instance);
+	if (texture != nullptr)
+		m_WoWObjectsCreator->RequestTextureSize(texture.get(), ScreenSize, Time);
+}
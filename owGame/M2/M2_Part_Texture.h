@@ -18,6 +18,9 @@ public:
 	const std::shared_ptr<ITexture>& GetTexture() const;
 	const std::shared_ptr<ITexture>& GetTexture(const CM2_Base_Instance* M2Instance) const;
 
+	// Streamed textures level (see 'IWoWObjectsCreator::RequestTextureSize')
+	void RequestSize(const CM2_Base_Instance* M2Instance, float ScreenSize, double Time) const;
+
 private:
 	bool                       m_WrapX;
 	bool                       m_WrapY;
@@ -26,5 +29,6 @@ private:
 	SM2_Texture::Type          m_SpecialType;
 
 private:
+	IWoWObjectsCreator* m_WoWObjectsCreator;
 	const CM2& m_M2Object;
 };
\ No newline at end of file
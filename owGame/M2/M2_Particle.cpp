@@ -0,0 +1,256 @@
+#include "stdafx.h"
+
+// General
+#include "M2_Particle.h"
+
+// Additional
+#include "M2_ParticlesFrameBuffer.h"
+#include <xmmintrin.h>
+#include <chrono>
+
+namespace
+{
+	inline __m128 LifeRamp4(__m128 IsFirstHalf, __m128 T1, __m128 T2, float A, float B, float C)
+	{
+		__m128 a = _mm_set1_ps(A);
+		__m128 b = _mm_set1_ps(B);
+		__m128 c = _mm_set1_ps(C);
+
+		__m128 first = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), T1));
+		__m128 second = _mm_add_ps(b, _mm_mul_ps(_mm_sub_ps(c, b), T2));
+		return _mm_or_ps(_mm_and_ps(IsFirstHalf, first), _mm_andnot_ps(IsFirstHalf, second));
+	}
+
+	inline size_t AlignTo4(size_t Value)
+	{
+		return (Value + 3) & ~static_cast<size_t>(3);
+	}
+}
+
+CM2_ParticlesPool::CM2_ParticlesPool(size_t Capacity)
+	: m_Count(0)
+	, m_Capacity(Capacity)
+{
+	const size_t alignedCapacity = AlignTo4(Capacity);
+
+	for (auto arr : { &m_PosX, &m_PosY, &m_PosZ, &m_SpeedX, &m_SpeedY, &m_SpeedZ, &m_DownX, &m_DownY, &m_DownZ, &m_DirX, &m_DirY, &m_DirZ, &m_OriginX, &m_OriginY, &m_OriginZ, &m_CurrentTime, &m_Size, &m_ColorR, &m_ColorG, &m_ColorB, &m_ColorA })
+		arr->resize(alignedCapacity, 0.0f);
+
+	// Not zero to avoid division by zero in the tail
+	m_MaxTime.resize(alignedCapacity, 1.0f);
+	m_Tile.resize(alignedCapacity, 0);
+}
+
+CM2_ParticlesPool::~CM2_ParticlesPool()
+{
+}
+
+void CM2_ParticlesPool::Add(const CM2_ParticleObject& Particle)
+{
+	_ASSERT(false == IsFull());
+	const size_t i = m_Count++;
+
+	m_PosX[i] = Particle.pos.x;       m_PosY[i] = Particle.pos.y;       m_PosZ[i] = Particle.pos.z;
+	m_SpeedX[i] = Particle.speed.x;   m_SpeedY[i] = Particle.speed.y;   m_SpeedZ[i] = Particle.speed.z;
+	m_DownX[i] = Particle.down.x;     m_DownY[i] = Particle.down.y;     m_DownZ[i] = Particle.down.z;
+	m_DirX[i] = Particle.dir.x;       m_DirY[i] = Particle.dir.y;       m_DirZ[i] = Particle.dir.z;
+	m_OriginX[i] = Particle.origin.x; m_OriginY[i] = Particle.origin.y; m_OriginZ[i] = Particle.origin.z;
+
+	m_CurrentTime[i] = Particle.currentTime;
+	m_MaxTime[i] = Particle.maxTime;
+	m_Size[i] = Particle.size;
+	m_ColorR[i] = Particle.color.r;   m_ColorG[i] = Particle.color.g;   m_ColorB[i] = Particle.color.b;   m_ColorA[i] = Particle.color.a;
+	m_Tile[i] = Particle.tile;
+}
+
+void CM2_ParticlesPool::Remove(size_t Index)
+{
+	_ASSERT(Index < m_Count);
+	const size_t last = --m_Count;
+	if (Index == last)
+		return;
+
+	for (auto arr : { &m_PosX, &m_PosY, &m_PosZ, &m_SpeedX, &m_SpeedY, &m_SpeedZ, &m_DownX, &m_DownY, &m_DownZ, &m_DirX, &m_DirY, &m_DirZ, &m_OriginX, &m_OriginY, &m_OriginZ, &m_CurrentTime, &m_MaxTime, &m_Size, &m_ColorR, &m_ColorG, &m_ColorB, &m_ColorA })
+		(*arr)[Index] = (*arr)[last];
+	m_Tile[Index] = m_Tile[last];
+}
+
+void CM2_ParticlesPool::Clear()
+{
+	m_Count = 0;
+}
+
+void CM2_ParticlesPool::Update(float DeltaTime, float Gravity, float Deaccel, float Slowdown, const SLifeRamp& LifeRamp)
+{
+	if (m_Count == 0)
+		return;
+
+	const size_t alignedCount = AlignTo4(m_Count);
+
+	const __m128 gravDt = _mm_set1_ps(Gravity * DeltaTime);
+	const __m128 deaccelDt = _mm_set1_ps(Deaccel * DeltaTime);
+	const __m128 dt = _mm_set1_ps(DeltaTime);
+	const __m128 middleTime = _mm_set1_ps(LifeRamp.MiddleTime);
+	const __m128 invMiddleTime = _mm_set1_ps(1.0f / LifeRamp.MiddleTime);
+	const __m128 invSecondHalf = _mm_set1_ps(1.0f / (1.0f - LifeRamp.MiddleTime));
+
+	for (size_t i = 0; i < alignedCount; i += 4)
+	{
+		// speed += down * gravity * dt - dir * deaccel * dt
+		__m128 speedX = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(&m_SpeedX[i]), _mm_mul_ps(_mm_loadu_ps(&m_DownX[i]), gravDt)), _mm_mul_ps(_mm_loadu_ps(&m_DirX[i]), deaccelDt));
+		__m128 speedY = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(&m_SpeedY[i]), _mm_mul_ps(_mm_loadu_ps(&m_DownY[i]), gravDt)), _mm_mul_ps(_mm_loadu_ps(&m_DirY[i]), deaccelDt));
+		__m128 speedZ = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(&m_SpeedZ[i]), _mm_mul_ps(_mm_loadu_ps(&m_DownZ[i]), gravDt)), _mm_mul_ps(_mm_loadu_ps(&m_DirZ[i]), deaccelDt));
+		_mm_storeu_ps(&m_SpeedX[i], speedX);
+		_mm_storeu_ps(&m_SpeedY[i], speedY);
+		_mm_storeu_ps(&m_SpeedZ[i], speedZ);
+
+		__m128 currentTime = _mm_loadu_ps(&m_CurrentTime[i]);
+
+		// pos += speed * slowdown * dt
+		__m128 moveDt = dt;
+		if (Slowdown > 0.0f)
+		{
+			__declspec(align(16)) float slowdown[4];
+			_mm_store_ps(slowdown, currentTime);
+			for (size_t j = 0; j < 4; j++)
+				slowdown[j] = glm::exp(-Slowdown * slowdown[j]);
+			moveDt = _mm_mul_ps(_mm_load_ps(slowdown), dt);
+		}
+
+		_mm_storeu_ps(&m_PosX[i], _mm_add_ps(_mm_loadu_ps(&m_PosX[i]), _mm_mul_ps(speedX, moveDt)));
+		_mm_storeu_ps(&m_PosY[i], _mm_add_ps(_mm_loadu_ps(&m_PosY[i]), _mm_mul_ps(speedY, moveDt)));
+		_mm_storeu_ps(&m_PosZ[i], _mm_add_ps(_mm_loadu_ps(&m_PosZ[i]), _mm_mul_ps(speedZ, moveDt)));
+
+		// Lifetime
+		currentTime = _mm_add_ps(currentTime, dt);
+		_mm_storeu_ps(&m_CurrentTime[i], currentTime);
+
+		__m128 rlife = _mm_div_ps(currentTime, _mm_loadu_ps(&m_MaxTime[i]));
+		__m128 isFirstHalf = _mm_cmple_ps(rlife, middleTime);
+		__m128 t1 = _mm_mul_ps(rlife, invMiddleTime);
+		__m128 t2 = _mm_mul_ps(_mm_sub_ps(rlife, middleTime), invSecondHalf);
+
+		_mm_storeu_ps(&m_Size[i], LifeRamp4(isFirstHalf, t1, t2, LifeRamp.Scales[0], LifeRamp.Scales[1], LifeRamp.Scales[2]));
+		_mm_storeu_ps(&m_ColorR[i], LifeRamp4(isFirstHalf, t1, t2, LifeRamp.Colors[0].r, LifeRamp.Colors[1].r, LifeRamp.Colors[2].r));
+		_mm_storeu_ps(&m_ColorG[i], LifeRamp4(isFirstHalf, t1, t2, LifeRamp.Colors[0].g, LifeRamp.Colors[1].g, LifeRamp.Colors[2].g));
+		_mm_storeu_ps(&m_ColorB[i], LifeRamp4(isFirstHalf, t1, t2, LifeRamp.Colors[0].b, LifeRamp.Colors[1].b, LifeRamp.Colors[2].b));
+		_mm_storeu_ps(&m_ColorA[i], LifeRamp4(isFirstHalf, t1, t2, LifeRamp.Colors[0].a, LifeRamp.Colors[1].a, LifeRamp.Colors[2].a));
+	}
+
+	// Kill off old particles. From the end, so swapped particle is already processed
+	for (size_t i = m_Count; i-- > 0; )
+	{
+		if (m_CurrentTime[i] >= m_MaxTime[i])
+			Remove(i);
+	}
+}
+
+void CM2_ParticlesPool::BuildBillboards(const glm::mat4& World, const glm::vec3& Right, const glm::vec3& Up, const std::vector<TexCoordSet>& Tiles, SM2_ParticleVertex* Vertices) const
+{
+	const size_t alignedCount = AlignTo4(m_Count);
+
+	// Corners: 0 = P - (R + U) * S, 1 = P + (R - U) * S, 2 = P + (R + U) * S, 3 = P - (R - U) * S
+	const glm::vec3 rightPlusUp = Right + Up;
+	const glm::vec3 rightMinusUp = Right - Up;
+	const __m128 cornerDirs[4][3] =
+	{
+		{ _mm_set1_ps(-rightPlusUp.x),  _mm_set1_ps(-rightPlusUp.y),  _mm_set1_ps(-rightPlusUp.z) },
+		{ _mm_set1_ps(rightMinusUp.x),  _mm_set1_ps(rightMinusUp.y),  _mm_set1_ps(rightMinusUp.z) },
+		{ _mm_set1_ps(rightPlusUp.x),   _mm_set1_ps(rightPlusUp.y),   _mm_set1_ps(rightPlusUp.z) },
+		{ _mm_set1_ps(-rightMinusUp.x), _mm_set1_ps(-rightMinusUp.y), _mm_set1_ps(-rightMinusUp.z) }
+	};
+
+	__m128 world[4][4];
+	for (size_t c = 0; c < 4; c++)
+		for (size_t r = 0; r < 4; r++)
+			world[c][r] = _mm_set1_ps(World[c][r]);
+
+	__declspec(align(16)) float corners[4][3][4];
+	for (size_t i = 0; i < alignedCount; i += 4)
+	{
+		__m128 posX = _mm_loadu_ps(&m_PosX[i]);
+		__m128 posY = _mm_loadu_ps(&m_PosY[i]);
+		__m128 posZ = _mm_loadu_ps(&m_PosZ[i]);
+		__m128 size = _mm_loadu_ps(&m_Size[i]);
+
+		// To world space
+		__m128 worldPos[3];
+		for (size_t r = 0; r < 3; r++)
+			worldPos[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(world[0][r], posX), _mm_mul_ps(world[1][r], posY)), _mm_add_ps(_mm_mul_ps(world[2][r], posZ), world[3][r]));
+
+		for (size_t corner = 0; corner < 4; corner++)
+			for (size_t r = 0; r < 3; r++)
+				_mm_store_ps(corners[corner][r], _mm_add_ps(worldPos[r], _mm_mul_ps(cornerDirs[corner][r], size)));
+
+		const size_t lanesCount = glm::min<size_t>(4, m_Count - i);
+		for (size_t lane = 0; lane < lanesCount; lane++)
+		{
+			const size_t index = i + lane;
+			const glm::vec4 color(m_ColorR[index], m_ColorG[index], m_ColorB[index], m_ColorA[index]);
+			_ASSERT(m_Tile[index] >= 0 && static_cast<size_t>(m_Tile[index]) < Tiles.size());
+			const TexCoordSet& tile = Tiles[m_Tile[index]];
+
+			static const size_t cQuadCorners[6] = { 0, 1, 2, 0, 2, 3 };
+
+			SM2_ParticleVertex* vertices = Vertices + index * 6;
+			for (size_t v = 0; v < 6; v++)
+			{
+				const size_t corner = cQuadCorners[v];
+				vertices[v].Position = glm::vec3(corners[corner][0][lane], corners[corner][1][lane], corners[corner][2][lane]);
+				vertices[v].Color = color;
+				vertices[v].TexCoord = tile.tc[corner];
+			}
+		}
+	}
+}
+
+void CM2_ParticlesPool::Benchmark(size_t EmittersCount, size_t FramesCount)
+{
+	const size_t cParticlesPerEmitter = 100;
+	const float cDeltaTime = 1.0f / 60.0f;
+
+	SLifeRamp lifeRamp;
+	lifeRamp.MiddleTime = 0.5f;
+	for (size_t i = 0; i < 3; i++)
+	{
+		lifeRamp.Scales[i] = 1.0f;
+		lifeRamp.Colors[i] = glm::vec4(1.0f);
+	}
+
+	Random random(0);
+	std::vector<CM2_ParticlesPool> emitters(EmittersCount, CM2_ParticlesPool(cParticlesPerEmitter));
+
+	auto respawn = [&random](CM2_ParticlesPool& Pool) {
+		while (false == Pool.IsFull())
+		{
+			CM2_ParticleObject p;
+			p.pos = p.origin = glm::vec3(random.Range(-1.0f, 1.0f), 0.0f, random.Range(-1.0f, 1.0f));
+			p.dir = glm::vec3(0.0f, 1.0f, 0.0f);
+			p.down = glm::vec3(0.0f, -1.0f, 0.0f);
+			p.speed = p.dir * random.Range(1.0f, 2.0f);
+			p.size = 1.0f;
+			p.color = glm::vec4(1.0f);
+			p.currentTime = 0.0f;
+			p.maxTime = random.Range(0.5f, 2.0f);
+			p.tile = 0;
+			Pool.Add(p);
+		}
+	};
+
+	size_t updatedParticles = 0;
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	for (size_t frame = 0; frame < FramesCount; frame++)
+	{
+		for (auto& emitter : emitters)
+		{
+			respawn(emitter);
+			updatedParticles += emitter.GetCount();
+			emitter.Update(cDeltaTime, 9.8f, 0.1f, 0.5f, lifeRamp);
+		}
+	}
+	const auto endTime = std::chrono::high_resolution_clock::now();
+
+	double totalMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	Log::Info("CM2_ParticlesPool: Benchmark: '%d' emitters, '%d' frames, '%d' particles updated. Total '%.3f' ms, '%.3f' ms per frame, '%.3f' ns per particle.",
+		static_cast<uint32>(EmittersCount), static_cast<uint32>(FramesCount), static_cast<uint32>(updatedParticles), totalMs, totalMs / FramesCount, (totalMs * 1000000.0) / updatedParticles);
+}
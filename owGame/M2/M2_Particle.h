@@ -1,12 +1,22 @@
 #pragma once
 
-struct CM2_ParticleObject
+// FORWARD BEGIN
+struct SM2_ParticleVertex;
+// FORWARD END
+
+//
+// Texture coords of particle tile corners
+//
+struct TexCoordSet 
 {
-	CM2_ParticleObject()
-		: Active(false)
-	{}
+	glm::vec2 tc[4];
+};
 
-	bool Active;
+//
+// Spawn parameters of one particle. Filled by emitter generators and packed into the pool.
+//
+struct CM2_ParticleObject
+{
 	glm::vec3 pos;
 	glm::vec3 speed;
 	glm::vec3 down;
@@ -18,3 +28,60 @@ struct CM2_ParticleObject
 	glm::vec4 color;
 	int tile;
 };
+
+//
+// Structure of arrays particles storage. Only first 'GetCount()' particles are alive,
+// dead particles are swap-removed, so update cost depends on alive particles only.
+//
+class ZN_API CM2_ParticlesPool
+{
+public:
+	struct SLifeRamp
+	{
+		float     MiddleTime;
+		float     Scales[3];
+		glm::vec4 Colors[3];
+	};
+
+public:
+	CM2_ParticlesPool(size_t Capacity);
+	virtual ~CM2_ParticlesPool();
+
+	size_t GetCount() const { return m_Count; }
+	size_t GetCapacity() const { return m_Capacity; }
+	bool IsFull() const { return m_Count == m_Capacity; }
+
+	void Add(const CM2_ParticleObject& Particle);
+	void Remove(size_t Index);
+	void Clear();
+
+	// Integrate speed and position, calculate size and color by lifetime (4 particles per step) and remove dead particles
+	void Update(float DeltaTime, float Gravity, float Deaccel, float Slowdown, const SLifeRamp& LifeRamp);
+
+	glm::vec3 GetPosition(size_t Index) const { return glm::vec3(m_PosX[Index], m_PosY[Index], m_PosZ[Index]); }
+	glm::vec3 GetOrigin(size_t Index) const { return glm::vec3(m_OriginX[Index], m_OriginY[Index], m_OriginZ[Index]); }
+	glm::vec4 GetColor(size_t Index) const { return glm::vec4(m_ColorR[Index], m_ColorG[Index], m_ColorB[Index], m_ColorA[Index]); }
+	float     GetSize(size_t Index) const { return m_Size[Index]; }
+	int       GetTile(size_t Index) const { return m_Tile[Index]; }
+
+	// Camera facing quads in world space, 6 vertices per particle
+	void BuildBillboards(const glm::mat4& World, const glm::vec3& Right, const glm::vec3& Up, const std::vector<TexCoordSet>& Tiles, SM2_ParticleVertex* Vertices) const;
+
+	// Stress test: 'EmittersCount' full pools updated during 'FramesCount' frames. Result is printed to log.
+	static void Benchmark(size_t EmittersCount, size_t FramesCount);
+
+private:
+	size_t m_Count;
+	size_t m_Capacity;
+
+	// Capacity is aligned to 4, tail is processed together with alive particles
+	std::vector<float> m_PosX, m_PosY, m_PosZ;
+	std::vector<float> m_SpeedX, m_SpeedY, m_SpeedZ;
+	std::vector<float> m_DownX, m_DownY, m_DownZ;
+	std::vector<float> m_DirX, m_DirY, m_DirZ;
+	std::vector<float> m_OriginX, m_OriginY, m_OriginZ;
+	std::vector<float> m_CurrentTime, m_MaxTime;
+	std::vector<float> m_Size;
+	std::vector<float> m_ColorR, m_ColorG, m_ColorB, m_ColorA;
+	std::vector<int>   m_Tile;
+};
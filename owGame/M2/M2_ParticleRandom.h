@@ -0,0 +1,63 @@
+#pragma once
+
+//
+// Small and fast PCG32 generator for particle emitters.
+// Each emitter has own stream, so the same seed gives the same effect (replays, tests).
+//
+class CM2_ParticleRandom
+{
+public:
+	CM2_ParticleRandom(uint64 Seed = 0, uint64 Stream = 0)
+	{
+		SetSeed(Seed, Stream);
+	}
+
+	void SetSeed(uint64 Seed, uint64 Stream)
+	{
+		m_State = 0u;
+		m_Increment = (Stream << 1u) | 1u;
+		NextUInt();
+		m_State += Seed;
+		NextUInt();
+	}
+
+	uint32 NextUInt()
+	{
+		uint64 oldState = m_State;
+		m_State = oldState * 6364136223846793005ULL + m_Increment;
+		uint32 xorShifted = static_cast<uint32>(((oldState >> 18u) ^ oldState) >> 27u);
+		uint32 rot = static_cast<uint32>(oldState >> 59u);
+		return (xorShifted >> rot) | (xorShifted << ((~rot + 1u) & 31u));
+	}
+
+	// [0.0; 1.0)
+	float NextFloat()
+	{
+		return static_cast<float>(NextUInt() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// [Min; Max)
+	float Range(float Min, float Max)
+	{
+		return Min + (Max - Min) * NextFloat();
+	}
+
+	// [Min; Max]
+	int Range(int Min, int Max)
+	{
+		if (Max <= Min)
+			return Min;
+		return Min + static_cast<int>(NextUInt() % static_cast<uint32>(Max - Min + 1));
+	}
+
+	void FillRange(float* Values, size_t Count, float Min, float Max)
+	{
+		const float range = (Max - Min) * (1.0f / 16777216.0f);
+		for (size_t i = 0; i < Count; i++)
+			Values[i] = Min + static_cast<float>(NextUInt() >> 8) * range;
+	}
+
+private:
+	uint64 m_State;
+	uint64 m_Increment;
+};
@@ -10,13 +10,14 @@
 
 namespace
 {
-	glm::mat4 CalcSpreadMatrix(float Spread1, float Spread2, float w, float l)
+	const size_t cMaxParticlesPerBurst = MAX_PARTICLES;
+
+	glm::mat4 CalcSpreadMatrix(float Angle1, float Angle2, float w, float l)
 	{
-		Random random(time(0));
 		float a[2], c[2], s[2];
 
-		a[0] = random.Range(-Spread1, Spread1) / 2.0f;
-		a[1] = random.Range(-Spread2, Spread2) / 2.0f;
+		a[0] = Angle1;
+		a[1] = Angle2;
 
 		for (size_t i = 0; i < 2; i++)
 		{
@@ -48,13 +49,15 @@ namespace
 		return SpreadMat;
 	}
 
-	template<class T>
-	inline T lifeRamp(float currentTime, float mid, const T& a, const T& b, const T& c)
+	void CalcSpreadMatrices(CM2_ParticleRandom& Random, size_t Count, float Spread1, float Spread2, float w, float l, glm::mat4* SpreadMatrices)
 	{
-		if (currentTime <= mid)
-			return interpolateLinear<T>(currentTime / mid, a, b);
-		else
-			return interpolateLinear<T>((currentTime - mid) / (1.0f - mid), b, c);
+		float angles1[cMaxParticlesPerBurst];
+		float angles2[cMaxParticlesPerBurst];
+		Random.FillRange(angles1, Count, -Spread1 / 2.0f, Spread1 / 2.0f);
+		Random.FillRange(angles2, Count, -Spread2 / 2.0f, Spread2 / 2.0f);
+
+		for (size_t i = 0; i < Count; i++)
+			SpreadMatrices[i] = CalcSpreadMatrix(angles1[i], angles2[i], w, l);
 	}
 }
 
@@ -62,7 +65,6 @@ namespace
 SM2_ParticleSystem_Wrapper::SM2_ParticleSystem_Wrapper(const CM2& M2Object, const std::shared_ptr<IFile>& File, const SM2_Particle& M2Particle)
 	: m_M2Object(M2Object)
 	, m_M2Particle(M2Particle)
-	, m_Random(time(0))
 {
 	m_Flags = M2Particle.flags;
 	m_Position = Fix_XZmY(M2Particle.Position);
@@ -92,14 +94,14 @@ SM2_ParticleSystem_Wrapper::SM2_ParticleSystem_Wrapper(const CM2& M2Object, cons
 	enabled.Initialize(M2Particle.enabledIn, File, M2Object.getSkeleton().GetAnimFiles());
 
 #if WOW_CLIENT_VERSION < WOW_WOTLK_3_3_5
-	m_MiddleTime = M2Particle.midPoint;
+	m_LifeRamp.MiddleTime = M2Particle.midPoint;
 	for (size_t i = 0; i < 3; i++)
 	{
-		m_Colors[i] = glm::vec4(M2Particle.colorValues[i].r, M2Particle.colorValues[i].g, M2Particle.colorValues[i].b, M2Particle.colorValues[i].a) / 255.0f;
-		m_Scales[i]  = M2Particle.scaleValues[i];
+		m_LifeRamp.Colors[i] = glm::vec4(M2Particle.colorValues[i].r, M2Particle.colorValues[i].g, M2Particle.colorValues[i].b, M2Particle.colorValues[i].a) / 255.0f;
+		m_LifeRamp.Scales[i]  = M2Particle.scaleValues[i];
 	}
 #else
-	m_MiddleTime = 0.5f;
+	m_LifeRamp.MiddleTime = 0.5f;
 	glm::vec3 colors2[3];
 	memcpy(colors2, File->getData() + M2Particle.colorTrack.values.offset, sizeof(glm::vec3) * 3);
 
@@ -107,8 +109,8 @@ SM2_ParticleSystem_Wrapper::SM2_ParticleSystem_Wrapper(const CM2& M2Object, cons
 	{
 		float opacity = *(short*)(File->getData() + M2Particle.alphaTrack.values.offset + i * sizeof(short));
 
-		m_Colors[i] = glm::vec4(colors2[i].x / 255.0f, colors2[i].y / 255.0f, colors2[i].z / 255.0f, opacity / 32767.0f);
-		m_Scales[i] = (*(float*)(File->getData() + M2Particle.scaleTrack.values.offset + i * sizeof(float)));
+		m_LifeRamp.Colors[i] = glm::vec4(colors2[i].x / 255.0f, colors2[i].y / 255.0f, colors2[i].z / 255.0f, opacity / 32767.0f);
+		m_LifeRamp.Scales[i] = (*(float*)(File->getData() + M2Particle.scaleTrack.values.offset + i * sizeof(float)));
 	}
 #endif
 
@@ -131,7 +133,7 @@ SM2_ParticleSystem_Wrapper::~SM2_ParticleSystem_Wrapper()
 {
 }
 
-void SM2_ParticleSystem_Wrapper::update(const CM2_Base_Instance* M2Instance, const UpdateEventArgs& e, float * rem, CM2_ParticleObject * Particles) const
+void SM2_ParticleSystem_Wrapper::update(const CM2_Base_Instance* M2Instance, const UpdateEventArgs& e, float * rem, CM2_ParticlesPool& Particles, CM2_ParticleRandom& Random) const
 {
 	double deltaTime = e.DeltaTime / 1000.0;
 	uint32 globalTime = static_cast<uint32>(e.TotalTime);
@@ -142,34 +144,9 @@ void SM2_ParticleSystem_Wrapper::update(const CM2_Base_Instance* M2Instance, con
 	float grav = gravity.GetValue(sequence, sequenceTime, m_M2Object.getSkeleton().getGlobalLoops(), globalTime);
 	float deaccel = zSource.GetValue(sequence, sequenceTime, m_M2Object.getSkeleton().getGlobalLoops(), globalTime);
 
-	CreateAndDeleteParticles(M2Instance, e, rem, Particles);
-
-	for (size_t i = 0; i < MAX_PARTICLES; i++)
-	{
-		CM2_ParticleObject& p = Particles[i];
-		if (!p.Active)
-			continue;
-
-		p.speed += (p.down * float(grav * deltaTime)) - (p.dir * float(deaccel * deltaTime));
-
-		float mspeed = 1.0f;
-		if (m_Slowdown > 0.0f)
-		{
-			mspeed = glm::exp((-1.0f * m_Slowdown) * p.currentTime);
-		}
-		p.pos += (p.speed * float(mspeed * deltaTime));
-
-		p.currentTime += deltaTime;
-		float rlife = p.currentTime / p.maxTime;
+	CreateAndDeleteParticles(M2Instance, e, rem, Particles, Random);
 
-		// calculate size and color based on lifetime
-		p.size = lifeRamp<float>(rlife, m_MiddleTime, m_Scales[0], m_Scales[1], m_Scales[2]);
-		p.color = lifeRamp<glm::vec4>(rlife, m_MiddleTime, m_Colors[0], m_Colors[1], m_Colors[2]);
-
-		// kill off old Particles
-		if (rlife >= 1.0f)
-			p.Active = false;
-	}
+	Particles.Update(static_cast<float>(deltaTime), grav, deaccel, m_Slowdown, m_LifeRamp);
 }
 
 const IBlendState::BlendMode SM2_ParticleSystem_Wrapper::GetBlendMode() const
@@ -224,7 +201,7 @@ const std::vector<TexCoordSet>& SM2_ParticleSystem_Wrapper::GetTiles() const
 	return tiles;
 }
 
-void SM2_ParticleSystem_Wrapper::CreateAndDeleteParticles(const CM2_Base_Instance * M2Instance, const UpdateEventArgs & e, float * rem, CM2_ParticleObject * Particles) const
+void SM2_ParticleSystem_Wrapper::CreateAndDeleteParticles(const CM2_Base_Instance * M2Instance, const UpdateEventArgs & e, float * rem, CM2_ParticlesPool& Particles, CM2_ParticleRandom& Random) const
 {
 	double deltaTime = e.DeltaTime / 2000.0;
 	uint32 globalTime = static_cast<uint32>(e.TotalTime);
@@ -266,47 +243,27 @@ void SM2_ParticleSystem_Wrapper::CreateAndDeleteParticles(const CM2_Base_Instanc
 
 		if (enabledValue)
 		{
-			for (int i = 0; i < tospawn; i++)
+			// Particles, that don't fit to the pool, will be spawned later
+			size_t freeCount = Particles.GetCapacity() - Particles.GetCount();
+			if (static_cast<size_t>(tospawn) > freeCount)
 			{
-				size_t freeIndex = -1;
-				for (size_t ind = 0; ind < MAX_PARTICLES; ind++)
-				{
-					if (!Particles[ind].Active)
-					{
-						freeIndex = ind;
-						break;
-					}
-				}
-
-				if (freeIndex == -1)
-				{
-					*rem += tospawn - i - 1;
-					break;
-				}
+				*rem += static_cast<float>(tospawn - freeCount);
+				tospawn = static_cast<int>(freeCount);
+			}
 
+			if (tospawn > 0)
+			{
 				switch (m_EmitterType)
 				{
 					case 0:
 					case 3:
-					{
-						CM2_ParticleObject p = DefaultGenerator_New(M2Instance, emissionAreaLengthValue, emissionAreaWidthValue, emissionSpeedValue, speedVariationValue, lifespanValue, verticalRangeValue, horizontalRangeValue);
-						p.Active = true;
-						Particles[freeIndex] = p;
-					}
+						DefaultGenerator_New(M2Instance, Random, tospawn, Particles, emissionAreaLengthValue, emissionAreaWidthValue, emissionSpeedValue, speedVariationValue, lifespanValue, verticalRangeValue, horizontalRangeValue);
 					break;
 					case 1:
-					{
-						CM2_ParticleObject p = PlaneGenerator_New(M2Instance, emissionAreaLengthValue, emissionAreaWidthValue, emissionSpeedValue, speedVariationValue, lifespanValue, verticalRangeValue, horizontalRangeValue);
-						p.Active = true;
-						Particles[freeIndex] = p;
-					}
+						PlaneGenerator_New(M2Instance, Random, tospawn, Particles, emissionAreaLengthValue, emissionAreaWidthValue, emissionSpeedValue, speedVariationValue, lifespanValue, verticalRangeValue, horizontalRangeValue);
 					break;
 					case 2:
-					{
-						CM2_ParticleObject p = SphereGenerator_New(M2Instance, emissionAreaLengthValue, emissionAreaWidthValue, emissionSpeedValue, speedVariationValue, lifespanValue, verticalRangeValue, horizontalRangeValue);
-						p.Active = true;
-						Particles[freeIndex] = p;
-					}
+						SphereGenerator_New(M2Instance, Random, tospawn, Particles, emissionAreaLengthValue, emissionAreaWidthValue, emissionSpeedValue, speedVariationValue, lifespanValue, verticalRangeValue, horizontalRangeValue);
 					break;
 					default:
 					{
@@ -318,7 +275,7 @@ void SM2_ParticleSystem_Wrapper::CreateAndDeleteParticles(const CM2_Base_Instanc
 	}
 }
 
-CM2_ParticleObject SM2_ParticleSystem_Wrapper::DefaultGenerator_New(const CM2_Base_Instance * M2Instance, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const
+void SM2_ParticleSystem_Wrapper::DefaultGenerator_New(const CM2_Base_Instance * M2Instance, CM2_ParticleRandom& Random, size_t Count, CM2_ParticlesPool& Particles, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const
 {
 	std::shared_ptr<ISkeletonBone3D> bone;
 	if (GetBone() != -1)
@@ -334,7 +291,6 @@ CM2_ParticleObject SM2_ParticleSystem_Wrapper::DefaultGenerator_New(const CM2_Ba
 		p.dir = bone->GetRotateMatrix() * glm::vec4(p.dir, 0.0f);
 
 	p.down = glm::vec3(0, -1.0f, 0);
-	p.speed = glm::normalize(p.dir) * spd * (1.0f + m_Random.Range(-var, var));
 
 	/*if (m_ParticleSystem->GetFlags().DONOTBILLBOARD)
 	{
@@ -347,100 +303,134 @@ CM2_ParticleObject SM2_ParticleSystem_Wrapper::DefaultGenerator_New(const CM2_Ba
 	p.currentTime = 0;
 	p.maxTime = lifespan;
 	p.origin = p.pos;
-	p.tile = m_Random.Range(0, rows * cols - 1);
-	return p;
+
+	// Position and direction are same for whole burst, only velocities are differ
+	const glm::vec3 speedDir = glm::normalize(p.dir) * spd;
+
+	float speedVariations[cMaxParticlesPerBurst];
+	Random.FillRange(speedVariations, Count, -var, var);
+
+	for (size_t i = 0; i < Count; i++)
+	{
+		p.speed = speedDir * (1.0f + speedVariations[i]);
+		p.tile = Random.Range(0, rows * cols - 1);
+		Particles.Add(p);
+	}
 }
 
-CM2_ParticleObject SM2_ParticleSystem_Wrapper::PlaneGenerator_New(const CM2_Base_Instance * M2Instance, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const
+void SM2_ParticleSystem_Wrapper::PlaneGenerator_New(const CM2_Base_Instance * M2Instance, CM2_ParticleRandom& Random, size_t Count, CM2_ParticlesPool& Particles, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const
 {
 	std::shared_ptr<ISkeletonBone3D> bone;
 	if (GetBone() != -1)
 		bone = M2Instance->getSkeletonComponent()->GetBone(GetBone());
 
-	CM2_ParticleObject p;
-
 	//glm::mat4 SpreadMat = CalcSpreadMatrix(spr, spr, 1.0f, 1.0f);
 	//glm::mat4 mrot = bone->GetRotateMatrix() * SpreadMat;
 
-	p.pos = GetPosition() + glm::vec3(m_Random.Range(-l, l), 0, m_Random.Range(-w, w));
+	glm::vec3 dir = glm::vec3(0.0f, 1.0f, 0.0f);
 	if (bone)
-		p.pos = bone->GetMatrix() * glm::vec4(p.pos, 1.0f);
+		dir = bone->GetRotateMatrix() * glm::vec4(dir, 0.0f);
 
-	p.dir = glm::vec3(0.0f, 1.0f, 0.0f);
-	if (bone)
-		p.dir = bone->GetRotateMatrix() * glm::vec4(p.dir, 0.0f);
+	const glm::vec3 speedDir = glm::normalize(dir) * spd;
 
-	p.down = glm::vec3(0, -1.0f, 0);
-	p.speed = glm::normalize(p.dir) * spd * (1.0f + m_Random.Range(-var, var));
+	float offsetsX[cMaxParticlesPerBurst];
+	float offsetsZ[cMaxParticlesPerBurst];
+	float speedVariations[cMaxParticlesPerBurst];
+	Random.FillRange(offsetsX, Count, -l, l);
+	Random.FillRange(offsetsZ, Count, -w, w);
+	Random.FillRange(speedVariations, Count, -var, var);
 
-	/*if (m_ParticleSystem->GetFlags().DONOTBILLBOARD)
+	for (size_t i = 0; i < Count; i++)
 	{
-		p.corners[0] = mrot * vec4(-1, 0, +1, 0);
-		p.corners[1] = mrot * vec4(+1, 0, +1, 0);
-		p.corners[2] = mrot * vec4(+1, 0, -1, 0);
-		p.corners[3] = mrot * vec4(-1, 0, -1, 0);
-	}*/
+		CM2_ParticleObject p;
 
-	p.currentTime = 0;
-	p.maxTime = lifespan;
-	p.origin = p.pos;
-	p.tile = m_Random.Range(0, rows * cols - 1);
-	return p;
+		p.pos = GetPosition() + glm::vec3(offsetsX[i], 0, offsetsZ[i]);
+		if (bone)
+			p.pos = bone->GetMatrix() * glm::vec4(p.pos, 1.0f);
+
+		p.dir = dir;
+		p.down = glm::vec3(0, -1.0f, 0);
+		p.speed = speedDir * (1.0f + speedVariations[i]);
+
+		/*if (m_ParticleSystem->GetFlags().DONOTBILLBOARD)
+		{
+			p.corners[0] = mrot * vec4(-1, 0, +1, 0);
+			p.corners[1] = mrot * vec4(+1, 0, +1, 0);
+			p.corners[2] = mrot * vec4(+1, 0, -1, 0);
+			p.corners[3] = mrot * vec4(-1, 0, -1, 0);
+		}*/
+
+		p.currentTime = 0;
+		p.maxTime = lifespan;
+		p.origin = p.pos;
+		p.tile = Random.Range(0, rows * cols - 1);
+		Particles.Add(p);
+	}
 }
 
-CM2_ParticleObject SM2_ParticleSystem_Wrapper::SphereGenerator_New(const CM2_Base_Instance * M2Instance, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const
+void SM2_ParticleSystem_Wrapper::SphereGenerator_New(const CM2_Base_Instance * M2Instance, CM2_ParticleRandom& Random, size_t Count, CM2_ParticlesPool& Particles, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const
 {
 	std::shared_ptr<ISkeletonBone3D> bone;
 	if (GetBone() != -1)
 		bone = M2Instance->getSkeletonComponent()->GetBone(GetBone());
 
-	CM2_ParticleObject p;
-	glm::vec3 dir;
-
-	float radius = m_Random.Range(0.0f, 1.0f);
+	const glm::mat4 boneRotateMatrix = bone ? bone->GetRotateMatrix() : glm::mat4(1.0f);
 
 	//Spread Calculation
-	glm::mat4 SpreadMat = CalcSpreadMatrix(spr * 2, spr2 * 2, w, l);
-	glm::mat4 mrot = bone->GetRotateMatrix() * SpreadMat;
+	glm::mat4 spreadMatrices[cMaxParticlesPerBurst];
+	CalcSpreadMatrices(Random, Count, spr * 2, spr2 * 2, w, l, spreadMatrices);
 
-	glm::vec3 bdir = mrot * glm::vec4(glm::vec3(0, 1, 0) * radius, 0);
-	float temp = bdir.z;
-	bdir.z = bdir.y;
-	bdir.y = temp;
+	float radiuses[cMaxParticlesPerBurst];
+	float speedVariations[cMaxParticlesPerBurst];
+	Random.FillRange(radiuses, Count, 0.0f, 1.0f);
+	Random.FillRange(speedVariations, Count, -var, var);
 
-	p.pos = GetPosition() + bdir;
-	if (bone)
-		p.pos = bone->GetMatrix() * glm::vec4(p.pos, 0.0f);
+	for (size_t i = 0; i < Count; i++)
+	{
+		CM2_ParticleObject p;
+		glm::vec3 dir;
 
+		glm::mat4 mrot = boneRotateMatrix * spreadMatrices[i];
 
-	/*if ((glm::length2(bdir) == 0) && ((m_ParticleSystem->flags & 0x100) != 0x100))
-	{
-		p.speed = vec3(0, 0, 0);
-		dir = ParticleSystem_ParentBone->getRotateMatrix() * vec4(0, 1, 0, 0);
-	}
-	else
-	{
-		if (m_ParticleSystem->flags & 0x100)
+		glm::vec3 bdir = mrot * glm::vec4(glm::vec3(0, 1, 0) * radiuses[i], 0);
+		float temp = bdir.z;
+		bdir.z = bdir.y;
+		bdir.y = temp;
+
+		p.pos = GetPosition() + bdir;
+		if (bone)
+			p.pos = bone->GetMatrix() * glm::vec4(p.pos, 0.0f);
+
+
+		/*if ((glm::length2(bdir) == 0) && ((m_ParticleSystem->flags & 0x100) != 0x100))
+		{
+			p.speed = vec3(0, 0, 0);
 			dir = ParticleSystem_ParentBone->getRotateMatrix() * vec4(0, 1, 0, 0);
+		}
 		else
-			dir = glm::normalize(bdir);
+		{
+			if (m_ParticleSystem->flags & 0x100)
+				dir = ParticleSystem_ParentBone->getRotateMatrix() * vec4(0, 1, 0, 0);
+			else
+				dir = glm::normalize(bdir);
 
-		p.speed = glm::normalize(dir) * spd * (1.0f + random.Range(-var, var));   // ?
-	}*/
+			p.speed = glm::normalize(dir) * spd * (1.0f + random.Range(-var, var));   // ?
+		}*/
 
-	if (bone)
-		dir = bone->GetRotateMatrix() * glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
-	else
-		dir = glm::normalize(bdir);
+		if (bone)
+			dir = boneRotateMatrix * glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+		else
+			dir = glm::normalize(bdir);
 
-	p.speed = glm::normalize(dir) * spd * (1.0f + m_Random.Range(-var, var));   // ?
-	p.dir = glm::normalize(dir);//mrot * vec3(0, 1.0f,0);
-	p.down = glm::vec3(0, -1.0f, 0);
-	p.currentTime = 0;
-	p.maxTime = lifespan;
-	p.origin = p.pos;
-	p.tile = glm::round(m_Random.Range(0, rows * cols - 1));
-	return p;
+		p.speed = glm::normalize(dir) * spd * (1.0f + speedVariations[i]);   // ?
+		p.dir = glm::normalize(dir);//mrot * vec3(0, 1.0f,0);
+		p.down = glm::vec3(0, -1.0f, 0);
+		p.currentTime = 0;
+		p.maxTime = lifespan;
+		p.origin = p.pos;
+		p.tile = Random.Range(0, rows * cols - 1);
+		Particles.Add(p);
+	}
 }
 
 #if 0
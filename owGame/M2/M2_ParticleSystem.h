@@ -12,11 +12,7 @@ class CM2_Base_Instance;
 #define MAX_PARTICLES 100
 
 #include "M2_Particle.h"
-
-struct TexCoordSet 
-{
-	glm::vec2 tc[4];
-};
+#include "M2_ParticleRandom.h"
 
 class SM2_ParticleSystem_Wrapper
 {
@@ -24,7 +20,7 @@ public:
 	SM2_ParticleSystem_Wrapper(const CM2& M2Object, const std::shared_ptr<IFile>& File, const SM2_Particle& M2Particle);
 	virtual ~SM2_ParticleSystem_Wrapper();
 
-	void update(const CM2_Base_Instance* M2Instance, const UpdateEventArgs& e, float* rem, CM2_ParticleObject* Particles) const;
+	void update(const CM2_Base_Instance* M2Instance, const UpdateEventArgs& e, float* rem, CM2_ParticlesPool& Particles, CM2_ParticleRandom& Random) const;
 
 	SM2_Particle::Flags               GetFlags() const { return m_Flags; }
 	const glm::vec3&                  GetPosition() const { return m_Position; }
@@ -34,10 +30,10 @@ public:
 	const std::vector<TexCoordSet>&   GetTiles() const;
 
 protected:
-	void               CreateAndDeleteParticles(const CM2_Base_Instance* M2Instance, const UpdateEventArgs& e, float * rem, CM2_ParticleObject * Particles) const;
-	CM2_ParticleObject DefaultGenerator_New(const CM2_Base_Instance* M2Instance, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const;
-	CM2_ParticleObject PlaneGenerator_New(const CM2_Base_Instance* M2Instance, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const;
-	CM2_ParticleObject SphereGenerator_New(const CM2_Base_Instance* M2Instance, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const;
+	void               CreateAndDeleteParticles(const CM2_Base_Instance* M2Instance, const UpdateEventArgs& e, float * rem, CM2_ParticlesPool& Particles, CM2_ParticleRandom& Random) const;
+	void               DefaultGenerator_New(const CM2_Base_Instance* M2Instance, CM2_ParticleRandom& Random, size_t Count, CM2_ParticlesPool& Particles, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const;
+	void               PlaneGenerator_New(const CM2_Base_Instance* M2Instance, CM2_ParticleRandom& Random, size_t Count, CM2_ParticlesPool& Particles, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const;
+	void               SphereGenerator_New(const CM2_Base_Instance* M2Instance, CM2_ParticleRandom& Random, size_t Count, CM2_ParticlesPool& Particles, float w, float l, float spd, float var, float lifespan, float spr, float spr2) const;
 	void               initTile(glm::vec2 *tc, int num);
 
 private:
@@ -62,9 +58,7 @@ private:
 	M2_Animated<float>        emissionAreaWidth;
 	M2_Animated<float>        zSource;
 
-	float                     m_MiddleTime;
-	glm::vec4                 m_Colors[3];
-	float                     m_Scales[3];
+	CM2_ParticlesPool::SLifeRamp m_LifeRamp;
 
 	float                     m_Slowdown;
 
@@ -79,5 +73,4 @@ private:
 private:
 	const CM2& m_M2Object;
 	const SM2_Particle m_M2Particle;
-	Random m_Random;
 };
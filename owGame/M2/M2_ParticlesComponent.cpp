@@ -7,12 +7,18 @@
 // General
 #include "M2_ParticlesComponent.h"
 
+// Additional
+#include "WowHash.h"
+
 //
 // CM2ParticleSystem
 //
-CM2ParticleSystem::CM2ParticleSystem(IRenderDevice& RenderDevice, const std::shared_ptr<SM2_ParticleSystem_Wrapper>& M2ParticleSystem)
-	: m_M2ParticleSystem(M2ParticleSystem)
+CM2ParticleSystem::CM2ParticleSystem(IRenderDevice& RenderDevice, const std::shared_ptr<SM2_ParticleSystem_Wrapper>& M2ParticleSystem, uint64 Seed, uint64 Stream)
+	: m_IsParticleObjectsDirty(false)
+	, m_M2ParticleSystem(M2ParticleSystem)
 	, rem(0.0f)
+	, m_M2ParticleObjects(MAX_PARTICLES)
+	, m_Random(Seed, Stream)
 {
 	if (m_M2ParticleSystem->GetTexture())
 	{
@@ -33,24 +39,29 @@ CM2ParticleSystem::~CM2ParticleSystem()
 //
 void CM2ParticleSystem::Update(const CM2_Base_Instance * M2Instance, const UpdateEventArgs & e)
 {
-	m_M2ParticleSystem->update(M2Instance, e, &rem, m_M2ParticleObjects);
+	m_M2ParticleSystem->update(M2Instance, e, &rem, m_M2ParticleObjects, m_Random);
 
-	m_ParticleObjects.clear();
-	for (size_t i = 0; i < 100; i++)
-	{
-		const auto& m2P = m_M2ParticleObjects[i];
-		if (!m2P.Active)
-			continue;
+	// Vertices are built by CRenderPass_M2_Particles from pool, 'm_ParticleObjects' is filled only for other consumers
+	m_IsParticleObjectsDirty = true;
+}
 
-		SParticle particle;
-		particle.Position = m2P.pos;
-		_ASSERT(m2P.tile < m_M2ParticleSystem->GetTiles().size());
-		particle.TexCoordBegin = m_M2ParticleSystem->GetTiles()[m2P.tile].tc[1];
-		particle.TexCoordEnd = m_M2ParticleSystem->GetTiles()[m2P.tile].tc[3];
-		particle.Color = m2P.color;
-		particle.Size = glm::vec2(m2P.size);
-		m_ParticleObjects.push_back(particle);
-	}
+void CM2ParticleSystem::SetSeed(uint64 Seed, uint64 Stream)
+{
+	m_Random.SetSeed(Seed, Stream);
+	m_M2ParticleObjects.Clear();
+	m_IsParticleObjectsDirty = true;
+	rem = 0.0f;
+}
+
+bool CM2ParticleSystem::BuildVertices(const glm::mat4& World, const glm::vec3& CameraRight, const glm::vec3& CameraUp, CM2_ParticlesFrameBuffer& FrameBuffer, size_t* FirstVertex, size_t* VerticesCount) const
+{
+	if (m_M2ParticleObjects.GetCount() == 0 || m_M2ParticleSystem->GetTiles().empty())
+		return false;
+
+	*VerticesCount = m_M2ParticleObjects.GetCount() * 6;
+	SM2_ParticleVertex* vertices = FrameBuffer.Allocate(*VerticesCount, FirstVertex);
+	m_M2ParticleObjects.BuildBillboards(World, CameraRight, CameraUp, m_M2ParticleSystem->GetTiles(), vertices);
+	return true;
 }
 
 //
@@ -68,6 +79,25 @@ void CM2ParticleSystem::ClearParticles()
 
 const std::vector<SParticle>& CM2ParticleSystem::GetParticles() const
 {
+	if (false == m_IsParticleObjectsDirty)
+		return m_ParticleObjects;
+
+	m_ParticleObjects.clear();
+	for (size_t i = 0; i < m_M2ParticleObjects.GetCount(); i++)
+	{
+		const int tile = m_M2ParticleObjects.GetTile(i);
+		_ASSERT(tile >= 0 && static_cast<size_t>(tile) < m_M2ParticleSystem->GetTiles().size());
+
+		SParticle particle;
+		particle.Position = m_M2ParticleObjects.GetPosition(i);
+		particle.TexCoordBegin = m_M2ParticleSystem->GetTiles()[tile].tc[1];
+		particle.TexCoordEnd = m_M2ParticleSystem->GetTiles()[tile].tc[3];
+		particle.Color = m_M2ParticleObjects.GetColor(i);
+		particle.Size = glm::vec2(m_M2ParticleObjects.GetSize(i));
+		m_ParticleObjects.push_back(particle);
+	}
+
+	m_IsParticleObjectsDirty = false;
 	return m_ParticleObjects;
 }
 
@@ -91,6 +121,7 @@ std::shared_ptr<IBlendState> CM2ParticleSystem::GetBlendState() const
 //
 CM2ParticlesComponent3D::CM2ParticlesComponent3D(const CM2_Base_Instance& SceneNode)
 	: CComponentBase(SceneNode)
+	, m_IsSeeded(false)
 {
 
 	//for (size_t i = 0; i < 1; i++)
@@ -99,9 +130,11 @@ CM2ParticlesComponent3D::CM2ParticlesComponent3D(const CM2_Base_Instance& SceneN
 	//	m_ParticleSystems.push_back(std::make_shared<CM2ParticleSystem>(GetM2OwnerNode().getM2().GetRenderDevice(), p));
 	//}
 
-	for (const auto& m2ParticleSystem : GetM2OwnerNode().getM2().getMiscellaneous().GetParticles())
+	// Real seed is set by first update, when world position is known (see 'SeedByWorldPosition')
+	const auto& m2ParticleSystems = GetM2OwnerNode().getM2().getMiscellaneous().GetParticles();
+	for (size_t i = 0; i < m2ParticleSystems.size(); i++)
 	{
-		m_ParticleSystems.push_back(std::make_shared<CM2ParticleSystem>(GetM2OwnerNode().getM2().GetRenderDevice(), m2ParticleSystem));
+		m_ParticleSystems.push_back(std::make_shared<CM2ParticleSystem>(GetM2OwnerNode().getM2().GetRenderDevice(), m2ParticleSystems[i], 0, i));
 	}
 }
 
@@ -114,6 +147,9 @@ CM2ParticlesComponent3D::~CM2ParticlesComponent3D()
 //
 void CM2ParticlesComponent3D::Update(const UpdateEventArgs& e)
 {
+	if (false == m_IsSeeded)
+		SeedByWorldPosition();
+
 	for (auto& it : m_ParticleSystems)
 	{
 		it->Update(&GetM2OwnerNode(), e);
@@ -135,3 +171,21 @@ const CM2_Base_Instance& CM2ParticlesComponent3D::GetM2OwnerNode() const
 {
 	return reinterpret_cast<const CM2_Base_Instance&>(GetOwnerNode());
 }
+
+void CM2ParticlesComponent3D::SeedByWorldPosition()
+{
+	// Seed doesn't depend on loading order: model, emitter index and position (1/16 yard) identify emitter in scene
+	const std::string fileName = GetM2OwnerNode().getM2().getFilename();
+	const uint64 modelHash = HashFNV1aBytes(cHashFNV1aOffset, fileName.data(), fileName.size());
+
+	const glm::ivec3 position = glm::ivec3(glm::round(glm::vec3(GetM2OwnerNode().GetWorldTransfom()[3]) * 16.0f));
+	const uint64 instanceSeed = HashFNV1aBytes(modelHash, &position, sizeof(position));
+
+	for (size_t i = 0; i < m_ParticleSystems.size(); i++)
+	{
+		const uint64 index = i;
+		m_ParticleSystems[i]->SetSeed(instanceSeed, HashFNV1aBytes(modelHash, &index, sizeof(index)));
+	}
+
+	m_IsSeeded = true;
+}
@@ -3,6 +3,7 @@
 class CM2;
 class CM2_Base_Instance;
 #include "M2/M2_ParticleSystem.h"
+#include "M2/M2_ParticlesFrameBuffer.h"
 
 //
 // CM2ParticleSystem
@@ -11,11 +12,13 @@ class CM2ParticleSystem
 	: public IParticleSystem
 {
 public:
-	CM2ParticleSystem(IRenderDevice& RenderDevice, const std::shared_ptr<SM2_ParticleSystem_Wrapper>& M2ParticleSystem);
+	CM2ParticleSystem(IRenderDevice& RenderDevice, const std::shared_ptr<SM2_ParticleSystem_Wrapper>& M2ParticleSystem, uint64 Seed, uint64 Stream);
 	virtual ~CM2ParticleSystem();
 
 	// CM2ParticleSystem
 	void Update(const CM2_Base_Instance* M2Instance, const UpdateEventArgs& e);
+	void SetSeed(uint64 Seed, uint64 Stream);
+	bool BuildVertices(const glm::mat4& World, const glm::vec3& CameraRight, const glm::vec3& CameraUp, CM2_ParticlesFrameBuffer& FrameBuffer, size_t* FirstVertex, size_t* VerticesCount) const;
 
 	// IParticleSystem
 	void AddParticle(const SParticle& Particle) override;
@@ -26,14 +29,16 @@ public:
 	std::shared_ptr<IBlendState> GetBlendState() const override;
 
 private:
-	std::vector<SParticle> m_ParticleObjects;
+	mutable std::vector<SParticle> m_ParticleObjects; // Copy of pool, made on demand by 'GetParticles'
+	mutable bool m_IsParticleObjectsDirty;
 	std::shared_ptr<IMaterial> m_Material;
 	std::shared_ptr<IBlendState> m_BlendState;
 
 private:
 	float rem;
 	std::shared_ptr<SM2_ParticleSystem_Wrapper> m_M2ParticleSystem;
-	CM2_ParticleObject m_M2ParticleObjects[MAX_PARTICLES];
+	CM2_ParticlesPool m_M2ParticleObjects;
+	CM2_ParticleRandom m_Random;
 };
 
 //
@@ -51,9 +56,13 @@ public:
 	void Update(const UpdateEventArgs& e) override final;
 	void Accept(IVisitor* visitor) override final;
 
+	const std::vector<std::shared_ptr<CM2ParticleSystem>>& GetParticleSystems() const { return m_ParticleSystems; }
+
 protected:
 	const CM2_Base_Instance& GetM2OwnerNode() const;
+	void SeedByWorldPosition();
 
 private:
 	std::vector<std::shared_ptr<CM2ParticleSystem>> m_ParticleSystems;
+	bool m_IsSeeded;
 };
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "stdafx.h"
+
+// General
+#include "M2_ParticlesFrameBuffer.h"
+
+namespace
+{
+	const size_t cInitialVerticesCount = 16384;
+}
+
+CM2_ParticlesFrameBuffer::CM2_ParticlesFrameBuffer(IRenderDevice& RenderDevice)
+	: m_RenderDevice(RenderDevice)
+{
+	m_Vertices.reserve(cInitialVerticesCount);
+	m_Buffer = m_RenderDevice.GetObjectsFactory().CreateStructuredBuffer(nullptr, cInitialVerticesCount, sizeof(SM2_ParticleVertex), CPUAccess::Write);
+}
+
+CM2_ParticlesFrameBuffer::~CM2_ParticlesFrameBuffer()
+{
+}
+
+void CM2_ParticlesFrameBuffer::BeginFrame()
+{
+	// Capacity is kept between frames
+	m_Vertices.clear();
+}
+
+SM2_ParticleVertex* CM2_ParticlesFrameBuffer::Allocate(size_t VerticesCount, size_t* FirstVertex)
+{
+	*FirstVertex = m_Vertices.size();
+	m_Vertices.resize(m_Vertices.size() + VerticesCount);
+	return m_Vertices.data() + *FirstVertex;
+}
+
+const std::shared_ptr<IStructuredBuffer>& CM2_ParticlesFrameBuffer::EndFrame()
+{
+	if (m_Vertices.empty())
+		return m_Buffer;
+
+	// Buffer is only grown (to CPU storage capacity), so in most frames this is just one update
+	if (m_Vertices.size() > m_Buffer->GetElementCount())
+		m_Buffer = m_RenderDevice.GetObjectsFactory().CreateStructuredBuffer(nullptr, m_Vertices.capacity(), sizeof(SM2_ParticleVertex), CPUAccess::Write);
+
+	m_Buffer->Set(m_Vertices);
+
+	return m_Buffer;
+}
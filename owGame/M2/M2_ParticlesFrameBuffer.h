@@ -0,0 +1,35 @@
+#pragma once
+
+struct ZN_API SM2_ParticleVertex
+{
+	glm::vec3 Position;
+	glm::vec4 Color;
+	glm::vec2 TexCoord;
+};
+
+//
+// All particle systems and ribbons append their vertices to this buffer during the frame.
+// CPU storage and GPU buffer are reused between frames and the GPU buffer is updated once per frame.
+//
+class ZN_API CM2_ParticlesFrameBuffer
+{
+public:
+	CM2_ParticlesFrameBuffer(IRenderDevice& RenderDevice);
+	virtual ~CM2_ParticlesFrameBuffer();
+
+	void BeginFrame();
+
+	// Returned pointer is valid until next 'Allocate'
+	SM2_ParticleVertex* Allocate(size_t VerticesCount, size_t* FirstVertex);
+	size_t GetVerticesCount() const { return m_Vertices.size(); }
+
+	// Upload all vertices of the frame
+	const std::shared_ptr<IStructuredBuffer>& EndFrame();
+
+private:
+	std::vector<SM2_ParticleVertex>     m_Vertices;
+	std::shared_ptr<IStructuredBuffer>  m_Buffer;
+
+private:
+	IRenderDevice& m_RenderDevice;
+};
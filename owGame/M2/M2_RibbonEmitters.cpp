@@ -7,17 +7,6 @@
 // General
 #include "M2_RibbonEmitters.h"
 
-struct RibbonVertex
-{
-	RibbonVertex(glm::vec3 _pos, glm::vec2 _tex) :
-		pos(_pos),
-		tex(_tex)
-	{}
-
-	glm::vec3 pos;
-	glm::vec2 tex;
-};
-
 CM2_RibbonEmitters::CM2_RibbonEmitters(const CM2& M2Object, const std::shared_ptr<IFile>& File, const SM2_RibbonEmitter& M2RibbonEmitter) 
 	: m_M2Object(M2Object)
 	, tcolor(glm::vec4(1.0f))
@@ -128,19 +117,40 @@ void CM2_RibbonEmitters::setup(uint16 anim, uint32 time, uint32 _globalTime, con
 	}
 }
 
-void CM2_RibbonEmitters::Render(const glm::mat4& _world)
+size_t CM2_RibbonEmitters::Render(const glm::mat4& _world, CM2_ParticlesFrameBuffer& FrameBuffer, size_t* FirstVertex) const
 {
-	std::vector<RibbonVertex> vertices;
+	// Quad strip edges: one per segment and one more for the tail of last segment
+	const size_t edgesCount = segs.size() + ((segs.size() > 1) ? 1 : 0);
+	if (edgesCount < 2)
+		return 0;
+
+	const size_t verticesCount = (edgesCount - 1) * 6;
+	SM2_ParticleVertex* vertices = FrameBuffer.Allocate(verticesCount, FirstVertex);
+
+	SM2_ParticleVertex prevTop, prevBottom;
+	auto addEdge = [&vertices, &prevTop, &prevBottom, this](bool IsFirst, const glm::vec3& Top, const glm::vec3& Bottom, float u) {
+		SM2_ParticleVertex top = { Top, tcolor, glm::vec2(u, 0.0f) };
+		SM2_ParticleVertex bottom = { Bottom, tcolor, glm::vec2(u, 1.0f) };
+		if (false == IsFirst)
+		{
+			*vertices++ = prevTop;
+			*vertices++ = prevBottom;
+			*vertices++ = top;
+
+			*vertices++ = top;
+			*vertices++ = prevBottom;
+			*vertices++ = bottom;
+		}
+		prevTop = top;
+		prevBottom = bottom;
+	};
 
-	std::list<RibbonSegment>::iterator it = segs.begin();
+	std::list<RibbonSegment>::const_iterator it = segs.begin();
 	float l = 0;
 	for (; it != segs.end(); ++it)
 	{
 		float u = l / length;
-
-		vertices.push_back(RibbonVertex(it->pos + it->up * tabove, glm::vec2(u, 0)));
-		vertices.push_back(RibbonVertex(it->pos - it->up * tbelow, glm::vec2(u, 1)));
-
+		addEdge(it == segs.begin(), it->pos + it->up * tabove, it->pos - it->up * tbelow, u);
 		l += it->len;
 	}
 
@@ -148,12 +158,9 @@ void CM2_RibbonEmitters::Render(const glm::mat4& _world)
 	{
 		// last segment...?
 		--it;
-		vertices.push_back(RibbonVertex(it->pos + it->up * tabove + it->back*(it->len / it->len0), glm::vec2(1, 0)));
-		vertices.push_back(RibbonVertex(it->pos - it->up * tbelow + it->back*(it->len / it->len0), glm::vec2(1, 1)));
+		addEdge(false, it->pos + it->up * tabove + it->back*(it->len / it->len0), it->pos - it->up * tbelow + it->back*(it->len / it->len0), 1.0f);
 	}
 
-
-
 	/*texture->Bind();
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
@@ -199,38 +206,5 @@ void CM2_RibbonEmitters::Render(const glm::mat4& _world)
 	glDepthMask(GL_TRUE);*/
 
 
-	for (auto& it : vertices)
-	{
-		//_Render->DrawSphere(mat4(), it.pos, 0.1f);
-	}
-
-
-	// Vertex buffer
-	/*std::shared_ptr<IBuffer> __vb = _Render->r.createVertexBuffer(vertices.size() * sizeof(RibbonVertex), vertices.data());
-
-	// Geometry
-	std::shared_ptr<IModel> __geom = _Render->r.beginCreatingGeometry(PRIM_TRISTRIP, _Render->getRenderStorage()->__layout_GxVBF_PT);
-	__geom->setGeomVertexParams(__vb, R_DataType::T_FLOAT, 0, sizeof(RibbonVertex));
-	__geom->setGeomVertexParams(__vb, R_DataType::T_FLOAT, 12, sizeof(RibbonVertex));
-	__geom->finishCreatingGeometry();
-
-	//__vb->updateBufferData(0, vertices.size() * sizeof(RibbonVertex), vertices.data());
-
-	_Render->r.setBlendMode(true, R_BlendFunc::BS_BLEND_SRC_ALPHA, R_BlendFunc::BS_BLEND_ONE);
-	_Render->r.setCullMode(R_CullMode::RS_CULL_NONE);
-	_Render->r.setDepthMask(false);
-
-	_Render->r.setGeometry(__geom);
-
-	CM2_RibbonEmitters_Pass* pass = _Render->getTechniquesMgr()->M2_RibbonEmitters_Pass.operator->();
-	pass->Bind();
-	{
-		pass->setWorld(mat4());
-		pass->SetColor(vec4(1.0f));
-
-		_Render->r.setTexture(Material::C_DiffuseTextureIndex, m_Texture, 0, 0);
-
-		_Render->r.draw(0, vertices.size());
-	}
-	pass->Unbind();*/
+	return verticesCount;
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "M2_ParticlesFrameBuffer.h"
+
 // FORWARD BEGIN
 class CM2;
 class SM2_Part_Bone_Wrapper;
@@ -18,7 +20,8 @@ public:
 
 	void setup(uint16 anim, uint32 time, uint32 _globalTime, const glm::mat4& _worldMatrix);
 
-	void Render(const glm::mat4& _world);
+	// Append ribbon triangles to frame buffer. Returns vertices count.
+	size_t Render(const glm::mat4& _world, CM2_ParticlesFrameBuffer& FrameBuffer, size_t* FirstVertex) const;
 
 private:
 	uint32										m_ID;
@@ -13,6 +13,7 @@ CM2SkeletonBone3D::CM2SkeletonBone3D(const SM2_Part_Bone_Wrapper& M2Bone)
 	, m_Matrix(glm::mat4(1.0f))
 	, m_RotateMatrix(glm::mat4(1.0f))
 	, m_IsCalculated(false)
+	, m_HasPoseKeys(false)
 {
 }
 
@@ -69,8 +70,7 @@ void CM2SkeletonBone3D::Calculate(const CM2_Base_Instance * M2Instance, const IC
 	if (parentBone)
 		std::dynamic_pointer_cast<CM2SkeletonBone3D>(parentBone)->Calculate(M2Instance, Camera, GlobalTime);
 
-	m_Matrix = m_M2Bone.calcMatrix(M2Instance, GlobalTime);
-	m_RotateMatrix = m_M2Bone.calcRotationMatrix(M2Instance, GlobalTime);
+	m_M2Bone.calcMatrices(M2Instance, GlobalTime, m_Matrix, m_RotateMatrix);
 
 	if (parentBone)
 	{
@@ -91,6 +91,73 @@ void CM2SkeletonBone3D::Reset()
 	m_IsCalculated = false;
 }
 
+void CM2SkeletonBone3D::PushPoseKey()
+{
+	// Bone was skipped by bones culling, don't interpolate from stale pose
+	if (!m_IsCalculated)
+	{
+		m_HasPoseKeys = false;
+		return;
+	}
+
+	m_PoseKeyMatrix[0] = m_PoseKeyMatrix[1];
+	m_PoseKeyRotateMatrix[0] = m_PoseKeyRotateMatrix[1];
+	m_PoseKeyMatrix[1] = DecomposePoseKey(m_Matrix);
+	m_PoseKeyRotateMatrix[1] = DecomposePoseKey(m_RotateMatrix);
+
+	if (!m_HasPoseKeys)
+	{
+		m_PoseKeyMatrix[0] = m_PoseKeyMatrix[1];
+		m_PoseKeyRotateMatrix[0] = m_PoseKeyRotateMatrix[1];
+	}
+
+	m_HasPoseKeys = true;
+}
+
+void CM2SkeletonBone3D::InterpolatePose(float Factor)
+{
+	if (!m_HasPoseKeys)
+		return;
+
+	m_Matrix = InterpolatePoseKeys(m_PoseKeyMatrix[0], m_PoseKeyMatrix[1], Factor);
+	m_RotateMatrix = InterpolatePoseKeys(m_PoseKeyRotateMatrix[0], m_PoseKeyRotateMatrix[1], Factor);
+}
+
+
+
+//
+// Private
+//
+CM2SkeletonBone3D::SPoseKey CM2SkeletonBone3D::DecomposePoseKey(const glm::mat4& Matrix)
+{
+	SPoseKey key;
+	key.Translate = glm::vec3(Matrix[3]);
+	key.Scale = glm::vec3(glm::length(glm::vec3(Matrix[0])), glm::length(glm::vec3(Matrix[1])), glm::length(glm::vec3(Matrix[2])));
+
+	// Mirrored bone
+	if (glm::determinant(glm::mat3(Matrix)) < 0.0f)
+		key.Scale.x = -key.Scale.x;
+
+	// Collapsed bone (zero scale) has not rotation
+	if (glm::abs(key.Scale.x) < 1e-6f || glm::abs(key.Scale.y) < 1e-6f || glm::abs(key.Scale.z) < 1e-6f)
+	{
+		key.Rotate = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		return key;
+	}
+
+	glm::mat3 rotate(glm::vec3(Matrix[0]) / key.Scale.x, glm::vec3(Matrix[1]) / key.Scale.y, glm::vec3(Matrix[2]) / key.Scale.z);
+	key.Rotate = glm::normalize(glm::quat_cast(rotate));
+	return key;
+}
+
+glm::mat4 CM2SkeletonBone3D::InterpolatePoseKeys(const SPoseKey& From, const SPoseKey& To, float Factor)
+{
+	glm::vec3 translate = glm::mix(From.Translate, To.Translate, Factor);
+	glm::quat rotate = glm::slerp(From.Rotate, To.Rotate, Factor);
+	glm::vec3 scale = glm::mix(From.Scale, To.Scale, Factor);
+	return glm::translate(translate) * glm::mat4_cast(rotate) * glm::scale(scale);
+}
+
 
 
 //
@@ -98,12 +165,31 @@ void CM2SkeletonBone3D::Reset()
 //
 CM2SkeletonComponent3D::CM2SkeletonComponent3D(const CM2_Base_Instance& OwnerNode)
 	: CComponentBase(OwnerNode)
+	, m_AnimationLOD(OwnerNode.getM2().GetBaseManager())
+	, m_UpdateInterval(1)
+	, m_FrameCounter(0)
+	// Spread reduced rate updates of different instances between frames
+	, m_FramePhase(static_cast<uint32>(reinterpret_cast<uintptr_t>(&OwnerNode) >> 4))
 {
 	for (const auto& m2Bone : OwnerNode.getM2().getSkeleton().GetBones())
 		m_Bones.push_back(std::make_shared<CM2SkeletonBone3D>(m2Bone));
 
 	for (const auto& bone : m_Bones)
 		bone->SetParentAndChildsInternals(m_Bones);
+
+	m_RequiredBones.resize(m_Bones.size(), true);
+	m_PinnedBones.resize(m_Bones.size(), 0);
+
+	// Parent bone is always before child
+	std::vector<bool> isBillboard(m_Bones.size(), false);
+	const auto& m2Bones = OwnerNode.getM2().getSkeleton().GetBones();
+	for (size_t i = 0; i < m2Bones.size(); i++)
+	{
+		int32 parentBoneID = m2Bones[i].getParentBoneID();
+		isBillboard[i] = m2Bones[i].IsBillboard() || (parentBoneID != -1 && parentBoneID < static_cast<int32>(i) && isBillboard[parentBoneID]);
+		if (isBillboard[i])
+			m_BillboardBones.push_back(i);
+	}
 }
 
 CM2SkeletonComponent3D::~CM2SkeletonComponent3D()
@@ -119,6 +205,29 @@ std::vector<glm::mat4> CM2SkeletonComponent3D::CreatePose(size_t BoneStartIndex,
 	return result;
 }
 
+void CM2SkeletonComponent3D::WritePose(size_t BoneStartIndex, size_t BonesCount, glm::mat4* Pose) const
+{
+	const CM2_Comp_Skeleton& skeleton = GetM2OwnerNode().getM2().getSkeleton();
+	for (size_t i = 0; i < BonesCount; i++)
+	{
+		int16 boneIndex = skeleton.getBoneLookupIndex(BoneStartIndex + i);
+		Pose[i] = (boneIndex != -1) ? m_Bones[boneIndex]->GetMatrix() : glm::mat4(1.0f);
+	}
+}
+
+void CM2SkeletonComponent3D::PinBone(size_t Index)
+{
+	_ASSERT(Index < m_PinnedBones.size());
+	m_PinnedBones[Index]++;
+}
+
+void CM2SkeletonComponent3D::UnpinBone(size_t Index)
+{
+	_ASSERT(Index < m_PinnedBones.size());
+	_ASSERT(m_PinnedBones[Index] > 0);
+	m_PinnedBones[Index]--;
+}
+
 //
 // ISkeletonComponent3D
 //
@@ -130,11 +239,20 @@ std::shared_ptr<ISkeletonBone3D> CM2SkeletonComponent3D::GetBone(size_t Index) c
 
 void CM2SkeletonComponent3D::Update(const UpdateEventArgs & e)
 {
-	for (const auto& b : m_Bones)
-		b->Reset();
+	m_UpdateInterval = m_AnimationLOD.GetUpdateInterval(GetM2OwnerNode(), e.CameraForCulling);
+	uint32 frameInWindow = (m_FrameCounter++ + m_FramePhase) % m_UpdateInterval;
 
-	for (const auto& b : m_Bones)
-		b->Calculate(&GetM2OwnerNode(), e.CameraForCulling, static_cast<uint32>(e.TotalTime));
+	if (frameInWindow == 0)
+	{
+		CalculatePose(e);
+	}
+	else
+	{
+		float factor = static_cast<float>(frameInWindow) / static_cast<float>(m_UpdateInterval);
+		for (const auto& b : m_Bones)
+			b->InterpolatePose(factor);
+		CalculateBillboardBones(e);
+	}
 
 	// TODO: Fix me
 	const_cast<CM2_Base_Instance&>(GetM2OwnerNode()).UpdateAttachPositionAfterSkeletonUpdate();
@@ -147,3 +265,71 @@ const CM2_Base_Instance& CM2SkeletonComponent3D::GetM2OwnerNode() const
 {
 	return reinterpret_cast<const CM2_Base_Instance&>(GetOwnerNode());
 }
+
+void CM2SkeletonComponent3D::CalculatePose(const UpdateEventArgs& e)
+{
+	for (const auto& b : m_Bones)
+		b->Reset();
+
+	if (m_AnimationLOD.IsBonesCullingEnabled())
+	{
+		const auto& skins = GetM2OwnerNode().getM2().GetSkins();
+		UpdateRequiredBones(GetM2OwnerNode().getActiveSkin(skins.empty() ? nullptr : skins.front().get()));
+	}
+	else
+		std::fill(m_RequiredBones.begin(), m_RequiredBones.end(), true);
+
+	for (size_t i = 0; i < m_Bones.size(); i++)
+		if (m_RequiredBones[i])
+			m_Bones[i]->Calculate(&GetM2OwnerNode(), e.CameraForCulling, static_cast<uint32>(e.TotalTime));
+
+	for (const auto& b : m_Bones)
+		b->PushPoseKey();
+
+	// On reduced rate palette is one update behind: interpolate from previous key to the new one
+	if (m_UpdateInterval > 1)
+	{
+		for (const auto& b : m_Bones)
+			b->InterpolatePose(0.0f);
+		CalculateBillboardBones(e);
+	}
+}
+
+void CM2SkeletonComponent3D::UpdateRequiredBones(const CM2_Skin* ActiveSkin)
+{
+	const CM2& m2Model = GetM2OwnerNode().getM2();
+	if (ActiveSkin == nullptr)
+	{
+		std::fill(m_RequiredBones.begin(), m_RequiredBones.end(), true);
+		return;
+	}
+
+	for (size_t i = 0; i < m_RequiredBones.size(); i++)
+		m_RequiredBones[i] = m_PinnedBones[i] > 0;
+
+	// Bones of visible geosets of drawn LOD skin. Parent bones are calculated anyway by CM2SkeletonBone3D::Calculate
+	for (const auto& section : ActiveSkin->GetSections())
+	{
+		if (!GetM2OwnerNode().isMeshEnabled(section->getProto().meshPartID))
+			continue;
+
+		for (const auto& boneIndex : section->GetUsedBones())
+			m_RequiredBones[boneIndex] = true;
+	}
+
+	// Particles emitters
+	for (const auto& particleSystem : m2Model.getMiscellaneous().GetParticles())
+		if (particleSystem->GetBone() != -1)
+			m_RequiredBones[particleSystem->GetBone()] = true;
+}
+
+void CM2SkeletonComponent3D::CalculateBillboardBones(const UpdateEventArgs& e)
+{
+	// Interpolated billboard faces to old camera position. Bone is calculated again with interpolated parent.
+	for (const auto& boneIndex : m_BillboardBones)
+		m_Bones[boneIndex]->Reset();
+
+	for (const auto& boneIndex : m_BillboardBones)
+		if (m_RequiredBones[boneIndex])
+			m_Bones[boneIndex]->Calculate(&GetM2OwnerNode(), e.CameraForCulling, static_cast<uint32>(e.TotalTime));
+}
@@ -3,6 +3,7 @@
 class CM2;
 class CM2_Base_Instance;
 #include "M2/M2_Part_Bone.h"
+#include "M2/M2_AnimationLOD.h"
 
 
 //
@@ -28,6 +29,22 @@ public:
 	void Calculate(const CM2_Base_Instance* M2Instance, const ICameraComponent3D* Camera, uint32 GlobalTime);
 	void Reset();
 
+	// Animation LOD
+	void PushPoseKey();
+	void InterpolatePose(float Factor);
+
+private:
+	// Decomposed pose key. Matrices are interpolated as translation, rotation (slerp) and scale
+	struct SPoseKey
+	{
+		glm::vec3 Translate;
+		glm::quat Rotate;
+		glm::vec3 Scale;
+	};
+
+	static SPoseKey DecomposePoseKey(const glm::mat4& Matrix);
+	static glm::mat4 InterpolatePoseKeys(const SPoseKey& From, const SPoseKey& To, float Factor);
+
 private:
 	const SM2_Part_Bone_Wrapper&                   m_M2Bone;
 	std::weak_ptr<ISkeletonBone3D>                 m_ParentBone;
@@ -36,6 +53,11 @@ private:
 	glm::mat4                                      m_Matrix;
 	glm::mat4                                      m_RotateMatrix;
 	bool                                           m_IsCalculated;
+
+	// Two last calculated poses (for animation LOD)
+	SPoseKey                                       m_PoseKeyMatrix[2];
+	SPoseKey                                       m_PoseKeyRotateMatrix[2];
+	bool                                           m_HasPoseKeys;
 };
 
 
@@ -52,6 +74,9 @@ public:
 	virtual ~CM2SkeletonComponent3D();
 
 	std::vector<glm::mat4> CreatePose(size_t BoneStartIndex, size_t BonesCount) const;
+	void WritePose(size_t BoneStartIndex, size_t BonesCount, glm::mat4* Pose) const; // Unused lookup entries are identity
+	void PinBone(size_t Index);   // Bone is calculated, while at least one pin is alive
+	void UnpinBone(size_t Index);
 
 	// ISkeletonComponent3D
 	std::shared_ptr<ISkeletonBone3D> GetBone(size_t Index) const override;
@@ -61,7 +86,19 @@ public:
 
 protected:
 	const CM2_Base_Instance& GetM2OwnerNode() const;
+	void CalculatePose(const UpdateEventArgs& e);
+	void UpdateRequiredBones(const CM2_Skin* ActiveSkin);
+	void CalculateBillboardBones(const UpdateEventArgs& e);
 
 private:
 	std::vector<std::shared_ptr<CM2SkeletonBone3D>> m_Bones;
+
+	// Animation LOD
+	CM2_AnimationLOD                                m_AnimationLOD;
+	uint32                                          m_UpdateInterval;
+	uint32                                          m_FrameCounter;
+	uint32                                          m_FramePhase;
+	std::vector<bool>                               m_RequiredBones;
+	std::vector<uint32>                             m_PinnedBones; // Pins count of bones used by attached instances
+	std::vector<size_t>                             m_BillboardBones; // Billboards and their childs. Are calculated every frame, because depend on camera
 };
\ No newline at end of file
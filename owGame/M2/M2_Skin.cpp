@@ -10,12 +10,67 @@
 // Additional
 #include "M2_Part_Material.h"
 
+namespace
+{
+	uint16 PackHalf(float Value)
+	{
+		uint32 bits;
+		memcpy(&bits, &Value, sizeof(float));
+
+		uint16 sign = static_cast<uint16>((bits >> 16) & 0x8000u);
+		int32 exponent = static_cast<int32>((bits >> 23) & 0xFFu) - 127 + 15;
+		uint32 mantissa = bits & 0x007FFFFFu;
+
+		if (exponent <= 0) // Denormals and zero
+		{
+			if (exponent < -10)
+				return sign;
+			mantissa |= 0x00800000u;
+			return sign | static_cast<uint16>((mantissa + (1u << (13 - exponent))) >> (14 - exponent));
+		}
+
+		if (exponent >= 31) // Overflow, inf and nan are not expected in texture coordinates
+			return sign | 0x7BFFu;
+
+		uint32 half = (static_cast<uint32>(exponent) << 10) | (mantissa >> 13);
+		half += (mantissa >> 12) & 1u; // Round, can carry to exponent
+		return sign | static_cast<uint16>(glm::min(half, 0x7BFFu));
+	}
+
+	int16 PackSnorm(float Value)
+	{
+		return static_cast<int16>(glm::round(glm::clamp(Value, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	void PackOctahedronNormal(const glm::vec3& Normal, int16* Packed)
+	{
+		float length = glm::abs(Normal.x) + glm::abs(Normal.y) + glm::abs(Normal.z);
+		if (length < 1e-6f)
+		{
+			Packed[0] = 0;
+			Packed[1] = 0;
+			return;
+		}
+
+		glm::vec2 octahedron = glm::vec2(Normal.x, Normal.y) / length;
+		if (Normal.z < 0.0f)
+		{
+			glm::vec2 signNotZero(octahedron.x >= 0.0f ? 1.0f : -1.0f, octahedron.y >= 0.0f ? 1.0f : -1.0f);
+			octahedron = (1.0f - glm::abs(glm::vec2(octahedron.y, octahedron.x))) * signNotZero;
+		}
+
+		Packed[0] = PackSnorm(octahedron.x);
+		Packed[1] = PackSnorm(octahedron.y);
+	}
+}
+
 CM2_Skin::CM2_Skin(IBaseManager& BaseManager, IRenderDevice& RenderDevice, const CM2& M2Model, const SM2_SkinProfile& M2SkinProfile)
 	: ModelProxie(RenderDevice.GetObjectsFactory().CreateModel())
 	, m_BaseManager(BaseManager)
 	, m_RenderDevice(RenderDevice)
 	, m_M2Model(M2Model)
 	, m_M2SkinProfile(M2SkinProfile)
+	, m_BonesLookupCount(0)
 {}
 
 CM2_Skin::~CM2_Skin()
@@ -32,33 +87,106 @@ void CM2_Skin::Load(const SM2_Header& M2Header, const std::shared_ptr<IFile>& Fi
 
 	_ASSERT(m_M2SkinProfile.vertices.size == m_M2SkinProfile.bones.size);
 
-	for (uint32 sectionIndex = 0; sectionIndex < m_M2SkinProfile.submeshes.size; sectionIndex++)
+	const SM2_SkinBatch* skinBatchesProtos = (const SM2_SkinBatch*)(File->getData() + m_M2SkinProfile.batches.offset);
+
+	// VERTICES: all sections share one vertex buffer
+
+	std::vector<SM2_Vertex_znEngine> zenonVertices;
+	zenonVertices.resize(m_M2SkinProfile.vertices.size);
+	for (uint32 i = 0; i < m_M2SkinProfile.vertices.size; i++)
 	{
-		const SM2_SkinSection& sectionProto = t_sections[sectionIndex];
+		const SM2_Vertex& m2Vertex = Vertices[t_verticesIndexes[i]];
+		const SM2_SkinBones& m2Bones = t_bonesIndexes[i];
+
+		SM2_Vertex_znEngine& vertex = zenonVertices[i];
+		vertex.pos = m2Vertex.pos;
+		PackOctahedronNormal(m2Vertex.normal, vertex.normal);
 
-		std::vector<SM2_Vertex> vertexes;
-		vertexes.resize(sectionProto.vertexCount);
-		for (uint32 i = 0; i < sectionProto.vertexCount; i++)
+		for (size_t j = 0; j < 2; j++)
 		{
-			size_t indexIntoVertices = static_cast<size_t>(sectionProto.vertexStart) + static_cast<size_t>(i);
+			vertex.tex_coords[j][0] = PackHalf(m2Vertex.tex_coords[j].x);
+			vertex.tex_coords[j][1] = PackHalf(m2Vertex.tex_coords[j].y);
+		}
 
-			_ASSERT(indexIntoVertices < m_M2SkinProfile.vertices.size);
-			SM2_Vertex newVertex = Vertices[t_verticesIndexes[indexIntoVertices]];
+		for (size_t j = 0; j < 4; j++)
+		{
+			vertex.bone_weights[j] = m2Vertex.bone_weights[j];
+			vertex.bone_indices[j] = m2Bones.index[j]; // Index into section bones
+		}
+	}
 
-			_ASSERT(indexIntoVertices < m_M2SkinProfile.bones.size);
-			const SM2_SkinBones& newBones = t_bonesIndexes[indexIntoVertices];
+	// INDEXES: sections ranges in one index buffer. Consecutive sections, that can be drawn with one call, are merged.
 
-			for (uint16 bone = 0; bone < sectionProto.boneInfluences; bone++)
+	std::vector<std::vector<uint32>> sectionsBatches(m_M2SkinProfile.submeshes.size);
+	for (uint32 i = 0; i < m_M2SkinProfile.batches.size; i++)
+	{
+		_ASSERT(skinBatchesProtos[i].skinSectionIndex < m_M2SkinProfile.submeshes.size);
+		sectionsBatches[skinBatchesProtos[i].skinSectionIndex].push_back(i);
+	}
+
+	auto isBatchesEqual = [](const SM2_SkinBatch& Left, const SM2_SkinBatch& Right) -> bool {
+		return memcmp(&Left.flags, &Right.flags, sizeof(SM2_SkinBatch::Flags)) == 0 &&
+			Left.priorityPlane == Right.priorityPlane &&
+			Left.shader_id == Right.shader_id &&
+			Left.colorIndex == Right.colorIndex &&
+			Left.materialIndex == Right.materialIndex &&
+			Left.materialLayer == Right.materialLayer &&
+			Left.textureCount == Right.textureCount &&
+			Left.texture_Index == Right.texture_Index &&
+			Left.texture_CoordIndex == Right.texture_CoordIndex &&
+			Left.texture_WeightIndex == Right.texture_WeightIndex &&
+			Left.texture_TransformIndex == Right.texture_TransformIndex;
+	};
+
+	auto isSectionsMergeable = [&](uint32 Left, uint32 Right) -> bool {
+		const SM2_SkinSection& left = t_sections[Left];
+		const SM2_SkinSection& right = t_sections[Right];
+
+		// Same geoset, same bones palette and one equal material
+		return left.meshPartID == right.meshPartID &&
+			left.bonesStartIndex == right.bonesStartIndex &&
+			left.boneCount == right.boneCount &&
+			left.boneInfluences == right.boneInfluences &&
+			sectionsBatches[Left].size() == 1 && sectionsBatches[Right].size() == 1 &&
+			isBatchesEqual(skinBatchesProtos[sectionsBatches[Left][0]], skinBatchesProtos[sectionsBatches[Right][0]]);
+	};
+
+	std::vector<uint16> indexes;
+	indexes.reserve(m_M2SkinProfile.indices.size);
+
+	std::vector<bool> isMergedSection(m_M2SkinProfile.submeshes.size, false);
+	std::vector<uint32> sectionsIndexStart(m_M2SkinProfile.submeshes.size);
+	std::vector<uint32> sectionsBaseVertex(m_M2SkinProfile.submeshes.size);
+	std::vector<std::pair<uint32, uint32>> groups; // First section and sections count
+
+	for (uint32 sectionIndex = 0; sectionIndex < m_M2SkinProfile.submeshes.size; sectionIndex++)
+	{
+		const SM2_SkinSection& sectionProto = t_sections[sectionIndex];
+
+		uint32 baseVertex = sectionProto.vertexStart;
+		if (false == groups.empty())
+		{
+			auto& lastGroup = groups.back();
+			const SM2_SkinSection& groupProto = t_sections[lastGroup.first];
+			if (isSectionsMergeable(lastGroup.first, sectionIndex) && sectionProto.vertexStart >= groupProto.vertexStart)
 			{
-				_ASSERT(newBones.index[bone] < sectionProto.boneCount);
-				newVertex.bone_indices[bone] = newBones.index[bone];
+				lastGroup.second++;
+				isMergedSection[sectionIndex] = true;
+				baseVertex = groupProto.vertexStart;
+			}
+			else
+			{
+				groups.push_back(std::make_pair(sectionIndex, 1u));
 			}
-
-			vertexes[i] = newVertex;
 		}
+		else
+		{
+			groups.push_back(std::make_pair(sectionIndex, 1u));
+		}
+
+		sectionsIndexStart[sectionIndex] = static_cast<uint32>(indexes.size());
+		sectionsBaseVertex[sectionIndex] = baseVertex;
 
-		std::vector<uint16> indexes;
-		indexes.resize(sectionProto.indexCount);
 		for (uint16 i = 0; i < sectionProto.indexCount; i++)
 		{
 			size_t indexIntoIndexes = static_cast<size_t>(sectionProto.indexStart) + static_cast<size_t>(i);
@@ -67,10 +195,45 @@ void CM2_Skin::Load(const SM2_Header& M2Header, const std::shared_ptr<IFile>& Fi
 
 			_ASSERT(index >= sectionProto.vertexStart);
 			_ASSERT(index < sectionProto.vertexStart + sectionProto.vertexCount);
-			indexes[i] = index - sectionProto.vertexStart;
+			indexes.push_back(index - baseVertex);
 		}
 
-		m_Sections.push_back(std::make_shared<CM2_SkinSection>(m_RenderDevice, m_M2Model, sectionIndex, sectionProto, vertexes, indexes));
+		for (uint32 i = sectionProto.vertexStart; i < static_cast<uint32>(sectionProto.vertexStart) + sectionProto.vertexCount; i++)
+			for (uint16 bone = 0; bone < sectionProto.boneInfluences; bone++)
+				_ASSERT(zenonVertices[i].bone_indices[bone] < sectionProto.boneCount);
+	}
+
+	std::shared_ptr<IBuffer> vertexBuffer = m_RenderDevice.GetObjectsFactory().CreateVoidVertexBuffer(zenonVertices.data(), zenonVertices.size(), 0, sizeof(SM2_Vertex_znEngine));
+	std::shared_ptr<IBuffer> indexBuffer = m_RenderDevice.GetObjectsFactory().CreateIndexBuffer(indexes);
+
+	for (uint32 sectionIndex = 0; sectionIndex < m_M2SkinProfile.submeshes.size; sectionIndex++)
+	{
+		const SM2_SkinSection& sectionProto = t_sections[sectionIndex];
+
+		std::shared_ptr<CM2_SkinSection> section = std::make_shared<CM2_SkinSection>(m_RenderDevice, m_M2Model, sectionIndex, sectionProto, vertexBuffer, indexBuffer);
+		section->SetDrawRange(sectionsIndexStart[sectionIndex], sectionProto.indexCount, sectionsBaseVertex[sectionIndex], sectionProto.vertexCount);
+		m_Sections.push_back(section);
+
+		m_BonesLookupCount = glm::max<uint32>(m_BonesLookupCount, static_cast<uint32>(sectionProto.bonesStartIndex) + sectionProto.boneCount);
+	}
+
+	// First section of the group draws whole group
+	for (const auto& group : groups)
+	{
+		if (group.second == 1)
+			continue;
+
+		const SM2_SkinSection& firstProto = t_sections[group.first];
+
+		uint32 indexCount = 0;
+		uint32 vertexEnd = 0;
+		for (uint32 i = group.first; i < group.first + group.second; i++)
+		{
+			indexCount += t_sections[i].indexCount;
+			vertexEnd = glm::max<uint32>(vertexEnd, static_cast<uint32>(t_sections[i].vertexStart) + t_sections[i].vertexCount);
+		}
+
+		m_Sections[group.first]->SetDrawRange(sectionsIndexStart[group.first], indexCount, firstProto.vertexStart, vertexEnd - firstProto.vertexStart);
 	}
 
 	//--
@@ -83,7 +246,6 @@ void CM2_Skin::Load(const SM2_Header& M2Header, const std::shared_ptr<IFile>& Fi
 	// BATCHES
 
 
-	const SM2_SkinBatch* skinBatchesProtos = (const SM2_SkinBatch*)(File->getData() + m_M2SkinProfile.batches.offset);
 	for (uint32 i = 0; i < m_M2SkinProfile.batches.size; i++)
 	{
 		
@@ -97,6 +259,10 @@ void CM2_Skin::Load(const SM2_Header& M2Header, const std::shared_ptr<IFile>& Fi
 		//if (skinBatchObject->m_PriorityPlan != 0)
 		//	Log::Green("Test");
 
+		// Merged sections are drawn by the first section of the group
+		if (isMergedSection[skinBatchesProtos[i].skinSectionIndex])
+			continue;
+
 		m_TTT[skinBatchesProtos[i].skinSectionIndex].push_back(skinBatchObject);
 		/*auto& ttIter = m_TTT.find(m_Sections[skinBatchesProtos[i].skinSectionIndex]);
 		if (ttIter == m_TTT.end())
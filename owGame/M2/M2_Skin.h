@@ -29,6 +29,12 @@ public:
 		return m_TTT;
 	}
 
+	// Bones lookup entries used by all sections ('bonesStartIndex + boneCount' maximum)
+	uint32 GetBonesLookupCount() const
+	{
+		return m_BonesLookupCount;
+	}
+
 	// IModel
 	void Accept(IVisitor* visitor) override final;
 
@@ -37,6 +43,7 @@ private:
 	std::vector<std::shared_ptr<CM2_Skin_Batch>> m_Batches;   // 'Materials'
 
 	std::map<size_t, std::vector<std::shared_ptr<CM2_Skin_Batch>>> m_TTT;
+	uint32 m_BonesLookupCount;
 	
 private:
 	IBaseManager& m_BaseManager;
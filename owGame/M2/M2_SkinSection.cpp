@@ -7,20 +7,14 @@
 // General
 #include "M2_SkinSection.h"
 
-struct SM2_Vertex_BoneWeight
-{
-	float weights[4];
-};
-
-struct SM2_Vertex_BoneIndex
-{
-	uint32 indexes[4];
-};
-
-CM2_SkinSection::CM2_SkinSection(IRenderDevice& RenderDevice, const CM2& M2Model, const uint16 SkinSectionIndex, const SM2_SkinSection& SkinSectionProto, const std::vector<SM2_Vertex>& Vertexes, const std::vector<uint16>& Indexes)
+CM2_SkinSection::CM2_SkinSection(IRenderDevice& RenderDevice, const CM2& M2Model, const uint16 SkinSectionIndex, const SM2_SkinSection& SkinSectionProto, const std::shared_ptr<IBuffer>& VertexBuffer, const std::shared_ptr<IBuffer>& IndexBuffer)
 	: GeometryProxie(RenderDevice.GetObjectsFactory().CreateGeometry())
 	, m_SkinSectionIndex(SkinSectionIndex)
 	, m_SkinSectionProto(SkinSectionProto)
+	, m_IndexStart(0)
+	, m_IndexCount(SkinSectionProto.indexCount)
+	, m_BaseVertex(SkinSectionProto.vertexStart)
+	, m_VertexCount(SkinSectionProto.vertexCount)
 	, m_RenderDevice(RenderDevice)
 	, m_M2Model(M2Model)
 {
@@ -29,71 +23,21 @@ CM2_SkinSection::CM2_SkinSection(IRenderDevice& RenderDevice, const CM2& M2Model
 
 	m_PropertiesBuffer = RenderDevice.GetObjectsFactory().CreateConstantBuffer(nullptr, sizeof(ShaderM2GeometryProperties));
 
-
-	std::vector<SM2_Vertex_znEngine> zenonVertices;
-	zenonVertices.resize(Vertexes.size());
-	for (size_t i = 0; i < Vertexes.size(); i++)
-	{
-		const auto& m2Vertex = Vertexes[i];
-
-		SM2_Vertex_znEngine vertex;
-		vertex.pos = m2Vertex.pos;
-		vertex.normal = m2Vertex.normal;
-		vertex.tex_coords[0] = m2Vertex.tex_coords[0];
-		vertex.tex_coords[1] = m2Vertex.tex_coords[1];
-
-		for (size_t j = 0; j < 4; j++)
-		{
-			_ASSERT(m2Vertex.bone_indices[j] < m_SkinSectionProto.boneCount);
-
-			vertex.bone_weights.weights[j] = static_cast<float>(m2Vertex.bone_weights[j]) / 255.0f;
-			vertex.bone_indices.indexes[j] = m2Vertex.bone_indices[j];
-		}
-
-		zenonVertices[i] = vertex;
-	}
-
-	/*std::vector<vec3> verts;
-	std::vector<SM2_Vertex_BoneWeight> weights;
-	std::vector<SM2_Vertex_BoneIndex> indexes;
-	std::vector<vec3> normals;
-	std::vector<vec2> tex0;
-	std::vector<vec2> tex1;
-
-	for (const auto& it : Vertexes)
-	{
-		SM2_Vertex_BoneWeight m2_weights;
-		SM2_Vertex_BoneIndex m2_indexes;
-		for (size_t i = 0; i < 4; i++)
-		{
-			m2_weights.weights[i] = static_cast<float>(it.bone_weights[i]) / 255.0f;
-			m2_indexes.indexes[i] = it.bone_indices[i];
-
-			_ASSERT(it.bone_indices[i] < m_SkinSectionProto.boneCount);
-		}
-
-		verts.push_back(it.pos);
-		weights.push_back(m2_weights);
-		indexes.push_back(m2_indexes);
-		normals.push_back(it.normal);
-		tex0.push_back(it.tex_coords[0]);
-		tex1.push_back(it.tex_coords[1]);
-	}*/
-
-	SetVertexBuffer(RenderDevice.GetObjectsFactory().CreateVoidVertexBuffer(zenonVertices.data(), zenonVertices.size(), 0, sizeof(SM2_Vertex_znEngine)));
-
-	/*AddVertexBuffer(BufferBinding("POSITION", 0), RenderDevice.GetObjectsFactory().CreateVoidVertexBuffer(verts.data(), verts.size(), 0, sizeof(vec3)));
-	AddVertexBuffer(BufferBinding("BLENDWEIGHT", 0), RenderDevice.GetObjectsFactory().CreateVoidVertexBuffer(weights.data(), weights.size(), 0, sizeof(SM2_Vertex_BoneWeight)));
-	AddVertexBuffer(BufferBinding("BLENDINDICES", 0), RenderDevice.GetObjectsFactory().CreateVoidVertexBuffer(indexes.data(), indexes.size(), 0, sizeof(SM2_Vertex_BoneIndex)));
-	AddVertexBuffer(BufferBinding("NORMAL", 0), RenderDevice.GetObjectsFactory().CreateVoidVertexBuffer(normals.data(), normals.size(), 0, sizeof(vec3)));
-	AddVertexBuffer(BufferBinding("TEXCOORD", 0), RenderDevice.GetObjectsFactory().CreateVoidVertexBuffer(tex0.data(), tex0.size(), 0, sizeof(vec2)));
-	AddVertexBuffer(BufferBinding("TEXCOORD", 1), RenderDevice.GetObjectsFactory().CreateVoidVertexBuffer(tex1.data(), tex1.size(), 0, sizeof(vec2)));*/
-	SetIndexBuffer(RenderDevice.GetObjectsFactory().CreateIndexBuffer(Indexes));
+	// Buffers are shared by all sections of the skin
+	SetVertexBuffer(VertexBuffer);
+	SetIndexBuffer(IndexBuffer);
 
 	if (m_SkinSectionProto.boneCount > 0)
 	{
 		m_BonesList.resize(m_SkinSectionProto.boneCount);
 		m_StructuredBuffer = m_RenderDevice.GetObjectsFactory().CreateStructuredBuffer(m_BonesList, CPUAccess::Write);
+
+		for (uint16 i = 0; i < m_SkinSectionProto.boneCount; i++)
+		{
+			int16 boneIndex = m_M2Model.getSkeleton().getBoneLookupIndex(m_SkinSectionProto.bonesStartIndex + i);
+			if (boneIndex != -1)
+				m_UsedBones.push_back(static_cast<uint16>(boneIndex));
+		}
 	}
 }
 
@@ -104,8 +48,6 @@ CM2_SkinSection::~CM2_SkinSection()
 
 void CM2_SkinSection::UpdateGeometryProps(const RenderEventArgs& RenderEventArgs, const CM2_Base_Instance * M2Instance)
 {
-	M2Instance->getAnimator()->Update(RenderEventArgs.TotalTime, RenderEventArgs.DeltaTime);
-
 	bool isAnimated = m_M2Model.getSkeleton().hasBones() && m_M2Model.isAnimated();
 	m_Properties->gIsAnimated = isAnimated ? 1 : 0;
 	if (isAnimated)
@@ -133,14 +75,37 @@ void CM2_SkinSection::UpdateGeometryProps(const RenderEventArgs& RenderEventArgs
 		//	m_BonesList[i] = m_M2Model.getSkeleton().getBoneLookup(m_SkinSectionProto.bonesStartIndex + i)->getTransformMatrix();
 		//}
 
-		m_BonesList = M2Instance->getSkeletonComponent()->CreatePose(m_SkinSectionProto.bonesStartIndex, m_SkinSectionProto.boneCount);
-		_ASSERT(m_BonesList.size() == m_SkinSectionProto.boneCount);
-		m_StructuredBuffer->Set(m_BonesList);
+		// Instanced draw (M2Instance == nullptr) takes bones from per-instance palettes
+		if (M2Instance != nullptr)
+		{
+			m_BonesList = M2Instance->getSkeletonComponent()->CreatePose(m_SkinSectionProto.bonesStartIndex, m_SkinSectionProto.boneCount);
+			_ASSERT(m_BonesList.size() == m_SkinSectionProto.boneCount);
+			m_StructuredBuffer->Set(m_BonesList);
+		}
 	}
 
 	m_PropertiesBuffer->Set(m_Properties, sizeof(ShaderM2GeometryProperties));
 }
 
+void CM2_SkinSection::SetDrawRange(uint32 IndexStart, uint32 IndexCount, uint32 BaseVertex, uint32 VertexCount)
+{
+	m_IndexStart = IndexStart;
+	m_IndexCount = IndexCount;
+	m_BaseVertex = BaseVertex;
+	m_VertexCount = VertexCount;
+}
+
+SGeometryDrawArgs CM2_SkinSection::GetDrawArgs(UINT InstancesCnt) const
+{
+	SGeometryDrawArgs geometryDrawArgs = { 0 };
+	geometryDrawArgs.IndexStartLocation = m_IndexStart;
+	geometryDrawArgs.IndexCnt = m_IndexCount;
+	geometryDrawArgs.VertexStartLocation = m_BaseVertex;
+	geometryDrawArgs.VertexCnt = m_VertexCount;
+	geometryDrawArgs.InstanceCnt = InstancesCnt;
+	return geometryDrawArgs;
+}
+
 const std::shared_ptr<IConstantBuffer>& CM2_SkinSection::GetGeometryPropsBuffer() const
 {
 	return m_PropertiesBuffer;
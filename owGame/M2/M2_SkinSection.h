@@ -12,15 +12,20 @@ class CM2_SkinSection
 	: public GeometryProxie
 {
 public:
-	CM2_SkinSection(IRenderDevice& RenderDevice, const CM2& M2Model, const uint16 SkinSectionIndex, const SM2_SkinSection& SkinSectionProto, const std::vector<SM2_Vertex>& Vertexes, const std::vector<uint16>& Indexes);
+	CM2_SkinSection(IRenderDevice& RenderDevice, const CM2& M2Model, const uint16 SkinSectionIndex, const SM2_SkinSection& SkinSectionProto, const std::shared_ptr<IBuffer>& VertexBuffer, const std::shared_ptr<IBuffer>& IndexBuffer);
 	virtual ~CM2_SkinSection();
 
 	void UpdateGeometryProps(const RenderEventArgs& RenderEventArgs, const CM2_Base_Instance* M2Instance);
 	const std::shared_ptr<IConstantBuffer>& GetGeometryPropsBuffer() const;
 	const std::shared_ptr<IStructuredBuffer>& GetGeometryBonesBuffer() const;
 
+	// Range of the section (or merged sections) in the skin buffers. Indexes are relative to 'BaseVertex'.
+	void SetDrawRange(uint32 IndexStart, uint32 IndexCount, uint32 BaseVertex, uint32 VertexCount);
+	SGeometryDrawArgs GetDrawArgs(UINT InstancesCnt = UINT32_MAX) const;
+
 	uint16                  getIndex() const { return m_SkinSectionIndex; }
 	const SM2_SkinSection&  getProto() const { return m_SkinSectionProto; }
+	const std::vector<uint16>& GetUsedBones() const { return m_UsedBones; } // Direct indexes of the bones referenced by this section
 
 	bool operator<(const CM2_SkinSection& other) const
 	{
@@ -34,6 +39,12 @@ public:
 private:
 	const uint16            m_SkinSectionIndex;
 	const SM2_SkinSection   m_SkinSectionProto;
+	std::vector<uint16>     m_UsedBones;
+
+	uint32                  m_IndexStart;
+	uint32                  m_IndexCount;
+	uint32                  m_BaseVertex;
+	uint32                  m_VertexCount;
 
 private:
 	__declspec(align(16)) struct ShaderM2GeometryProperties
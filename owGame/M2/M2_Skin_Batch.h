@@ -21,6 +21,7 @@ public:
 
 	const std::shared_ptr<const CM2_Part_Material>& GetM2Material() const {	return m_M2ModelMaterial; }
 	void UpdateMaterialProps(const RenderEventArgs& RenderEventArgs, const CM2_Base_Instance* M2Instance);
+	const SM2_SkinBatch& GetProto() const { return m_SkinBatchProto; }
 
 public:
 	int32												m_PriorityPlan;
@@ -122,19 +122,14 @@ struct SM2_Vertex
 	glm::vec2	tex_coords[2];		// 32-40, 40-48		// two DiffuseTextures, depending on shader used
 };
 
+// Packed GPU vertex (32 bytes). Weights and indexes are stored as in file, normal is octahedron encoded, UVs are half floats.
 struct SM2_Vertex_znEngine
 {
-	glm::vec3 pos;
-	struct
-	{
-		float weights[4];
-	} bone_weights;
-	struct
-	{
-		uint32 indexes[4];
-	} bone_indices;
-	glm::vec3 normal;
-	glm::vec2 tex_coords[2];
+	glm::vec3 pos;               // 0-12
+	uint8     bone_weights[4];   // 12-16     // unorm
+	uint8     bone_indices[4];   // 16-20     // index into section bones
+	int16     normal[2];         // 20-24     // snorm
+	uint16    tex_coords[2][2];  // 24-28, 28-32
 };
 
 #include __PACK_END
@@ -47,13 +47,7 @@ void CRenderPass_M2::DoRenderM2Model(const CM2_Base_Instance* M2SceneNode, const
 		if (!M2SceneNode->isMeshEnabled(meshPartID))
 			continue;
 
-		geom->UpdateGeometryProps(GetRenderEventArgs(), M2SceneNode);
-
-		m_ShaderM2GeometryParameter->SetConstantBuffer(geom->GetGeometryPropsBuffer());
-		m_ShaderM2GeometryParameter->Bind();
-		
-		m_ShaderM2GeometryBonesParameter->SetStructuredBuffer(geom->GetGeometryBonesBuffer());
-		m_ShaderM2GeometryBonesParameter->Bind();
+		BindSection(geom.get(), M2SceneNode);
 		{
 			std::shared_ptr<IGeometryInternal> geomInternal = std::dynamic_pointer_cast<IGeometryInternal>(geom);
 			geomInternal->Render_BindAllBuffers(GetRenderEventArgs(), vertexShader);
@@ -82,25 +76,34 @@ void CRenderPass_M2::DoRenderM2Model(const CM2_Base_Instance* M2SceneNode, const
 				mat->UpdateMaterialProps(GetRenderEventArgs(), M2SceneNode);
 				mat->Bind(shaders);
 				{
-					SGeometryDrawArgs geometryDrawArgs = { 0 };
-					//geometryDrawArgs.IndexStartLocation = geom->getProto().indexStart;
-					geometryDrawArgs.IndexCnt = geom->getProto().indexCount;
-					//geometryDrawArgs.VertexStartLocation = geom->getProto().vertexStart;
-					geometryDrawArgs.VertexCnt = geom->getProto().vertexCount;
-					geometryDrawArgs.InstanceCnt = InstancesCnt;
-					geomInternal->Render_Draw(geometryDrawArgs);
+					geomInternal->Render_Draw(geom->GetDrawArgs(InstancesCnt));
 				}
 				mat->Unbind(shaders);
 			}
 
 			geomInternal->Render_UnbindAllBuffers(GetRenderEventArgs(), vertexShader);
 		}
-		m_ShaderM2GeometryBonesParameter->Unbind();
-
-		m_ShaderM2GeometryParameter->Unbind();
+		UnbindSection(geom.get());
 	}
 }
 
+void CRenderPass_M2::BindSection(CM2_SkinSection* M2SkinSection, const CM2_Base_Instance* M2SceneNode)
+{
+	M2SkinSection->UpdateGeometryProps(GetRenderEventArgs(), M2SceneNode);
+
+	m_ShaderM2GeometryParameter->SetConstantBuffer(M2SkinSection->GetGeometryPropsBuffer());
+	m_ShaderM2GeometryParameter->Bind();
+
+	m_ShaderM2GeometryBonesParameter->SetStructuredBuffer(M2SkinSection->GetGeometryBonesBuffer());
+	m_ShaderM2GeometryBonesParameter->Bind();
+}
+
+void CRenderPass_M2::UnbindSection(CM2_SkinSection* M2SkinSection)
+{
+	m_ShaderM2GeometryBonesParameter->Unbind();
+	m_ShaderM2GeometryParameter->Unbind();
+}
+
 
 
 //
@@ -113,11 +116,8 @@ std::shared_ptr<IRenderPassPipelined> CRenderPass_M2::CreatePipeline(std::shared
 	//vertexShader->LoadInputLayoutFromReflector();
 	std::vector<SCustomVertexElement> elements;
 	elements.push_back({ 0, 0,  ECustomVertexElementType::FLOAT3, ECustomVertexElementUsage::POSITION, 0 });
-	elements.push_back({ 0, 12,  ECustomVertexElementType::FLOAT4, ECustomVertexElementUsage::BLENDWEIGHT, 0 });
-	elements.push_back({ 0, 28,  ECustomVertexElementType::FLOAT4, ECustomVertexElementUsage::BLENDINDICES, 0 });
-	elements.push_back({ 0, 44, ECustomVertexElementType::FLOAT3, ECustomVertexElementUsage::NORMAL, 0 });
-	elements.push_back({ 0, 56, ECustomVertexElementType::FLOAT2, ECustomVertexElementUsage::TEXCOORD, 0 });
-	elements.push_back({ 0, 68, ECustomVertexElementType::FLOAT2, ECustomVertexElementUsage::TEXCOORD, 1 });
+	elements.push_back({ 0, 12, ECustomVertexElementType::FLOAT2, ECustomVertexElementUsage::BLENDWEIGHT, 0 }); // Packed weights and indexes (raw bits, see SM2_Vertex_znEngine)
+	elements.push_back({ 0, 20, ECustomVertexElementType::FLOAT3, ECustomVertexElementUsage::NORMAL, 0 });      // Packed normal and texture coords (raw bits)
 	vertexShader->LoadInputLayoutFromCustomElements(elements);
 
 	std::shared_ptr<IShader> pixelShader = GetRenderDevice().GetObjectsFactory().CreateShader(EShaderType::PixelShader, "shaders_D3D/M2.hlsl", "PS_main");
@@ -177,7 +177,7 @@ EVisitResult CRenderPass_M2::Visit(const IModel* Model)
 {
 	if (const CM2_Skin* m2Skin = static_cast<const CM2_Skin*>(Model))
 	{
-		DoRenderM2Model(m_CurrentM2Model, m2Skin, m_OpaqueDraw);
+		DoRenderM2Model(m_CurrentM2Model, m_CurrentM2Model->getActiveSkin(m2Skin), m_OpaqueDraw);
 
 		return EVisitResult::AllowAll;
 	}
@@ -22,6 +22,12 @@ public:
 	// CRenderPass_M2
 	void DoRenderM2Model(const CM2_Base_Instance* M2SceneNode, const CM2_Skin* M2Model, bool OpaqueDraw, UINT InstancesCnt = UINT32_MAX);
 
+protected:
+	virtual void BindSection(CM2_SkinSection* M2SkinSection, const CM2_Base_Instance* M2SceneNode);
+	virtual void UnbindSection(CM2_SkinSection* M2SkinSection);
+
+public:
+
 	// IRenderPassPipelined
 	virtual std::shared_ptr<IRenderPassPipelined> CreatePipeline(std::shared_ptr<IRenderTarget> RenderTarget, const Viewport* Viewport) override;
 
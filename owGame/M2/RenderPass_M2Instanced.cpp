@@ -15,12 +15,64 @@
 
 // Additional (meshes)
 #include "M2_Skin_Batch.h"
+#include "ShaderResolver.h"
+#include "WowParallel.h"
 
+#include <chrono>
+
+namespace
+{
+	const size_t cInitialInstancesCount = 1000;
+	const size_t cInitialInstancesBonesCount = 1000 * 64;
+	const uint64 cDrawStatisticsLogInterval = 100;
+	const size_t cMinSkinDrawsPerTask = 64;
+
+	// Opaque: pass (1) | blend mode (7) | combiner (6) | depth & cull states (3) | skin draw (16) | section (15) | textures set (16)
+	uint64 MakeOpaqueKey(const CM2_Skin_Batch& Batch, uint32 SkinDrawIndex, uint32 SectionIndex)
+	{
+		uint64 texturesSet = 0;
+		for (const auto& texture : Batch.m_Textures)
+			texturesSet = texturesSet * 31 + reinterpret_cast<uintptr_t>(texture.lock().get());
+		texturesSet ^= (texturesSet >> 32) ^ (texturesSet >> 16);
+
+		uint64 key = 0;
+		key |= (static_cast<uint64>(Batch.GetM2Material()->getBlendMode()) & 0x7F) << 56;
+		key |= (static_cast<uint64>(GetPixel(Batch.GetProto())) & 0x3F) << 50;
+		key |= (static_cast<uint64>(Batch.GetM2Material()->getStatesID()) & 0x07) << 47;
+		key |= (static_cast<uint64>(SkinDrawIndex) & 0xFFFF) << 31;
+		key |= (static_cast<uint64>(SectionIndex) & 0x7FFF) << 16;
+		key |= (texturesSet & 0xFFFF);
+		return key;
+	}
+
+	// Transparent: pass (1) | inverted distance (24) | skin draw (16) | priority plane (8) | batch order in skin (15)
+	// Skin draws go back to front, priority plane orders batches only inside of one skin draw.
+	uint64 MakeTransparentKey(int32 PriorityPlane, float Distance, uint32 SkinDrawIndex, uint32 BatchOrder)
+	{
+		uint64 priority = static_cast<uint64>(glm::clamp(PriorityPlane, -128, 127) + 128);
+		uint64 distance = static_cast<uint64>(glm::clamp(Distance * 16.0f, 0.0f, static_cast<float>(0xFFFFFF)));
+
+		uint64 key = 1ull << 63;
+		key |= ((0xFFFFFF - distance) & 0xFFFFFF) << 39;
+		key |= (static_cast<uint64>(SkinDrawIndex) & 0xFFFF) << 23;
+		key |= (priority & 0xFF) << 15;
+		key |= (static_cast<uint64>(BatchOrder) & 0x7FFF);
+		return key;
+	}
+}
 
 CRenderPass_M2_Instanced::CRenderPass_M2_Instanced(IRenderDevice & RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneCreateTypedListsPass, bool OpaqueDraw)
 	: CRenderPass_M2(RenderDevice, SceneCreateTypedListsPass, OpaqueDraw)
+	, m_FrameIndex(0)
+	, m_IsInstancesGroupsChanged(true)
 {
-	m_InstancesBuffer = GetRenderDevice().GetObjectsFactory().CreateStructuredBuffer(nullptr, 1000, sizeof(M2PerObject), CPUAccess::Write);
+	m_InstancesBuffer = GetRenderDevice().GetObjectsFactory().CreateStructuredBuffer(nullptr, cInitialInstancesCount, sizeof(M2PerInstance), CPUAccess::Write);
+	m_InstancesBonesBuffer = GetRenderDevice().GetObjectsFactory().CreateStructuredBuffer(nullptr, cInitialInstancesBonesCount, sizeof(glm::mat4), CPUAccess::Write);
+	m_InstancesRangeBuffer = GetRenderDevice().GetObjectsFactory().CreateConstantBuffer(nullptr, sizeof(ShaderM2InstancesRange));
+
+	std::shared_ptr<ISettingGroup> wowSettings = RenderDevice.GetBaseManager().GetManager<ISettings>()->GetGroup("WoWSettings");
+	m_DrawStatisticsLog = wowSettings->GetSettingT<bool>("M2_DrawStatistics_Log");
+	m_NullDeviceReplay = wowSettings->GetSettingT<bool>("Render_NullDeviceReplay");
 }
 
 CRenderPass_M2_Instanced::~CRenderPass_M2_Instanced()
@@ -29,43 +81,39 @@ CRenderPass_M2_Instanced::~CRenderPass_M2_Instanced()
 
 void CRenderPass_M2_Instanced::Render(RenderEventArgs & e)
 {
-	std::unordered_map<const CM2_Skin*, std::vector<const CM2_Base_Instance*>> modelPriorMap;
+	auto recordStart = std::chrono::high_resolution_clock::now();
 
-	for (const auto& acceptableNodeType : GetAcceptableNodeTypes())
-	{
-		if (GetSceneNodeListPass()->HasModelsList(acceptableNodeType))
-		{
-			for (const auto& it : GetSceneNodeListPass()->GetModelsList(acceptableNodeType))
-			{
-				modelPriorMap[static_cast<const CM2_Skin*>(it.Model)].push_back(static_cast<const CM2_Base_Instance*>(it.SceneNode));
-			}
-		}
-	}
+	UpdateInstancesLists();
+	UploadInstances(e.Camera->GetTranslation());
+	RecordCommands();
 
-	for (const auto& it : modelPriorMap)
-	{
-		std::vector<M2PerObject> instances;
-		instances.reserve(it.second.size());
-		std::for_each(it.second.begin(), it.second.end(), [&instances](const CM2_Base_Instance* sceneNode) {
-			instances.push_back(M2PerObject(sceneNode->GetWorldTransfom(), sceneNode->getColor())); 
-		});
-
-		if (instances.size() > m_InstancesBuffer->GetElementCount())
-			m_InstancesBuffer = GetRenderDevice().GetObjectsFactory().CreateStructuredBuffer(instances, CPUAccess::Write);
-		else
-			m_InstancesBuffer->Set(instances);
+	auto replayStart = std::chrono::high_resolution_clock::now();
 
+	if (false == m_Commands.empty() && false == m_NullDeviceReplay->Get())
+	{
 		m_ShaderInstancesBufferParameter->SetStructuredBuffer(m_InstancesBuffer);
 		m_ShaderInstancesBufferParameter->Bind();
+
+		m_ShaderInstancesBonesBufferParameter->SetStructuredBuffer(m_InstancesBonesBuffer);
+		m_ShaderInstancesBonesBufferParameter->Bind();
 		{
-			DoRenderM2Model(*it.second.begin(), it.first, m_OpaqueDraw, instances.size());
+			ReplayCommands();
 		}
+		m_ShaderInstancesBonesBufferParameter->Unbind();
+
 		m_ShaderInstancesBufferParameter->Unbind();
 	}
 
+	auto replayEnd = std::chrono::high_resolution_clock::now();
 
-	//Log::Info("Test = '%d'", modelPriorMap.size());
-
+	if (m_DrawStatisticsLog->Get() && (m_FrameIndex % cDrawStatisticsLogInterval) == 0)
+	{
+		double recordTime = std::chrono::duration<double, std::milli>(replayStart - recordStart).count();
+		double replayTime = std::chrono::duration<double, std::milli>(replayEnd - replayStart).count();
+		Log::Info("M2 instanced pass [%s]: draws '%d', instances ranges '%d', sections '%d', states '%d', materials '%d', skipped binds '%d'. Record '%0.3f' ms, replay '%0.3f' ms%s.", m_OpaqueDraw ? "opaque" : "transparent",
+			m_Statistics.Draws, m_Statistics.InstancesRangeBinds, m_Statistics.SectionBinds, m_Statistics.StateBinds, m_Statistics.MaterialBinds, m_Statistics.SkippedBinds,
+			recordTime, replayTime, m_NullDeviceReplay->Get() ? " (null device)" : "");
+	}
 }
 
 std::shared_ptr<IRenderPassPipelined> CRenderPass_M2_Instanced::CreatePipeline(std::shared_ptr<IRenderTarget> RenderTarget, const Viewport * Viewport)
@@ -75,11 +123,8 @@ std::shared_ptr<IRenderPassPipelined> CRenderPass_M2_Instanced::CreatePipeline(s
 	//vertexShader->LoadInputLayoutFromReflector();
 	std::vector<SCustomVertexElement> elements;
 	elements.push_back({ 0, 0,  ECustomVertexElementType::FLOAT3, ECustomVertexElementUsage::POSITION, 0 });
-	elements.push_back({ 0, 12,  ECustomVertexElementType::FLOAT4, ECustomVertexElementUsage::BLENDWEIGHT, 0 });
-	elements.push_back({ 0, 28,  ECustomVertexElementType::FLOAT4, ECustomVertexElementUsage::BLENDINDICES, 0 });
-	elements.push_back({ 0, 44, ECustomVertexElementType::FLOAT3, ECustomVertexElementUsage::NORMAL, 0 });
-	elements.push_back({ 0, 56, ECustomVertexElementType::FLOAT2, ECustomVertexElementUsage::TEXCOORD, 0 });
-	elements.push_back({ 0, 68, ECustomVertexElementType::FLOAT2, ECustomVertexElementUsage::TEXCOORD, 1 });
+	elements.push_back({ 0, 12, ECustomVertexElementType::FLOAT2, ECustomVertexElementUsage::BLENDWEIGHT, 0 }); // Packed weights and indexes (raw bits, see SM2_Vertex_znEngine)
+	elements.push_back({ 0, 20, ECustomVertexElementType::FLOAT3, ECustomVertexElementUsage::NORMAL, 0 });      // Packed normal and texture coords (raw bits)
 	vertexShader->LoadInputLayoutFromCustomElements(elements);
 
 	std::shared_ptr<IShader> pixelShader = GetRenderDevice().GetObjectsFactory().CreateShader(EShaderType::PixelShader, "shaders_D3D/M2.hlsl", "PS_main");
@@ -102,6 +147,12 @@ std::shared_ptr<IRenderPassPipelined> CRenderPass_M2_Instanced::CreatePipeline(s
 	m_ShaderInstancesBufferParameter = &vertexShader->GetShaderParameterByName("Instances");
 	_ASSERT(m_ShaderInstancesBufferParameter->IsValid());
 
+	m_ShaderInstancesBonesBufferParameter = &vertexShader->GetShaderParameterByName("InstancesBones");
+	_ASSERT(m_ShaderInstancesBonesBufferParameter->IsValid());
+
+	m_ShaderInstancesRangeParameter = &vertexShader->GetShaderParameterByName("M2InstancesRange");
+	_ASSERT(m_ShaderInstancesRangeParameter->IsValid());
+
 	m_ShaderM2GeometryParameter = &vertexShader->GetShaderParameterByName("M2Geometry");
 	_ASSERT(m_ShaderM2GeometryParameter->IsValid());
 
@@ -122,3 +173,335 @@ EVisitResult CRenderPass_M2_Instanced::Visit(const IModel * Model)
 	_ASSERT(false);
 	return EVisitResult::Block;
 }
+
+
+
+//
+// CRenderPass_M2
+//
+void CRenderPass_M2_Instanced::BindSection(CM2_SkinSection* M2SkinSection, const CM2_Base_Instance* M2SceneNode)
+{
+	// Bones are taken from per-instance palettes
+	M2SkinSection->UpdateGeometryProps(GetRenderEventArgs(), nullptr);
+
+	m_ShaderM2GeometryParameter->SetConstantBuffer(M2SkinSection->GetGeometryPropsBuffer());
+	m_ShaderM2GeometryParameter->Bind();
+}
+
+void CRenderPass_M2_Instanced::UnbindSection(CM2_SkinSection* M2SkinSection)
+{
+	m_ShaderM2GeometryParameter->Unbind();
+}
+
+
+
+//
+// Private
+//
+void CRenderPass_M2_Instanced::UpdateInstancesLists()
+{
+	m_FrameIndex++;
+
+	for (const auto& acceptableNodeType : GetAcceptableNodeTypes())
+	{
+		if (false == GetSceneNodeListPass()->HasModelsList(acceptableNodeType))
+			continue;
+
+		for (const auto& it : GetSceneNodeListPass()->GetModelsList(acceptableNodeType))
+		{
+			const CM2_Base_Instance* m2Instance = static_cast<const CM2_Base_Instance*>(it.SceneNode);
+
+			SInstancesGroupKey group;
+			group.Skin = m2Instance->getActiveSkin(static_cast<const CM2_Skin*>(it.Model));
+			group.MeshesSignature = m2Instance->getMeshesSignature();
+			group.TexturesSignature = m2Instance->getSpecialTexturesSignature();
+			group.Alpha = m2Instance->getAlpha();
+
+			auto slotIt = m_InstancesSlots.find(m2Instance);
+			if (slotIt == m_InstancesSlots.end())
+			{
+				AddInstance(m2Instance, group);
+				slotIt = m_InstancesSlots.find(m2Instance);
+			}
+			else if (false == (slotIt->second.Group == group))
+			{
+				RemoveInstance(m2Instance);
+				AddInstance(m2Instance, group);
+				slotIt = m_InstancesSlots.find(m2Instance);
+			}
+
+			slotIt->second.LastFrame = m_FrameIndex;
+		}
+	}
+
+	// Instances, that left visibility. Pointers of removed instances are never dereferenced.
+	std::vector<const CM2_Base_Instance*> leftInstances;
+	for (const auto& it : m_InstancesSlots)
+		if (it.second.LastFrame != m_FrameIndex)
+			leftInstances.push_back(it.first);
+
+	for (const auto& it : leftInstances)
+		RemoveInstance(it);
+}
+
+void CRenderPass_M2_Instanced::AddInstance(const CM2_Base_Instance* M2Instance, const SInstancesGroupKey& Group)
+{
+	auto& instances = m_InstancesGroups[Group];
+
+	SInstanceSlot slot;
+	slot.Group = Group;
+	slot.Index = instances.size();
+	slot.LastFrame = m_FrameIndex;
+	m_InstancesSlots.insert(std::make_pair(M2Instance, slot));
+
+	instances.push_back(M2Instance);
+	m_IsInstancesGroupsChanged = true;
+}
+
+void CRenderPass_M2_Instanced::RemoveInstance(const CM2_Base_Instance* M2Instance)
+{
+	auto slotIt = m_InstancesSlots.find(M2Instance);
+	_ASSERT(slotIt != m_InstancesSlots.end());
+
+	auto instancesIt = m_InstancesGroups.find(slotIt->second.Group);
+	_ASSERT(instancesIt != m_InstancesGroups.end());
+
+	// Swap with last
+	auto& instances = instancesIt->second;
+	size_t index = slotIt->second.Index;
+	if (index != instances.size() - 1)
+	{
+		instances[index] = instances.back();
+		m_InstancesSlots[instances[index]].Index = index;
+	}
+	instances.pop_back();
+
+	// Skin can be unloaded (LOD) after all instances left it
+	if (instances.empty())
+		m_InstancesGroups.erase(instancesIt);
+
+	m_InstancesSlots.erase(slotIt);
+	m_IsInstancesGroupsChanged = true;
+}
+
+void CRenderPass_M2_Instanced::UploadInstances(const glm::vec3& CameraPosition)
+{
+	m_SkinsDraws.clear();
+
+	// Ranges of groups
+	uint32 instancesCount = 0;
+	uint32 bonesCount = 0;
+	for (auto& it : m_InstancesGroups)
+	{
+		auto& instances = it.second;
+		_ASSERT(false == instances.empty());
+
+		// Instances of one draw are rasterized in order: transparent instances go back to front
+		if (false == m_OpaqueDraw)
+		{
+			auto distanceSqr = [&CameraPosition](const CM2_Base_Instance* M2Instance) -> float {
+				glm::vec3 direction = glm::vec3(M2Instance->GetWorldTransfom()[3]) - CameraPosition;
+				return glm::dot(direction, direction);
+			};
+
+			std::sort(instances.begin(), instances.end(), [&distanceSqr](const CM2_Base_Instance* Left, const CM2_Base_Instance* Right) {
+				return distanceSqr(Left) > distanceSqr(Right);
+			});
+
+			for (size_t i = 0; i < instances.size(); i++)
+				m_InstancesSlots[instances[i]].Index = i;
+		}
+
+		const CM2& m2 = instances.front()->getM2();
+		bool isAnimated = m2.getSkeleton().hasBones() && m2.isAnimated();
+
+		SSkinDraw skinDraw;
+		skinDraw.Skin = it.first.Skin;
+		skinDraw.Instances = &instances;
+		skinDraw.FirstInstance = instances.front();
+		skinDraw.InstancesOffset = instancesCount;
+		skinDraw.InstancesCount = static_cast<uint32>(instances.size());
+		skinDraw.BonesOffset = bonesCount;
+		skinDraw.BonesLookupCount = isAnimated ? it.first.Skin->GetBonesLookupCount() : 0;
+		skinDraw.Distance = glm::distance(glm::vec3(instances.front()->GetWorldTransfom()[3]), CameraPosition);
+		m_SkinsDraws.push_back(skinDraw);
+
+		instancesCount += skinDraw.InstancesCount;
+		bonesCount += skinDraw.InstancesCount * skinDraw.BonesLookupCount;
+	}
+
+	m_InstancesData.resize(instancesCount);
+	m_InstancesBonesData.resize(bonesCount);
+
+	// Instances data and poses
+	ParallelFor(m_SkinsDraws.size(), cMinSkinDrawsPerTask, [this](size_t Begin, size_t End, size_t TaskIndex) {
+		for (size_t i = Begin; i < End; i++)
+		{
+			const SSkinDraw& skinDraw = m_SkinsDraws[i];
+
+			uint32 bonesOffset = skinDraw.BonesOffset;
+			for (uint32 j = 0; j < skinDraw.InstancesCount; j++)
+			{
+				const CM2_Base_Instance* m2Instance = (*skinDraw.Instances)[j];
+				m_InstancesData[skinDraw.InstancesOffset + j] = M2PerInstance(m2Instance->GetWorldTransfom(), m2Instance->getColor(), bonesOffset);
+
+				if (skinDraw.BonesLookupCount > 0)
+				{
+					m2Instance->getSkeletonComponent()->WritePose(0, skinDraw.BonesLookupCount, m_InstancesBonesData.data() + bonesOffset);
+					bonesOffset += skinDraw.BonesLookupCount;
+				}
+			}
+		}
+	});
+
+	if (m_InstancesData.empty() || m_NullDeviceReplay->Get())
+		return;
+
+	if (m_InstancesData.size() > m_InstancesBuffer->GetElementCount())
+		m_InstancesBuffer = GetRenderDevice().GetObjectsFactory().CreateStructuredBuffer(nullptr, m_InstancesData.capacity(), sizeof(M2PerInstance), CPUAccess::Write);
+	m_InstancesBuffer->Set(m_InstancesData);
+
+	if (m_InstancesBonesData.empty())
+		return;
+
+	if (m_InstancesBonesData.size() > m_InstancesBonesBuffer->GetElementCount())
+		m_InstancesBonesBuffer = GetRenderDevice().GetObjectsFactory().CreateStructuredBuffer(nullptr, m_InstancesBonesData.capacity(), sizeof(glm::mat4), CPUAccess::Write);
+	m_InstancesBonesBuffer->Set(m_InstancesBonesData);
+}
+
+void CRenderPass_M2_Instanced::RecordCommands()
+{
+	// Opaque commands depend only on groups (their order and sizes), transparent commands depend on distances
+	if (m_OpaqueDraw && false == m_IsInstancesGroupsChanged)
+		return;
+
+	m_IsInstancesGroupsChanged = false;
+
+	m_TasksDrawItems.resize(glm::max<size_t>(std::thread::hardware_concurrency(), 1));
+	for (auto& taskDrawItems : m_TasksDrawItems)
+		taskDrawItems.clear();
+
+	ParallelFor(m_SkinsDraws.size(), cMinSkinDrawsPerTask, [this](size_t Begin, size_t End, size_t TaskIndex) {
+		std::vector<CM2_DrawList::SItem>& taskDrawItems = m_TasksDrawItems[TaskIndex];
+
+		for (size_t skinDrawIndex = Begin; skinDrawIndex < End; skinDrawIndex++)
+		{
+			const SSkinDraw& skinDraw = m_SkinsDraws[skinDrawIndex];
+
+			uint32 batchOrder = 0;
+			for (const auto& it : skinDraw.Skin->GetTTT())
+			{
+				const auto& section = skinDraw.Skin->GetSections()[it.first];
+				if (!skinDraw.FirstInstance->isMeshEnabled(section->getProto().meshPartID))
+					continue;
+
+				for (const auto& batch : it.second)
+				{
+					uint32 blendMode = batch->GetM2Material()->getBlendMode();
+					bool isOpaqueGeom = blendMode == 0 || blendMode == 1;
+					if (isOpaqueGeom != m_OpaqueDraw)
+						continue;
+
+					CM2_DrawList::SItem item;
+					item.Key = m_OpaqueDraw ? MakeOpaqueKey(*batch, static_cast<uint32>(skinDrawIndex), section->getIndex()) : MakeTransparentKey(batch->m_PriorityPlan, skinDraw.Distance, static_cast<uint32>(skinDrawIndex), batchOrder++);
+					item.SkinDrawIndex = static_cast<uint32>(skinDrawIndex);
+					item.Section = section.get();
+					item.Batch = batch.get();
+					taskDrawItems.push_back(item);
+				}
+			}
+		}
+	});
+
+	m_DrawList.Clear();
+	for (const auto& taskDrawItems : m_TasksDrawItems)
+		m_DrawList.Add(taskDrawItems);
+
+	m_DrawList.Sort();
+	m_DrawList.Record(m_Commands, m_Statistics);
+}
+
+void CRenderPass_M2_Instanced::ReplayCommands()
+{
+	const ShaderMap& shaders = GetPipeline().GetShaders();
+	const IShader* vertexShader = shaders.at(EShaderType::VertexShader).get();
+
+	bool isInstancesRangeBound = false;
+	CM2_SkinSection* boundSection = nullptr;
+	IGeometryInternal* boundGeometry = nullptr;
+	CM2_Skin_Batch* boundBatch = nullptr;
+
+	for (const auto& command : m_Commands)
+	{
+		const SSkinDraw& skinDraw = m_SkinsDraws[command.SkinDrawIndex];
+
+		switch (command.Type)
+		{
+			case EM2_DrawCommandType::InstancesRange:
+			{
+				ShaderM2InstancesRange instancesRange = { 0 };
+				instancesRange.gInstancesOffset = skinDraw.InstancesOffset;
+				m_InstancesRangeBuffer->Set(instancesRange);
+
+				m_ShaderInstancesRangeParameter->SetConstantBuffer(m_InstancesRangeBuffer);
+				m_ShaderInstancesRangeParameter->Bind();
+				isInstancesRangeBound = true;
+			}
+			break;
+
+			case EM2_DrawCommandType::Section:
+			{
+				if (boundSection != nullptr)
+				{
+					boundGeometry->Render_UnbindAllBuffers(GetRenderEventArgs(), vertexShader);
+					UnbindSection(boundSection);
+				}
+
+				BindSection(command.Section, skinDraw.FirstInstance);
+				boundGeometry = dynamic_cast<IGeometryInternal*>(command.Section);
+				boundGeometry->Render_BindAllBuffers(GetRenderEventArgs(), vertexShader);
+				boundSection = command.Section;
+			}
+			break;
+
+			case EM2_DrawCommandType::BlendState:
+				command.Batch->GetM2Material()->GetBlendState()->Bind();
+			break;
+
+			case EM2_DrawCommandType::DepthStencilState:
+				command.Batch->GetM2Material()->GetDepthStencilState()->Bind();
+			break;
+
+			case EM2_DrawCommandType::RasterizerState:
+				command.Batch->GetM2Material()->GetRasterizerState()->Bind();
+			break;
+
+			case EM2_DrawCommandType::Material:
+			{
+				if (boundBatch != nullptr)
+					boundBatch->Unbind(shaders);
+
+				command.Batch->UpdateMaterialProps(GetRenderEventArgs(), skinDraw.FirstInstance);
+				command.Batch->Bind(shaders);
+				boundBatch = command.Batch;
+			}
+			break;
+
+			case EM2_DrawCommandType::Draw:
+				boundGeometry->Render_Draw(command.Section->GetDrawArgs(skinDraw.InstancesCount));
+			break;
+		}
+	}
+
+	if (boundBatch != nullptr)
+		boundBatch->Unbind(shaders);
+
+	if (boundSection != nullptr)
+	{
+		boundGeometry->Render_UnbindAllBuffers(GetRenderEventArgs(), vertexShader);
+		UnbindSection(boundSection);
+	}
+
+	if (isInstancesRangeBound)
+		m_ShaderInstancesRangeParameter->Unbind();
+}
@@ -2,7 +2,33 @@
 
 #include "M2/M2_Base_Instance.h"
 #include "M2/RenderPass_M2.h"
+#include "M2/M2_DrawList.h"
 
+struct __declspec(novtable, align(16)) ZN_API M2PerInstance
+{
+	M2PerInstance()
+		: Model(1.0f)
+		, Color(1.0f)
+		, BonesOffset(0)
+	{}
+	M2PerInstance(const glm::mat4& Model, const glm::vec4& Color, uint32 BonesOffset)
+		: Model(Model)
+		, Color(Color)
+		, BonesOffset(BonesOffset)
+	{}
+	glm::mat4 Model;
+	glm::vec4 Color;
+	uint32    BonesOffset;
+	uint32    __padding[3];
+};
+
+/**
+  * Draws all visible instances of one M2 skin with one draw per section.
+  * Per-skin instances lists live between frames and are updated only when instances enter or leave visibility
+  * (or change LOD skin or geosets). Instances data and bones palettes of all skins are uploaded with one update per frame.
+  * Visible batches are recorded to POD commands after culling (on worker threads for big scenes) and replayed by submit loop.
+  * Opaque commands are reused while instances lists are not changed.
+*/
 class ZN_API CRenderPass_M2_Instanced
 	: public CRenderPass_M2
 {
@@ -12,6 +38,8 @@ public:
 
 	void Render(RenderEventArgs& e) override;
 
+	const SM2_DrawStatistics& GetStatistics() const { return m_Statistics; }
+
 	// IRenderPassPipelined
 	virtual std::shared_ptr<IRenderPassPipelined> CreatePipeline(std::shared_ptr<IRenderTarget> RenderTarget, const Viewport* Viewport) override;
 
@@ -19,7 +47,93 @@ public:
 	EVisitResult Visit(const ISceneNode3D* node) override final;
 	EVisitResult Visit(const IModel* Model) override final;
 
+protected:
+	// CRenderPass_M2
+	void BindSection(CM2_SkinSection* M2SkinSection, const CM2_Base_Instance* M2SceneNode) override;
+	void UnbindSection(CM2_SkinSection* M2SkinSection) override;
+
+private:
+	// Instances of one group are drawn together with materials of first instance,
+	// so group contains instances with equal geosets, special textures (monster skins, baked skins, hair, items) and alpha
+	struct SInstancesGroupKey
+	{
+		const CM2_Skin* Skin;
+		uint64          MeshesSignature;
+		uint64          TexturesSignature;
+		float           Alpha;
+
+		bool operator==(const SInstancesGroupKey& other) const
+		{
+			return Skin == other.Skin && MeshesSignature == other.MeshesSignature && TexturesSignature == other.TexturesSignature && Alpha == other.Alpha;
+		}
+	};
+
+	struct SInstancesGroupKeyHash
+	{
+		size_t operator()(const SInstancesGroupKey& Key) const
+		{
+			size_t hash = std::hash<const void*>()(Key.Skin);
+			hash = hash * 31 + std::hash<uint64>()(Key.MeshesSignature);
+			hash = hash * 31 + std::hash<uint64>()(Key.TexturesSignature);
+			hash = hash * 31 + std::hash<float>()(Key.Alpha);
+			return hash;
+		}
+	};
+
+	typedef std::vector<const CM2_Base_Instance*> InstancesList;
+
+	void UpdateInstancesLists();
+	void AddInstance(const CM2_Base_Instance* M2Instance, const SInstancesGroupKey& Group);
+	void RemoveInstance(const CM2_Base_Instance* M2Instance);
+	void UploadInstances(const glm::vec3& CameraPosition);
+	void RecordCommands();
+	void ReplayCommands();
+
 private:
+	struct SInstanceSlot
+	{
+		SInstancesGroupKey Group;
+		size_t             Index;     // Index in group instances list
+		uint64             LastFrame; // Last frame, where instance was visible
+	};
+
+	struct SSkinDraw
+	{
+		const CM2_Skin*          Skin;
+		const InstancesList*     Instances;
+		const CM2_Base_Instance* FirstInstance; // Source of materials and geometry state
+		uint32                   InstancesOffset;
+		uint32                   InstancesCount;
+		uint32                   BonesOffset;
+		uint32                   BonesLookupCount; // Zero for not animated models
+		float                    Distance;      // Farthest instance
+	};
+
+	std::unordered_map<SInstancesGroupKey, InstancesList, SInstancesGroupKeyHash> m_InstancesGroups;
+	std::unordered_map<const CM2_Base_Instance*, SInstanceSlot>                   m_InstancesSlots;
+	uint64                                                                        m_FrameIndex;
+	bool                                                                          m_IsInstancesGroupsChanged;
+
+	std::vector<M2PerInstance>         m_InstancesData;
+	std::vector<glm::mat4>             m_InstancesBonesData;
+	std::vector<SSkinDraw>             m_SkinsDraws;
+	CM2_DrawList                       m_DrawList;
+	std::vector<std::vector<CM2_DrawList::SItem>> m_TasksDrawItems;
+	std::vector<SM2_DrawCommand>       m_Commands;
+	SM2_DrawStatistics                 m_Statistics;
+	std::shared_ptr<ISettingT<bool>>   m_DrawStatisticsLog;
+	std::shared_ptr<ISettingT<bool>>   m_NullDeviceReplay;
+
+	__declspec(align(16)) struct ShaderM2InstancesRange
+	{
+		uint32 gInstancesOffset;
+		uint32 __padding[3];
+	};
+
 	IShaderParameter*                  m_ShaderInstancesBufferParameter;
+	IShaderParameter*                  m_ShaderInstancesBonesBufferParameter;
+	IShaderParameter*                  m_ShaderInstancesRangeParameter;
 	std::shared_ptr<IStructuredBuffer> m_InstancesBuffer;
+	std::shared_ptr<IStructuredBuffer> m_InstancesBonesBuffer;
+	std::shared_ptr<IConstantBuffer>   m_InstancesRangeBuffer;
 };
@@ -0,0 +1,145 @@
+#include "stdafx.h"
+
+// General
+#include "RenderPass_M2Particles.h"
+
+// Additional (SceneNodes)
+#include "M2_Base_Instance.h"
+
+CRenderPass_M2_Particles::CRenderPass_M2_Particles(IRenderDevice& RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneCreateTypedListsPass)
+	: CBaseList3DPass(RenderDevice, SceneCreateTypedListsPass, cM2_NodeType)
+	, m_FrameBuffer(RenderDevice)
+	, m_ShaderVerticesParameter(nullptr)
+{
+	// Vertices are fetched from structured buffer by 'SV_VertexID', geometry has no own buffers
+	m_Geometry = GetRenderDevice().GetObjectsFactory().CreateGeometry();
+}
+
+CRenderPass_M2_Particles::~CRenderPass_M2_Particles()
+{
+}
+
+void CRenderPass_M2_Particles::Render(RenderEventArgs& e)
+{
+	m_FrameBuffer.BeginFrame();
+	m_Draws.clear();
+	m_ProcessedInstances.clear();
+
+	const glm::mat4& view = e.Camera->GetViewMatrix();
+	const glm::vec3 cameraRight = glm::vec3(view[0][0], view[1][0], view[2][0]);
+	const glm::vec3 cameraUp = glm::vec3(view[0][1], view[1][1], view[2][1]);
+
+	// Build vertices of all emitters to the one buffer
+	for (const auto& acceptableNodeType : GetAcceptableNodeTypes())
+	{
+		if (false == GetSceneNodeListPass()->HasModelsList(acceptableNodeType))
+			continue;
+
+		for (const auto& it : GetSceneNodeListPass()->GetModelsList(acceptableNodeType))
+		{
+			const CM2_Base_Instance* m2Instance = static_cast<const CM2_Base_Instance*>(it.SceneNode);
+			if (false == m_ProcessedInstances.insert(m2Instance).second)
+				continue;
+
+			const auto& particlesComponent = m2Instance->getParticleComponent();
+			if (particlesComponent == nullptr)
+				continue;
+
+			for (const auto& particleSystem : particlesComponent->GetParticleSystems())
+			{
+				if (particleSystem->GetMaterial() == nullptr)
+					continue;
+
+				SParticlesDraw draw;
+				draw.ParticleSystem = particleSystem.get();
+				if (particleSystem->BuildVertices(m2Instance->GetWorldTransfom(), cameraRight, cameraUp, m_FrameBuffer, &draw.FirstVertex, &draw.VerticesCount))
+					m_Draws.push_back(draw);
+			}
+		}
+	}
+
+	if (m_Draws.empty())
+		return;
+
+	// One upload per frame
+	m_ShaderVerticesParameter->SetStructuredBuffer(m_FrameBuffer.EndFrame());
+	m_ShaderVerticesParameter->Bind();
+	{
+		const ShaderMap& shaders = GetPipeline().GetShaders();
+		const IShader* vertexShader = shaders.at(EShaderType::VertexShader).get();
+
+		std::shared_ptr<IGeometryInternal> geomInternal = std::dynamic_pointer_cast<IGeometryInternal>(m_Geometry);
+		geomInternal->Render_BindAllBuffers(e, vertexShader);
+
+		for (const auto& draw : m_Draws)
+		{
+			draw.ParticleSystem->GetBlendState()->Bind();
+
+			const auto& material = draw.ParticleSystem->GetMaterial();
+			material->Bind(shaders);
+			{
+				SGeometryDrawArgs geometryDrawArgs = { 0 };
+				geometryDrawArgs.VertexStartLocation = draw.FirstVertex;
+				geometryDrawArgs.VertexCnt = draw.VerticesCount;
+				geomInternal->Render_Draw(geometryDrawArgs);
+			}
+			material->Unbind(shaders);
+		}
+
+		// Emitters blend states replace pipeline one
+		GetPipeline().GetBlendState()->Bind();
+
+		geomInternal->Render_UnbindAllBuffers(e, vertexShader);
+	}
+	m_ShaderVerticesParameter->Unbind();
+}
+
+
+
+//
+// IRenderPassPipelined
+//
+std::shared_ptr<IRenderPassPipelined> CRenderPass_M2_Particles::CreatePipeline(std::shared_ptr<IRenderTarget> RenderTarget, const Viewport * Viewport)
+{
+	// CreateShaders
+	std::shared_ptr<IShader> vertexShader = GetRenderDevice().GetObjectsFactory().CreateShader(EShaderType::VertexShader, "shaders_D3D/M2_Particles.hlsl", "VS_main");
+	vertexShader->LoadInputLayoutFromReflector();
+
+	std::shared_ptr<IShader> pixelShader = GetRenderDevice().GetObjectsFactory().CreateShader(EShaderType::PixelShader, "shaders_D3D/M2_Particles.hlsl", "PS_main");
+
+	// PIPELINES
+	std::shared_ptr<IPipelineState> pipeline = GetRenderDevice().GetObjectsFactory().CreatePipelineState();
+	pipeline->GetBlendState()->SetBlendMode(alphaBlending);
+	pipeline->GetDepthStencilState()->SetDepthMode(disableDepthWrites);
+	pipeline->GetRasterizerState()->SetCullMode(IRasterizerState::CullMode::None);
+	pipeline->GetRasterizerState()->SetFillMode(IRasterizerState::FillMode::Solid);
+	pipeline->SetRenderTarget(RenderTarget);
+	pipeline->SetShader(EShaderType::VertexShader, vertexShader);
+	pipeline->SetShader(EShaderType::PixelShader, pixelShader);
+
+	std::shared_ptr<ISamplerState> sampler = GetRenderDevice().GetObjectsFactory().CreateSamplerState();
+	sampler->SetFilter(ISamplerState::MinFilter::MinLinear, ISamplerState::MagFilter::MagLinear, ISamplerState::MipFilter::MipLinear);
+	pipeline->SetSampler(0, sampler);
+
+	m_ShaderVerticesParameter = &vertexShader->GetShaderParameterByName("Vertices");
+	_ASSERT(m_ShaderVerticesParameter->IsValid());
+
+	return SetPipeline(pipeline);
+}
+
+
+
+//
+// IVisitor
+//
+EVisitResult CRenderPass_M2_Particles::Visit(const ISceneNode3D * node)
+{
+	_ASSERT(false);
+	return EVisitResult::Block;
+}
+
+EVisitResult CRenderPass_M2_Particles::Visit(const IModel * Model)
+{
+	_ASSERT(false);
+	return EVisitResult::Block;
+}
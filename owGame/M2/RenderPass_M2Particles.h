@@ -0,0 +1,36 @@
+#pragma once
+
+#include "M2/M2_Base_Instance.h"
+#include "M2/M2_ParticlesFrameBuffer.h"
+
+class ZN_API CRenderPass_M2_Particles
+	: public CBaseList3DPass
+{
+public:
+	CRenderPass_M2_Particles(IRenderDevice& RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneCreateTypedListsPass);
+	virtual ~CRenderPass_M2_Particles();
+
+	void Render(RenderEventArgs& e) override;
+
+	// IRenderPassPipelined
+	virtual std::shared_ptr<IRenderPassPipelined> CreatePipeline(std::shared_ptr<IRenderTarget> RenderTarget, const Viewport* Viewport) override;
+
+	// IVisitor
+	EVisitResult Visit(const ISceneNode3D* node) override final;
+	EVisitResult Visit(const IModel* Model) override final;
+
+private:
+	struct SParticlesDraw
+	{
+		const CM2ParticleSystem* ParticleSystem;
+		size_t                   FirstVertex;
+		size_t                   VerticesCount;
+	};
+
+	CM2_ParticlesFrameBuffer                       m_FrameBuffer;
+	std::vector<SParticlesDraw>                    m_Draws;
+	std::unordered_set<const CM2_Base_Instance*>   m_ProcessedInstances;
+
+	std::shared_ptr<IGeometry>                     m_Geometry;
+	IShaderParameter*                              m_ShaderVerticesParameter;
+};
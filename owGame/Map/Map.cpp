@@ -282,6 +282,12 @@ uint32 CMap::GetAreaID(const ICameraComponent3D* camera)
 	return curChunk->GetAreaID();
 }
 
+std::shared_ptr<CMapTile> CMap::getCurrentTile() const
+{
+    int midTile = static_cast<uint32>(C_RenderedTiles / 2);
+    return m_Current[midTile][midTile];
+}
+
 bool CMap::getTileIsCurrent(int x, int z) const
 {
     int midTile = static_cast<uint32>(C_RenderedTiles / 2);
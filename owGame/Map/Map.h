@@ -43,6 +43,7 @@ public: // Getters
 
 	std::shared_ptr<ITexture>                       getMinimap() const { return m_WDL->getMinimap(); }
 
+	std::shared_ptr<CMapTile>                       getCurrentTile() const;
 	bool                                            getTileIsCurrent(int x, int z) const;
 	bool                                            IsTileInCurrent(const CMapTile& _mapTile);
 
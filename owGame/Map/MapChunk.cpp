@@ -14,6 +14,36 @@
 
 namespace
 {
+	// Liquid layers are merged by tile, when all chunks are reported. Chunk reports once from any exit of Load, without liquid if it isn't reported explicitly.
+	class CChunkLiquidReporter
+	{
+	public:
+		CChunkLiquidReporter(const std::shared_ptr<CMapTile>& MapTile, const glm::vec3& ChunkOffset)
+			: m_MapTile(MapTile)
+			, m_ChunkOffset(ChunkOffset)
+			, m_IsReported(false)
+		{}
+		~CChunkLiquidReporter()
+		{
+			Report(nullptr, BoundingBox());
+		}
+
+		void Report(const std::shared_ptr<CMapChunkLiquid>& Liquid, const BoundingBox& Bounds)
+		{
+			if (m_IsReported)
+				return;
+
+			if (m_MapTile != nullptr)
+				m_MapTile->AddChunkLiquid(m_ChunkOffset, Liquid, Bounds);
+			m_IsReported = true;
+		}
+
+	private:
+		std::shared_ptr<CMapTile> m_MapTile;
+		glm::vec3                 m_ChunkOffset;
+		bool                      m_IsReported;
+	};
+
 	inline uint8 lerpUInt8(uint8 a, uint8 b, uint8 f)
 	{
 		const float aF = static_cast<float>(a) / 255.0f;
@@ -97,6 +127,8 @@ void CMapChunk::Initialize()
 //
 bool CMapChunk::Load()
 {
+	CChunkLiquidReporter liquidReporter(std::dynamic_pointer_cast<CMapTile>(GetDependense().lock()), glm::vec3(GetTranslation().x, 0.0f, GetTranslation().z));
+
 	if (auto depend = GetDependense().lock())
 		if (depend->GetState() == ILoadable::ELoadableState::Deleted)
 			return false;
@@ -317,6 +349,8 @@ bool CMapChunk::Load()
 	}
 
 	// Liquids
+	std::shared_ptr<CMapChunkLiquid> liquid = nullptr;
+	BoundingBox liquidBounds;
 	m_Bytes->seek(startPos + header.ofsLiquid);
 	{
 		if (header.sizeLiquid > 8)
@@ -336,27 +370,22 @@ bool CMapChunk::Load()
 				GetColliderComponent()->SetBounds(bbox);
 			}
 
-			CMapChunkLiquid liquidObject(m_RenderDevice, m_Bytes, header);
-
-			auto liquidInstance = CreateSceneNode<Liquid_Instance>();
-			liquidObject.CreateInsances(liquidInstance);
+			liquid = std::make_shared<CMapChunkLiquid>(m_RenderDevice, m_Bytes, header);
 
-			// Transform
-			liquidInstance->SetTranslate(glm::vec3(0.0f, (-GetTranslation().y), 0.0f));
-
-			// IColliderComponent3D
+			// World space bounds
 			{
 				BoundingBox bbox = GetColliderComponent()->GetBounds();
-				bbox.setMinY(height.min);
-				bbox.setMaxY(height.max);
-				bbox.calculateCenter();
-				liquidInstance->GetColliderComponent()->SetCullStrategy(IColliderComponent3D::ECullStrategy::ByFrustrumAndDistance2D);
-				liquidInstance->GetColliderComponent()->SetBounds(bbox);
-				liquidInstance->GetColliderComponent()->SetDebugDrawMode(false);
+				liquidBounds = BoundingBox
+				(
+					glm::vec3(GetTranslation().x + bbox.getMin().x, height.min, GetTranslation().z + bbox.getMin().z),
+					glm::vec3(GetTranslation().x + bbox.getMax().x, height.max, GetTranslation().z + bbox.getMax().z)
+				);
 			}
 		}
 	}
 
+	liquidReporter.Report(liquid, liquidBounds);
+
 	m_Bytes.reset();
 
 	// All chunk is holes
@@ -6,12 +6,17 @@
 // General
 #include "MapTile.h"
 
+// Additional
+#include "MapChunkLiquid.h"
+#include "Liquid/LiquidInstance.h"
+
 CMapTile::CMapTile(IBaseManager& BaseManager, IRenderDevice& RenderDevice, const CMap& Map, uint32 IndexX, uint32 IndexZ)
 	: m_BaseManager(BaseManager)
 	, m_RenderDevice(RenderDevice)
 	, m_Map(Map)
 	, m_IndexX(IndexX)
 	, m_IndexZ(IndexZ)
+	, m_ChunksLiquidsReported(0)
 {
 	SetType(cMapTile_NodeType);
 	SetName("MapTile[" + std::to_string(getIndexX()) + "," + std::to_string(getIndexZ()) + "]");
@@ -121,23 +126,19 @@ bool CMapTile::Load()
 #if 0
 		textureInfo->diffuseTexture = GetBaseManager().GetManager<IImagesFactory>()->CreateImage(_string);
 #else
-		textureInfo->diffuseTexture = m_RenderDevice.GetObjectsFactory().LoadTexture2D(_string);
+		textureInfo->diffuseTexture = GetBaseManager().GetManager<IWoWObjectsCreator>()->LoadTexture2D(m_RenderDevice, _string);
 #endif
 
-		// PreLoad specular texture
-		try
+		// PreLoad specular texture (optional)
 		{
 			std::string specularTextureName = _string;
 			specularTextureName = specularTextureName.insert(specularTextureName.length() - 4, "_s");
 #if 0
 			textureInfo->specularTexture = GetBaseManager().GetManager<IImagesFactory>()->CreateImage(specularTextureName);
 #else
-			textureInfo->specularTexture = m_RenderDevice.GetObjectsFactory().LoadTexture2D(specularTextureName);
+			textureInfo->specularTexture = GetBaseManager().GetManager<IWoWObjectsCreator>()->TryLoadTexture2D(m_RenderDevice, specularTextureName);
 #endif
 		}
-		catch (const CException& e)
-		{
-		}
 
 
 		m_Textures.push_back(textureInfo);
@@ -297,3 +298,94 @@ bool CMapTile::Delete()
 {
 	return true;
 }
+
+
+
+//
+// Liquids
+//
+void CMapTile::AddChunkLiquid(const glm::vec3& ChunkOffset, const std::shared_ptr<CMapChunkLiquid>& Liquid, const BoundingBox& Bounds)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_ChunksLiquidsLock);
+
+		if (Liquid != nullptr)
+			m_ChunksLiquids.push_back({ ChunkOffset, Liquid, Bounds });
+
+		m_ChunksLiquidsReported++;
+		_ASSERT(m_ChunksLiquidsReported <= C_ChunksInTileGlobal);
+		if (m_ChunksLiquidsReported != C_ChunksInTileGlobal)
+			return;
+	}
+
+	// Last chunk. Other chunks don't touch list anymore.
+	if (GetState() == ILoadable::ELoadableState::Deleted)
+		return;
+
+	CreateLiquids();
+}
+
+void CMapTile::CreateLiquids()
+{
+	std::vector<const DBC_LiquidTypeRecord*> liquidTypes;
+	for (const auto& chunkLiquid : m_ChunksLiquids)
+		for (const auto& chunkLayer : chunkLiquid.Liquid->m_WaterLayers)
+			if (std::find(liquidTypes.begin(), liquidTypes.end(), chunkLayer->LiquidType) == liquidTypes.end())
+				liquidTypes.push_back(chunkLayer->LiquidType);
+
+	for (const auto& liquidType : liquidTypes)
+	{
+		std::vector<glm::vec3> verticesPos;
+		std::vector<glm::vec3> verticesTex;
+		std::vector<uint16> indices;
+
+		glm::vec3 boundsMin(Math::MaxFloat);
+		glm::vec3 boundsMax(Math::MinFloat);
+
+		for (const auto& chunkLiquid : m_ChunksLiquids)
+		{
+			bool isChunkHasType = false;
+			for (const auto& chunkLayer : chunkLiquid.Liquid->m_WaterLayers)
+			{
+				if (chunkLayer->LiquidType != liquidType)
+					continue;
+
+				chunkLayer->AppendGeometry(chunkLiquid.Liquid->ydir, chunkLiquid.Offset, verticesPos, verticesTex, indices);
+				isChunkHasType = true;
+			}
+
+			if (isChunkHasType)
+			{
+				boundsMin = glm::min(boundsMin, chunkLiquid.Bounds.getMin());
+				boundsMax = glm::max(boundsMax, chunkLiquid.Bounds.getMax());
+			}
+		}
+
+		if (indices.empty())
+			continue;
+
+		std::shared_ptr<CLiquidLayer> layer = std::make_shared<CLiquidLayer>(m_RenderDevice);
+		layer->LiquidType = liquidType;
+		layer->InitTextures(liquidType->Get_Type());
+
+		std::shared_ptr<IGeometry> geometry = m_RenderDevice.GetObjectsFactory().CreateGeometry();
+		geometry->AddVertexBuffer(BufferBinding("POSITION", 0), m_RenderDevice.GetObjectsFactory().CreateVertexBuffer(verticesPos));
+		geometry->AddVertexBuffer(BufferBinding("TEXCOORD", 0), m_RenderDevice.GetObjectsFactory().CreateVertexBuffer(verticesTex));
+		geometry->SetIndexBuffer(m_RenderDevice.GetObjectsFactory().CreateIndexBuffer(indices));
+		layer->AddConnection(layer->GetMaterial(), geometry);
+
+		auto liquidInstance = CreateSceneNode<Liquid_Instance>();
+		liquidInstance->GetComponent<IModelsComponent3D>()->AddModel(layer);
+
+		// IColliderComponent3D
+		{
+			BoundingBox bbox(boundsMin, boundsMax);
+			liquidInstance->GetColliderComponent()->SetCullStrategy(IColliderComponent3D::ECullStrategy::ByFrustrumAndDistance2D);
+			liquidInstance->GetColliderComponent()->SetBounds(bbox);
+			liquidInstance->GetColliderComponent()->SetDebugDrawMode(false);
+		}
+	}
+
+	// Source layers aren't needed anymore
+	m_ChunksLiquids.clear();
+}
@@ -6,6 +6,7 @@
 
 // FORWARD BEGIN
 class CMap;
+class CMapChunkLiquid;
 // FORWARD END
 
 class ZN_API CMapTile
@@ -27,6 +28,12 @@ public:
 	bool                                            Load() override;
 	bool                                            Delete() override;
 
+	// Chunks liquids are merged to one geometry per liquid type, when all chunks are reported. Liquid can be nullptr.
+	void                                            AddChunkLiquid(const glm::vec3& ChunkOffset, const std::shared_ptr<CMapChunkLiquid>& Liquid, const BoundingBox& Bounds);
+
+private:
+	void                                            CreateLiquids();
+
 public:
 	ADT_MHDR                                        header;
 	std::vector<std::shared_ptr<ADT_TextureInfo>>	m_Textures;
@@ -45,4 +52,14 @@ private:
 
 	const int m_IndexX;
 	const int m_IndexZ;
+
+	struct SChunkLiquid
+	{
+		glm::vec3                        Offset;
+		std::shared_ptr<CMapChunkLiquid> Liquid;
+		BoundingBox                      Bounds;
+	};
+	std::mutex                m_ChunksLiquidsLock;
+	std::vector<SChunkLiquid> m_ChunksLiquids;
+	uint32                    m_ChunksLiquidsReported;
 };
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "WowRecordedListPass.h"
+
 class ZN_API CRenderPass_ADT_MCNK 
-	: public CBaseList3DPass
+	: public CRecordedList3DPass
 {
 public:
 	CRenderPass_ADT_MCNK(IRenderDevice& RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneNodeListPass);
@@ -11,6 +11,15 @@ CWoWSettingsGroup::~CWoWSettingsGroup()
 
 void CWoWSettingsGroup::AddDefaultSettings()
 {
+	// Game client 'Data' folder (MPQ archives)
+#if WOW_CLIENT_VERSION == WOW_CLASSIC_1_12_1
+	AddSetting("WoW_DataPath", std::make_shared<CSettingBase<std::string>>("D:\\_games\\World of Warcraft 1.12.1\\Data\\"));
+#elif WOW_CLIENT_VERSION == WOW_BC_2_4_3
+	AddSetting("WoW_DataPath", std::make_shared<CSettingBase<std::string>>("c:\\_engine\\World of Warcraft 2.4.3\\Data\\"));
+#elif WOW_CLIENT_VERSION == WOW_WOTLK_3_3_5
+	AddSetting("WoW_DataPath", std::make_shared<CSettingBase<std::string>>("c:\\_engine\\World of Warcraft 3.3.5a\\Data\\"));
+#endif
+
 	// Distances
 	AddSetting("ADT_MCNK_Distance", std::make_shared<CSettingBase<float>>(998.0f * 2.0f));
 	AddSetting("ADT_MCNK_HighRes_Distance", std::make_shared<CSettingBase<float>>(384.0f * 0.65f * 2.0f));
@@ -29,4 +38,38 @@ void CWoWSettingsGroup::AddDefaultSettings()
 	AddSetting("draw_wmo_water", std::make_shared<CSettingBase<bool>>(true));
 
 	AddSetting("drawfog", std::make_shared<CSettingBase<bool>>(true));
+
+	// M2 animation LOD (projected size is 'bounding radius / distance to camera')
+	AddSetting("M2_AnimLOD_Enabled", std::make_shared<CSettingBase<bool>>(true));
+	AddSetting("M2_AnimLOD_BonesCulling", std::make_shared<CSettingBase<bool>>(true));
+	AddSetting("M2_AnimLOD_HalfRate_Size", std::make_shared<CSettingBase<float>>(0.08f));
+	AddSetting("M2_AnimLOD_QuarterRate_Size", std::make_shared<CSettingBase<float>>(0.04f));
+	AddSetting("M2_AnimLOD_EighthRate_Size", std::make_shared<CSettingBase<float>>(0.02f));
+
+	// M2 skin LOD (skin index is 'distance to camera / distance'; unused skins are unloaded after evict time, ms)
+	AddSetting("M2_SkinLOD_Enabled", std::make_shared<CSettingBase<bool>>(true));
+	AddSetting("M2_SkinLOD_Distance", std::make_shared<CSettingBase<float>>(64.0f * 2.0f));
+	AddSetting("M2_SkinLOD_EvictTime", std::make_shared<CSettingBase<float>>(30000.0f));
+
+	// M2 passes state changes statistics. Null device replay records commands of M2, WMO, map chunks and liquid passes without submitting them (CPU timings)
+	AddSetting("M2_DrawStatistics_Log", std::make_shared<CSettingBase<bool>>(false));
+	AddSetting("Render_NullDeviceReplay", std::make_shared<CSettingBase<bool>>(false));
+
+	// WMO portals visibility is recalculated only if camera changes group, moves more than distance or turns more than angle (degrees)
+	AddSetting("WMO_Portals_CacheDistance", std::make_shared<CSettingBase<float>>(0.25f));
+	AddSetting("WMO_Portals_CacheAngle", std::make_shared<CSettingBase<float>>(0.5f));
+	AddSetting("WMO_Portals_ScreenRectsCulling", std::make_shared<CSettingBase<bool>>(true));
+
+	// BLP textures streaming (budget in MB, sizes in texels, levels of not requested textures are dropped after evict time, ms)
+	AddSetting("Textures_Streaming_Enabled", std::make_shared<CSettingBase<bool>>(true));
+	AddSetting("Textures_Streaming_Budget", std::make_shared<CSettingBase<float>>(256.0f));
+	AddSetting("Textures_Streaming_MinSize", std::make_shared<CSettingBase<float>>(32.0f));
+	AddSetting("Textures_Streaming_ScreenHeight", std::make_shared<CSettingBase<float>>(1080.0f));
+	AddSetting("Textures_Streaming_EvictTime", std::make_shared<CSettingBase<float>>(30000.0f));
+
+	// Textures cache keeps released textures until resident size is over budget (MB)
+	AddSetting("Textures_Cache_Budget", std::make_shared<CSettingBase<float>>(512.0f));
+
+	// Scene hotkeys for benchmarks and validations (B - M2 collision, P - particles, N - BLP decode, M - BLP decoders, K - textures cache report)
+	AddSetting("Debug_TestHotkeys", std::make_shared<CSettingBase<bool>>(false));
 }
@@ -0,0 +1,239 @@
+#include "stdafx.h"
+
+// General
+#include "TexturesCache.h"
+
+// Additional
+#include "Formats/FileProbesCache.h"
+
+CTexturesCache::CTexturesCache(IBaseManager& BaseManager, IRenderDevice& RenderDevice)
+	: m_ReleasedBytes(0)
+	, m_Hits(0)
+	, m_Misses(0)
+	, m_Evictions(0)
+	, m_Streamer(std::make_shared<CTexturesStreamer>(BaseManager, RenderDevice))
+	, m_BaseManager(BaseManager)
+	, m_RenderDevice(RenderDevice)
+{
+	m_ResidentBytes[0] = m_ResidentBytes[1] = 0;
+
+	m_Budget = m_BaseManager.GetManager<ISettings>()->GetGroup("WoWSettings")->GetSettingT<float>("Textures_Cache_Budget");
+	m_StreamingEnabled = m_BaseManager.GetManager<ISettings>()->GetGroup("WoWSettings")->GetSettingT<bool>("Textures_Streaming_Enabled");
+}
+
+CTexturesCache::~CTexturesCache()
+{
+}
+
+std::shared_ptr<ITexture> CTexturesCache::LoadTexture2D(const std::string& FileName)
+{
+	return Load(FileName, false);
+}
+
+std::shared_ptr<ITexture> CTexturesCache::LoadStreamedTexture2D(const std::string& FileName)
+{
+	return Load(FileName, m_StreamingEnabled->Get());
+}
+
+void CTexturesCache::Update(double Time)
+{
+	// Full resolution textures (terrain, liquids, skins) are in streaming budget too
+	uint64 otherResidentBytes = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		otherResidentBytes = m_ResidentBytes[0];
+	}
+
+	m_Streamer->Update(Time, otherResidentBytes);
+}
+
+void CTexturesCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	while (false == m_Released.empty())
+		Evict(*m_Released.front());
+}
+
+STexturesCacheStatistics CTexturesCache::GetStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	STexturesCacheStatistics statistics;
+	statistics.Hits = m_Hits;
+	statistics.Misses = m_Misses;
+	statistics.Evictions = m_Evictions;
+	statistics.Textures = static_cast<uint32>(m_Entries[0].size() + m_Entries[1].size());
+	statistics.ResidentBytes = m_ResidentBytes[0] + m_ResidentBytes[1];
+	statistics.RetainedBytes = m_ReleasedBytes;
+	statistics.BudgetBytes = static_cast<uint64>(m_Budget->Get()) * 1024ull * 1024ull;
+	return statistics;
+}
+
+std::vector<STexturesCacheConsumer> CTexturesCache::GetTopConsumers(size_t Count) const
+{
+	std::vector<STexturesCacheConsumer> consumers;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		for (const auto& entries : m_Entries)
+		{
+			for (const auto& it : entries)
+			{
+				// Handle isn't locked here, last handle would be released under lock
+				STexturesCacheConsumer consumer;
+				consumer.FileName = it.second.FileName;
+				consumer.IsStreamed = it.second.IsStreamed;
+				consumer.Width = it.second.Texture->GetWidth();
+				consumer.Height = it.second.Texture->GetHeight();
+				consumer.Bytes = GetTextureBytes(it.second.Texture.get());
+				consumer.Users = static_cast<uint32>(it.second.Handle.use_count());
+				consumer.Hits = it.second.Hits;
+				consumers.push_back(consumer);
+			}
+		}
+	}
+
+	std::sort(consumers.begin(), consumers.end(), [](const STexturesCacheConsumer& Left, const STexturesCacheConsumer& Right) {
+		return Left.Bytes > Right.Bytes;
+	});
+
+	if (consumers.size() > Count)
+		consumers.resize(Count);
+
+	return consumers;
+}
+
+uint64 CTexturesCache::GetTextureBytes(const ITexture* Texture)
+{
+	return CTexturesStreamer::GetTextureBytes(Texture->GetWidth(), Texture->GetHeight());
+}
+
+
+
+//
+// Private
+//
+std::shared_ptr<ITexture> CTexturesCache::Load(const std::string& FileName, bool Streamed)
+{
+	std::unordered_map<std::string, SEntry>& entries = m_Entries[Streamed ? 1 : 0];
+	std::string normalizedFileName = CFileProbesCache::NormalizeFileName(FileName);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		const auto& entryIt = entries.find(normalizedFileName);
+		if (entryIt != entries.end())
+		{
+			entryIt->second.Hits++;
+			m_Hits++;
+			return CreateHandle(entryIt->second);
+		}
+
+		m_Misses++;
+	}
+
+	// Without lock, other threads continue to hit cache. Texture, that is loaded by two threads at same time, is loaded twice.
+	std::shared_ptr<ITexture> texture = Streamed ? m_Streamer->LoadTexture2D(FileName) : m_RenderDevice.GetObjectsFactory().LoadTexture2D(FileName);
+	if (texture == nullptr)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	const auto& insertResult = entries.insert(std::make_pair(normalizedFileName, SEntry()));
+	SEntry& entry = insertResult.first->second;
+	if (false == insertResult.second)
+		return CreateHandle(entry);
+
+	entry.Texture = texture;
+	entry.Key = normalizedFileName;
+	entry.FileName = FileName;
+	entry.IsStreamed = Streamed;
+	entry.Bytes = GetTextureBytes(texture.get());
+	entry.Hits = 0;
+	entry.IsReleased = false;
+	m_ResidentBytes[Streamed ? 1 : 0] += entry.Bytes;
+
+	std::shared_ptr<ITexture> handle = CreateHandle(entry);
+	Trim();
+	return handle;
+}
+
+std::shared_ptr<ITexture> CTexturesCache::CreateHandle(SEntry& Entry)
+{
+	// Texture is in use again
+	if (Entry.IsReleased)
+	{
+		m_Released.erase(Entry.ReleasedIt);
+		m_ReleasedBytes -= Entry.Bytes;
+		Entry.IsReleased = false;
+	}
+
+	// Returned handle is released outside of lock
+	if (std::shared_ptr<ITexture> handle = Entry.Handle.lock())
+		return handle;
+
+	// Handle keeps texture alive, if cache is destroyed before owners
+	std::weak_ptr<CTexturesCache> cache = shared_from_this();
+	std::shared_ptr<ITexture> texture = Entry.Texture;
+	std::string key = Entry.Key;
+	bool isStreamed = Entry.IsStreamed;
+	std::shared_ptr<ITexture> handle(texture.get(), [cache, texture, key, isStreamed](ITexture*) {
+		if (auto cacheObject = cache.lock())
+			cacheObject->OnHandleReleased(key, isStreamed);
+	});
+
+	Entry.Handle = handle;
+	return handle;
+}
+
+void CTexturesCache::OnHandleReleased(const std::string& Key, bool Streamed)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	std::unordered_map<std::string, SEntry>& entries = m_Entries[Streamed ? 1 : 0];
+	const auto& entryIt = entries.find(Key);
+	if (entryIt == entries.end())
+		return;
+
+	// Other thread has created new handle or released it already
+	SEntry& entry = entryIt->second;
+	if (false == entry.Handle.expired() || entry.IsReleased)
+		return;
+
+	// Streamed texture could change level since insert
+	uint64 bytes = GetTextureBytes(entry.Texture.get());
+	m_ResidentBytes[Streamed ? 1 : 0] = m_ResidentBytes[Streamed ? 1 : 0] - entry.Bytes + bytes;
+	entry.Bytes = bytes;
+
+	entry.IsReleased = true;
+	entry.ReleasedIt = m_Released.insert(m_Released.end(), &entry);
+	m_ReleasedBytes += entry.Bytes;
+
+	Trim();
+}
+
+void CTexturesCache::Evict(SEntry& Entry)
+{
+	_ASSERT(Entry.IsReleased);
+
+	m_Released.erase(Entry.ReleasedIt);
+	m_ReleasedBytes -= Entry.Bytes;
+	m_ResidentBytes[Entry.IsStreamed ? 1 : 0] -= Entry.Bytes;
+	m_Evictions++;
+
+	// Texture is freed here, it hasn't handles
+	std::string key = Entry.Key;
+	m_Entries[Entry.IsStreamed ? 1 : 0].erase(key);
+}
+
+void CTexturesCache::Trim()
+{
+	const uint64 budgetBytes = static_cast<uint64>(m_Budget->Get()) * 1024ull * 1024ull;
+
+	// Textures in use can't be freed, only released textures are evicted
+	while (m_ResidentBytes[0] + m_ResidentBytes[1] > budgetBytes && false == m_Released.empty())
+		Evict(*m_Released.front());
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "TexturesStreamer.h"
+
+//
+// Textures cache statistics and consumers report
+//
+struct ZN_API STexturesCacheStatistics
+{
+	STexturesCacheStatistics()
+		: Hits(0)
+		, Misses(0)
+		, Evictions(0)
+		, Textures(0)
+		, ResidentBytes(0)
+		, RetainedBytes(0)
+		, BudgetBytes(0)
+	{}
+
+	uint64 Hits;
+	uint64 Misses;
+	uint64 Evictions;     // Released textures, freed by budget
+	uint32 Textures;      // Alive textures in cache
+	uint64 ResidentBytes; // All alive textures
+	uint64 RetainedBytes; // Textures, that are kept alive only by cache
+	uint64 BudgetBytes;
+};
+
+struct ZN_API STexturesCacheConsumer
+{
+	std::string FileName;
+	bool        IsStreamed;
+	uint32      Width;
+	uint32      Height;
+	uint64      Bytes;
+	uint32      Users; // Owners except cache
+	uint64      Hits;
+};
+
+/**
+  * Textures are shared by normalized file name (see 'CFileProbesCache::NormalizeFileName'), so equal paths with different case or
+  * separators load once. Owners get handle of cached texture, cache is notified, when last handle is released.
+  * Released textures are kept in least recently released order and are freed from front of this list, when resident size is over budget.
+  * Resident size is tracked on insert, release and evict. Full resolution and streamed textures are cached separately (CPU users need full resolution).
+  * Streamed textures are accounted by level at insert and at last release.
+*/
+class ZN_API CTexturesCache
+	: public std::enable_shared_from_this<CTexturesCache>
+{
+public:
+	CTexturesCache(IBaseManager& BaseManager, IRenderDevice& RenderDevice);
+	virtual ~CTexturesCache();
+
+	std::shared_ptr<ITexture> LoadTexture2D(const std::string& FileName);
+	std::shared_ptr<ITexture> LoadStreamedTexture2D(const std::string& FileName); // Full resolution texture if streaming is disabled
+
+	CTexturesStreamer& GetStreamer() { return *m_Streamer; }
+	void Update(double Time); // Streamer update, once per frame
+	void Clear(); // Frees released textures
+
+	STexturesCacheStatistics GetStatistics() const;
+	std::vector<STexturesCacheConsumer> GetTopConsumers(size_t Count) const;
+
+	static uint64 GetTextureBytes(const ITexture* Texture);
+
+private:
+	struct SEntry
+	{
+		std::shared_ptr<ITexture>           Texture; // Resident until evicted
+		std::weak_ptr<ITexture>             Handle;  // Shared by owners
+		std::string                         Key;     // Normalized file name
+		std::string                         FileName;
+		bool                                IsStreamed;
+		uint64                              Bytes;
+		uint64                              Hits;
+		bool                                IsReleased;
+		std::list<SEntry*>::iterator        ReleasedIt;
+	};
+
+	std::shared_ptr<ITexture> Load(const std::string& FileName, bool Streamed);
+	std::shared_ptr<ITexture> CreateHandle(SEntry& Entry); // Under lock
+	void OnHandleReleased(const std::string& Key, bool Streamed);
+	void Evict(SEntry& Entry); // Under lock, entry is erased
+	void Trim();               // Under lock
+
+private:
+	std::shared_ptr<ISettingT<float>>        m_Budget;
+	std::shared_ptr<ISettingT<bool>>         m_StreamingEnabled;
+
+	mutable std::mutex                       m_Lock;
+	std::unordered_map<std::string, SEntry>  m_Entries[2];       // Full resolution, streamed
+	uint64                                   m_ResidentBytes[2];
+	std::list<SEntry*>                       m_Released;         // Least recently released first
+	uint64                                   m_ReleasedBytes;
+	uint64                                   m_Hits;
+	uint64                                   m_Misses;
+	uint64                                   m_Evictions;
+
+	std::shared_ptr<CTexturesStreamer>       m_Streamer; // Referenced weakly by queued mip loads
+
+private:
+	IBaseManager& m_BaseManager;
+	IRenderDevice& m_RenderDevice;
+};
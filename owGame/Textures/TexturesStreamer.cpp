@@ -0,0 +1,261 @@
+#include "stdafx.h"
+
+// General
+#include "TexturesStreamer.h"
+
+// Additional
+#include "Formats/ImageBLP.h"
+
+namespace
+{
+	const uint32 cMaxLoadsPerUpdate = 16;
+}
+
+//
+// Loads one mip level of BLP to existing texture object
+//
+class CTextureMipLoader
+	: public CLoadableObject
+{
+public:
+	CTextureMipLoader(IBaseManager& BaseManager, const std::shared_ptr<CTexturesStreamer>& Streamer, const std::shared_ptr<ITexture>& Texture, const std::string& FileName, uint32 Mip)
+		: m_BaseManager(BaseManager)
+		, m_Streamer(Streamer)
+		, m_Texture(Texture)
+		, m_FileName(FileName)
+		, m_Mip(Mip)
+	{}
+	virtual ~CTextureMipLoader()
+	{}
+
+	// CLoadableObject
+	bool Load() override
+	{
+		// Streamer was destroyed while load was in queue
+		std::shared_ptr<CTexturesStreamer> streamer = m_Streamer.lock();
+		if (streamer == nullptr)
+			return true;
+
+		std::shared_ptr<IFile> file = m_BaseManager.GetManager<IFilesManager>()->Open(m_FileName);
+		std::shared_ptr<CImageBLP> image = (file != nullptr) ? CImageBLP::CreateImage(file, m_Mip) : nullptr;
+		if (image != nullptr)
+			m_Texture->LoadTextureFromImage(image);
+
+		// Texture isn't streamed anymore after error
+		streamer->OnMipLoaded(m_Texture.get(), (image != nullptr) ? image->GetMip() : UINT32_MAX);
+		return true;
+	}
+
+private:
+	IBaseManager& m_BaseManager;
+	std::weak_ptr<CTexturesStreamer> m_Streamer;
+	std::shared_ptr<ITexture> m_Texture;
+	const std::string m_FileName;
+	const uint32 m_Mip;
+};
+
+
+
+CTexturesStreamer::CTexturesStreamer(IBaseManager& BaseManager, IRenderDevice& RenderDevice)
+	: m_BaseManager(BaseManager)
+	, m_RenderDevice(RenderDevice)
+	, m_LastUpdateTime(0.0)
+{
+	m_Budget = m_BaseManager.GetManager<ISettings>()->GetGroup("WoWSettings")->GetSettingT<float>("Textures_Streaming_Budget");
+	m_MinSize = m_BaseManager.GetManager<ISettings>()->GetGroup("WoWSettings")->GetSettingT<float>("Textures_Streaming_MinSize");
+	m_ScreenHeight = m_BaseManager.GetManager<ISettings>()->GetGroup("WoWSettings")->GetSettingT<float>("Textures_Streaming_ScreenHeight");
+	m_EvictTime = m_BaseManager.GetManager<ISettings>()->GetGroup("WoWSettings")->GetSettingT<float>("Textures_Streaming_EvictTime");
+}
+
+CTexturesStreamer::~CTexturesStreamer()
+{
+}
+
+std::shared_ptr<ITexture> CTexturesStreamer::LoadTexture2D(const std::string& FileName)
+{
+	std::shared_ptr<IFile> file = m_BaseManager.GetManager<IFilesManager>()->Open(FileName);
+
+	// Header is read once for levels info and image
+	BLPFormat::BLPHeader header = { 0 };
+	STexture streamedTexture;
+	if (file == nullptr || false == CImageBLP::ReadHeader(file, &header) || false == CImageBLP::GetMipsInfo(header, &streamedTexture.Width, &streamedTexture.Height, &streamedTexture.MipsCount))
+		return m_RenderDevice.GetObjectsFactory().LoadTexture2D(FileName);
+
+	streamedTexture.FileName = FileName;
+	streamedTexture.MinMip = 0;
+	while (streamedTexture.MinMip + 1 < streamedTexture.MipsCount && static_cast<float>(std::max(streamedTexture.Width, streamedTexture.Height) >> streamedTexture.MinMip) > m_MinSize->Get())
+		streamedTexture.MinMip++;
+
+	std::shared_ptr<CImageBLP> image = CImageBLP::CreateImage(file, header, streamedTexture.MinMip);
+	if (image == nullptr)
+		return nullptr;
+
+	std::shared_ptr<ITexture> texture = m_RenderDevice.GetObjectsFactory().CreateEmptyTexture();
+	texture->LoadTextureFromImage(image);
+
+	streamedTexture.Texture = texture;
+	streamedTexture.ResidentMip = image->GetMip();
+	streamedTexture.DesiredMip = streamedTexture.ResidentMip;
+	streamedTexture.IsLoading = false;
+	streamedTexture.RequestedSize = 0.0f;
+	streamedTexture.LastRequestTime = m_LastUpdateTime;
+
+	std::lock_guard<std::mutex> lock(m_Lock);
+	m_Textures[texture.get()] = streamedTexture;
+
+	return texture;
+}
+
+void CTexturesStreamer::RequestSize(const ITexture* Texture, float ScreenSize, double Time)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	const auto& textureIt = m_Textures.find(Texture);
+	if (textureIt != m_Textures.end())
+	{
+		textureIt->second.RequestedSize = std::max(textureIt->second.RequestedSize, ScreenSize);
+		textureIt->second.LastRequestTime = Time;
+	}
+}
+
+void CTexturesStreamer::Update(double Time, uint64 OtherResidentBytes)
+{
+	std::vector<std::shared_ptr<ILoadable>> loads;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		if (Time == m_LastUpdateTime)
+			return;
+
+		CalculateLevels(Time, OtherResidentBytes, loads);
+		m_LastUpdateTime = Time;
+	}
+
+	// Outside of lock, loaders report to streamer
+	for (const auto& load : loads)
+		m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(load);
+}
+
+uint64 CTexturesStreamer::GetResidentBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	uint64 residentBytes = 0;
+	for (const auto& it : m_Textures)
+		residentBytes += GetMipBytes(it.second, it.second.ResidentMip);
+	return residentBytes;
+}
+
+uint64 CTexturesStreamer::GetBudgetBytes() const
+{
+	return static_cast<uint64>(m_Budget->Get()) * 1024ull * 1024ull;
+}
+
+uint64 CTexturesStreamer::GetTextureBytes(uint32 Width, uint32 Height)
+{
+	return (static_cast<uint64>(Width) * static_cast<uint64>(Height) * 4ull * 4ull) / 3ull;
+}
+
+
+
+//
+// Private
+//
+void CTexturesStreamer::CalculateLevels(double Time, uint64 OtherResidentBytes, std::vector<std::shared_ptr<ILoadable>>& Loads)
+{
+	// Desired levels
+	uint64 desiredBytes = 0;
+	for (auto it = m_Textures.begin(); it != m_Textures.end(); )
+	{
+		STexture& texture = it->second;
+		if (texture.Texture.expired())
+		{
+			it = m_Textures.erase(it);
+			continue;
+		}
+
+		// Texture, that isn't requested in last frame (culled), keeps level until evict time
+		if (Time - texture.LastRequestTime > m_EvictTime->Get())
+			texture.DesiredMip = texture.MinMip;
+		else if (texture.RequestedSize > 0.0f)
+			texture.DesiredMip = GetMipForSize(texture, texture.RequestedSize);
+
+		texture.RequestedSize = 0.0f;
+		desiredBytes += GetMipBytes(texture, texture.DesiredMip);
+		++it;
+	}
+
+	// Budget, that isn't used by not streamed textures
+	const uint64 budgetBytes = (GetBudgetBytes() > OtherResidentBytes) ? (GetBudgetBytes() - OtherResidentBytes) : 0;
+	while (desiredBytes > budgetBytes)
+	{
+		bool isChanged = false;
+		for (auto& it : m_Textures)
+		{
+			STexture& texture = it.second;
+			if (texture.DesiredMip >= texture.MinMip)
+				continue;
+
+			desiredBytes -= GetMipBytes(texture, texture.DesiredMip);
+			texture.DesiredMip++;
+			desiredBytes += GetMipBytes(texture, texture.DesiredMip);
+			isChanged = true;
+		}
+
+		if (false == isChanged)
+			break;
+	}
+
+	// Loads
+	for (auto& it : m_Textures)
+	{
+		STexture& texture = it.second;
+		if (texture.IsLoading || texture.DesiredMip == texture.ResidentMip)
+			continue;
+
+		std::shared_ptr<ITexture> textureObject = texture.Texture.lock();
+		if (textureObject == nullptr)
+			continue;
+
+		texture.IsLoading = true;
+		Loads.push_back(std::make_shared<CTextureMipLoader>(m_BaseManager, shared_from_this(), textureObject, texture.FileName, texture.DesiredMip));
+
+		if (Loads.size() >= cMaxLoadsPerUpdate)
+			break;
+	}
+}
+
+uint32 CTexturesStreamer::GetMipForSize(const STexture& Texture, float ScreenSize) const
+{
+	const float texels = ScreenSize * m_ScreenHeight->Get();
+
+	uint32 mip = Texture.MinMip;
+	while (mip > 0 && static_cast<float>(std::max(Texture.Width, Texture.Height) >> mip) < texels)
+		mip--;
+
+	return mip;
+}
+
+uint64 CTexturesStreamer::GetMipBytes(const STexture& Texture, uint32 Mip) const
+{
+	return GetTextureBytes(std::max(Texture.Width >> Mip, 1u), std::max(Texture.Height >> Mip, 1u));
+}
+
+void CTexturesStreamer::OnMipLoaded(const ITexture* Texture, uint32 Mip)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+
+	const auto& textureIt = m_Textures.find(Texture);
+	if (textureIt == m_Textures.end())
+		return;
+
+	if (Mip == UINT32_MAX)
+	{
+		m_Textures.erase(textureIt);
+		return;
+	}
+
+	textureIt->second.IsLoading = false;
+	textureIt->second.ResidentMip = Mip;
+}
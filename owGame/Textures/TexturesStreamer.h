@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+  * BLP textures start with small stored mip and are reloaded with larger (or smaller) mips later.
+  * Level of texture is defined by the largest on-screen size, that was requested since last update,
+  * textures that aren't requested for evict time fall back to the smallest level.
+  * Levels are recalculated once per frame (also without requests, so not requested textures are evicted in time).
+  * Budget is shared with not streamed resident textures. If all levels don't fit into the rest of budget, all textures lose one level until they fit.
+  * Mips are loaded by loader threads, texture object is the same all time. Queued loads reference streamer weakly.
+*/
+class ZN_API CTexturesStreamer
+	: public std::enable_shared_from_this<CTexturesStreamer>
+{
+public:
+	CTexturesStreamer(IBaseManager& BaseManager, IRenderDevice& RenderDevice);
+	virtual ~CTexturesStreamer();
+
+	std::shared_ptr<ITexture> LoadTexture2D(const std::string& FileName);
+
+	// 'ScreenSize' is part of screen height, covered by object with texture. Requests are used by next update.
+	void RequestSize(const ITexture* Texture, float ScreenSize, double Time);
+
+	// Called once per frame. 'OtherResidentBytes' is size of not streamed textures, that are in budget too.
+	void Update(double Time, uint64 OtherResidentBytes);
+
+	uint64 GetResidentBytes() const;
+	uint64 GetBudgetBytes() const;
+
+	static uint64 GetTextureBytes(uint32 Width, uint32 Height); // RGBA and generated mips
+
+private:
+	struct STexture
+	{
+		std::weak_ptr<ITexture> Texture;
+		std::string             FileName;
+		uint32                  Width;     // Level 0
+		uint32                  Height;
+		uint32                  MipsCount;
+		uint32                  MinMip;    // Smallest resident level (initial)
+		uint32                  ResidentMip;
+		uint32                  DesiredMip;
+		bool                    IsLoading;
+		float                   RequestedSize;
+		double                  LastRequestTime;
+	};
+
+	void   CalculateLevels(double Time, uint64 OtherResidentBytes, std::vector<std::shared_ptr<ILoadable>>& Loads);
+	uint32 GetMipForSize(const STexture& Texture, float ScreenSize) const;
+	uint64 GetMipBytes(const STexture& Texture, uint32 Mip) const;
+
+	void   OnMipLoaded(const ITexture* Texture, uint32 Mip);
+	friend class CTextureMipLoader;
+
+private:
+	std::shared_ptr<ISettingT<float>>   m_Budget;
+	std::shared_ptr<ISettingT<float>>   m_MinSize;
+	std::shared_ptr<ISettingT<float>>   m_ScreenHeight;
+	std::shared_ptr<ISettingT<float>>   m_EvictTime;
+
+	mutable std::mutex                  m_Lock;
+	std::unordered_map<const ITexture*, STexture> m_Textures;
+	double                              m_LastUpdateTime;
+
+private:
+	IBaseManager& m_BaseManager;
+	IRenderDevice& m_RenderDevice;
+};
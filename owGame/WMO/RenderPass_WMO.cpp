@@ -9,7 +9,7 @@
 #include "WMO/WMO_Part_Material.h"
 
 CRenderPass_WMO::CRenderPass_WMO(IRenderDevice& RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneNodeListPass)
-	: CBaseList3DPass(RenderDevice, SceneNodeListPass, cWMOGroup_NodeType)
+	: CRecordedList3DPass(RenderDevice, SceneNodeListPass, cWMOGroup_NodeType)
 {
 	m_WoWSettings = RenderDevice.GetBaseManager().GetManager<ISettings>()->GetGroup("WoWSettings");
 }
@@ -57,9 +57,7 @@ std::shared_ptr<IRenderPassPipelined> CRenderPass_WMO::CreatePipeline(std::share
 EVisitResult CRenderPass_WMO::Visit(const ISceneNode3D* SceneNode3D)
 {
 	if (SceneNode3D->Is(cWMO_NodeType) || SceneNode3D->Is(cWMOGroup_NodeType))
-	{
 		return CBaseList3DPass::Visit(SceneNode3D);
-	}
 
 	return EVisitResult::Block;
 }
@@ -75,6 +73,22 @@ EVisitResult CRenderPass_WMO::Visit(const IGeometry * Geometry, const IMaterial
 }
 
 
+
+//
+// CRecordedList3DPass
+//
+bool CRenderPass_WMO::IsModelVisible(const ISceneNode3D* SceneNode, const IModel* Model) const
+{
+	if (false == SceneNode->Is(cWMOGroup_NodeType))
+		return true;
+
+	// Batches outside of portals screen rect
+	const CWMO_Group_Instance* wmoGroupInstance = static_cast<const CWMO_Group_Instance*>(SceneNode);
+	const WMO_Group_Part_Batch* batch = static_cast<const WMO_Group_Part_Batch*>(Model);
+	return wmoGroupInstance->IsBatchVisible(batch->GetIndex());
+}
+
+
 #if 0
 
 CRenderPass_WMO2::CRenderPass_WMO2(IRenderDevice & RenderDevice, const std::shared_ptr<BuildRenderListPassTemplated<CWMO_Group_Instance>>& List, std::shared_ptr<IScene> scene)
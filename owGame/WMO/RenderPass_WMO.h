@@ -1,9 +1,10 @@
 #pragma once
 
 #include "WMO_Base_Instance.h"
+#include "WowRecordedListPass.h"
 
 class ZN_API CRenderPass_WMO 
-	: public CBaseList3DPass
+	: public CRecordedList3DPass
 {
 public:
 	CRenderPass_WMO(IRenderDevice& RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneNodeListPass);
@@ -16,6 +17,10 @@ public:
     EVisitResult Visit(const ISceneNode3D* node) override final;
 	EVisitResult Visit(const IGeometry* Geometry, const IMaterial* Material, SGeometryDrawArgs GeometryDrawArgs = SGeometryDrawArgs()) override final;
 
+protected:
+	// CRecordedList3DPass
+	bool IsModelVisible(const ISceneNode3D* SceneNode, const IModel* Model) const override final;
+
 private:
 	std::shared_ptr<ISettingGroup> m_WoWSettings;
 };
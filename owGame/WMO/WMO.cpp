@@ -45,12 +45,10 @@ void CWMO::CreateInsances(const std::shared_ptr<CWMO_Base_Instance>& Parent) con
 	{
 		auto groupInstance = Parent->CreateSceneNode<CWMO_Group_Instance>(it);
 		Parent->AddGroupInstance(groupInstance);
-		if (it->m_GroupHeader.flags.IS_OUTDOOR)
+		if (it->m_GroupFlags.IS_OUTDOOR)
 			Parent->AddOutdoorGroupInstance(groupInstance);
 
-		groupInstance->Load();
-		groupInstance->SetState(ILoadable::ELoadableState::Loaded);
-		//m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(groupInstance);
+		// Group instances are added to load queue by parent (see CWMO_Base_Instance::QueueGroupsLoading)
 	}
 
 #ifdef USE_WMO_PORTALS_CULLING
@@ -70,6 +68,28 @@ void CWMO::CreateInsances(const std::shared_ptr<CWMO_Base_Instance>& Parent) con
 	}
 }
 
+bool CWMO::LoadGroup(uint32 GroupIndex) const
+{
+	std::lock_guard<std::mutex> lock(m_GroupsLoadLock);
+
+	const auto& group = m_Groups.at(GroupIndex);
+	if (group->GetState() == ILoadable::ELoadableState::Loaded)
+		return true;
+
+	if (group->GetState() == ILoadable::ELoadableState::Deleted)
+		return false;
+
+	if (false == group->Load())
+	{
+		Log::Error("CWMO: Unable to load group '%d' of '%s'.", GroupIndex, m_FileName.c_str());
+		group->SetState(ILoadable::ELoadableState::Deleted);
+		return false;
+	}
+
+	group->SetState(ILoadable::ELoadableState::Loaded);
+	return true;
+}
+
 bool CWMO::Load()
 {
 	// Textures
@@ -197,12 +217,10 @@ bool CWMO::Load()
 		for (const auto& groupInfo : m_ChunkReader->OpenChunkT<SWMO_GroupInfoDef>("MOGI"))
 		{
 			std::shared_ptr<WMO_Group> group = std::make_shared<WMO_Group>(m_BaseManager, m_RenderDevice, std::dynamic_pointer_cast<CWMO>(shared_from_this()), cntr++, groupInfo);
-			group->Load();
-			group->SetState(ELoadableState::Loaded);
-			//m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(group);
+			// Group data is loaded by first group instance (see LoadGroup)
 			m_Groups.push_back(group);
 
-			if (group->m_GroupHeader.flags.IS_OUTDOOR)
+			if (group->m_GroupFlags.IS_OUTDOOR)
 			{
 				m_OutdoorGroups.push_back(group);
 			}
@@ -226,18 +244,11 @@ bool CWMO::Load()
 		}
 	}
 
-	// Create portal controller
-	if (portals.size() > 0)
+	// Portal controllers are created per instance
+	for (const auto& it : portalsReferences)
 	{
-#ifdef USE_WMO_PORTALS_CULLING
-		m_PortalController = std::make_shared<CWMO_PortalsController>();
-
-		for (const auto& it : portalsReferences)
-		{
-			_ASSERT(it.portalIndex < portals.size());
-			_ASSERT(it.groupIndex < m_Groups.size());
-}
-#endif
+		_ASSERT(it.portalIndex < portals.size());
+		_ASSERT(it.groupIndex < m_Groups.size());
 	}
 
 	return true;
@@ -31,6 +31,10 @@ public:
 	// ISceneNodeProvider
 	void CreateInsances(const std::shared_ptr<CWMO_Base_Instance>& Parent) const;
 
+	// Loads group data once, for first group instance, that needs it. Called from loader threads.
+	// Failed group is marked deleted and isn't loaded again. Returns true if group is loaded.
+	bool LoadGroup(uint32 GroupIndex) const;
+
 	// CLoadableObject
 	bool Load() override;
 
@@ -49,6 +53,8 @@ public:
 	const SWMO_Doodad_PlacementInfo& GetDoodadPlacement(size_t Index) const { return m_DoodadsPlacementInfos.at(Index); }
 
 	bool useAmbColor() const { return !(m_Header.flags.skip_base_color); }
+	bool IsPortalsExists() const { return m_Header.nPortals > 0; }
+	const std::vector<std::shared_ptr<WMO_Group>>& GetGroups() const { return m_Groups; }
 
 private:
 	//-- Materials --//
@@ -59,15 +65,11 @@ private:
 	std::unique_ptr<char[]>												m_GroupNames;		    // MOGN chunk
 	std::vector<std::shared_ptr<WMO_Group>>                             m_Groups;				// MOGI chunk
 	std::vector<std::shared_ptr<WMO_Group>>                             m_OutdoorGroups;
+	mutable std::mutex                                                  m_GroupsLoadLock;
 
 	//-- Skybox --//
 	std::shared_ptr<CM2>                                                m_Skybox;
 
-	//-- Portals --//
-#ifdef USE_WMO_PORTALS_CULLING
-	std::shared_ptr<CWMO_PortalsController>                             m_PortalController;
-#endif
-	
 	//-- Visible block
 	std::vector<glm::vec3>                                              m_VisibleBlockVertices;	// MOVV chunk
 	std::vector<SWMO_VisibleBlockListDef>                               m_VisibleBlockList;		// MOVB chunk
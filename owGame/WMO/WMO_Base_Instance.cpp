@@ -3,9 +3,13 @@
 // General
 #include "WMO_Base_Instance.h"
 
+// Additional
+#include "WowCollisionMath.h"
+
 CWMO_Base_Instance::CWMO_Base_Instance(const std::shared_ptr<CWMO>& WMOObject)
     : CLoadableObject(WMOObject)
 	, m_WMOObject(WMOObject)
+	, m_IsGroupsLoadingQueued(false)
 {
 	SetType(cWMO_NodeType);
 }
@@ -19,6 +23,11 @@ CWMO_Base_Instance::~CWMO_Base_Instance()
 void CWMO_Base_Instance::CreateInstances()
 {
 	m_WMOObject->CreateInsances(std::dynamic_pointer_cast<CWMO_Base_Instance>(shared_from_this()));
+
+#ifdef USE_WMO_PORTALS_CULLING
+	if (m_WMOObject->IsPortalsExists())
+		m_PortalController = std::make_unique<CWMO_PortalsController>(GetBaseManager());
+#endif
 }
 
 
@@ -56,6 +65,48 @@ bool CWMO_Base_Instance::IsDoodadInSet(uint16 doodadIndex) const
 	return false;
 }
 
+void CWMO_Base_Instance::InvalidatePortals()
+{
+#ifdef USE_WMO_PORTALS_CULLING
+	if (m_PortalController)
+		m_PortalController->Invalidate();
+#endif
+}
+
+bool CWMO_Base_Instance::RayCast(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SWMO_CollisionHit* Hit, std::shared_ptr<CWMO_Group_Instance>* HitGroup, bool CameraQuery) const
+{
+	const glm::vec3 invDirection = 1.0f / Direction;
+
+	bool isHit = false;
+	SWMO_CollisionHit nearestHit;
+	nearestHit.Distance = MaxDistance;
+	for (const auto& groupInstanceWeak : m_GroupInstances)
+	{
+		std::shared_ptr<CWMO_Group_Instance> groupInstance = groupInstanceWeak.lock();
+		if (groupInstance == nullptr || groupInstance->getObject().GetCollision() == nullptr)
+			continue;
+
+		// Bounds
+		BoundingBox bounds = groupInstance->GetBoundingBox();
+		if (IntersectRayBox(bounds.getMin(), bounds.getMax(), Origin, invDirection, nearestHit.Distance) == FLT_MAX)
+			continue;
+
+		SWMO_CollisionHit hit;
+		if (groupInstance->RayCast(Origin, Direction, nearestHit.Distance, &hit, CameraQuery))
+		{
+			nearestHit = hit;
+			isHit = true;
+			if (HitGroup != nullptr)
+				*HitGroup = groupInstance;
+		}
+	}
+
+	if (isHit && Hit != nullptr)
+		*Hit = nearestHit;
+
+	return isHit;
+}
+
 
 
 //
@@ -73,10 +124,16 @@ void CWMO_Base_Instance::Update(const UpdateEventArgs& e)
 	if (GetState() != ILoadable::ELoadableState::Loaded)
 		return;
 
+	if (false == m_IsGroupsLoadingQueued)
+	{
+		QueueGroupsLoading(e.CameraForCulling);
+		m_IsGroupsLoadingQueued = true;
+	}
+
 #ifdef USE_WMO_PORTALS_CULLING
-	if (m_WMOObject->m_PortalController)
+	if (m_PortalController)
 	{
-		m_WMOObject->m_PortalController->Update(this, e.CameraForCulling);
+		m_PortalController->Update(this, e.CameraForCulling);
 	}
 #endif
 }
@@ -85,3 +142,95 @@ void CWMO_Base_Instance::Accept(IVisitor* visitor)
 {
 	SceneNode3D::Accept(visitor);
 }
+
+
+
+//
+// Protected
+//
+void CWMO_Base_Instance::QueueGroupsLoading(const ICameraComponent3D* Camera)
+{
+	const auto& groups = getWMO().GetGroups();
+	glm::vec3 localCamera = glm::inverse(GetWorldTransfom()) * glm::vec4(Camera->GetTranslation(), 1.0f);
+
+	// Portal hops from camera groups
+	std::vector<uint32> hops(groups.size(), UINT32_MAX);
+	std::vector<uint32> hopsQueue;
+	for (uint32 i = 0; i < groups.size(); i++)
+	{
+		if (groups[i]->m_GroupFlags.IS_OUTDOOR)
+			continue;
+
+		if (groups[i]->m_Bounds.isPointInside(localCamera))
+		{
+			hops[i] = 0;
+			hopsQueue.push_back(i);
+		}
+	}
+
+	// Camera is outside, start from exteriors
+	if (hopsQueue.empty())
+	{
+		for (uint32 i = 0; i < groups.size(); i++)
+		{
+			if (groups[i]->m_GroupFlags.IS_OUTDOOR)
+			{
+				hops[i] = 0;
+				hopsQueue.push_back(i);
+			}
+		}
+	}
+
+	for (size_t queueIndex = 0; queueIndex < hopsQueue.size(); queueIndex++)
+	{
+		uint32 groupIndex = hopsQueue[queueIndex];
+
+		for (const auto& portal : groups[groupIndex]->GetPortals())
+		{
+			for (int32 nextGroupIndex : { portal.getGrInner(), portal.getGrOuter() })
+			{
+				if (nextGroupIndex < 0 || nextGroupIndex >= static_cast<int32>(groups.size()))
+					continue;
+
+				if (hops[nextGroupIndex] != UINT32_MAX)
+					continue;
+
+				hops[nextGroupIndex] = hops[groupIndex] + 1;
+				hopsQueue.push_back(nextGroupIndex);
+			}
+		}
+	}
+
+	// Nearest by portals, then exteriors, then nearest by distance
+	std::vector<float> distances(groups.size());
+	for (uint32 i = 0; i < groups.size(); i++)
+	{
+		const BoundingBox& bounds = groups[i]->m_Bounds;
+		distances[i] = glm::distance(glm::clamp(localCamera, bounds.getMin(), bounds.getMax()), localCamera);
+	}
+
+	std::vector<uint32> order(groups.size());
+	for (uint32 i = 0; i < groups.size(); i++)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(), [&groups, &hops, &distances](uint32 Left, uint32 Right) {
+		if (hops[Left] != hops[Right])
+			return hops[Left] < hops[Right];
+
+		bool isLeftOutdoor = groups[Left]->m_GroupFlags.IS_OUTDOOR;
+		bool isRightOutdoor = groups[Right]->m_GroupFlags.IS_OUTDOOR;
+		if (isLeftOutdoor != isRightOutdoor)
+			return isLeftOutdoor;
+
+		return distances[Left] < distances[Right];
+	});
+
+	for (const auto& groupIndex : order)
+	{
+		if (auto groupInstance = m_GroupInstances[groupIndex].lock())
+		{
+			GetBaseManager().GetManager<ILoader>()->AddToLoadQueue(groupInstance);
+		}
+		else _ASSERT(false);
+	}
+}
@@ -33,13 +33,27 @@ public:
 	void AddOutdoorGroupInstance(const std::weak_ptr<CWMO_Group_Instance>& _group) { m_OutdoorGroupInstances.push_back(_group); }
 	const GroupInstances& getGroupOutdoorInstances() const { return m_OutdoorGroupInstances; }
 
+	// Room objects are created or loaded, portals visibility must be recalculated. Can be called from loader threads.
+	void InvalidatePortals();
+
+	// Nearest hit of all groups (groups are tested by world bounds first). 'HitGroup' is optional.
+	bool RayCast(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SWMO_CollisionHit* Hit = nullptr, std::shared_ptr<CWMO_Group_Instance>* HitGroup = nullptr, bool CameraQuery = false) const;
+
 	// SceneNode3D
 	void Initialize() override;
 	void Update(const UpdateEventArgs& e) override;
 	void Accept(IVisitor* visitor) override;
 
+protected:
+	// Groups are loaded asynchronously: groups, that are near by portals to camera group (or outdoor groups, if camera is outside), are loaded first
+	void QueueGroupsLoading(const ICameraComponent3D* Camera);
+
 protected:
 	std::shared_ptr<CWMO> m_WMOObject;	
 	GroupInstances  m_GroupInstances;
 	GroupInstances  m_OutdoorGroupInstances;
+	bool            m_IsGroupsLoadingQueued;
+#ifdef USE_WMO_PORTALS_CULLING
+	std::unique_ptr<CWMO_PortalsController> m_PortalController;
+#endif
 };
\ No newline at end of file
@@ -26,6 +26,27 @@ CWMO_Doodad_Instance::~CWMO_Doodad_Instance()
 
 
 
+//
+// CLoadableObject
+//
+bool CWMO_Doodad_Instance::Load()
+{
+	if (false == CM2_Base_Instance::Load())
+		return false;
+
+	// Model could be not loaded, when instance was created
+	GetColliderComponent()->SetBounds(getM2().GetBounds());
+
+	// Loaded bounds are not in cached portals result (parent is group instance)
+	if (auto groupInstance = GetParent().lock())
+		if (auto baseInstance = std::dynamic_pointer_cast<CWMO_Base_Instance>(groupInstance->GetParent().lock()))
+			baseInstance->InvalidatePortals();
+
+	return true;
+}
+
+
+
 //
 // IPortalRoomObject
 //
@@ -46,14 +67,10 @@ void CWMO_Doodad_Instance::Initialize()
 
 void CWMO_Doodad_Instance::Accept(IVisitor* visitor)
 {
-	auto parentOfParent = std::dynamic_pointer_cast<CWMO_Base_Instance>(GetParent().lock()->GetParent().lock());
-
-	if (parentOfParent->IsDoodadInSet(m_Index))
+	// Only doodads from active sets are created (see WMO_Group::CreateDoodadsInsances)
+	if (m_PortalVisibilityState)
 	{
-		if (m_PortalVisibilityState)
-		{
-			return CM2_Base_Instance::Accept(visitor);
-		}
+		return CM2_Base_Instance::Accept(visitor);
 	}
 }
 
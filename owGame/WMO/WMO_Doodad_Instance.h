@@ -14,6 +14,9 @@ public:
 	CWMO_Doodad_Instance(const std::shared_ptr<CM2>& M2Object, uint32 _index, const SWMO_Doodad_PlacementInfo& _placement);
 	virtual ~CWMO_Doodad_Instance();
 
+	// CLoadableObject
+	bool Load() override;
+
 	// IPortalRoomObject
 	BoundingBox GetBoundingBox() const override final;
 	inline void SetVisibilityState(bool _visibility) override { m_PortalVisibilityState = _visibility; }
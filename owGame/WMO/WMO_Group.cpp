@@ -17,6 +17,7 @@
 
 WMO_Group::WMO_Group(IBaseManager& BaseManager, IRenderDevice& RenderDevice, const std::shared_ptr<CWMO>& WMOModel, const uint32 GroupIndex, const SWMO_GroupInfoDef& GroupProto)
 	: CLoadableObject(WMOModel)
+	, m_GroupFlags(GroupProto.flags)
 	, m_IsMOCVExists(false)
 	, m_BaseManager(BaseManager)
 	, m_RenderDevice(RenderDevice)
@@ -28,38 +29,10 @@ WMO_Group::WMO_Group(IBaseManager& BaseManager, IRenderDevice& RenderDevice, con
 	else
 		m_GroupName = m_WMOModel.GetFilename() + "_Group" + std::to_string(GroupIndex);
 
-	m_Bounds = GroupProto.bounding_box.Convert();
-
-	char temp[MAX_PATH];
-	strcpy_s(temp, m_WMOModel.GetFilename().c_str());
-	temp[m_WMOModel.GetFilename().length() - 4] = 0;
-
-	char groupFilename[MAX_PATH];
-	sprintf_s(groupFilename, "%s_%03d.wmo", temp, m_GroupIndex);
-
-	std::unique_ptr<WoWChunkReader> chunkReader = std::make_unique<WoWChunkReader>(m_BaseManager, groupFilename);
-
-	// Version
-	if (auto buffer = chunkReader->OpenChunk("MVER"))
-	{
-		uint32 version;
-		buffer->readBytes(&version, 4);
-		_ASSERT(version == 17);
-	}
-
-	// Header
-	if (auto buffer = chunkReader->OpenChunk("MOGP"))
-	{
-		buffer->readBytes(&m_GroupHeader, sizeof(SWMO_Group_HeaderDef));
-		_ASSERT(m_GroupHeader.flags.HAS_3_MOTV == 0);
+	// Header is read from group file by Load
+	memset(&m_GroupHeader, 0x00, sizeof(SWMO_Group_HeaderDef));
 
-		// Real wmo group file contains only 2 chunks: MVER and MOGP.
-		// Start of MOGP is header (without fourcc).
-		// After header data places others chunks.
-		// We reinitialize chunk reader from current position
-		// chunkReader.reset() DON'T call this, because source buffer will be free.
-		m_ChunkReader = std::make_unique<WoWChunkReader>(m_BaseManager, buffer->getDataFromCurrent(), buffer->getSize() - sizeof(SWMO_Group_HeaderDef));
-	}
+	m_Bounds = GroupProto.bounding_box.Convert();
 }
 
 WMO_Group::~WMO_Group()
@@ -81,6 +54,12 @@ void WMO_Group::AddPortal(const CWMO_Part_Portal& WMOPartPortal)
 	m_Portals.push_back(WMOPartPortal);
 }
 
+void WMO_Group::RequestTexturesSize(float ScreenSize, double Time) const
+{
+	for (const auto& batch : m_WMOBatchIndexes)
+		m_WMOModel.GetMaterial(batch->GetMaterialIndex())->RequestTextureSize(ScreenSize, Time);
+}
+
 const std::vector<CWMO_Part_Portal>& WMO_Group::GetPortals() const
 {
 	return m_Portals;
@@ -123,41 +102,34 @@ void WMO_Group::CreateInsances(const std::shared_ptr<CWMO_Group_Instance>& Paren
 		Parent->AddRoomObject(liquidInstance);
 		
 	}
+}
 
-#if 1 && defined(USE_M2_MODELS)
-	//std::vector<SWMO_Doodad_SetInfo> activeDoodadSets;
-	//activeDoodadSets.push_back(m_WMOModel.m_DoodadsSetInfos[0]);
-
-	//if (parentAsWMOInstance->GetDoodadSetIndex() != -1)
-	//	activeDoodadSets.push_back(m_WMOModel.m_DoodadsSetInfos[parentAsWMOInstance->GetDoodadSetIndex()]);
+void WMO_Group::CreateDoodadsInsances(const std::shared_ptr<CWMO_Group_Instance>& Parent, const CWMO_Base_Instance& BaseInstance) const
+{
+	_ASSERT(GetState() == ILoadable::ELoadableState::Loaded);
 
-	// WMO Group M2s
-	//for (const auto& doodadSet : activeDoodadSets)
-	//{
-		//for (size_t i = doodadSet.start; i < doodadSet.start + doodadSet.size; i++)
-		for (size_t i = 0; i < m_DoodadsPlacementIndexes.size(); i++)
-		{
-			auto doodadPlacementIndex = m_DoodadsPlacementIndexes[i];
+#ifdef USE_M2_MODELS
+	// Only doodads from default and active sets. Models and instances are loaded asynchronously.
+	for (const auto& doodadPlacementIndex : m_DoodadsPlacementIndexes)
+	{
+		if (false == BaseInstance.IsDoodadInSet(doodadPlacementIndex))
+			continue;
 
-			const SWMO_Doodad_PlacementInfo& placement = m_WMOModel.GetDoodadPlacement(doodadPlacementIndex);
+		const SWMO_Doodad_PlacementInfo& placement = m_WMOModel.GetDoodadPlacement(doodadPlacementIndex);
 
-			std::string doodadFileName = m_WMOModel.GetDoodadFileName(placement.flags.nameIndex);
-			std::shared_ptr<CM2> m2 = m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadM2(m_RenderDevice, doodadFileName, true);
-			if (m2)
-			{
-				auto inst = Parent->CreateSceneNode<CWMO_Doodad_Instance>(m2, doodadPlacementIndex, placement);
-
-				if (!m_GroupHeader.flags.DO_NOT_USE_LIGHTING_DIFFUSE && !m_GroupHeader.flags.IS_OUTDOOR)
-					inst->setColor(placement.getColor());
+		std::string doodadFileName = m_WMOModel.GetDoodadFileName(placement.flags.nameIndex);
+		std::shared_ptr<CM2> m2 = m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadM2(m_RenderDevice, doodadFileName);
+		if (m2)
+		{
+			auto inst = Parent->CreateSceneNode<CWMO_Doodad_Instance>(m2, doodadPlacementIndex, placement);
 
-				inst->Load();
-				inst->SetState(ELoadableState::Loaded);
+			if (!m_GroupHeader.flags.DO_NOT_USE_LIGHTING_DIFFUSE && !m_GroupHeader.flags.IS_OUTDOOR)
+				inst->setColor(placement.getColor());
 
-				//m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(inst);
-				Parent->AddRoomObject(inst);
-			}
+			m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(inst);
+			Parent->AddRoomObject(inst);
 		}
-	//}
+	}
 #endif
 }
 
@@ -181,13 +153,49 @@ uint32 to_wmo_liquid(const SWMO_Group_HeaderDef& Header, int x)
 
 bool WMO_Group::Load()
 {
+	char temp[MAX_PATH];
+	strcpy_s(temp, m_WMOModel.GetFilename().c_str());
+	temp[m_WMOModel.GetFilename().length() - 4] = 0;
+
+	char groupFilename[MAX_PATH];
+	sprintf_s(groupFilename, "%s_%03d.wmo", temp, m_GroupIndex);
+
+	std::unique_ptr<WoWChunkReader> chunkReader = std::make_unique<WoWChunkReader>(m_BaseManager, groupFilename);
+
+	// Version
+	if (auto buffer = chunkReader->OpenChunk("MVER"))
+	{
+		uint32 version;
+		buffer->readBytes(&version, 4);
+		_ASSERT(version == 17);
+	}
+
+	// Header is published at the end, other threads read only flags from root file until group is loaded
+	SWMO_Group_HeaderDef groupHeader = { 0 };
+	if (auto buffer = chunkReader->OpenChunk("MOGP"))
+	{
+		buffer->readBytes(&groupHeader, sizeof(SWMO_Group_HeaderDef));
+		_ASSERT(groupHeader.flags.HAS_3_MOTV == 0);
+
+		// Real wmo group file contains only 2 chunks: MVER and MOGP.
+		// Start of MOGP is header (without fourcc).
+		// After header data places others chunks.
+		// We reinitialize chunk reader from current position
+		// chunkReader.reset() DON'T call this, because source buffer will be free.
+		m_ChunkReader = std::make_unique<WoWChunkReader>(m_BaseManager, buffer->getDataFromCurrent(), buffer->getSize() - sizeof(SWMO_Group_HeaderDef));
+	}
+
+	if (m_ChunkReader == nullptr)
+		return false;
+
 	// Buffer
-	uint16* dataFromMOVI = nullptr;
 	dataFromMOVT = nullptr;
 
-	// CollisionTEMP
-	uint32 collisionCount = 0;
-	SWMO_Group_MOBNDef* collisions = nullptr;
+	// Collision (tree is built after all chunks are read)
+	std::vector<uint16> collisionIndexes;
+	std::vector<glm::vec3> collisionVertices;
+	std::vector<SWMO_Group_MOBNDef> collisionNodes;
+	std::vector<uint16> collisionNodesFaces;
 
 	std::shared_ptr<IGeometry> geometry = m_RenderDevice.GetObjectsFactory().CreateGeometry();
 
@@ -203,6 +211,9 @@ bool WMO_Group::Load()
 	{
 		// Buffer
 		geometry->SetIndexBuffer(m_RenderDevice.GetObjectsFactory().CreateIndexBuffer((const uint16*)buffer->getData(), buffer->getSize() / sizeof(uint16)));
+
+		const uint16* indexes = (const uint16*)buffer->getData();
+		collisionIndexes.assign(indexes, indexes + buffer->getSize() / sizeof(uint16));
 	}
 
 
@@ -225,6 +236,7 @@ bool WMO_Group::Load()
 		geometry->AddVertexBuffer(BufferBinding("COLOR", 0), m_RenderDevice.GetObjectsFactory().CreateVertexBuffer(colors));
 
 		dataFromMOVT = vertexes;
+		collisionVertices.assign(vertexes, vertexes + vertexesCount);
 	}
 
 
@@ -262,7 +274,7 @@ bool WMO_Group::Load()
 	// Light references
 	if (auto buffer = m_ChunkReader->OpenChunk("MOLR"))
 	{
-		_ASSERT(m_GroupHeader.flags.HAS_LIGHTS);
+		_ASSERT(groupHeader.flags.HAS_LIGHTS);
 		uint32 lightsIndexesCount = buffer->getSize() / sizeof(uint16);
 		uint16* lightsIndexes = (uint16*)buffer->getDataFromCurrent();
 		for (uint32 i = 0; i < lightsIndexesCount; i++)
@@ -275,7 +287,7 @@ bool WMO_Group::Load()
 	// Doodad references
 	if (auto buffer = m_ChunkReader->OpenChunk("MODR"))
 	{
-		_ASSERT(m_GroupHeader.flags.HAS_DOODADS);
+		_ASSERT(groupHeader.flags.HAS_DOODADS);
 
 		uint32 doodadsIndexesCount = buffer->getSize() / sizeof(uint16);
 		uint16* doodadsIndexes = (uint16*)buffer->getDataFromCurrent();
@@ -283,35 +295,33 @@ bool WMO_Group::Load()
 	}
 
 
-	for (const auto& collision : m_ChunkReader->OpenChunkT<SWMO_Group_MOBNDef>("MOBN"))
+	// Collision BSP tree
+	for (const auto& collisionNode : m_ChunkReader->OpenChunkT<SWMO_Group_MOBNDef>("MOBN"))
 	{
-		std::shared_ptr<CWMO_Group_Part_BSP_Node> collisionNode = std::make_shared<CWMO_Group_Part_BSP_Node>(*this, collision);
-		m_CollisionNodes.push_back(collisionNode);
+		collisionNodes.push_back(collisionNode);
 	}
 
 
+	// Collision BSP leafs faces
 	if (auto buffer = m_ChunkReader->OpenChunk("MOBR"))
 	{
-		uint32 indexesCnt = buffer->getSize() / sizeof(uint16);
-		uint16* indices = (uint16*)buffer->getDataFromCurrent();
-
-		// Buffer
-		//geometry->SetIndexBuffer(m_RenderDevice.GetObjectsFactory().CreateIndexBuffer((const uint16*)buffer->getData(), buffer->getSize() / sizeof(uint16)));
+		uint32 facesCount = buffer->getSize() / sizeof(uint16);
+		const uint16* faces = (const uint16*)buffer->getDataFromCurrent();
+		collisionNodesFaces.assign(faces, faces + facesCount);
+	}
 
-		/*collisionIndexes.reserve(indexesCnt * 3);
-		for (uint32 i = 0; i < indexesCnt; i++)
-		{
-			collisionIndexes[i * 3 + 0] = dataFromMOVI[3 * indices[i] + 0];
-			collisionIndexes[i * 3 + 1] = dataFromMOVI[3 * indices[i] + 1];
-			collisionIndexes[i * 3 + 2] = dataFromMOVI[3 * indices[i] + 2];
-		}*/
+	if (false == collisionNodes.empty())
+	{
+		m_Collision = std::make_unique<CWMO_Group_Part_BSP>(collisionNodes, collisionNodesFaces, collisionVertices.data(), static_cast<uint32>(collisionVertices.size()), collisionIndexes.data(), static_cast<uint32>(collisionIndexes.size()), m_MaterialsInfo);
+		if (m_Collision->IsEmpty())
+			m_Collision.reset();
 	}
 
 
 	// Vertex colors
 	for (const auto& buffer : m_ChunkReader->OpenChunks("MOCV"))
 	{
-		_ASSERT(m_GroupHeader.flags.HAS_VERTEX_COLORS);
+		_ASSERT(groupHeader.flags.HAS_VERTEX_COLORS);
 
 		uint32 vertexColorsCount = buffer->getSize() / sizeof(CBgra);
 		CBgra* vertexColors = (CBgra*)buffer->getDataFromCurrent();
@@ -347,7 +357,7 @@ bool WMO_Group::Load()
 		//(
 		//	"WMO[%s]: Liq: headerID [%d] headerFlag [%d] MatID: [%d] MatShader[%d]", 
 		//	m_WMOModel.getFilename().c_str(),
-		//	m_GroupHeader.liquidType,
+		//	groupHeader.liquidType,
 		//	m_WMOModel.m_Header.flags.use_liquid_type_dbc_id, 
 		//	liquidHeader.materialID
 		//);
@@ -355,24 +365,24 @@ bool WMO_Group::Load()
 		uint32 liquid_type;
 		if (m_WMOModel.GetHeader().flags.use_liquid_type_dbc_id != 0)
 		{
-			if (m_GroupHeader.liquidType < 21)
+			if (groupHeader.liquidType < 21)
 			{
-				liquid_type = to_wmo_liquid(m_GroupHeader, m_GroupHeader.liquidType - 1);
+				liquid_type = to_wmo_liquid(groupHeader, groupHeader.liquidType - 1);
 			}
 			else
 			{
-				liquid_type = m_GroupHeader.liquidType;
+				liquid_type = groupHeader.liquidType;
 			}
 		}
 		else
 		{
-			if (m_GroupHeader.liquidType < 20)
+			if (groupHeader.liquidType < 20)
 			{
-				liquid_type = to_wmo_liquid(m_GroupHeader, m_GroupHeader.liquidType);
+				liquid_type = to_wmo_liquid(groupHeader, groupHeader.liquidType);
 			}
 			else
 			{
-				liquid_type = m_GroupHeader.liquidType + 1;
+				liquid_type = groupHeader.liquidType + 1;
 			}
 		}
 
@@ -381,7 +391,7 @@ bool WMO_Group::Load()
 
 	for (const auto& WMOGroupBatchProto : WMOBatchs)
 	{
-		std::shared_ptr<WMO_Group_Part_Batch> batch = std::make_shared<WMO_Group_Part_Batch>(m_RenderDevice, m_WMOModel, WMOGroupBatchProto);
+		std::shared_ptr<WMO_Group_Part_Batch> batch = std::make_shared<WMO_Group_Part_Batch>(m_RenderDevice, m_WMOModel, static_cast<uint32>(m_WMOBatchIndexes.size()), WMOGroupBatchProto);
 
 		batch->AddConnection(m_WMOModel.GetMaterial(WMOGroupBatchProto.material_id), geometry, SGeometryDrawArgs(WMOGroupBatchProto.indexStart, WMOGroupBatchProto.indexCount));
 
@@ -392,6 +402,7 @@ bool WMO_Group::Load()
 
 	m_ChunkReader.reset();
 
+	m_GroupHeader = groupHeader;
 	return true;
 }
 
@@ -11,10 +11,11 @@
 #include "WMO_Part_Portal.h"
 
 #include "WMO_Group_Part_Batch.h"
-#include "WMO_Group_Part_BSP_Node.h"
+#include "WMO_Group_Part_BSP.h"
 
 // FORWARD BEGIN
 class CWMO;
+class CWMO_Base_Instance;
 class CWMO_Group_Instance;
 class CWMO_Doodad_Instance;
 // FORWARD END
@@ -28,11 +29,15 @@ public:
 
 	// WMO_Group
 	const uint32 GetGroupIndex() const;
+	const CWMO& GetWMOModel() const { return m_WMOModel; }
 	void AddPortal(const CWMO_Part_Portal& WMOPartPortal);
 	const std::vector<CWMO_Part_Portal>& GetPortals() const;
+	const CWMO_Group_Part_BSP* GetCollision() const { return m_Collision.get(); } // nullptr if group don't have collision
+	void RequestTexturesSize(float ScreenSize, double Time) const;
 
 	// ISceneNodeProvider
 	void CreateInsances(const std::shared_ptr<CWMO_Group_Instance>& Parent) const;
+	void CreateDoodadsInsances(const std::shared_ptr<CWMO_Group_Instance>& Parent, const CWMO_Base_Instance& BaseInstance) const;
 
 	// CLoadableObject
 	bool Load() override;
@@ -44,7 +49,8 @@ private:
 public:
 	std::string                             m_GroupName;
 	
-	SWMO_Group_HeaderDef					m_GroupHeader;
+	SWMO_Group_HeaderDef					m_GroupHeader; // Valid after load
+	const SWMOGroup_Flags					m_GroupFlags;  // From root file (MOGI), can be read by any thread
 	BoundingBox								m_Bounds;
 
 public:
@@ -63,11 +69,8 @@ public:
 	std::vector<uint16>						m_DoodadsPlacementIndexes;
 
 	//-- Collision --//
-	// MOBN chunk
-	// MOBR chunk
-	std::vector<uint16>                     collisionIndexes;
-	std::shared_ptr<IBuffer>                 VB_Collision;
-	std::vector<std::shared_ptr<CWMO_Group_Part_BSP_Node>>	m_CollisionNodes;
+	// MOBN and MOBR chunks
+	std::unique_ptr<CWMO_Group_Part_BSP>    m_Collision;
 
 	//-- Liquid --//
 	std::shared_ptr<CWMO_Liquid>            m_WMOLiqiud;
@@ -95,10 +95,10 @@ struct SWMO_Group_MaterialDef
 
 	uint8 materialId; // 0xff for collision
 
-	bool isTransFace()  { return flags.UNK_0x01 && (flags.DETAIL || flags.RENDER); }
-	bool isColor()      { return !flags.COLLISION; }
-	bool isRenderFace() { return flags.RENDER && !flags.DETAIL; }
-	bool isCollidable() { return flags.COLLISION || isRenderFace(); }
+	bool isTransFace()  const { return flags.UNK_0x01 && (flags.DETAIL || flags.RENDER); }
+	bool isColor()      const { return !flags.COLLISION; }
+	bool isRenderFace() const { return flags.RENDER && !flags.DETAIL; }
+	bool isCollidable() const { return flags.COLLISION || isRenderFace(); }
 };
 
 struct SWMO_Group_BatchDef
@@ -12,6 +12,8 @@ CWMO_Group_Instance::CWMO_Group_Instance(const std::shared_ptr<WMO_Group>& WMOGr
 	: CLoadableObject(WMOGroupObject)
 	, m_PortalsVis(true)
 	, m_Calculated(false)
+	, m_IsPortalScreenRectExists(false)
+	, m_IsDoodadsCreated(false)
 	, m_WMOGroupObject(*WMOGroupObject)
 {
 	SetType(cWMOGroup_NodeType);
@@ -29,6 +31,9 @@ CWMO_Group_Instance::~CWMO_Group_Instance()
 //
 bool CWMO_Group_Instance::Load()
 {
+	if (false == m_WMOGroupObject.GetWMOModel().LoadGroup(m_WMOGroupObject.GetGroupIndex()))
+		return false;
+
 	m_WMOGroupObject.CreateInsances(std::dynamic_pointer_cast<CWMO_Group_Instance>(shared_from_this()));
 
 	return true;
@@ -64,6 +69,10 @@ void CWMO_Group_Instance::Reset()
 	SetVisibilityState(false);
 	SetCalculatedState(false);
 
+	m_PortalScreenRect = SWMO_PortalScreenRect();
+	m_IsPortalScreenRectExists = false;
+	m_BatchesVisibility.clear();
+
 	for (const auto& roomObjectPtr : GetRoomObjects())
 		if (auto roomObject = roomObjectPtr.lock())
 			roomObject->SetVisibilityState(false);
@@ -131,6 +140,144 @@ void CWMO_Group_Instance::CreatePortals(const std::shared_ptr<CWMO_Base_Instance
 	}
 }
 
+bool CWMO_Group_Instance::RayCast(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SWMO_CollisionHit* Hit, bool CameraQuery) const
+{
+	// Group is loaded asynchronously
+	if (GetState() != ILoadable::ELoadableState::Loaded)
+		return false;
+
+	const CWMO_Group_Part_BSP* collision = m_WMOGroupObject.GetCollision();
+	if (collision == nullptr)
+		return false;
+
+	glm::mat4 inverseTransform = glm::inverse(GetWorldTransfom());
+	glm::vec3 localOrigin = inverseTransform * glm::vec4(Origin, 1.0f);
+	glm::vec3 localDirection = glm::mat3(inverseTransform) * Direction;
+	float scale = glm::length(localDirection);
+
+	if (false == collision->RayCast(localOrigin, localDirection / scale, MaxDistance * scale, Hit, CameraQuery))
+		return false;
+
+	if (Hit != nullptr)
+	{
+		Hit->Distance /= scale;
+		Hit->Point = GetWorldTransfom() * glm::vec4(Hit->Point, 1.0f);
+		Hit->Normal = glm::normalize(glm::transpose(glm::mat3(inverseTransform)) * Hit->Normal);
+	}
+
+	return true;
+}
+
+bool CWMO_Group_Instance::IsCapsuleIntersects(const glm::vec3& A, const glm::vec3& B, float Radius, std::vector<uint32>& Faces, SWMO_CollisionHit* Hit, bool CameraQuery) const
+{
+	// Group is loaded asynchronously
+	if (GetState() != ILoadable::ELoadableState::Loaded)
+		return false;
+
+	const CWMO_Group_Part_BSP* collision = m_WMOGroupObject.GetCollision();
+	if (collision == nullptr)
+		return false;
+
+	glm::mat4 inverseTransform = glm::inverse(GetWorldTransfom());
+	float scale = glm::length(glm::vec3(inverseTransform[0]));
+
+	if (false == collision->IsCapsuleIntersects(inverseTransform * glm::vec4(A, 1.0f), inverseTransform * glm::vec4(B, 1.0f), Radius * scale, Faces, Hit, CameraQuery))
+		return false;
+
+	if (Hit != nullptr)
+	{
+		Hit->Distance /= scale;
+		Hit->Point = GetWorldTransfom() * glm::vec4(Hit->Point, 1.0f);
+		Hit->Normal = glm::normalize(glm::transpose(glm::mat3(inverseTransform)) * Hit->Normal);
+	}
+
+	return true;
+}
+
+bool CWMO_Group_Instance::IsAABBIntersects(const glm::vec3& Min, const glm::vec3& Max, std::vector<uint32>& Faces, SWMO_CollisionHit* Hit) const
+{
+	// Group is loaded asynchronously
+	if (GetState() != ILoadable::ELoadableState::Loaded)
+		return false;
+
+	const CWMO_Group_Part_BSP* collision = m_WMOGroupObject.GetCollision();
+	if (collision == nullptr)
+		return false;
+
+	// Box in group space is conservative for rotated instances
+	glm::mat4 inverseTransform = glm::inverse(GetWorldTransfom());
+	glm::vec3 localMin(FLT_MAX), localMax(-FLT_MAX);
+	for (uint32 corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 point((corner & 1) ? Max.x : Min.x, (corner & 2) ? Max.y : Min.y, (corner & 4) ? Max.z : Min.z);
+		glm::vec3 localPoint = inverseTransform * glm::vec4(point, 1.0f);
+		localMin = glm::min(localMin, localPoint);
+		localMax = glm::max(localMax, localPoint);
+	}
+
+	if (false == collision->IsAABBIntersects(localMin, localMax, Faces, Hit))
+		return false;
+
+	if (Hit != nullptr)
+	{
+		Hit->Point = GetWorldTransfom() * glm::vec4(Hit->Point, 1.0f);
+		Hit->Normal = glm::normalize(glm::transpose(glm::mat3(inverseTransform)) * Hit->Normal);
+		Hit->Distance = glm::distance(Hit->Point, (Min + Max) * 0.5f);
+	}
+
+	return true;
+}
+
+
+
+void CWMO_Group_Instance::AddPortalScreenRect(const SWMO_PortalScreenRect& Rect)
+{
+	if (m_IsPortalScreenRectExists)
+	{
+		m_PortalScreenRect.Merge(Rect);
+	}
+	else
+	{
+		m_PortalScreenRect = Rect;
+		m_IsPortalScreenRectExists = true;
+	}
+}
+
+void CWMO_Group_Instance::CalculateBatchesVisibility(const glm::mat4& ViewProjection)
+{
+	m_BatchesVisibility.clear();
+
+	if (GetState() != ILoadable::ELoadableState::Loaded)
+		return;
+
+	if (false == m_IsPortalScreenRectExists || m_PortalScreenRect.IsFullScreen())
+		return;
+
+	const auto& batches = m_WMOGroupObject.m_WMOBatchIndexes;
+	m_BatchesVisibility.resize(batches.size(), true);
+
+	for (const auto& batch : batches)
+	{
+		BoundingBox batchBounds = batch->GetBatchBounds();
+		batchBounds.transform(GetWorldTransfom());
+
+		SWMO_PortalScreenRect batchRect;
+		if (false == batchRect.Project(ViewProjection, batchBounds))
+			continue;
+
+		m_BatchesVisibility[batch->GetIndex()] = m_PortalScreenRect.IsIntersects(batchRect);
+	}
+}
+
+bool CWMO_Group_Instance::IsBatchVisible(uint32 BatchIndex) const
+{
+	if (m_BatchesVisibility.empty())
+		return true;
+
+	_ASSERT(BatchIndex < m_BatchesVisibility.size());
+	return m_BatchesVisibility[BatchIndex];
+}
+
 
 
 //
@@ -143,8 +290,38 @@ void CWMO_Group_Instance::Initialize()
 	GetColliderComponent()->SetDebugDrawMode(true);
 }
 
+void CWMO_Group_Instance::Update(const UpdateEventArgs& e)
+{
+	if (GetState() != ILoadable::ELoadableState::Loaded)
+		return;
+
+	if (false == m_IsDoodadsCreated && m_PortalsVis)
+	{
+		auto baseInstance = std::dynamic_pointer_cast<CWMO_Base_Instance>(GetParent().lock());
+		_ASSERT(baseInstance != nullptr);
+
+		m_WMOGroupObject.CreateDoodadsInsances(std::dynamic_pointer_cast<CWMO_Group_Instance>(shared_from_this()), *baseInstance);
+		m_IsDoodadsCreated = true;
+
+		// New room objects are not in cached portals result
+		baseInstance->InvalidatePortals();
+	}
+
+	// Textures level by on-screen size of group (part of screen height). Camera inside group requests full size.
+	if (e.Camera != nullptr && m_PortalsVis)
+	{
+		const BoundingBox& worldBounds = GetColliderComponent()->GetWorldBounds();
+		float radius = glm::length(worldBounds.getMax() - worldBounds.getMin()) * 0.5f;
+		float distance = glm::max(glm::distance((worldBounds.getMin() + worldBounds.getMax()) * 0.5f, e.Camera->GetTranslation()), radius);
+		m_WMOGroupObject.RequestTexturesSize(radius / distance * e.Camera->GetProjectionMatrix()[1][1], e.TotalTime);
+	}
+}
+
 void CWMO_Group_Instance::Accept(IVisitor* visitor)
 {
+	if (GetState() != ILoadable::ELoadableState::Loaded)
+		return;
+
 	if (m_PortalsVis)
 	{
 		SceneNode3D::Accept(visitor);
@@ -44,8 +44,20 @@ public:
 	void CreatePortals(const std::shared_ptr<CWMO_Base_Instance>& BaseInstance);
     const WMO_Group& getObject() const { return m_WMOGroupObject; }
 
+	// World space collision queries (see CWMO_Group_Part_BSP). Uniform scale is expected for capsule radius. 'Faces' is caller buffer, reused between queries.
+	bool RayCast(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SWMO_CollisionHit* Hit = nullptr, bool CameraQuery = false) const;
+	bool IsCapsuleIntersects(const glm::vec3& A, const glm::vec3& B, float Radius, std::vector<uint32>& Faces, SWMO_CollisionHit* Hit = nullptr, bool CameraQuery = false) const;
+	bool IsAABBIntersects(const glm::vec3& Min, const glm::vec3& Max, std::vector<uint32>& Faces, SWMO_CollisionHit* Hit = nullptr) const;
+
+	// Accumulated portals screen rect. Batches outside of it are skipped by render pass.
+	void AddPortalScreenRect(const SWMO_PortalScreenRect& Rect);
+	const SWMO_PortalScreenRect& GetPortalScreenRect() const { return m_PortalScreenRect; }
+	void CalculateBatchesVisibility(const glm::mat4& ViewProjection);
+	bool IsBatchVisible(uint32 BatchIndex) const;
+
 	// SceneNode3D
 	void Initialize() override;
+	void Update(const UpdateEventArgs& e) override;
 	void Accept(IVisitor* visitor) override;
 
 private:
@@ -53,6 +65,10 @@ private:
 	std::vector<std::weak_ptr<IPortalRoomObject>> m_PortalRoomObjects;
 	bool                                          m_PortalsVis;
 	bool                                          m_Calculated;
+	SWMO_PortalScreenRect                         m_PortalScreenRect;
+	bool                                          m_IsPortalScreenRectExists;
+	std::vector<bool>                             m_BatchesVisibility; // Empty if all batches are visible
+	bool                                          m_IsDoodadsCreated; // Doodads are created, when group is visible first time
 
 private:
 	const WMO_Group& m_WMOGroupObject;
@@ -0,0 +1,465 @@
+#include "stdafx.h"
+
+// General
+#include "WMO_Group_Part_BSP.h"
+
+// Additional
+#include "WowCollisionMath.h"
+
+namespace
+{
+	const float cEpsilon = 1e-8f;
+
+	// Real-Time Collision Detection, 5.1.5
+	glm::vec3 ClosestPointOnTriangle(const glm::vec3& P, const glm::vec3& A, const glm::vec3& B, const glm::vec3& C)
+	{
+		glm::vec3 ab = B - A;
+		glm::vec3 ac = C - A;
+		glm::vec3 ap = P - A;
+		float d1 = glm::dot(ab, ap);
+		float d2 = glm::dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+			return A;
+
+		glm::vec3 bp = P - B;
+		float d3 = glm::dot(ab, bp);
+		float d4 = glm::dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3)
+			return B;
+
+		float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			return A + ab * (d1 / (d1 - d3));
+
+		glm::vec3 cp = P - C;
+		float d5 = glm::dot(ab, cp);
+		float d6 = glm::dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6)
+			return C;
+
+		float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			return A + ac * (d2 / (d2 - d6));
+
+		float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+			return B + (C - B) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+		float denom = 1.0f / (va + vb + vc);
+		return A + ab * (vb * denom) + ac * (vc * denom);
+	}
+
+	// Real-Time Collision Detection, 5.1.9
+	void ClosestPointsOfSegments(const glm::vec3& P1, const glm::vec3& Q1, const glm::vec3& P2, const glm::vec3& Q2, glm::vec3& C1, glm::vec3& C2)
+	{
+		glm::vec3 d1 = Q1 - P1;
+		glm::vec3 d2 = Q2 - P2;
+		glm::vec3 r = P1 - P2;
+		float a = glm::dot(d1, d1);
+		float e = glm::dot(d2, d2);
+		float f = glm::dot(d2, r);
+
+		float s = 0.0f, t = 0.0f;
+		if (a <= cEpsilon && e <= cEpsilon)
+		{
+			// Both segments are points
+		}
+		else if (a <= cEpsilon)
+		{
+			t = glm::clamp(f / e, 0.0f, 1.0f);
+		}
+		else
+		{
+			float c = glm::dot(d1, r);
+			if (e <= cEpsilon)
+			{
+				s = glm::clamp(-c / a, 0.0f, 1.0f);
+			}
+			else
+			{
+				float b = glm::dot(d1, d2);
+				float denom = a * e - b * b;
+				s = (denom != 0.0f) ? glm::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+				t = (b * s + f) / e;
+				if (t < 0.0f)
+				{
+					t = 0.0f;
+					s = glm::clamp(-c / a, 0.0f, 1.0f);
+				}
+				else if (t > 1.0f)
+				{
+					t = 1.0f;
+					s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+				}
+			}
+		}
+
+		C1 = P1 + d1 * s;
+		C2 = P2 + d2 * t;
+	}
+
+	// Returns squared distance, closest points on segment and on triangle
+	float SegmentTriangleDistanceSqr(const glm::vec3& A, const glm::vec3& B, const glm::vec3& V0, const glm::vec3& V1, const glm::vec3& V2, glm::vec3& OnSegment, glm::vec3& OnTriangle)
+	{
+		float t;
+		if (IntersectRayTriangle(A, B - A, V0, V1, V2, t) && t <= 1.0f)
+		{
+			OnSegment = OnTriangle = A + (B - A) * t;
+			return 0.0f;
+		}
+
+		float best = FLT_MAX;
+		auto check = [&](const glm::vec3& PointOnSegment, const glm::vec3& PointOnTriangle) {
+			glm::vec3 delta = PointOnSegment - PointOnTriangle;
+			float distanceSqr = glm::dot(delta, delta);
+			if (distanceSqr < best)
+			{
+				best = distanceSqr;
+				OnSegment = PointOnSegment;
+				OnTriangle = PointOnTriangle;
+			}
+		};
+
+		check(A, ClosestPointOnTriangle(A, V0, V1, V2));
+		check(B, ClosestPointOnTriangle(B, V0, V1, V2));
+
+		const glm::vec3* edges[3][2] = { { &V0, &V1 }, { &V1, &V2 }, { &V2, &V0 } };
+		for (const auto& edge : edges)
+		{
+			glm::vec3 onSegment, onEdge;
+			ClosestPointsOfSegments(A, B, *edge[0], *edge[1], onSegment, onEdge);
+			check(onSegment, onEdge);
+		}
+
+		return best;
+	}
+
+	// Separating axis test (Akenine-Moller)
+	bool IsTriangleIntersectsBox(const glm::vec3& Center, const glm::vec3& HalfSize, const glm::vec3& V0, const glm::vec3& V1, const glm::vec3& V2)
+	{
+		const glm::vec3 v[3] = { V0 - Center, V1 - Center, V2 - Center };
+		const glm::vec3 edges[3] = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+
+		auto isSeparated = [&](const glm::vec3& Axis) -> bool {
+			float p0 = glm::dot(v[0], Axis);
+			float p1 = glm::dot(v[1], Axis);
+			float p2 = glm::dot(v[2], Axis);
+			float r = glm::dot(HalfSize, glm::abs(Axis));
+			return glm::min(p0, glm::min(p1, p2)) > r || glm::max(p0, glm::max(p1, p2)) < -r;
+		};
+
+		// Box faces
+		for (int axis = 0; axis < 3; axis++)
+		{
+			glm::vec3 unit(0.0f);
+			unit[axis] = 1.0f;
+			if (isSeparated(unit))
+				return false;
+		}
+
+		// Triangle plane
+		if (isSeparated(glm::cross(edges[0], edges[1])))
+			return false;
+
+		// Edges cross products
+		for (int axis = 0; axis < 3; axis++)
+		{
+			glm::vec3 unit(0.0f);
+			unit[axis] = 1.0f;
+			for (const auto& edge : edges)
+				if (isSeparated(glm::cross(unit, edge)))
+					return false;
+		}
+
+		return true;
+	}
+
+	inline glm::vec3 FaceNormal(const glm::vec3& V0, const glm::vec3& V1, const glm::vec3& V2, const glm::vec3& Towards)
+	{
+		glm::vec3 normal = glm::cross(V1 - V0, V2 - V0);
+		float length = glm::length(normal);
+		if (length < cEpsilon)
+			return glm::vec3(0.0f, 1.0f, 0.0f);
+		normal /= length;
+		return (glm::dot(normal, Towards - V0) < 0.0f) ? -normal : normal;
+	}
+}
+
+CWMO_Group_Part_BSP::CWMO_Group_Part_BSP(const std::vector<SWMO_Group_MOBNDef>& Nodes, const std::vector<uint16>& NodesFaces, const glm::vec3* Vertices, uint32 VerticesCount, const uint16* Indexes, uint32 IndexesCount, const std::vector<SWMO_Group_MaterialDef>& FacesMaterials)
+	: m_NodesFaces(NodesFaces)
+	, m_Vertices(Vertices, Vertices + VerticesCount)
+	, m_Indexes(Indexes, Indexes + IndexesCount)
+	, m_FacesMaterials(FacesMaterials)
+{
+	uint32 facesCount = IndexesCount / 3;
+
+	// Broken references disable collision of group
+	bool isFacesValid = std::all_of(m_NodesFaces.begin(), m_NodesFaces.end(), [&](uint16 Face) {
+		return Face < facesCount && m_Indexes[Face * 3 + 0] < VerticesCount && m_Indexes[Face * 3 + 1] < VerticesCount && m_Indexes[Face * 3 + 2] < VerticesCount;
+	});
+	if (false == isFacesValid)
+	{
+		Log::Warn("WMO BSP: Group contains invalid MOBR faces references. Collision is disabled for group.");
+		return;
+	}
+
+	m_Nodes.reserve(Nodes.size());
+	for (const auto& nodeProto : Nodes)
+	{
+		auto toChild = [&Nodes](int16 Child) -> int32 {
+			return (Child < 0 || static_cast<size_t>(Child) >= Nodes.size()) ? -1 : static_cast<int32>(Child);
+		};
+
+		SNode node;
+		node.Axis = -1;
+		node.Distance = 0.0f;
+		node.Children[0] = -1;
+		node.Children[1] = -1;
+		node.FaceStart = glm::min(nodeProto.faceStart, static_cast<uint32>(m_NodesFaces.size()));
+		node.FacesCount = glm::min<uint32>(nodeProto.nFaces, static_cast<uint32>(m_NodesFaces.size()) - node.FaceStart);
+
+		if ((nodeProto.flags & SWMO_Group_MOBNDef::Flag_Leaf) == 0)
+		{
+			// File axes to group space axes ('Fix_XZmY': x, z, -y)
+			switch (nodeProto.flags & SWMO_Group_MOBNDef::Flag_AxisMask)
+			{
+			case SWMO_Group_MOBNDef::Flag_XAxis:
+				node.Axis = 0;
+				node.Distance = nodeProto.planeDist;
+				node.Children[0] = toChild(nodeProto.negChild);
+				node.Children[1] = toChild(nodeProto.posChild);
+				break;
+			case SWMO_Group_MOBNDef::Flag_YAxis: // Inverted
+				node.Axis = 2;
+				node.Distance = -nodeProto.planeDist;
+				node.Children[0] = toChild(nodeProto.posChild);
+				node.Children[1] = toChild(nodeProto.negChild);
+				break;
+			case SWMO_Group_MOBNDef::Flag_ZAxis:
+				node.Axis = 1;
+				node.Distance = nodeProto.planeDist;
+				node.Children[0] = toChild(nodeProto.negChild);
+				node.Children[1] = toChild(nodeProto.posChild);
+				break;
+			default:
+				_ASSERT(false);
+				break;
+			}
+		}
+
+		m_Nodes.push_back(node);
+	}
+}
+
+CWMO_Group_Part_BSP::~CWMO_Group_Part_BSP()
+{
+}
+
+bool CWMO_Group_Part_BSP::RayCast(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SWMO_CollisionHit* Hit, bool CameraQuery) const
+{
+	if (IsEmpty())
+		return false;
+
+	float bestDistance = MaxDistance;
+	uint32 bestFace = UINT32_MAX;
+	RayCastNode(0, Origin, Direction, 0.0f, MaxDistance, CameraQuery, bestDistance, bestFace);
+
+	if (bestFace == UINT32_MAX)
+		return false;
+
+	if (Hit != nullptr)
+	{
+		glm::vec3 v0, v1, v2;
+		GetTriangle(bestFace, v0, v1, v2);
+
+		Hit->Distance = bestDistance;
+		Hit->Point = Origin + Direction * bestDistance;
+		Hit->Normal = FaceNormal(v0, v1, v2, Origin);
+		Hit->FaceIndex = bestFace;
+	}
+
+	return true;
+}
+
+bool CWMO_Group_Part_BSP::IsCapsuleIntersects(const glm::vec3& A, const glm::vec3& B, float Radius, std::vector<uint32>& Faces, SWMO_CollisionHit* Hit, bool CameraQuery) const
+{
+	GetFaces(glm::min(A, B) - glm::vec3(Radius), glm::max(A, B) + glm::vec3(Radius), Faces, CameraQuery);
+
+	float bestDistanceSqr = Radius * Radius;
+	uint32 bestFace = UINT32_MAX;
+	glm::vec3 bestOnSegment, bestOnTriangle;
+	for (const auto& face : Faces)
+	{
+		glm::vec3 v0, v1, v2;
+		GetTriangle(face, v0, v1, v2);
+
+		glm::vec3 onSegment, onTriangle;
+		float distanceSqr = SegmentTriangleDistanceSqr(A, B, v0, v1, v2, onSegment, onTriangle);
+		if (distanceSqr <= bestDistanceSqr)
+		{
+			bestDistanceSqr = distanceSqr;
+			bestFace = face;
+			bestOnSegment = onSegment;
+			bestOnTriangle = onTriangle;
+
+			if (Hit == nullptr)
+				break;
+		}
+	}
+
+	if (bestFace == UINT32_MAX)
+		return false;
+
+	if (Hit != nullptr)
+	{
+		glm::vec3 v0, v1, v2;
+		GetTriangle(bestFace, v0, v1, v2);
+
+		Hit->Distance = glm::sqrt(bestDistanceSqr);
+		Hit->Point = bestOnTriangle;
+		Hit->Normal = FaceNormal(v0, v1, v2, bestOnSegment);
+		Hit->FaceIndex = bestFace;
+	}
+
+	return true;
+}
+
+bool CWMO_Group_Part_BSP::IsAABBIntersects(const glm::vec3& Min, const glm::vec3& Max, std::vector<uint32>& Faces, SWMO_CollisionHit* Hit) const
+{
+	GetFaces(Min, Max, Faces);
+
+	glm::vec3 center = (Min + Max) * 0.5f;
+	glm::vec3 halfSize = (Max - Min) * 0.5f;
+	for (const auto& face : Faces)
+	{
+		glm::vec3 v0, v1, v2;
+		GetTriangle(face, v0, v1, v2);
+
+		if (false == IsTriangleIntersectsBox(center, halfSize, v0, v1, v2))
+			continue;
+
+		if (Hit != nullptr)
+		{
+			Hit->Point = ClosestPointOnTriangle(center, v0, v1, v2);
+			Hit->Distance = glm::distance(Hit->Point, center);
+			Hit->Normal = FaceNormal(v0, v1, v2, center);
+			Hit->FaceIndex = face;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+void CWMO_Group_Part_BSP::GetFaces(const glm::vec3& Min, const glm::vec3& Max, std::vector<uint32>& Faces, bool CameraQuery) const
+{
+	Faces.clear();
+	if (IsEmpty())
+		return;
+
+	GetFacesNode(0, Min, Max, CameraQuery, Faces);
+
+	// Faces, that cross planes, are referenced from some leafs
+	std::sort(Faces.begin(), Faces.end());
+	Faces.erase(std::unique(Faces.begin(), Faces.end()), Faces.end());
+}
+
+
+
+//
+// Private
+//
+bool CWMO_Group_Part_BSP::IsFaceCollidable(uint32 Face, bool CameraQuery) const
+{
+	if (Face >= m_FacesMaterials.size())
+		return true;
+
+	const SWMO_Group_MaterialDef& material = m_FacesMaterials[Face];
+	if (CameraQuery && material.flags.NOCAMCOLLIDE)
+		return false;
+
+	return material.isCollidable();
+}
+
+void CWMO_Group_Part_BSP::GetTriangle(uint32 Face, glm::vec3& V0, glm::vec3& V1, glm::vec3& V2) const
+{
+	V0 = m_Vertices[m_Indexes[Face * 3 + 0]];
+	V1 = m_Vertices[m_Indexes[Face * 3 + 1]];
+	V2 = m_Vertices[m_Indexes[Face * 3 + 2]];
+}
+
+void CWMO_Group_Part_BSP::GetFacesNode(int32 Node, const glm::vec3& Min, const glm::vec3& Max, bool CameraQuery, std::vector<uint32>& Faces) const
+{
+	if (Node < 0)
+		return;
+
+	const SNode& node = m_Nodes[Node];
+	if (node.Axis < 0)
+	{
+		for (uint32 i = node.FaceStart; i < node.FaceStart + node.FacesCount; i++)
+			if (IsFaceCollidable(m_NodesFaces[i], CameraQuery))
+				Faces.push_back(m_NodesFaces[i]);
+		return;
+	}
+
+	if (Min[node.Axis] < node.Distance)
+		GetFacesNode(node.Children[0], Min, Max, CameraQuery, Faces);
+	if (Max[node.Axis] >= node.Distance)
+		GetFacesNode(node.Children[1], Min, Max, CameraQuery, Faces);
+}
+
+void CWMO_Group_Part_BSP::RayCastNode(int32 Node, const glm::vec3& Origin, const glm::vec3& Direction, float MinDistance, float MaxDistance, bool CameraQuery, float& BestDistance, uint32& BestFace) const
+{
+	if (Node < 0 || MinDistance > BestDistance)
+		return;
+
+	const SNode& node = m_Nodes[Node];
+	if (node.Axis < 0)
+	{
+		for (uint32 i = node.FaceStart; i < node.FaceStart + node.FacesCount; i++)
+		{
+			uint32 face = m_NodesFaces[i];
+			if (false == IsFaceCollidable(face, CameraQuery))
+				continue;
+
+			glm::vec3 v0, v1, v2;
+			GetTriangle(face, v0, v1, v2);
+
+			float distance;
+			if (IntersectRayTriangle(Origin, Direction, v0, v1, v2, distance) && distance < BestDistance)
+			{
+				BestDistance = distance;
+				BestFace = face;
+			}
+		}
+		return;
+	}
+
+	float origin = Origin[node.Axis] + Direction[node.Axis] * MinDistance;
+	float direction = Direction[node.Axis];
+
+	int nearSide = (origin < node.Distance) ? 0 : 1;
+	if (origin == node.Distance)
+		nearSide = (direction < 0.0f) ? 0 : 1;
+
+	if (glm::abs(direction) < cEpsilon)
+	{
+		RayCastNode(node.Children[nearSide], Origin, Direction, MinDistance, MaxDistance, CameraQuery, BestDistance, BestFace);
+		return;
+	}
+
+	float splitDistance = (node.Distance - Origin[node.Axis]) / direction;
+	if (splitDistance <= MinDistance || splitDistance >= MaxDistance)
+	{
+		RayCastNode(node.Children[nearSide], Origin, Direction, MinDistance, MaxDistance, CameraQuery, BestDistance, BestFace);
+		return;
+	}
+
+	// Near half space first. Faces of leaf can be outside of leaf cell, so hits farther than split don't stop traversal.
+	RayCastNode(node.Children[nearSide], Origin, Direction, MinDistance, splitDistance, CameraQuery, BestDistance, BestFace);
+	if (BestDistance <= splitDistance)
+		return;
+
+	RayCastNode(node.Children[1 - nearSide], Origin, Direction, splitDistance, MaxDistance, CameraQuery, BestDistance, BestFace);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "WMO_Group_Headers.h"
+
+//
+// Result of WMO group collision query
+//
+struct SWMO_CollisionHit
+{
+	SWMO_CollisionHit()
+		: Distance(FLT_MAX)
+		, Point(0.0f)
+		, Normal(0.0f)
+		, FaceIndex(UINT32_MAX)
+	{}
+
+	float     Distance;  // Along ray (ray cast) or to query volume (capsule)
+	glm::vec3 Point;     // Nearest point on face
+	glm::vec3 Normal;    // Face normal, faces query
+	uint32    FaceIndex; // Triangle index in group (MOVI / MOPY)
+};
+
+/**
+  * Collision queries against WMO group geometry with MOBN tree and MOBR faces lists.
+  * Works in group space (converted with 'Fix_XZmY', MOBN planes are converted at build).
+  * Faces, that don't collide by MOPY flags, are skipped. Camera queries also skip NOCAMCOLLIDE faces.
+*/
+class CWMO_Group_Part_BSP
+{
+public:
+	CWMO_Group_Part_BSP(const std::vector<SWMO_Group_MOBNDef>& Nodes, const std::vector<uint16>& NodesFaces, const glm::vec3* Vertices, uint32 VerticesCount, const uint16* Indexes, uint32 IndexesCount, const std::vector<SWMO_Group_MaterialDef>& FacesMaterials);
+	virtual ~CWMO_Group_Part_BSP();
+
+	bool IsEmpty() const { return m_Nodes.empty(); }
+
+	// Nearest hit. Direction must be normalized.
+	bool RayCast(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, SWMO_CollisionHit* Hit, bool CameraQuery = false) const;
+
+	// Capsule (segment and radius) overlap. Hit is the nearest face to segment. 'Faces' is caller buffer, reused between queries.
+	bool IsCapsuleIntersects(const glm::vec3& A, const glm::vec3& B, float Radius, std::vector<uint32>& Faces, SWMO_CollisionHit* Hit, bool CameraQuery = false) const;
+
+	// Box overlap. Hit is the first found face. 'Faces' is caller buffer, reused between queries.
+	bool IsAABBIntersects(const glm::vec3& Min, const glm::vec3& Max, std::vector<uint32>& Faces, SWMO_CollisionHit* Hit) const;
+
+	// Collidable faces, that are in leafs touched by box (without exact test). 'Faces' is cleared, but keeps capacity.
+	void GetFaces(const glm::vec3& Min, const glm::vec3& Max, std::vector<uint32>& Faces, bool CameraQuery = false) const;
+
+private:
+	struct SNode
+	{
+		int32  Axis;      // Group space axis, -1 for leaf
+		float  Distance;  // Plane in group space
+		int32  Children[2]; // Lower and upper half spaces, -1 if absent
+		uint32 FaceStart; // In 'm_NodesFaces'
+		uint32 FacesCount;
+	};
+
+	bool IsFaceCollidable(uint32 Face, bool CameraQuery) const;
+	void GetTriangle(uint32 Face, glm::vec3& V0, glm::vec3& V1, glm::vec3& V2) const;
+	void GetFacesNode(int32 Node, const glm::vec3& Min, const glm::vec3& Max, bool CameraQuery, std::vector<uint32>& Faces) const;
+	void RayCastNode(int32 Node, const glm::vec3& Origin, const glm::vec3& Direction, float MinDistance, float MaxDistance, bool CameraQuery, float& BestDistance, uint32& BestFace) const;
+
+private:
+	std::vector<SNode>                  m_Nodes;
+	std::vector<uint16>                 m_NodesFaces;
+	std::vector<glm::vec3>              m_Vertices;
+	std::vector<uint16>                 m_Indexes;
+	std::vector<SWMO_Group_MaterialDef> m_FacesMaterials;
+};
@@ -9,13 +9,15 @@
 
 // Additional
 
-WMO_Group_Part_Batch::WMO_Group_Part_Batch(IRenderDevice& RenderDevice, const CWMO& WMOModel, const SWMO_Group_BatchDef& WMOGroupBatchProto)
+WMO_Group_Part_Batch::WMO_Group_Part_Batch(IRenderDevice& RenderDevice, const CWMO& WMOModel, uint32 Index, const SWMO_Group_BatchDef& WMOGroupBatchProto)
 	: ModelProxie(RenderDevice.GetObjectsFactory().CreateModel())
 	, m_ParentWMO(WMOModel)
+	, m_Index(Index)
 	, m_WMOGroupBatchProto(WMOGroupBatchProto)
 {
-	m_Bounds.setMin(glm::vec3(m_WMOGroupBatchProto.bx, m_WMOGroupBatchProto.by, m_WMOGroupBatchProto.bz));
-	m_Bounds.setMax(glm::vec3(m_WMOGroupBatchProto.tx, m_WMOGroupBatchProto.ty, m_WMOGroupBatchProto.tz));
+	// File space to group space (see 'Fix_XZmY')
+	m_Bounds.setMin(glm::vec3(m_WMOGroupBatchProto.bx, m_WMOGroupBatchProto.bz, -m_WMOGroupBatchProto.ty));
+	m_Bounds.setMax(glm::vec3(m_WMOGroupBatchProto.tx, m_WMOGroupBatchProto.tz, -m_WMOGroupBatchProto.by));
 	m_Bounds.calculateCenter();
 
 	SetBounds(m_Bounds);
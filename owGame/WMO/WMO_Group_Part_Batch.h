@@ -11,9 +11,14 @@ class WMO_Group_Part_Batch
 	: public ModelProxie
 {
 public:
-	WMO_Group_Part_Batch(IRenderDevice& RenderDevice, const CWMO& WMOModel, const SWMO_Group_BatchDef& WMOGroupBatchProto);
+	WMO_Group_Part_Batch(IRenderDevice& RenderDevice, const CWMO& WMOModel, uint32 Index, const SWMO_Group_BatchDef& WMOGroupBatchProto);
 	virtual ~WMO_Group_Part_Batch();
 
+	// WMO_Group_Part_Batch
+	uint32 GetIndex() const { return m_Index; }
+	uint32 GetMaterialIndex() const { return m_WMOGroupBatchProto.material_id; } // In MOMT
+	const BoundingBox& GetBatchBounds() const { return m_Bounds; } // Group space
+
 	// ModelProxie
 	bool Render(const RenderEventArgs& renderEventArgs) const override;
 
@@ -22,6 +27,7 @@ private:
 
 private:
 	const CWMO& m_ParentWMO;
+	const uint32 m_Index; // In MOBA
 	const SWMO_Group_BatchDef m_WMOGroupBatchProto;
 };
 
@@ -8,6 +8,7 @@
 
 WMO_Part_Material::WMO_Part_Material(IRenderDevice& RenderDevice, const CWMO& WMOModel, const SWMO_MaterialDef& WMOMaterialProto)
 	: MaterialProxie(RenderDevice.GetObjectsFactory().CreateMaterial(sizeof(MaterialProperties)))
+	, m_WoWObjectsCreator(RenderDevice.GetBaseManager().GetManager<IWoWObjectsCreator>())
 	, m_WMOModel(WMOModel)
 {
 	SetWrapper(this);
@@ -28,8 +29,9 @@ WMO_Part_Material::WMO_Part_Material(IRenderDevice& RenderDevice, const CWMO& WM
 
 	// This
 	std::string textureName = m_WMOModel.GetTextureName(WMOMaterialProto.diffuseNameIndex);
-	std::shared_ptr<ITexture> texture = RenderDevice.GetObjectsFactory().LoadTexture2D(textureName);
+	std::shared_ptr<ITexture> texture = m_WoWObjectsCreator->LoadStreamedTexture2D(RenderDevice, textureName);
 	SetTexture(0, texture);
+	m_DiffuseTexture = texture.get();
 
 	//if (m_WMOMaterialProto.envNameIndex)
 	//{
@@ -40,7 +42,7 @@ WMO_Part_Material::WMO_Part_Material(IRenderDevice& RenderDevice, const CWMO& WM
 
 	glm::vec4 color = fromARGB(WMOMaterialProto.diffColor);
 
-	m_BlendState = RenderDevice.GetBaseManager().GetManager<IWoWObjectsCreator>()->GetEGxBlend(WMOMaterialProto.blendMode);
+	m_BlendState = m_WoWObjectsCreator->GetEGxBlend(WMOMaterialProto.blendMode);
 
 	m_RasterizerState = RenderDevice.GetObjectsFactory().CreateRasterizerState();
 	m_RasterizerState->SetCullMode((WMOMaterialProto.flags.IsTwoSided != 0) ? IRasterizerState::CullMode::None : IRasterizerState::CullMode::Back);
@@ -55,6 +57,12 @@ WMO_Part_Material::~WMO_Part_Material()
 	}
 }
 
+void WMO_Part_Material::RequestTextureSize(float ScreenSize, double Time) const
+{
+	if (m_DiffuseTexture != nullptr)
+		m_WoWObjectsCreator->RequestTextureSize(m_DiffuseTexture, ScreenSize, Time);
+}
+
 void WMO_Part_Material::UpdateConstantBuffer() const
 {
     MaterialProxie::UpdateConstantBuffer(m_pProperties, sizeof(MaterialProperties));
@@ -17,6 +17,9 @@ public:
 	const std::shared_ptr<IBlendState>& GetBlendState() const { return m_BlendState; };
 	const std::shared_ptr<IRasterizerState>& GetRasterizerState() const { return m_RasterizerState; };
 
+	// Streamed diffuse texture level (see 'IWoWObjectsCreator::RequestTextureSize')
+	void RequestTextureSize(float ScreenSize, double Time) const;
+
     void UpdateConstantBuffer() const override;
 
 private:
@@ -38,6 +41,9 @@ private:
 	std::shared_ptr<IBlendState>        m_BlendState;
 	std::shared_ptr<IRasterizerState>   m_RasterizerState;
 
+	const ITexture*                     m_DiffuseTexture;
+
 private:
+	IWoWObjectsCreator* m_WoWObjectsCreator;
 	const CWMO& m_WMOModel;
 };
\ No newline at end of file
@@ -3,6 +3,97 @@
 // General
 #include "WMO_Portal_Instance.h"
 
+namespace
+{
+	const float cNearDepth = 0.001f;
+}
+
+//
+// SWMO_PortalScreenRect
+//
+bool SWMO_PortalScreenRect::IsEmpty() const
+{
+	return (Min.x >= Max.x) || (Min.y >= Max.y) || (MinDepth > MaxDepth);
+}
+
+bool SWMO_PortalScreenRect::IsFullScreen() const
+{
+	return (Min.x <= -1.0f) && (Min.y <= -1.0f) && (Max.x >= 1.0f) && (Max.y >= 1.0f) && (MinDepth <= 0.0f);
+}
+
+bool SWMO_PortalScreenRect::IsIntersects(const SWMO_PortalScreenRect& Other) const
+{
+	if (Other.Max.x < Min.x || Other.Min.x > Max.x)
+		return false;
+
+	if (Other.Max.y < Min.y || Other.Min.y > Max.y)
+		return false;
+
+	return Other.MaxDepth >= MinDepth;
+}
+
+void SWMO_PortalScreenRect::Intersect(const SWMO_PortalScreenRect& Other)
+{
+	Min = glm::max(Min, Other.Min);
+	Max = glm::min(Max, Other.Max);
+	MinDepth = glm::max(MinDepth, Other.MinDepth);
+}
+
+void SWMO_PortalScreenRect::Merge(const SWMO_PortalScreenRect& Other)
+{
+	Min = glm::min(Min, Other.Min);
+	Max = glm::max(Max, Other.Max);
+	MinDepth = glm::min(MinDepth, Other.MinDepth);
+	MaxDepth = glm::max(MaxDepth, Other.MaxDepth);
+}
+
+void SWMO_PortalScreenRect::Expand(float Value)
+{
+	Min -= glm::vec2(Value);
+	Max += glm::vec2(Value);
+}
+
+bool SWMO_PortalScreenRect::Project(const glm::mat4& ViewProjection, const glm::vec3* Points, size_t PointsCount)
+{
+	Min = glm::vec2(FLT_MAX);
+	Max = glm::vec2(-FLT_MAX);
+	MinDepth = FLT_MAX;
+	MaxDepth = 0.0f;
+
+	for (size_t i = 0; i < PointsCount; i++)
+	{
+		glm::vec4 clip = ViewProjection * glm::vec4(Points[i], 1.0f);
+		if (clip.w < cNearDepth)
+		{
+			*this = SWMO_PortalScreenRect();
+			return false;
+		}
+
+		glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+		Min = glm::min(Min, ndc);
+		Max = glm::max(Max, ndc);
+		MinDepth = glm::min(MinDepth, clip.w);
+		MaxDepth = glm::max(MaxDepth, clip.w);
+	}
+
+	return true;
+}
+
+bool SWMO_PortalScreenRect::Project(const glm::mat4& ViewProjection, const BoundingBox& Bounds)
+{
+	const glm::vec3& min = Bounds.getMin();
+	const glm::vec3& max = Bounds.getMax();
+
+	glm::vec3 corners[8];
+	for (uint32 i = 0; i < 8; i++)
+		corners[i] = glm::vec3((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+
+	return Project(ViewProjection, corners, 8);
+}
+
+
+
+
 CWMOPortalInstance::CWMOPortalInstance(const std::weak_ptr<IPortalRoom>& RoomInner, const std::weak_ptr<IPortalRoom>& RoomOuter, const std::vector<glm::vec3>& PortalVertices, const Plane& PortalPlane)
 	: m_RoomInner(RoomInner)
 	, m_RoomOuter(RoomOuter)
@@ -22,25 +113,9 @@ CWMOPortalInstance::~CWMOPortalInstance()
 //
 Frustum CWMOPortalInstance::CreatePolyFrustum(glm::vec3 Eye) const
 {
-	Plane _portalPlanes[15];
-	_ASSERT(m_Vertices.size() < 15);
-
-	for (size_t i = 0; i < m_Vertices.size(); i++)
-	{
-		glm::vec3 v1 = m_Vertices[i];
-		glm::vec3 v2 = m_Vertices[(i + 1) % m_Vertices.size()];
-
-		if (IsPositive(Eye))
-		{
-			_portalPlanes[i] = Plane(Eye, v1, v2);
-		}
-		else
-		{
-			_portalPlanes[i] = Plane(Eye, v2, v1);
-		}
-	}
-
-	return Frustum(_portalPlanes, m_Vertices.size());
+	std::vector<Plane> portalPlanes;
+	CreatePolyPlanes(Eye, portalPlanes);
+	return Frustum(portalPlanes.data(), portalPlanes.size());
 }
 
 bool CWMOPortalInstance::IsVisible(const Frustum& Frustum) const
@@ -65,3 +140,31 @@ std::shared_ptr<IPortalRoom> CWMOPortalInstance::GetRoomObject(glm::vec3 Eye) co
 {
 	return IsPositive(Eye) ? m_RoomInner.lock() : m_RoomOuter.lock();
 }
+
+
+
+//
+// CWMOPortalInstance
+//
+void CWMOPortalInstance::CreatePolyPlanes(const glm::vec3& Eye, std::vector<Plane>& Planes) const
+{
+	_ASSERT(m_Vertices.size() < 15);
+
+	Planes.clear();
+
+	bool isPositive = IsPositive(Eye);
+	for (size_t i = 0; i < m_Vertices.size(); i++)
+	{
+		const glm::vec3& v1 = m_Vertices[i];
+		const glm::vec3& v2 = m_Vertices[(i + 1) % m_Vertices.size()];
+
+		if (isPositive)
+		{
+			Planes.push_back(Plane(Eye, v1, v2));
+		}
+		else
+		{
+			Planes.push_back(Plane(Eye, v2, v1));
+		}
+	}
+}
@@ -1,5 +1,36 @@
 #pragma once
 
+//
+// Projected area of portal or object. Rect is in NDC, depth is view space distance.
+//
+struct SWMO_PortalScreenRect
+{
+	SWMO_PortalScreenRect()
+		: Min(-1.0f)
+		, Max(1.0f)
+		, MinDepth(0.0f)
+		, MaxDepth(FLT_MAX)
+	{}
+
+	bool IsEmpty() const;
+	bool IsFullScreen() const;
+
+	// Object rect is visible through portal rect, if areas are overlapped and object isn't closer then portal
+	bool IsIntersects(const SWMO_PortalScreenRect& Other) const;
+	void Intersect(const SWMO_PortalScreenRect& Other);
+	void Merge(const SWMO_PortalScreenRect& Other);
+	void Expand(float Value);
+
+	// Returns false and full screen rect if some point is behind near plane
+	bool Project(const glm::mat4& ViewProjection, const glm::vec3* Points, size_t PointsCount);
+	bool Project(const glm::mat4& ViewProjection, const BoundingBox& Bounds);
+
+	glm::vec2 Min;
+	glm::vec2 Max;
+	float     MinDepth;
+	float     MaxDepth;
+};
+
 class CWMOPortalInstance
 	: public IPortal
 {
@@ -14,6 +45,10 @@ public:
 	bool IsPositive(const glm::vec3& InvTranslateCamera) const override final;
 	std::shared_ptr<IPortalRoom> GetRoomObject(glm::vec3 Eye) const override final;
 
+	// CWMOPortalInstance
+	void CreatePolyPlanes(const glm::vec3& Eye, std::vector<Plane>& Planes) const;
+	const std::vector<glm::vec3>& GetVertices() const { return m_Vertices; }
+
 private:
 	std::weak_ptr<IPortalRoom> m_RoomInner;
 	std::weak_ptr<IPortalRoom> m_RoomOuter;
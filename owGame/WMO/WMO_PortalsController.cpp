@@ -12,8 +12,75 @@
 
 #ifdef USE_WMO_PORTALS_CULLING
 
-CWMO_PortalsController::CWMO_PortalsController()
-{}
+namespace
+{
+	// Cached portal rect must cover portal and objects rects, while camera is moved and turned up to cache thresholds (see 'WMO_Portals_CacheDistance' and 'WMO_Portals_CacheAngle').
+	// First order NDC shift of point at view depth Z is (F + 1) * Distance / Z for move and (F + 1 / F) * tan(Angle) for turn, F is focal scale of projection.
+	// View depth of point at range R changes up to Distance + R * 2 * sin(Angle / 2). Portal and objects are shifted both, so margins are doubled.
+	void ExpandByCacheThresholds(SWMO_PortalScreenRect& Rect, const glm::mat4& Projection, float CacheDistance, float CacheAngle)
+	{
+		// Camera can reach portal
+		if (Rect.MinDepth <= CacheDistance)
+		{
+			Rect = SWMO_PortalScreenRect();
+			return;
+		}
+
+		float focalMax = glm::max(glm::abs(Projection[0][0]), glm::abs(Projection[1][1]));
+		float focalMin = glm::min(glm::abs(Projection[0][0]), glm::abs(Projection[1][1]));
+		float angle = glm::radians(CacheAngle);
+
+		float screenMargin = (focalMax + 1.0f) * CacheDistance / Rect.MinDepth + (focalMax + 1.0f / focalMin) * glm::tan(angle);
+		float maxRange = Rect.MaxDepth * glm::sqrt(1.0f + 2.0f / (focalMin * focalMin));
+		float depthMargin = CacheDistance + maxRange * 2.0f * glm::sin(angle * 0.5f);
+
+		Rect.Expand(screenMargin * 2.0f);
+		Rect.MinDepth = glm::max(Rect.MinDepth - depthMargin * 2.0f, 0.0f);
+	}
+
+	bool CullBoxByPlanes(const std::vector<Plane>& Planes, const BoundingBox& Box)
+	{
+		const glm::vec3& min = Box.getMin();
+		const glm::vec3& max = Box.getMax();
+
+		for (const auto& plane : Planes)
+		{
+			bool isAllOutside = true;
+			for (uint32 i = 0; i < 8; i++)
+			{
+				glm::vec3 corner((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+				if (plane.distToPoint(corner) >= 0.0f)
+				{
+					isAllOutside = false;
+					break;
+				}
+			}
+
+			if (isAllOutside)
+				return true;
+		}
+
+		return false;
+	}
+}
+
+CWMO_PortalsController::CWMO_PortalsController(IBaseManager& BaseManager)
+	: m_IsCacheValid(false)
+	, m_IsInvalidated(false)
+	, m_LastCameraTranslate(0.0f)
+	, m_LastCameraDirection(0.0f)
+	, m_LastCameraProjection(1.0f)
+	, m_LastWorldTransform(1.0f)
+	, m_LastLoadedGroupsCount(0)
+	, m_Projection(1.0f)
+	, m_ViewProjection(1.0f)
+	, m_IsScreenRectsUsed(false)
+{
+	std::shared_ptr<ISettingGroup> wowSettings = BaseManager.GetManager<ISettings>()->GetGroup("WoWSettings");
+	m_CacheDistance = wowSettings->GetSettingT<float>("WMO_Portals_CacheDistance");
+	m_CacheAngle = wowSettings->GetSettingT<float>("WMO_Portals_CacheAngle");
+	m_ScreenRectsCulling = wowSettings->GetSettingT<bool>("WMO_Portals_ScreenRectsCulling");
+}
 
 CWMO_PortalsController::~CWMO_PortalsController()
 {}
@@ -23,118 +90,276 @@ void CWMO_PortalsController::Update(const CWMO_Base_Instance* SceneNodeInstance,
 	if (SceneNodeInstance->GetState() != ILoadable::ELoadableState::Loaded)
 		return;
 
-	// Reset all flags
+	glm::vec3 cameraTranslate = _camera->GetTranslation();
+	const glm::mat4& view = _camera->GetViewMatrix();
+	glm::vec3 cameraDirection = -glm::vec3(view[0][2], view[1][2], view[2][2]);
+
+	// Groups are loaded asynchronously, each loaded group changes result
+	size_t loadedGroupsCount = 0;
 	for (const auto& groupPtr : SceneNodeInstance->getGroupInstances())
 		if (auto group = groupPtr.lock())
-			group->Reset();
+			if (group->GetState() == ILoadable::ELoadableState::Loaded)
+				loadedGroupsCount++;
 
-	glm::vec3 cameraTranslate = _camera->GetTranslation();
-	Frustum cameraFrustum = _camera->GetFrustum();
-	bool insideIndoor = false;
+	// Groups, that contains camera
+	m_CameraGroups.clear();
 
 	BoundingBox wmoBaseInstanceBounds = const_cast<CWMO_Base_Instance*>(SceneNodeInstance)->GetColliderComponent()->GetBounds();
 	wmoBaseInstanceBounds.transform(SceneNodeInstance->GetWorldTransfom());
 
 	if (wmoBaseInstanceBounds.isPointInside(cameraTranslate))
 	{
-		for (const auto& groupPtr : SceneNodeInstance->getGroupInstances())
+		const auto& groups = SceneNodeInstance->getGroupInstances();
+		for (size_t i = 0; i < groups.size(); i++)
 		{
-			auto group = groupPtr.lock();
+			auto group = groups[i].lock();
 			if (group == nullptr)
 				continue;
 
-			// Group camera culling
 			if (group->GetBoundingBox().isPointInside(cameraTranslate) == false)
 				continue;
 
-			if (group->getObject().m_GroupHeader.flags.HAS_COLLISION == false)
+			if (group->getObject().m_GroupFlags.HAS_COLLISION == false)
 				continue;
 
-			if (group->getObject().m_GroupHeader.flags.IS_OUTDOOR)
+			if (group->getObject().m_GroupFlags.IS_OUTDOOR)
 				continue;
 
-			bool recurResult = Recur(SceneNodeInstance, group, cameraFrustum, cameraTranslate, cameraFrustum, true);
-			if (!recurResult)
-			{
-				continue;
-			}
-
-			if (group->getObject().m_GroupHeader.flags.IS_INDOOR)
-			{
-				insideIndoor = true;
-			}
+			m_CameraGroups.push_back(i);
 		}
 	}
 
-	//_ASSERT(insideOneAtLeast || !(m_ParentWMO->m_OutdoorGroups.empty()));
+	// Room objects were created or loaded
+	if (m_IsInvalidated.exchange(false))
+		m_IsCacheValid = false;
+
+	const glm::mat4& projection = _camera->GetProjectionMatrix();
+	if (IsCacheValid(SceneNodeInstance, cameraTranslate, cameraDirection, projection, loadedGroupsCount))
+		return;
+
+	m_IsScreenRectsUsed = m_ScreenRectsCulling->Get();
+	m_Projection = projection;
+	m_ViewProjection = projection * view;
+
+	Calculate(SceneNodeInstance, _camera->GetFrustum(), cameraTranslate);
+
+	m_IsCacheValid = true;
+	m_LastCameraTranslate = cameraTranslate;
+	m_LastCameraDirection = cameraDirection;
+	m_LastCameraProjection = projection;
+	m_LastWorldTransform = SceneNodeInstance->GetWorldTransfom();
+	m_LastLoadedGroupsCount = loadedGroupsCount;
+	std::swap(m_LastCameraGroups, m_CameraGroups);
+}
+
+void CWMO_PortalsController::Invalidate()
+{
+	m_IsInvalidated = true;
+}
+
+
+
+//
+// Private
+//
+bool CWMO_PortalsController::IsCacheValid(const CWMO_Base_Instance* SceneNodeInstance, const glm::vec3& CameraTranslate, const glm::vec3& CameraDirection, const glm::mat4& CameraProjection, size_t LoadedGroupsCount) const
+{
+	if (false == m_IsCacheValid)
+		return false;
+
+	if (m_LastLoadedGroupsCount != LoadedGroupsCount)
+		return false;
+
+	if (m_IsScreenRectsUsed != m_ScreenRectsCulling->Get())
+		return false;
+
+	if (m_LastCameraGroups != m_CameraGroups)
+		return false;
+
+	if (m_LastWorldTransform != SceneNodeInstance->GetWorldTransfom())
+		return false;
+
+	// FOV or aspect is changed
+	if (m_LastCameraProjection != CameraProjection)
+		return false;
+
+	if (glm::distance(m_LastCameraTranslate, CameraTranslate) > m_CacheDistance->Get())
+		return false;
+
+	if (glm::dot(m_LastCameraDirection, CameraDirection) < glm::cos(glm::radians(m_CacheAngle->Get())))
+		return false;
+
+	return true;
+}
+
+void CWMO_PortalsController::Calculate(const CWMO_Base_Instance* SceneNodeInstance, const Frustum& CameraFrustum, const glm::vec3& CameraTranslate)
+{
+	const auto& groups = SceneNodeInstance->getGroupInstances();
+
+	// Each room is visited once, so recursion depth is limited by groups count
+	if (m_PortalPlanes.size() < groups.size() + 1)
+	{
+		m_PortalPlanes.resize(groups.size() + 1);
+		for (auto& planes : m_PortalPlanes)
+			planes.reserve(16);
+
+		m_PortalRects.resize(groups.size() + 1);
+	}
+
+	// Reset all flags
+	for (const auto& groupPtr : groups)
+		if (auto group = groupPtr.lock())
+			group->Reset();
+
+	m_PortalPlanes[0].assign(CameraFrustum.getPlanes().begin(), CameraFrustum.getPlanes().end());
+	m_PortalRects[0] = SWMO_PortalScreenRect();
+
+	bool insideIndoor = false;
+	for (const auto& groupIndex : m_CameraGroups)
+	{
+		auto group = groups[groupIndex].lock();
+		if (group == nullptr)
+			continue;
+
+		if (false == Recur(group, CameraFrustum, CameraTranslate, 0))
+			continue;
+
+		if (group->getObject().m_GroupFlags.IS_INDOOR)
+			insideIndoor = true;
+	}
 
 	// If we outside WMO, then get outdorr group
-	if (!insideIndoor)
+	if (false == insideIndoor)
 	{
 		for (const auto& groupPtr : SceneNodeInstance->getGroupOutdoorInstances())
 		{
 			if (auto group = groupPtr.lock())
 			{
-				Recur(SceneNodeInstance, group, cameraFrustum, cameraTranslate, cameraFrustum, true);
+				Recur(group, CameraFrustum, CameraTranslate, 0);
 			}
 			else _ASSERT(false);
 		}
 	}
+
+	if (m_IsScreenRectsUsed)
+	{
+		for (const auto& groupPtr : groups)
+			if (auto group = groupPtr.lock())
+				group->CalculateBatchesVisibility(m_ViewProjection);
+	}
 }
 
-bool CWMO_PortalsController::Recur(const CWMO_Base_Instance* SceneNodeInstance, const std::shared_ptr<IPortalRoom>& Room, const Frustum& CameraFrustum, const glm::vec3& _InvWorldCamera, const Frustum& PortalFrustum, bool _isFirstIteration)
+bool CWMO_PortalsController::Recur(const std::shared_ptr<IPortalRoom>& Room, const Frustum& CameraFrustum, const glm::vec3& _InvWorldCamera, size_t Depth)
 {
-	if (Room == nullptr || Room->IsCalculated())
+	if (Room == nullptr)
+		return false;
+
+	// All rooms are group instances
+	CWMO_Group_Instance* group = static_cast<CWMO_Group_Instance*>(Room.get());
+	const SWMO_PortalScreenRect& portalRect = m_PortalRects[Depth];
+
+	if (Room->IsCalculated())
 	{
+		// Room is visible through other portal, extend it area
+		if (m_IsScreenRectsUsed && Depth > 0 && group->GetState() == ILoadable::ELoadableState::Loaded)
+		{
+			group->AddPortalScreenRect(portalRect);
+
+			for (const auto& roomObjectPtr : Room->GetRoomObjects())
+				if (auto roomObject = roomObjectPtr.lock())
+					if (IsRoomObjectVisible(roomObject, Depth))
+						roomObject->SetVisibilityState(true);
+		}
+
 		return false;
 	}
 
 	if (CameraFrustum.cullBox(Room->GetBoundingBox()))
 		return false;
 
+	if (m_IsScreenRectsUsed && Depth > 0)
+	{
+		SWMO_PortalScreenRect roomRect;
+		roomRect.Project(m_ViewProjection, Room->GetBoundingBox());
+		if (false == portalRect.IsIntersects(roomRect))
+			return false;
+	}
+
 	// Set visible for current
 	Room->SetVisibilityState(true);
 	Room->SetCalculatedState(true);
 
-	for (const auto& roomObjectPtr : Room->GetRoomObjects())
+	if (m_IsScreenRectsUsed)
+		group->AddPortalScreenRect(portalRect);
+
+	// Room objects are created by group loading, but portals are passed through not loaded groups too
+	if (group->GetState() == ILoadable::ELoadableState::Loaded)
 	{
-		if (auto roomObject = roomObjectPtr.lock())
+		for (const auto& roomObjectPtr : Room->GetRoomObjects())
 		{
-			if (_isFirstIteration || PortalFrustum.cullBox(roomObject->GetBoundingBox()) == false)
+			if (auto roomObject = roomObjectPtr.lock())
 			{
-				roomObject->SetVisibilityState(true);
+				if (IsRoomObjectVisible(roomObject, Depth))
+				{
+					roomObject->SetVisibilityState(true);
+				}
 			}
 		}
 	}
 
+	_ASSERT(Depth + 1 < m_PortalPlanes.size());
+
 	for (const auto& p : Room->GetPortals())
 	{
 		// If we don't see portal // TODO: Don't use it on first step
 		if (p->IsVisible(CameraFrustum) == false)
 			continue;
 
-		// And we don't see portal from other portal
-		if (p->IsVisible(PortalFrustum.getPlanes()) == false)
-			continue;
+		const CWMOPortalInstance* portal = static_cast<const CWMOPortalInstance*>(p.get());
 
-		// Build camera-to-poratl frustum
-		Frustum portalFrustum = p->CreatePolyFrustum(_InvWorldCamera);
+		if (m_IsScreenRectsUsed)
+		{
+			// Portal area, that is visible through previous portals
+			SWMO_PortalScreenRect& nextRect = m_PortalRects[Depth + 1];
+			const auto& vertices = portal->GetVertices();
+			nextRect.Project(m_ViewProjection, vertices.data(), vertices.size());
+			ExpandByCacheThresholds(nextRect, m_Projection, m_CacheDistance->Get(), m_CacheAngle->Get());
+			nextRect.Intersect(portalRect);
+			if (nextRect.IsEmpty())
+				continue;
+		}
+		else
+		{
+			// And we don't see portal from other portal
+			if (p->IsVisible(m_PortalPlanes[Depth]) == false)
+				continue;
+
+			// Build camera-to-poratl planes
+			portal->CreatePolyPlanes(_InvWorldCamera, m_PortalPlanes[Depth + 1]);
+		}
 
 		// Find attached to portal group
 		auto nextRoom = p->GetRoomObject(_InvWorldCamera);
 
-		Recur
-		(
-			SceneNodeInstance,
-			nextRoom,
-			CameraFrustum,
-			_InvWorldCamera,
-			portalFrustum,
-			false
-		);
+		Recur(nextRoom, CameraFrustum, _InvWorldCamera, Depth + 1);
 	}
 
 	return true;
 }
 
+bool CWMO_PortalsController::IsRoomObjectVisible(const std::shared_ptr<IPortalRoomObject>& RoomObject, size_t Depth) const
+{
+	if (Depth == 0)
+		return true;
+
+	if (m_IsScreenRectsUsed)
+	{
+		SWMO_PortalScreenRect objectRect;
+		objectRect.Project(m_ViewProjection, RoomObject->GetBoundingBox());
+		return m_PortalRects[Depth].IsIntersects(objectRect);
+	}
+
+	return CullBoxByPlanes(m_PortalPlanes[Depth], RoomObject->GetBoundingBox()) == false;
+}
+
 #endif
@@ -8,14 +8,50 @@ class CWMO_Base_Instance;
 
 #ifdef USE_WMO_PORTALS_CULLING
 
+/**
+  * Portals visibility of one WMO instance.
+  * Result of traversal is stored in group instances flags and is recalculated only if camera changes group,
+  * moves or turns more than thresholds, projection or instance is changed, or room objects are created or loaded. Portal planes are stored per recursion depth and reused.
+  * With screen rects culling portals are projected to NDC rects, that are intersected along recursion,
+  * and groups, batches and doodads are tested against accumulated rect and portal depth instead of planes.
+  * Portal rects are expanded by margin, that is derived from cache thresholds and portal depth, so cached result stays conservative.
+*/
 class CWMO_PortalsController
 {
 public:
-	CWMO_PortalsController();
+	CWMO_PortalsController(IBaseManager& BaseManager);
     virtual ~CWMO_PortalsController();
 	
 	void Update(const CWMO_Base_Instance* SceneNodeInstance, const ICameraComponent3D* _camera);
-	bool Recur(const CWMO_Base_Instance* SceneNodeInstance, const std::shared_ptr<IPortalRoom>& Room, const Frustum& CameraFrustum, const glm::vec3& _InvWorldCamera, const Frustum& _frustum, bool _isFirstIteration);
+	void Invalidate(); // Can be called from loader threads, result is recalculated on next update
+
+private:
+	bool IsCacheValid(const CWMO_Base_Instance* SceneNodeInstance, const glm::vec3& CameraTranslate, const glm::vec3& CameraDirection, const glm::mat4& CameraProjection, size_t LoadedGroupsCount) const;
+	void Calculate(const CWMO_Base_Instance* SceneNodeInstance, const Frustum& CameraFrustum, const glm::vec3& CameraTranslate);
+	bool Recur(const std::shared_ptr<IPortalRoom>& Room, const Frustum& CameraFrustum, const glm::vec3& _InvWorldCamera, size_t Depth);
+	bool IsRoomObjectVisible(const std::shared_ptr<IPortalRoomObject>& RoomObject, size_t Depth) const;
+
+private:
+	std::vector<std::vector<Plane>> m_PortalPlanes; // Per recursion depth, zero is camera frustum
+	std::vector<SWMO_PortalScreenRect> m_PortalRects; // Per recursion depth, zero is full screen
+	glm::mat4                       m_Projection;
+	glm::mat4                       m_ViewProjection;
+	bool                            m_IsScreenRectsUsed;
+
+	// Cache
+	bool                            m_IsCacheValid;
+	std::atomic<bool>               m_IsInvalidated;
+	glm::vec3                       m_LastCameraTranslate;
+	glm::vec3                       m_LastCameraDirection;
+	glm::mat4                       m_LastCameraProjection;
+	glm::mat4                       m_LastWorldTransform;
+	size_t                          m_LastLoadedGroupsCount;
+	std::vector<size_t>             m_LastCameraGroups;
+	std::vector<size_t>             m_CameraGroups;
+
+	std::shared_ptr<ISettingT<float>>    m_CacheDistance;
+	std::shared_ptr<ISettingT<float>>    m_CacheAngle;
+	std::shared_ptr<ISettingT<bool>>     m_ScreenRectsCulling;
 };
 
 #endif
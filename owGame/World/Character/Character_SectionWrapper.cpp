@@ -38,7 +38,7 @@ std::shared_ptr<ITexture> Character_SectionWrapper::getSkinTexture(const Charact
 			if (textureName.empty())
 				break;
 
-			return m_RenderDevice.GetObjectsFactory().LoadTexture2D(textureName);
+			return m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadTexture2D(m_RenderDevice, textureName);
 		}
 	}
 
@@ -58,7 +58,7 @@ std::shared_ptr<ITexture> Character_SectionWrapper::getSkinExtraTexture(const Ch
 			if (textureName.empty())
 				break;
 
-			return m_RenderDevice.GetObjectsFactory().LoadTexture2D(textureName);
+			return m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadTexture2D(m_RenderDevice, textureName);
 		}
 	}
 
@@ -85,7 +85,7 @@ std::shared_ptr<ITexture> Character_SectionWrapper::getFaceLowerTexture(const Ch
 			if (textureName.empty())
 				break;
 
-			return m_RenderDevice.GetObjectsFactory().LoadTexture2D(textureName);
+			return m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadTexture2D(m_RenderDevice, textureName);
 		}
 	}
 	return nullptr;
@@ -107,7 +107,7 @@ std::shared_ptr<ITexture> Character_SectionWrapper::getFaceUpperTexture(const Ch
 			if (textureName.empty())
 				break;
 
-			return m_RenderDevice.GetObjectsFactory().LoadTexture2D(textureName);
+			return m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadTexture2D(m_RenderDevice, textureName);
 		}
 	}
 	return nullptr;
@@ -300,7 +300,7 @@ std::shared_ptr<ITexture> Character_SectionWrapper::getHairTexture(const Charact
 			if (textureName.empty())
 				break;
 
-			return m_RenderDevice.GetObjectsFactory().LoadTexture2D(textureName);
+			return m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadTexture2D(m_RenderDevice, textureName);
 		}
 	}
 
@@ -323,7 +323,7 @@ std::shared_ptr<ITexture> Character_SectionWrapper::getHairScalpLowerTexture(con
 			if (textureName.empty())
 				break;
 
-			return m_RenderDevice.GetObjectsFactory().LoadTexture2D(textureName);
+			return m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadTexture2D(m_RenderDevice, textureName);
 		}
 	}
 
@@ -347,7 +347,7 @@ std::shared_ptr<ITexture> Character_SectionWrapper::getHairScalpUpperTexture(con
 			if (textureName.empty())
 				break;
 
-			return m_RenderDevice.GetObjectsFactory().LoadTexture2D(textureName);
+			return m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadTexture2D(m_RenderDevice, textureName);
 		}
 	}
 
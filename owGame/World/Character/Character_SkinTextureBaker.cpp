@@ -8,6 +8,9 @@
 
 // Additional
 #include "Character_SectionWrapper.h"
+#include "WowHash.h"
+
+#include <emmintrin.h>
 
 const CharacterSkinLayout::List  cSkinDefaultLayout = CharacterSkinLayout::LAYOUT_1;
 const uint32                     cSkinTextureWidth = 512;
@@ -42,16 +45,82 @@ Character_SkinTextureBaker::Character_SkinTextureBaker(IBaseManager& BaseManager
 
 std::shared_ptr<ITexture> Character_SkinTextureBaker::createTexture(const Character* _character) const
 {
-	std::shared_ptr<ITexture> bakedSkinTexture = m_RenderDevice.GetObjectsFactory().CreateEmptyTexture();
+	const CInet_CharacterTemplate& characterTemplate = _character->GetTemplate();
+
+	CharacterSkinKey key;
+	key.Race = static_cast<uint32>(characterTemplate.Race);
+	key.Gender = static_cast<uint32>(characterTemplate.Gender);
+	key.Skin = characterTemplate.skin;
+	key.Face = characterTemplate.face;
+	for (uint32 slot = 0; slot < INVENTORY_SLOT_BAG_END; slot++)
+		key.ItemsDisplayIDs[slot] = characterTemplate.ItemsTemplates[slot].m_DisplayId;
+
+	{
+		std::lock_guard<std::mutex> lock(m_BakedLock);
+
+		const auto& bakedIt = m_Baked.find(key);
+		if (bakedIt != m_Baked.end())
+			if (std::shared_ptr<ITexture> bakedTexture = bakedIt->second.lock())
+				return bakedTexture;
+	}
+
+	bool isComplete = false;
+	std::shared_ptr<ITexture> bakedSkinTexture = bakeTexture(_character, &isComplete);
+
+	// Items, that aren't loaded yet, don't have texture components. Such texture isn't shared.
+	if (isComplete)
+	{
+		std::lock_guard<std::mutex> lock(m_BakedLock);
+
+		for (auto it = m_Baked.begin(); it != m_Baked.end(); )
+		{
+			if (it->second.expired())
+				it = m_Baked.erase(it);
+			else
+				++it;
+		}
+
+		m_Baked[key] = bakedSkinTexture;
+	}
+
+	return bakedSkinTexture;
+}
+
+
+
+//
+// Private
+//
+bool Character_SkinTextureBaker::CharacterSkinKey::operator==(const CharacterSkinKey& Other) const
+{
+	return (Race == Other.Race) && (Gender == Other.Gender) && (Skin == Other.Skin) && (Face == Other.Face) &&
+		(std::memcmp(ItemsDisplayIDs, Other.ItemsDisplayIDs, sizeof(ItemsDisplayIDs)) == 0);
+}
+
+size_t Character_SkinTextureBaker::CharacterSkinKeyHash::operator()(const CharacterSkinKey& Key) const
+{
+	// Key is hashed as array of uint32 fields, so it must have no other fields and no padding
+	static_assert(std::is_same<decltype(CharacterSkinKey::Race), uint32>::value && std::is_same<decltype(CharacterSkinKey::Gender), uint32>::value, "CharacterSkinKey fields must be uint32");
+	static_assert(std::is_same<decltype(CharacterSkinKey::Skin), uint32>::value && std::is_same<decltype(CharacterSkinKey::Face), uint32>::value, "CharacterSkinKey fields must be uint32");
+	static_assert(std::is_same<std::remove_extent<decltype(CharacterSkinKey::ItemsDisplayIDs)>::type, uint32>::value, "CharacterSkinKey fields must be uint32");
+	static_assert(sizeof(CharacterSkinKey) == sizeof(uint32) * (4 + INVENTORY_SLOT_BAG_END), "CharacterSkinKey must have no padding or other fields");
+
+	const uint32* fields = reinterpret_cast<const uint32*>(&Key);
+	uint64 hash = cHashFNV1aOffset;
+	for (size_t i = 0; i < sizeof(CharacterSkinKey) / sizeof(uint32); i++)
+		hash = HashFNV1a(hash, fields[i]);
+	return static_cast<size_t>(hash);
+}
 
-	m_Pixels = new PixelData[cSkinTextureWidth * cSkinTextureHeight];
-	memset(m_Pixels, 0x00, sizeof(PixelData) * cSkinTextureWidth * cSkinTextureHeight);
+std::shared_ptr<ITexture> Character_SkinTextureBaker::bakeTexture(const Character* _character, bool* _isComplete) const
+{
+	std::vector<PixelData> pixels(cSkinTextureWidth * cSkinTextureHeight, PixelData{ 0, 0, 0, 0 });
 
 	Character_SectionWrapper sectionSrapper(m_BaseManager, m_RenderDevice);
 
 	// 1. Get skin texture as pattern
 	{
-		FillWithSkin(sectionSrapper.getSkinTexture(_character));
+		FillWithSkin(pixels.data(), sectionSrapper.getSkinTexture(_character));
 	}
 
 	// 2. Hide boobs :)
@@ -59,83 +128,121 @@ std::shared_ptr<ITexture> Character_SkinTextureBaker::createTexture(const Charac
 		// Female
 		std::string nakedUpperTexture = sectionSrapper.getNakedTorsoTexture(_character);
 		if (nakedUpperTexture.length() > 0)
-			FillPixels(DBC_CharComponent_Sections::TORSO_UPPER, m_RenderDevice.GetObjectsFactory().LoadTexture2D(nakedUpperTexture));
+			FillPixels(pixels.data(), DBC_CharComponent_Sections::TORSO_UPPER, m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadTexture2D(m_RenderDevice, nakedUpperTexture));
 
 		// Male + Female
 		std::string nakedLowerTexture = sectionSrapper.getNakedPelvisTexture(_character);
 		_ASSERT(nakedLowerTexture.length() > 0);
-		FillPixels(DBC_CharComponent_Sections::LEGS_UPPER, m_RenderDevice.GetObjectsFactory().LoadTexture2D(nakedLowerTexture));
+		FillPixels(pixels.data(), DBC_CharComponent_Sections::LEGS_UPPER, m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadTexture2D(m_RenderDevice, nakedLowerTexture));
 	}
 
 	// 3. Apply items texture components
+	*_isComplete = true;
 	{
 		for (uint32 slot = 0; slot < INVENTORY_SLOT_BAG_END; slot++)
 		{
+			std::shared_ptr<const CItem_VisualData> itemVisualData = _character->getItemTextureComponents(static_cast<EInventoryType>(slot));
+			if (itemVisualData->m_DisplayId != 0 && itemVisualData->GetState() != ILoadable::ELoadableState::Loaded)
+				*_isComplete = false;
+
 			for (uint32 comp = 0; comp < static_cast<size_t>(DBC_CharComponent_Sections::ITEMS_COUNT); comp++)
 			{
-				std::shared_ptr<ITexture> itemComponentTexture = _character->getItemTextureComponents(static_cast<EInventoryType>(slot))->getTextureComponent((DBC_CharComponent_Sections)comp);
+				std::shared_ptr<ITexture> itemComponentTexture = itemVisualData->getTextureComponent((DBC_CharComponent_Sections) comp);
 				if (itemComponentTexture == nullptr)
 					continue;
 
-				FillPixels((DBC_CharComponent_Sections) comp, itemComponentTexture);
+				FillPixels(pixels.data(), (DBC_CharComponent_Sections) comp, itemComponentTexture);
 			}
 		}
 	}
 
 	// 4. Final
 	std::shared_ptr<CImageBase> image = std::make_shared<CImageBase>(cSkinTextureWidth, cSkinTextureHeight, 32, true);
-	std::memmove(image->GetDataEx(), m_Pixels, image->GetHeight() * image->GetStride());
+	std::memmove(image->GetDataEx(), pixels.data(), image->GetHeight() * image->GetStride());
 
+	std::shared_ptr<ITexture> bakedSkinTexture = m_RenderDevice.GetObjectsFactory().CreateEmptyTexture();
 	bakedSkinTexture->LoadTextureFromImage(image);
-	SafeDeleteArray(m_Pixels);
-
 	return bakedSkinTexture;
 }
 
-void Character_SkinTextureBaker::FillWithSkin(std::shared_ptr<ITexture> _skinTexture) const
+void Character_SkinTextureBaker::FillWithSkin(PixelData* _pixels, std::shared_ptr<ITexture> _skinTexture) const
 {
 	_ASSERT(_skinTexture != nullptr);
 	_ASSERT(_skinTexture->GetWidth() == (cSkinTextureWidth / 2) || _skinTexture->GetWidth() == cSkinTextureWidth);
 
-	const PixelData* skinTexturePixels = (const PixelData*)(_skinTexture->GetBuffer().data());
+	const uint32* skinTexturePixels = (const uint32*)(_skinTexture->GetBuffer().data());
+	const uint32 skinTextureWidth = _skinTexture->GetWidth();
 
-	_ASSERT(cSkinTextureWidth >= _skinTexture->GetWidth());
-	uint32 divSmall = cSkinTextureWidth / _skinTexture->GetWidth();
+	_ASSERT(cSkinTextureWidth >= skinTextureWidth);
+	uint32 divSmall = cSkinTextureWidth / skinTextureWidth;
 
-	for (uint32 x = 0; x < cSkinTextureWidth; x++)
+	for (uint32 y = 0; y < cSkinTextureHeight; y++)
 	{
-		for (uint32 y = 0; y < cSkinTextureWidth; y++)
+		const uint32* sourceRow = skinTexturePixels + (y / divSmall) * skinTextureWidth;
+		uint32* row = reinterpret_cast<uint32*>(_pixels + y * cSkinTextureWidth);
+
+		if (divSmall == 1)
+		{
+			std::memcpy(row, sourceRow, cSkinTextureWidth * sizeof(uint32));
+			continue;
+		}
+
+		// Each source pixel is doubled
+		for (uint32 x = 0; x < cSkinTextureWidth; x += 8)
 		{
-			uint32 index = (x + (y * cSkinTextureWidth));
-			uint32 indexLocal = ((x / divSmall) + ((y / divSmall) * _skinTexture->GetWidth()));
-			m_Pixels[index] = skinTexturePixels[indexLocal];
+			__m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sourceRow + x / 2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), _mm_unpacklo_epi32(source, source));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(row + x + 4), _mm_unpackhi_epi32(source, source));
 		}
 	}
 }
-void Character_SkinTextureBaker::FillPixels(DBC_CharComponent_Sections _type, std::shared_ptr<ITexture> _compTexture) const
+
+void Character_SkinTextureBaker::FillPixels(PixelData* _pixels, DBC_CharComponent_Sections _type, std::shared_ptr<ITexture> _compTexture) const
 {
 	if (_compTexture == nullptr)
 		return;
 
 	_ASSERT(_compTexture->GetWidth() == 128 || _compTexture->GetWidth() == 256);
 
-	const PixelData* texturePixels = (const PixelData*)_compTexture->GetBuffer().data();
+	const uint32* texturePixels = (const uint32*)_compTexture->GetBuffer().data();
+	const uint32 textureWidth = _compTexture->GetWidth();
+
+	_ASSERT(cSkinComponentWidth >= textureWidth);
+	uint32 divSmall = cSkinComponentWidth / textureWidth;
 
-	_ASSERT(cSkinComponentWidth >= _compTexture->GetWidth());
-	uint32 divSmall = cSkinComponentWidth / _compTexture->GetWidth();
+	const __m128i zero = _mm_setzero_si128();
 
+	// Component pixel replaces skin pixel, if component alpha isn't zero
 	const auto& region = m_Regions.at(_type);
-	for (uint32 x = 0; x < region.Width; x++)
+	for (uint32 y = 0; y < region.Height; y++)
 	{
-		for (uint32 y = 0; y < region.Height; y++)
-		{
-			uint32 index = (region.X + x) + ((region.Y + y) * cSkinTextureWidth);
-			uint32 indexLocal = ((x / divSmall) + ((y / divSmall) * _compTexture->GetWidth()));
+		const uint32* sourceRow = texturePixels + (y / divSmall) * textureWidth;
+		uint32* row = reinterpret_cast<uint32*>(_pixels + (region.Y + y) * cSkinTextureWidth + region.X);
 
-			if (texturePixels[indexLocal].a > 0)
+		uint32 x = 0;
+		for (; x + 4 <= region.Width; x += 4)
+		{
+			__m128i source;
+			if (divSmall == 1)
 			{
-				m_Pixels[index] = texturePixels[indexLocal];
+				source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sourceRow + x));
 			}
+			else
+			{
+				source = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(sourceRow + x / 2));
+				source = _mm_unpacklo_epi32(source, source);
+			}
+
+			__m128i destination = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+			__m128i isTransparent = _mm_cmpeq_epi32(_mm_srli_epi32(source, 24), zero);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), _mm_or_si128(_mm_and_si128(isTransparent, destination), _mm_andnot_si128(isTransparent, source)));
+		}
+
+		for (; x < region.Width; x++)
+		{
+			uint32 source = sourceRow[x / divSmall];
+			if ((source >> 24) > 0)
+				row[x] = source;
 		}
 	}
 }
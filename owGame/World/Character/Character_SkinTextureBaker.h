@@ -13,6 +13,11 @@ struct CharacterSkinLayout
 class Character;
 // FORWARD END
 
+/**
+  * Composes character skin, underwear and items components into one texture.
+  * Baked textures are shared by characters with equal race, gender, skin, face and items display IDs
+  * (cache keeps weak references). Baker doesn't have per call state and can be used from several threads.
+*/
 class Character_SkinTextureBaker
 {
 public:
@@ -20,10 +25,6 @@ public:
 
 	std::shared_ptr<ITexture> createTexture(const Character* _character) const;
 
-private:
-	void FillWithSkin(std::shared_ptr<ITexture> _texture) const;
-	void FillPixels(DBC_CharComponent_Sections _type, std::shared_ptr<ITexture> _texture) const;
-
 private:
 	struct PixelData
 	{
@@ -38,11 +39,36 @@ private:
 		uint32 Height;
 	};
 
-	mutable PixelData*	                                                              m_Pixels;
+	struct CharacterSkinKey
+	{
+		bool operator==(const CharacterSkinKey& Other) const;
+
+		uint32 Race;
+		uint32 Gender;
+		uint32 Skin;
+		uint32 Face;
+		uint32 ItemsDisplayIDs[INVENTORY_SLOT_BAG_END];
+	};
+
+	struct CharacterSkinKeyHash
+	{
+		size_t operator()(const CharacterSkinKey& Key) const;
+	};
+
+	std::shared_ptr<ITexture> bakeTexture(const Character* _character, bool* _isComplete) const;
+
+	// SSE2, 4 pixels per step
+	void FillWithSkin(PixelData* _pixels, std::shared_ptr<ITexture> _texture) const;
+	void FillPixels(PixelData* _pixels, DBC_CharComponent_Sections _type, std::shared_ptr<ITexture> _texture) const;
+
+private:
 	std::unordered_map<DBC_CharComponent_Sections, CharacterSkinRegion> m_Regions;
 
+	mutable std::mutex                                                                        m_BakedLock;
+	mutable std::unordered_map<CharacterSkinKey, std::weak_ptr<ITexture>, CharacterSkinKeyHash> m_Baked;
+
 private:
 	IBaseManager& m_BaseManager;
 	IRenderDevice& m_RenderDevice;
 	CDBCStorage* m_DBCs;
-};
\ No newline at end of file
+};
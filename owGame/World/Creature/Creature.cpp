@@ -3,6 +3,9 @@
 // General
 #include "Creature.h"
 
+// Additional
+#include "WowHash.h"
+
 /*
 m_FileName="Creature\\Alexstrasza\\Alexstrasza.m2"
 
@@ -66,5 +69,10 @@ bool Creature::isMeshEnabled(uint32 _index) const
 	return false;
 }
 
-
-
+uint64 Creature::getMeshesSignature() const
+{
+	uint64 signature = cHashFNV1aOffset;
+	for (uint32 i = 0; i < MeshIDType::Count; i++)
+		signature = HashFNV1a(signature, m_MeshID[i]);
+	return signature;
+}
@@ -13,6 +13,7 @@ public:
     // Mesh & textures provider
 	virtual void setMeshEnabled(MeshIDType::List _type, uint32 _value);
 	virtual bool isMeshEnabled(uint32 _index) const override;
+	virtual uint64 getMeshesSignature() const override;
 
 private:
 	// Mesh provider
@@ -242,7 +242,7 @@ std::string CItem_VisualData::GetObjectModelName(EInventoryType _objectType, std
 
 std::shared_ptr<ITexture> CItem_VisualData::LoadObjectTexture(EInventoryType _objectType, std::string _textureName)
 {
-	return m_RenderDevice.GetObjectsFactory().LoadTexture2D("Item\\ObjectComponents\\" + std::string(ItemObjectComponents[static_cast<size_t>(_objectType)].folder) + "\\" + _textureName + ".blp");
+	return m_BaseManager.GetManager<IWoWObjectsCreator>()->LoadStreamedTexture2D(m_RenderDevice, "Item\\ObjectComponents\\" + std::string(ItemObjectComponents[static_cast<size_t>(_objectType)].folder) + "\\" + _textureName + ".blp");
 }
 
 std::shared_ptr<ITexture> CItem_VisualData::LoadSkinTexture(DBC_CharComponent_Sections _type, std::string _textureName)
@@ -251,22 +251,15 @@ std::shared_ptr<ITexture> CItem_VisualData::LoadSkinTexture(DBC_CharComponent_Se
 	std::string maleTexture = getTextureComponentName(_type, _textureName, Gender::Male);
 	std::string femaleTexture = getTextureComponentName(_type, _textureName, Gender::Female);
 
-	IFilesManager* fManager = m_BaseManager.GetManager<IFilesManager>();
+	IWoWObjectsCreator* objectsCreator = m_BaseManager.GetManager<IWoWObjectsCreator>();
 
-	if (fManager->IsFileExists(universalTexture))
-	{
-		return m_RenderDevice.GetObjectsFactory().LoadTexture2D(universalTexture);
-	}
-	else if (fManager->IsFileExists(maleTexture))
-	{
-		return m_RenderDevice.GetObjectsFactory().LoadTexture2D(maleTexture);
-	}
-	else if (fManager->IsFileExists(femaleTexture))
-	{
-		return m_RenderDevice.GetObjectsFactory().LoadTexture2D(femaleTexture);
-	}
+	if (std::shared_ptr<ITexture> texture = objectsCreator->TryLoadTexture2D(m_RenderDevice, universalTexture))
+		return texture;
+
+	if (std::shared_ptr<ITexture> texture = objectsCreator->TryLoadTexture2D(m_RenderDevice, maleTexture))
+		return texture;
 
-	return nullptr;
+	return objectsCreator->TryLoadTexture2D(m_RenderDevice, femaleTexture);
 }
 
 
@@ -3,8 +3,84 @@
 // General
 #include "WorldObjectsCreator.h"
 
+// Additional
+#include "WowParallel.h"
+
+//
+// Creatures with one display info: appearance is resolved on loader thread, scene nodes are created by 'UpdateCreatures'
+//
+class CCreaturesLoader
+	: public CLoadableObject
+{
+public:
+	CCreaturesLoader(CWorldObjectCreator& Creator, IRenderDevice& RenderDevice, IScene* Scene, uint32 DisplayInfo, const std::function<void(size_t, const std::shared_ptr<Creature>&)>& OnCreated)
+		: m_Creator(Creator)
+		, m_RenderDevice(RenderDevice)
+		, m_Scene(Scene)
+		, m_DisplayInfo(DisplayInfo)
+		, m_OnCreated(OnCreated)
+		, m_IsResolved(false)
+		, m_IsDone(false)
+	{}
+	virtual ~CCreaturesLoader()
+	{}
+
+	void AddCreature(size_t Index, const std::shared_ptr<ISceneNode3D>& Parent)
+	{
+		m_Creatures.push_back(std::make_pair(Index, Parent));
+	}
+
+	bool IsDone() const
+	{
+		return m_IsDone;
+	}
+
+	// Calling thread owns scene graph
+	void CreateCreatures()
+	{
+		_ASSERT(m_IsDone);
+		if (false == m_IsResolved)
+			return;
+
+		Character_SectionWrapper sectionWrapper(m_Creator.m_BaseManager, m_RenderDevice);
+		for (const auto& creature : m_Creatures)
+		{
+			// Parent was removed while task was in queue
+			std::shared_ptr<ISceneNode3D> parent = creature.second.lock();
+			if (parent == nullptr)
+				continue;
+
+			std::shared_ptr<Creature> newCreature = m_Creator.CreateCreature(m_Scene, m_Appearance, parent, sectionWrapper);
+			if (newCreature != nullptr)
+				m_OnCreated(creature.first, newCreature);
+		}
+	}
+
+	// CLoadableObject
+	bool Load() override
+	{
+		m_IsResolved = m_Creator.ResolveCreatureAppearance(m_RenderDevice, m_DisplayInfo, &m_Appearance);
+		m_IsDone = true;
+		return true;
+	}
+
+private:
+	CWorldObjectCreator& m_Creator;
+	IRenderDevice& m_RenderDevice;
+	IScene* m_Scene;
+	const uint32 m_DisplayInfo;
+	const std::function<void(size_t, const std::shared_ptr<Creature>&)> m_OnCreated;
+	std::vector<std::pair<size_t, std::weak_ptr<ISceneNode3D>>> m_Creatures;
+
+	CWorldObjectCreator::SCreatureAppearance m_Appearance;
+	bool m_IsResolved;
+	std::atomic<bool> m_IsDone; // Appearance is published by this flag
+};
+
+
 CWorldObjectCreator::CWorldObjectCreator(IBaseManager & BaseManager)
 	: m_BaseManager(BaseManager)
+	, m_FileProbes(BaseManager)
 {
 	m_DBCs = m_BaseManager.GetManager<CDBCStorage>();
 
@@ -21,37 +97,91 @@ CWorldObjectCreator::CWorldObjectCreator(IBaseManager & BaseManager)
 //
 std::shared_ptr<Creature> CWorldObjectCreator::BuildCreatureFromDisplayInfo(IRenderDevice& RenderDevice, IScene* Scene, uint32 _id, const std::shared_ptr<ISceneNode3D>& Parent)
 {
-	const DBC_CreatureDisplayInfoRecord* rec = m_DBCs->DBC_CreatureDisplayInfo()[_id];
-	if (rec == nullptr)
+	SCreatureAppearance appearance;
+	if (false == ResolveCreatureAppearance(RenderDevice, _id, &appearance))
 		return nullptr;
 
-	const DBC_CreatureDisplayInfoExtraRecord* humanoidRecExtra = m_DBCs->DBC_CreatureDisplayInfoExtra()[rec->Get_HumanoidData()];
-	if (humanoidRecExtra != 0)
-		return BuildCharactedFromDisplayInfo(RenderDevice, Scene, _id, Parent);
+	Character_SectionWrapper sectionWrapper(m_BaseManager, RenderDevice);
+	return CreateCreature(Scene, appearance, Parent, sectionWrapper);
+}
 
-	// 1. Load model
-	std::shared_ptr<CM2> m2Model = CreateCreatureModel(RenderDevice, rec);
-	if (m2Model == nullptr)
-		return nullptr;
+std::vector<std::shared_ptr<Creature>> CWorldObjectCreator::BuildCreaturesFromDisplayInfos(IRenderDevice& RenderDevice, IScene* Scene, const std::vector<uint32>& DisplayInfos, const std::vector<std::shared_ptr<ISceneNode3D>>& Parents)
+{
+	_ASSERT(DisplayInfos.size() == Parents.size());
+
+	// 1. Creatures with equal display info have equal appearance
+	std::vector<uint32> appearancesDisplayInfos;
+	std::unordered_map<uint32, size_t> appearancesIndexes;
+	for (uint32 displayInfo : DisplayInfos)
+		if (appearancesIndexes.insert(std::make_pair(displayInfo, appearancesDisplayInfos.size())).second)
+			appearancesDisplayInfos.push_back(displayInfo);
+
+	// 2. DBC records, models and textures (files reading and decoding) on several threads, once per appearance
+	std::vector<SCreatureAppearance> appearances(appearancesDisplayInfos.size());
+	std::vector<uint8> appearancesResolved(appearancesDisplayInfos.size(), 0);
+	ParallelFor(appearancesDisplayInfos.size(), 1, [&](size_t Begin, size_t End, size_t TaskIndex) {
+		for (size_t i = Begin; i < End; i++)
+			appearancesResolved[i] = ResolveCreatureAppearance(RenderDevice, appearancesDisplayInfos[i], &appearances[i]) ? 1 : 0;
+	});
+
+	// 3. Scene nodes on calling thread (scene graph isn't thread safe, creatures may have one parent)
+	Character_SectionWrapper sectionWrapper(m_BaseManager, RenderDevice);
 
-	std::shared_ptr<Creature> newCreature = Scene->CreateSceneNode<Creature>(Parent, m2Model);
-	m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(newCreature);
-	newCreature->setAlpha(static_cast<float>(rec->Get_Opacity()) / 255.0f);
-	newCreature->SetScale(glm::vec3(rec->Get_Scale()));
+	std::vector<std::shared_ptr<Creature>> creatures(DisplayInfos.size());
+	for (size_t i = 0; i < DisplayInfos.size(); i++)
+	{
+		size_t appearanceIndex = appearancesIndexes.at(DisplayInfos[i]);
+		if (appearancesResolved[appearanceIndex] != 0)
+			creatures[i] = CreateCreature(Scene, appearances[appearanceIndex], Parents[i], sectionWrapper);
+	}
 
-	// 2. Creature textures
+	return creatures;
+}
+
+void CWorldObjectCreator::AddCreaturesToLoadQueue(IRenderDevice& RenderDevice, IScene* Scene, const std::vector<uint32>& DisplayInfos, const std::vector<std::shared_ptr<ISceneNode3D>>& Parents, std::function<void(size_t, const std::shared_ptr<Creature>&)> OnCreated)
+{
+	_ASSERT(DisplayInfos.size() == Parents.size());
+
+	// One load task per display info, tasks are processed by loader threads
+	std::unordered_map<uint32, std::shared_ptr<CCreaturesLoader>> loaders;
+	for (size_t i = 0; i < DisplayInfos.size(); i++)
 	{
-		if (rec->Get_Texture1().length() != 0)
-			newCreature->setSpecialTexture(SM2_Texture::Type::MONSTER_1, RenderDevice.GetObjectsFactory().LoadTexture2D(m2Model->getFilePath() + rec->Get_Texture1() + ".blp"));
+		std::shared_ptr<CCreaturesLoader>& loader = loaders[DisplayInfos[i]];
+		if (loader == nullptr)
+			loader = std::make_shared<CCreaturesLoader>(*this, RenderDevice, Scene, DisplayInfos[i], OnCreated);
 
-		if (rec->Get_Texture2().length() != 0)
-			newCreature->setSpecialTexture(SM2_Texture::Type::MONSTER_2, RenderDevice.GetObjectsFactory().LoadTexture2D(m2Model->getFilePath() + rec->Get_Texture2() + ".blp"));
+		loader->AddCreature(i, Parents[i]);
+	}
 
-		if (rec->Get_Texture3().length() != 0)
-			newCreature->setSpecialTexture(SM2_Texture::Type::MONSTER_3, RenderDevice.GetObjectsFactory().LoadTexture2D(m2Model->getFilePath() + rec->Get_Texture3() + ".blp"));
+	std::lock_guard<std::mutex> lock(m_CreaturesLoadersLock);
+	for (const auto& loader : loaders)
+	{
+		m_CreaturesLoaders.push_back(loader.second);
+		m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(loader.second);
 	}
+}
 
-	return newCreature;
+void CWorldObjectCreator::UpdateCreatures()
+{
+	std::vector<std::shared_ptr<CCreaturesLoader>> doneLoaders;
+	{
+		std::lock_guard<std::mutex> lock(m_CreaturesLoadersLock);
+		for (auto it = m_CreaturesLoaders.begin(); it != m_CreaturesLoaders.end(); )
+		{
+			if ((*it)->IsDone())
+			{
+				doneLoaders.push_back(*it);
+				it = m_CreaturesLoaders.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	for (const auto& loader : doneLoaders)
+		loader->CreateCreatures();
 }
 
 std::shared_ptr<Character> CWorldObjectCreator::BuildCharactedFromTemplate(IRenderDevice& RenderDevice, IScene* Scene, const CInet_CharacterTemplate& b, const std::shared_ptr<ISceneNode3D>& Parent)
@@ -74,8 +204,7 @@ std::shared_ptr<Character> CWorldObjectCreator::BuildCharactedFromTemplate(IRend
 
 	newCharacter->RefreshItemVisualData();
 
-	Character_SkinTextureBaker skinTextureBaker(m_BaseManager, RenderDevice);
-	auto skinTexture = skinTextureBaker.createTexture(newCharacter.get());
+	auto skinTexture = GetSkinTextureBaker(RenderDevice).createTexture(newCharacter.get());
 	newCharacter->RefreshTextures(sectionWrapper, skinTexture);
 
 	newCharacter->RefreshMeshIDs(sectionWrapper);
@@ -85,76 +214,14 @@ std::shared_ptr<Character> CWorldObjectCreator::BuildCharactedFromTemplate(IRend
 
 std::shared_ptr<Character> CWorldObjectCreator::BuildCharactedFromDisplayInfo(IRenderDevice& RenderDevice, IScene * Scene, uint32 _id, const std::shared_ptr<ISceneNode3D>& Parent)
 {
-	const DBC_CreatureDisplayInfoRecord* rec = m_DBCs->DBC_CreatureDisplayInfo()[_id];
-	_ASSERT(rec != nullptr);
-
-	const DBC_CreatureDisplayInfoExtraRecord* humanoidRecExtra = m_DBCs->DBC_CreatureDisplayInfoExtra()[rec->Get_HumanoidData()];
-	_ASSERT(humanoidRecExtra != nullptr);
-
-	// 1. Load model
-	std::shared_ptr<CM2> m2Model = CreateCreatureModel(RenderDevice, rec);
-	if (m2Model == nullptr)
+	SCreatureAppearance appearance;
+	if (false == ResolveCreatureAppearance(RenderDevice, _id, &appearance))
 		return nullptr;
 
-	std::shared_ptr<Character> newCharacter = Scene->CreateSceneNode<Character>(Parent, m2Model);
-	m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(newCharacter);
-
-	// 2. Template
-	{
-		CInet_CharacterTemplate characterTemplate;
-
-		// 2.1 Visual params
-		characterTemplate.Race = (Race)m_DBCs->DBC_ChrRaces()[humanoidRecExtra->Get_Race()]->Get_ID();
-		characterTemplate.Gender = (Gender)humanoidRecExtra->Get_Gender();
-		characterTemplate.skin = humanoidRecExtra->Get_SkinID();
-		characterTemplate.face = humanoidRecExtra->Get_FaceID();
-		characterTemplate.hairStyle = humanoidRecExtra->Get_HairStyleID();
-		characterTemplate.hairColor = humanoidRecExtra->Get_HairColorID();
-		characterTemplate.facialStyle = humanoidRecExtra->Get_FacialHairID();
-
-		// 2.2 Items
-		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_HEAD] = CInet_ItemTemplate(humanoidRecExtra->Get_Helm(), EInventoryType::HEAD, 0);
-		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_SHOULDERS] = CInet_ItemTemplate(humanoidRecExtra->Get_Shoulder(), EInventoryType::SHOULDERS, 0);
-		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_BODY] = CInet_ItemTemplate(humanoidRecExtra->Get_Shirt(), EInventoryType::BODY, 0);
-		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_CHEST] = CInet_ItemTemplate(humanoidRecExtra->Get_Chest(), EInventoryType::CHEST, 0);
-		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_WAIST] = CInet_ItemTemplate(humanoidRecExtra->Get_Belt(), EInventoryType::WAIST, 0);
-		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_LEGS] = CInet_ItemTemplate(humanoidRecExtra->Get_Legs(), EInventoryType::LEGS, 0);
-		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_FEET] = CInet_ItemTemplate(humanoidRecExtra->Get_Boots(), EInventoryType::FEET, 0);
-		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_WRISTS] = CInet_ItemTemplate(humanoidRecExtra->Get_Wrist(), EInventoryType::WRISTS, 0);
-		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_HANDS] = CInet_ItemTemplate(humanoidRecExtra->Get_Gloves(), EInventoryType::HANDS, 0);
-		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_TABARD] = CInet_ItemTemplate(humanoidRecExtra->Get_Tabard(), EInventoryType::TABARD, 0);
-		//ItemsTemplates[EQUIPMENT_SLOT_BACK] = CInet_ItemTemplate(humanoidRecExtra->Get_Cape(), EInventoryType::CLOAK, 0);
-
-		newCharacter->GetTemplate().TemplateSet(characterTemplate);
-	}
-
-	// 3. Items
-	{
-		newCharacter->RefreshItemVisualData();
-	}
-
-	// 4. Creature textures
-	{
-		std::string bakedTextureName = humanoidRecExtra->Get_BakedSkin();
-		std::shared_ptr<ITexture> bakedSkinTexture = nullptr;
-		if (!bakedTextureName.empty())
-		{
-			bakedSkinTexture = RenderDevice.GetObjectsFactory().LoadTexture2D("Textures\\BakedNpcTextures\\" + bakedTextureName);
-		}
-		else
-		{
-			Log::Error("Character[%d]: Missing baked texture for humanoid[%d]. Create own. [%s]", rec->Get_ID(), humanoidRecExtra->Get_ID(), bakedTextureName.c_str());
-		}
-
-		Character_SectionWrapper sectionWrapper(m_BaseManager, RenderDevice);
-
-		newCharacter->RefreshTextures(sectionWrapper, bakedSkinTexture);
-	}
+	_ASSERT(appearance.HumanoidExtra != nullptr);
 
 	Character_SectionWrapper sectionWrapper(m_BaseManager, RenderDevice);
-	newCharacter->RefreshMeshIDs(sectionWrapper);
-
-	return newCharacter;
+	return CreateCharacter(Scene, appearance, Parent, sectionWrapper);
 }
 
 std::shared_ptr<GameObject> CWorldObjectCreator::BuildGameObjectFromDisplayInfo(IRenderDevice & RenderDevice, IScene * Scene, uint32 _id, const std::shared_ptr<ISceneNode3D>& Parent)
@@ -178,24 +245,36 @@ std::shared_ptr<GameObject> CWorldObjectCreator::BuildGameObjectFromDisplayInfo(
 //
 void CWorldObjectCreator::ClearCache()
 {
+	{
+		std::lock_guard<std::mutex> lock(m_LiquidTexturesLock);
+		m_LiquidTextures.clear();
+	}
+
+	m_FileProbes.Clear();
+
+	std::lock_guard<std::mutex> lock(m_TexturesCacheLock);
+	if (m_TexturesCache != nullptr)
+		m_TexturesCache->Clear();
 }
 
 std::shared_ptr<CM2> CWorldObjectCreator::LoadM2(IRenderDevice& RenderDevice, const std::string& Filename, bool ImmediateLoad)
 {
-	std::lock_guard<std::mutex> lock(m_M2Lock);
-
-	const auto& M2ObjectsWPtrsIt = m_M2ObjectsWPtrs.find(Filename);
-	
-	// Already exists
-	if (M2ObjectsWPtrsIt != m_M2ObjectsWPtrs.end())
 	{
-		if (auto M2ObjectsPtr = M2ObjectsWPtrsIt->second.lock())
-		{
-			return M2ObjectsPtr;
-		}
-		else
+		std::lock_guard<std::mutex> lock(m_M2Lock);
+
+		const auto& M2ObjectsWPtrsIt = m_M2ObjectsWPtrs.find(Filename);
+
+		// Already exists
+		if (M2ObjectsWPtrsIt != m_M2ObjectsWPtrs.end())
 		{
-			m_M2ObjectsWPtrs.erase(M2ObjectsWPtrsIt);
+			if (auto M2ObjectsPtr = M2ObjectsWPtrsIt->second.lock())
+			{
+				return M2ObjectsPtr;
+			}
+			else
+			{
+				m_M2ObjectsWPtrs.erase(M2ObjectsWPtrsIt);
+			}
 		}
 	}
 
@@ -204,6 +283,7 @@ std::shared_ptr<CM2> CWorldObjectCreator::LoadM2(IRenderDevice& RenderDevice, co
 	if (newName.find("orgrimmarsmokeemitter.mdx") != -1 || newName.find("orgrimmarfloatingembers.mdx") != -1)
 		return nullptr;
 
+	// Header is read without lock, so different models are created on several threads at once
 	std::shared_ptr<CM2> m2Object;
 	try
 	{
@@ -215,18 +295,27 @@ std::shared_ptr<CM2> CWorldObjectCreator::LoadM2(IRenderDevice& RenderDevice, co
 		return nullptr;
 	}
 
-	m_M2ObjectsWPtrs[Filename] = m2Object;
-
+	// Model is registered loaded, other threads don't get it half loaded
 	if (ImmediateLoad)
 	{
 		m2Object->Load();
 		m2Object->SetState(ILoadable::ELoadableState::Loaded);
 	}
-	else
+
 	{
-		m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(m2Object);
+		std::lock_guard<std::mutex> lock(m_M2Lock);
+
+		// Same model was created by other thread, own copy is dropped
+		std::weak_ptr<CM2>& m2ObjectWPtr = m_M2ObjectsWPtrs[Filename];
+		if (auto M2ObjectsPtr = m2ObjectWPtr.lock())
+			return M2ObjectsPtr;
+
+		m2ObjectWPtr = m2Object;
 	}
 
+	if (false == ImmediateLoad)
+		m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(m2Object);
+
 	return m2Object;
 }
 
@@ -265,6 +354,74 @@ std::shared_ptr<CWMO> CWorldObjectCreator::LoadWMO(IRenderDevice& RenderDevice,
 	return wmoObject;
 }
 
+std::shared_ptr<CLiquidTextures> CWorldObjectCreator::LoadLiquidTextures(IRenderDevice& RenderDevice, const std::string& BaseName)
+{
+	std::lock_guard<std::mutex> lock(m_LiquidTexturesLock);
+
+	const auto& liquidTexturesIt = m_LiquidTextures.find(BaseName);
+	if (liquidTexturesIt != m_LiquidTextures.end())
+		return liquidTexturesIt->second;
+
+	std::shared_ptr<CLiquidTextures> liquidTextures = std::make_shared<CLiquidTextures>(RenderDevice, BaseName);
+	m_LiquidTextures.insert(std::make_pair(BaseName, liquidTextures));
+	return liquidTextures;
+}
+
+std::shared_ptr<ITexture> CWorldObjectCreator::LoadTexture2D(IRenderDevice& RenderDevice, const std::string& Filename)
+{
+	return GetTexturesCache(RenderDevice).LoadTexture2D(Filename);
+}
+
+const CTexturesCache* CWorldObjectCreator::GetTexturesCache() const
+{
+	std::lock_guard<std::mutex> lock(m_TexturesCacheLock);
+	return m_TexturesCache.get();
+}
+
+std::shared_ptr<IFile> CWorldObjectCreator::TryOpen(const std::string& Filename)
+{
+	return m_FileProbes.TryOpen(Filename);
+}
+
+std::shared_ptr<ITexture> CWorldObjectCreator::TryLoadTexture2D(IRenderDevice& RenderDevice, const std::string& Filename)
+{
+	if (false == m_FileProbes.IsFileExists(Filename))
+		return nullptr;
+
+	return LoadTexture2D(RenderDevice, Filename);
+}
+
+std::shared_ptr<ITexture> CWorldObjectCreator::LoadStreamedTexture2D(IRenderDevice& RenderDevice, const std::string& Filename)
+{
+	return GetTexturesCache(RenderDevice).LoadStreamedTexture2D(Filename);
+}
+
+void CWorldObjectCreator::RequestTextureSize(const ITexture* Texture, float ScreenSize, double Time)
+{
+	CTexturesCache* texturesCache = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(m_TexturesCacheLock);
+		texturesCache = m_TexturesCache.get();
+	}
+
+	if (texturesCache != nullptr)
+		texturesCache->GetStreamer().RequestSize(Texture, ScreenSize, Time);
+}
+
+void CWorldObjectCreator::UpdateTextures(double Time)
+{
+	CTexturesCache* texturesCache = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(m_TexturesCacheLock);
+		texturesCache = m_TexturesCache.get();
+	}
+
+	if (texturesCache != nullptr)
+		texturesCache->Update(Time);
+}
+
 void CWorldObjectCreator::InitEGxBlend(IRenderDevice& RenderDevice)
 {
 	for (uint32 i = 0; i < 14; i++)
@@ -276,6 +433,21 @@ void CWorldObjectCreator::InitEGxBlend(IRenderDevice& RenderDevice)
 		blendState->SetBlendMode(GetEGxBlendMode(i));
 		m_EGxBlendStates[i] = blendState;
 	}
+
+	for (uint32 i = 0; i < 4; i++)
+	{
+		bool depthTest = (i & 0x01) != 0;
+		bool depthWrite = (i & 0x02) != 0;
+
+		m_MaterialDepthStencilStates[i] = RenderDevice.GetObjectsFactory().CreateDepthStencilState();
+		m_MaterialDepthStencilStates[i]->SetDepthMode(IDepthStencilState::DepthMode(depthTest, depthWrite ? IDepthStencilState::DepthWrite::Enable : IDepthStencilState::DepthWrite::Disable));
+	}
+
+	for (uint32 i = 0; i < 2; i++)
+	{
+		m_MaterialRasterizerStates[i] = RenderDevice.GetObjectsFactory().CreateRasterizerState();
+		m_MaterialRasterizerStates[i]->SetCullMode((i != 0) ? IRasterizerState::CullMode::None : IRasterizerState::CullMode::Back);
+	}
 }
 
 std::shared_ptr<IBlendState> CWorldObjectCreator::GetEGxBlend(uint32 Index) const
@@ -283,11 +455,126 @@ std::shared_ptr<IBlendState> CWorldObjectCreator::GetEGxBlend(uint32 Index) cons
 	return m_EGxBlendStates.at(Index);
 }
 
+std::shared_ptr<IDepthStencilState> CWorldObjectCreator::GetMaterialDepthStencilState(bool DepthTest, bool DepthWrite) const
+{
+	return m_MaterialDepthStencilStates[(DepthTest ? 0x01 : 0x00) | (DepthWrite ? 0x02 : 0x00)];
+}
+
+std::shared_ptr<IRasterizerState> CWorldObjectCreator::GetMaterialRasterizerState(bool TwoSided) const
+{
+	return m_MaterialRasterizerStates[TwoSided ? 1 : 0];
+}
+
 
 
 //
 // Private 
 //
+bool CWorldObjectCreator::ResolveCreatureAppearance(IRenderDevice& RenderDevice, uint32 DisplayInfoID, SCreatureAppearance* Appearance)
+{
+	const DBC_CreatureDisplayInfoRecord* rec = m_DBCs->DBC_CreatureDisplayInfo()[DisplayInfoID];
+	if (rec == nullptr)
+		return false;
+
+	Appearance->DisplayInfo = rec;
+	Appearance->HumanoidExtra = m_DBCs->DBC_CreatureDisplayInfoExtra()[rec->Get_HumanoidData()];
+
+	// 1. Load model
+	Appearance->Model = CreateCreatureModel(RenderDevice, rec);
+	if (Appearance->Model == nullptr)
+		return false;
+
+	// 2. Creature textures
+	if (Appearance->HumanoidExtra == nullptr)
+	{
+		if (rec->Get_Texture1().length() != 0)
+			Appearance->Textures[0] = LoadTexture2D(RenderDevice, Appearance->Model->getFilePath() + rec->Get_Texture1() + ".blp");
+
+		if (rec->Get_Texture2().length() != 0)
+			Appearance->Textures[1] = LoadTexture2D(RenderDevice, Appearance->Model->getFilePath() + rec->Get_Texture2() + ".blp");
+
+		if (rec->Get_Texture3().length() != 0)
+			Appearance->Textures[2] = LoadTexture2D(RenderDevice, Appearance->Model->getFilePath() + rec->Get_Texture3() + ".blp");
+
+		return true;
+	}
+
+	const DBC_CreatureDisplayInfoExtraRecord* humanoidRecExtra = Appearance->HumanoidExtra;
+
+	// 3. Character template
+	{
+		CInet_CharacterTemplate& characterTemplate = Appearance->CharacterTemplate;
+
+		// 3.1 Visual params
+		characterTemplate.Race = (Race)m_DBCs->DBC_ChrRaces()[humanoidRecExtra->Get_Race()]->Get_ID();
+		characterTemplate.Gender = (Gender)humanoidRecExtra->Get_Gender();
+		characterTemplate.skin = humanoidRecExtra->Get_SkinID();
+		characterTemplate.face = humanoidRecExtra->Get_FaceID();
+		characterTemplate.hairStyle = humanoidRecExtra->Get_HairStyleID();
+		characterTemplate.hairColor = humanoidRecExtra->Get_HairColorID();
+		characterTemplate.facialStyle = humanoidRecExtra->Get_FacialHairID();
+
+		// 3.2 Items
+		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_HEAD] = CInet_ItemTemplate(humanoidRecExtra->Get_Helm(), EInventoryType::HEAD, 0);
+		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_SHOULDERS] = CInet_ItemTemplate(humanoidRecExtra->Get_Shoulder(), EInventoryType::SHOULDERS, 0);
+		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_BODY] = CInet_ItemTemplate(humanoidRecExtra->Get_Shirt(), EInventoryType::BODY, 0);
+		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_CHEST] = CInet_ItemTemplate(humanoidRecExtra->Get_Chest(), EInventoryType::CHEST, 0);
+		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_WAIST] = CInet_ItemTemplate(humanoidRecExtra->Get_Belt(), EInventoryType::WAIST, 0);
+		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_LEGS] = CInet_ItemTemplate(humanoidRecExtra->Get_Legs(), EInventoryType::LEGS, 0);
+		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_FEET] = CInet_ItemTemplate(humanoidRecExtra->Get_Boots(), EInventoryType::FEET, 0);
+		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_WRISTS] = CInet_ItemTemplate(humanoidRecExtra->Get_Wrist(), EInventoryType::WRISTS, 0);
+		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_HANDS] = CInet_ItemTemplate(humanoidRecExtra->Get_Gloves(), EInventoryType::HANDS, 0);
+		characterTemplate.ItemsTemplates[EQUIPMENT_SLOT_TABARD] = CInet_ItemTemplate(humanoidRecExtra->Get_Tabard(), EInventoryType::TABARD, 0);
+		//ItemsTemplates[EQUIPMENT_SLOT_BACK] = CInet_ItemTemplate(humanoidRecExtra->Get_Cape(), EInventoryType::CLOAK, 0);
+	}
+
+	// 4. Baked skin
+	{
+		std::string bakedTextureName = humanoidRecExtra->Get_BakedSkin();
+		if (!bakedTextureName.empty())
+		{
+			Appearance->BakedSkinTexture = LoadTexture2D(RenderDevice, "Textures\\BakedNpcTextures\\" + bakedTextureName);
+		}
+		else
+		{
+			Log::Error("Character[%d]: Missing baked texture for humanoid[%d]. Create own. [%s]", rec->Get_ID(), humanoidRecExtra->Get_ID(), bakedTextureName.c_str());
+		}
+	}
+
+	return true;
+}
+
+std::shared_ptr<Creature> CWorldObjectCreator::CreateCreature(IScene* Scene, const SCreatureAppearance& Appearance, const std::shared_ptr<ISceneNode3D>& Parent, const Character_SectionWrapper& SectionWrapper)
+{
+	if (Appearance.HumanoidExtra != nullptr)
+		return CreateCharacter(Scene, Appearance, Parent, SectionWrapper);
+
+	std::shared_ptr<Creature> newCreature = Scene->CreateSceneNode<Creature>(Parent, Appearance.Model);
+	m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(newCreature);
+	newCreature->setAlpha(static_cast<float>(Appearance.DisplayInfo->Get_Opacity()) / 255.0f);
+	newCreature->SetScale(glm::vec3(Appearance.DisplayInfo->Get_Scale()));
+
+	const SM2_Texture::Type texturesTypes[] = { SM2_Texture::Type::MONSTER_1, SM2_Texture::Type::MONSTER_2, SM2_Texture::Type::MONSTER_3 };
+	for (size_t i = 0; i < 3; i++)
+		if (Appearance.Textures[i] != nullptr)
+			newCreature->setSpecialTexture(texturesTypes[i], Appearance.Textures[i]);
+
+	return newCreature;
+}
+
+std::shared_ptr<Character> CWorldObjectCreator::CreateCharacter(IScene* Scene, const SCreatureAppearance& Appearance, const std::shared_ptr<ISceneNode3D>& Parent, const Character_SectionWrapper& SectionWrapper)
+{
+	std::shared_ptr<Character> newCharacter = Scene->CreateSceneNode<Character>(Parent, Appearance.Model);
+	m_BaseManager.GetManager<ILoader>()->AddToLoadQueue(newCharacter);
+
+	newCharacter->GetTemplate().TemplateSet(Appearance.CharacterTemplate);
+	newCharacter->RefreshItemVisualData();
+	newCharacter->RefreshTextures(SectionWrapper, Appearance.BakedSkinTexture);
+	newCharacter->RefreshMeshIDs(SectionWrapper);
+
+	return newCharacter;
+}
+
 std::shared_ptr<CM2> CWorldObjectCreator::CreateCreatureModel(IRenderDevice& RenderDevice, const DBC_CreatureDisplayInfoRecord* CreatureDisplayInfo)
 {
 	const DBC_CreatureModelDataRecord* modelRec = m_DBCs->DBC_CreatureModelData()[CreatureDisplayInfo->Get_Model()];
@@ -419,3 +706,23 @@ IBlendState::BlendMode CWorldObjectCreator::GetEGxBlendMode(uint32 Index)
 	_ASSERT(false);
 	return IBlendState::BlendMode();
 }
+
+CTexturesCache& CWorldObjectCreator::GetTexturesCache(IRenderDevice& RenderDevice)
+{
+	std::lock_guard<std::mutex> lock(m_TexturesCacheLock);
+
+	if (m_TexturesCache == nullptr)
+		m_TexturesCache = std::make_shared<CTexturesCache>(m_BaseManager, RenderDevice);
+
+	return *m_TexturesCache;
+}
+
+const Character_SkinTextureBaker& CWorldObjectCreator::GetSkinTextureBaker(IRenderDevice& RenderDevice)
+{
+	std::lock_guard<std::mutex> lock(m_SkinTextureBakerLock);
+
+	if (m_SkinTextureBaker == nullptr)
+		m_SkinTextureBaker = std::make_unique<Character_SkinTextureBaker>(m_BaseManager, RenderDevice);
+
+	return *m_SkinTextureBaker;
+}
\ No newline at end of file
@@ -5,18 +5,27 @@
 // Factory
 #include "M2/M2.h"
 #include "WMO/WMO.h"
+#include "Liquid/LiquidTextures.h"
+#include "Textures/TexturesCache.h"
+#include "Formats/FileProbesCache.h"
 #include "World/Creature/Creature.h"
 #include "World/Character/Character.h"
 #include "World/GameObject/GameObject.h"
 
+class CCreaturesLoader;
+
 class ZN_API CWorldObjectCreator
 	: public IWoWObjectsCreator
 {
+	friend class CCreaturesLoader;
 public:
 	CWorldObjectCreator(IBaseManager& BaseManager);
 
 	// Factory
 	std::shared_ptr<Creature> BuildCreatureFromDisplayInfo(IRenderDevice& RenderDevice, IScene* Scene, uint32 _id, const std::shared_ptr<ISceneNode3D>& Parent);
+	std::vector<std::shared_ptr<Creature>> BuildCreaturesFromDisplayInfos(IRenderDevice& RenderDevice, IScene* Scene, const std::vector<uint32>& DisplayInfos, const std::vector<std::shared_ptr<ISceneNode3D>>& Parents) override final;
+	void AddCreaturesToLoadQueue(IRenderDevice& RenderDevice, IScene* Scene, const std::vector<uint32>& DisplayInfos, const std::vector<std::shared_ptr<ISceneNode3D>>& Parents, std::function<void(size_t, const std::shared_ptr<Creature>&)> OnCreated) override final;
+	void UpdateCreatures() override final;
 	std::shared_ptr<Character> BuildCharactedFromTemplate(IRenderDevice& RenderDevice, IScene* Scene, const CInet_CharacterTemplate& b, const std::shared_ptr<ISceneNode3D>& Parent);
 	std::shared_ptr<Character> BuildCharactedFromDisplayInfo(IRenderDevice& RenderDevice, IScene* Scene, uint32 _id, const std::shared_ptr<ISceneNode3D>& Parent);
 	std::shared_ptr<GameObject> BuildGameObjectFromDisplayInfo(IRenderDevice& RenderDevice, IScene* Scene, uint32 _id, const std::shared_ptr<ISceneNode3D>& Parent);
@@ -25,16 +34,48 @@ public:
 	void ClearCache() override final;
 	std::shared_ptr<CM2> LoadM2(IRenderDevice& RenderDevice, const std::string& Filename, bool ImmediateLoad = false) override final;
 	std::shared_ptr<CWMO> LoadWMO(IRenderDevice& RenderDevice, const std::string& Filename, bool ImmediateLoad = false) override final;
+	std::shared_ptr<CLiquidTextures> LoadLiquidTextures(IRenderDevice& RenderDevice, const std::string& BaseName) override final;
+	std::shared_ptr<ITexture> LoadTexture2D(IRenderDevice& RenderDevice, const std::string& Filename) override final;
+	const CTexturesCache* GetTexturesCache() const override final;
+	std::shared_ptr<IFile> TryOpen(const std::string& Filename) override final;
+	std::shared_ptr<ITexture> TryLoadTexture2D(IRenderDevice& RenderDevice, const std::string& Filename) override final;
+	std::shared_ptr<ITexture> LoadStreamedTexture2D(IRenderDevice& RenderDevice, const std::string& Filename) override final;
+	void RequestTextureSize(const ITexture* Texture, float ScreenSize, double Time) override final;
+	void UpdateTextures(double Time) override final;
 	
 	void                         InitEGxBlend(IRenderDevice& RenderDevice) override final;
 	std::shared_ptr<IBlendState> GetEGxBlend(uint32 Index) const override final;
+	std::shared_ptr<IDepthStencilState> GetMaterialDepthStencilState(bool DepthTest, bool DepthWrite) const override final;
+	std::shared_ptr<IRasterizerState>    GetMaterialRasterizerState(bool TwoSided) const override final;
 
 private:
+	// Display info resolved once for all creatures with this display info
+	struct SCreatureAppearance
+	{
+		SCreatureAppearance()
+			: DisplayInfo(nullptr)
+			, HumanoidExtra(nullptr)
+		{}
+
+		const DBC_CreatureDisplayInfoRecord*      DisplayInfo;
+		const DBC_CreatureDisplayInfoExtraRecord* HumanoidExtra;     // Character if exists
+		std::shared_ptr<CM2>                      Model;
+		std::shared_ptr<ITexture>                 Textures[3];       // MONSTER_1 ... MONSTER_3, creature only
+		CInet_CharacterTemplate                   CharacterTemplate; // Character only
+		std::shared_ptr<ITexture>                 BakedSkinTexture;  // Character only
+	};
+
+	bool ResolveCreatureAppearance(IRenderDevice& RenderDevice, uint32 DisplayInfoID, SCreatureAppearance* Appearance); // Thread safe
+	std::shared_ptr<Creature> CreateCreature(IScene* Scene, const SCreatureAppearance& Appearance, const std::shared_ptr<ISceneNode3D>& Parent, const Character_SectionWrapper& SectionWrapper);
+	std::shared_ptr<Character> CreateCharacter(IScene* Scene, const SCreatureAppearance& Appearance, const std::shared_ptr<ISceneNode3D>& Parent, const Character_SectionWrapper& SectionWrapper);
+
 	std::shared_ptr<CM2> CreateCreatureModel(IRenderDevice& RenderDevice, const DBC_CreatureDisplayInfoRecord* CreatureDisplayInfo);
 	std::shared_ptr<CM2> CreateCharacterModel(IRenderDevice& RenderDevice, const CInet_CharacterTemplate& CharacterTemplate);
 	std::shared_ptr<CM2> CreateGameObjectModel(IRenderDevice& RenderDevice, const DBC_GameObjectDisplayInfoRecord* GameObjectDisplayInfoRecord);
 	
 	IBlendState::BlendMode GetEGxBlendMode(uint32 Index);
+	CTexturesCache& GetTexturesCache(IRenderDevice& RenderDevice);
+	const Character_SkinTextureBaker& GetSkinTextureBaker(IRenderDevice& RenderDevice);
 
 private:
 	IBaseManager& m_BaseManager;
@@ -43,8 +84,24 @@ private:
 	std::mutex m_M2Lock;
 	std::unordered_map<std::string, std::weak_ptr<CM2>> m_M2ObjectsWPtrs;
 	
+	std::mutex m_CreaturesLoadersLock;
+	std::vector<std::shared_ptr<CCreaturesLoader>> m_CreaturesLoaders; // Queued and loaded, nodes aren't created yet
+
 	std::mutex m_WMOLock;
 	std::unordered_map<std::string, std::weak_ptr<CWMO>> m_WMOObjectsWPtrs;
 
+	std::mutex m_LiquidTexturesLock;
+	std::unordered_map<std::string, std::shared_ptr<CLiquidTextures>> m_LiquidTextures; // Few liquid types, kept until cache clear
+
+	CFileProbesCache m_FileProbes;
+
+	mutable std::mutex m_TexturesCacheLock;
+	std::shared_ptr<CTexturesCache> m_TexturesCache; // Created with first texture, handles of textures reference it weakly
+
+	std::mutex m_SkinTextureBakerLock;
+	std::unique_ptr<Character_SkinTextureBaker> m_SkinTextureBaker; // Keeps baked skins cache
+
 	std::map<uint32, std::shared_ptr<IBlendState>> m_EGxBlendStates;
+	std::shared_ptr<IDepthStencilState> m_MaterialDepthStencilStates[4]; // DepthTest | DepthWrite << 1
+	std::shared_ptr<IRasterizerState> m_MaterialRasterizerStates[2];     // TwoSided
 };
\ No newline at end of file
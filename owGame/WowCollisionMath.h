@@ -0,0 +1,41 @@
+#pragma once
+
+// Slab test. Returns entry distance or FLT_MAX if box is missed.
+inline float IntersectRayBox(const glm::vec3& Min, const glm::vec3& Max, const glm::vec3& Origin, const glm::vec3& InvDirection, float MaxDistance)
+{
+	glm::vec3 t0 = (Min - Origin) * InvDirection;
+	glm::vec3 t1 = (Max - Origin) * InvDirection;
+	glm::vec3 tMin = glm::min(t0, t1);
+	glm::vec3 tMax = glm::max(t0, t1);
+
+	float entry = glm::max(glm::max(tMin.x, tMin.y), glm::max(tMin.z, 0.0f));
+	float exit = glm::min(glm::min(tMax.x, tMax.y), glm::min(tMax.z, MaxDistance));
+	return (entry <= exit) ? entry : FLT_MAX;
+}
+
+// Moller-Trumbore. Collision triangles are two-sided.
+inline bool IntersectRayTriangle(const glm::vec3& Origin, const glm::vec3& Direction, const glm::vec3& V0, const glm::vec3& V1, const glm::vec3& V2, float& Distance)
+{
+	const float cEpsilon = 1e-8f;
+
+	glm::vec3 e1 = V1 - V0;
+	glm::vec3 e2 = V2 - V0;
+	glm::vec3 p = glm::cross(Direction, e2);
+	float det = glm::dot(e1, p);
+	if (glm::abs(det) < cEpsilon)
+		return false;
+
+	float invDet = 1.0f / det;
+	glm::vec3 s = Origin - V0;
+	float u = glm::dot(s, p) * invDet;
+	if (u < 0.0f || u > 1.0f)
+		return false;
+
+	glm::vec3 q = glm::cross(s, e1);
+	float v = glm::dot(Direction, q) * invDet;
+	if (v < 0.0f || u + v > 1.0f)
+		return false;
+
+	Distance = glm::dot(e2, q) * invDet;
+	return Distance >= 0.0f;
+}
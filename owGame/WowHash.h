@@ -0,0 +1,20 @@
+#pragma once
+
+// FNV-1a (64 bit)
+const uint64 cHashFNV1aOffset = 14695981039346656037ull;
+const uint64 cHashFNV1aPrime = 1099511628211ull;
+
+// Mixes one value as a whole
+inline uint64 HashFNV1a(uint64 Hash, uint64 Value)
+{
+	return (Hash ^ Value) * cHashFNV1aPrime;
+}
+
+// Mixes data byte by byte
+inline uint64 HashFNV1aBytes(uint64 Hash, const void* Data, size_t Size)
+{
+	const uint8* bytes = static_cast<const uint8*>(Data);
+	for (size_t i = 0; i < Size; i++)
+		Hash = (Hash ^ bytes[i]) * cHashFNV1aPrime;
+	return Hash;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <future>
+#include <thread>
+
+// Splits [0, Count) to ranges and runs them on worker threads. First range is processed by calling thread.
+template <typename Function>
+inline void ParallelFor(size_t Count, size_t MinPerTask, Function Func)
+{
+	size_t tasksCount = glm::min<size_t>(glm::max<size_t>(std::thread::hardware_concurrency(), 1), (Count + MinPerTask - 1) / MinPerTask);
+	if (tasksCount <= 1)
+	{
+		Func(0, Count, 0);
+		return;
+	}
+
+	size_t perTask = (Count + tasksCount - 1) / tasksCount;
+
+	std::vector<std::future<void>> tasks;
+	for (size_t task = 1; task < tasksCount; task++)
+	{
+		size_t begin = task * perTask;
+		size_t end = glm::min(begin + perTask, Count);
+		if (begin < end)
+			tasks.push_back(std::async(std::launch::async, Func, begin, end, task));
+	}
+
+	Func(0, perTask, 0);
+
+	for (auto& task : tasks)
+		task.get();
+}
@@ -0,0 +1,106 @@
+#include "stdafx.h"
+
+// General
+#include "WowRecordedListPass.h"
+
+// Additional
+#include "WowParallel.h"
+
+namespace
+{
+	const size_t cMinModelsPerTask = 1024;
+}
+
+CRecordedList3DPass::CRecordedList3DPass(IRenderDevice& RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneNodeListPass, SceneNodeType NodeType)
+	: CBaseList3DPass(RenderDevice, SceneNodeListPass, NodeType)
+{
+	m_NullDeviceReplay = RenderDevice.GetBaseManager().GetManager<ISettings>()->GetGroup("WoWSettings")->GetSettingT<bool>("Render_NullDeviceReplay");
+}
+
+CRecordedList3DPass::CRecordedList3DPass(IRenderDevice& RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneNodeListPass, std::vector<SceneNodeType> NodesTypes)
+	: CBaseList3DPass(RenderDevice, SceneNodeListPass, NodesTypes)
+{
+	m_NullDeviceReplay = RenderDevice.GetBaseManager().GetManager<ISettings>()->GetGroup("WoWSettings")->GetSettingT<bool>("Render_NullDeviceReplay");
+}
+
+CRecordedList3DPass::~CRecordedList3DPass()
+{
+}
+
+void CRecordedList3DPass::Render(RenderEventArgs& e)
+{
+	RecordCommands();
+
+	if (false == m_Commands.empty() && false == m_NullDeviceReplay->Get())
+		ReplayCommands();
+}
+
+
+
+//
+// Protected
+//
+bool CRecordedList3DPass::IsModelVisible(const ISceneNode3D* SceneNode, const IModel* Model) const
+{
+	return true;
+}
+
+
+
+//
+// Private
+//
+void CRecordedList3DPass::RecordCommands()
+{
+	m_Commands.clear();
+
+	m_TasksCommands.resize(glm::max<size_t>(std::thread::hardware_concurrency(), 1));
+
+	for (const auto& acceptableNodeType : GetAcceptableNodeTypes())
+	{
+		if (false == GetSceneNodeListPass()->HasModelsList(acceptableNodeType))
+			continue;
+
+		const auto& modelsList = GetSceneNodeListPass()->GetModelsList(acceptableNodeType);
+
+		for (auto& taskCommands : m_TasksCommands)
+			taskCommands.clear();
+
+		ParallelFor(modelsList.size(), cMinModelsPerTask, [this, &modelsList](size_t Begin, size_t End, size_t TaskIndex) {
+			std::vector<SList3DDrawCommand>& taskCommands = m_TasksCommands[TaskIndex];
+			for (size_t i = Begin; i < End; i++)
+			{
+				const auto& it = modelsList[i];
+				if (false == IsModelVisible(it.SceneNode, it.Model))
+					continue;
+
+				SList3DDrawCommand command;
+				command.SceneNode = it.SceneNode;
+				command.Model = it.Model;
+				taskCommands.push_back(command);
+			}
+		});
+
+		// Tasks ranges are ordered, so commands keep order of models list
+		for (const auto& taskCommands : m_TasksCommands)
+			m_Commands.insert(m_Commands.end(), taskCommands.begin(), taskCommands.end());
+	}
+}
+
+void CRecordedList3DPass::ReplayCommands()
+{
+	const ISceneNode3D* boundSceneNode = nullptr;
+	bool isSceneNodeAllowed = false;
+
+	for (const auto& command : m_Commands)
+	{
+		if (command.SceneNode != boundSceneNode)
+		{
+			isSceneNodeAllowed = Visit(command.SceneNode) != EVisitResult::Block;
+			boundSceneNode = command.SceneNode;
+		}
+
+		if (isSceneNodeAllowed)
+			Visit(command.Model);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+//
+// Compact command of recorded list pass: model of scene node. Commands reference objects, that live at least until the end of the frame.
+//
+struct SList3DDrawCommand
+{
+	const ISceneNode3D* SceneNode;
+	const IModel*       Model;
+};
+
+/**
+  * List pass, that doesn't visit scene lists during rendering.
+  * Visible models are recorded to POD commands after culling (on worker threads for big lists), passes filter models by 'IsModelVisible'.
+  * Submit loop replays commands: scene node is visited (per-object data) only when it changes, then model is visited.
+  * Null device replay (setting 'Render_NullDeviceReplay') records commands without submitting them.
+*/
+class ZN_API CRecordedList3DPass
+	: public CBaseList3DPass
+{
+public:
+	CRecordedList3DPass(IRenderDevice& RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneNodeListPass, SceneNodeType NodeType);
+	CRecordedList3DPass(IRenderDevice& RenderDevice, const std::shared_ptr<CSceneCreateTypedListsPass>& SceneNodeListPass, std::vector<SceneNodeType> NodesTypes);
+	virtual ~CRecordedList3DPass();
+
+	void Render(RenderEventArgs& e) override;
+
+	const std::vector<SList3DDrawCommand>& GetCommands() const { return m_Commands; }
+
+protected:
+	// Called by worker threads
+	virtual bool IsModelVisible(const ISceneNode3D* SceneNode, const IModel* Model) const;
+
+private:
+	void RecordCommands();
+	void ReplayCommands();
+
+private:
+	std::vector<SList3DDrawCommand>              m_Commands;
+	std::vector<std::vector<SList3DDrawCommand>> m_TasksCommands;
+	std::shared_ptr<ISettingT<bool>>             m_NullDeviceReplay;
+};
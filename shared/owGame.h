@@ -18,6 +18,12 @@
 #include "../owGame/Client/ObjectGUID.h"
 #include "../owGame/Client/Client.h"
 
+// Formats
+#include "../owGame/Formats/ImageBLP.h"
+
+// Textures
+#include "../owGame/Textures/TexturesCache.h"
+
 // Liquid
 #include "../owGame/Liquid/Liquid.h"
 #include "../owGame/Liquid/LiquidInstance.h"
@@ -25,8 +31,10 @@
 
 // M2
 #include "../owGame/M2/M2_Base_Instance.h"
+#include "../owGame/M2/M2_CollisionBenchmark.h"
 #include "../owGame/M2/RenderPass_M2.h"
 #include "../owGame/M2/RenderPass_M2Instanced.h"
+#include "../owGame/M2/RenderPass_M2Particles.h"
 
 // WMO
 #include "../owGame/WMO/WMO_Base_Instance.h"